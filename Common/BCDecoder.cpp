@@ -0,0 +1,934 @@
+//***************************************************************************************
+// BCDecoder.cpp
+//
+// Block layouts follow the Direct3D 11 functional specification (BC6H and BC7 as in
+// the "BC6H/BC7 format" sections); interpolation uses the specification's integer
+// weights for BC6H and BC7 and rounds to nearest for BC1 to BC5.
+//***************************************************************************************
+
+#include "BCDecoder.h"
+#include "BCTables.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cstring>
+
+// The AVX2 lookups are compiled on every x86-64 build and picked at run time, so the
+// project does not have to require AVX2 (/arch:AVX2) of every machine it runs on.
+#if defined(_M_X64) || defined(__x86_64__)
+#define BC_DECODER_AVX2 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+#if defined(__GNUC__) || defined(__clang__)
+#define BC_DECODER_TARGET_AVX2 __attribute__((target("avx2")))
+#else
+#define BC_DECODER_TARGET_AVX2
+#endif
+#endif
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define BC_DECODER_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    using namespace BCTables;
+
+    using uint8 = std::uint8_t;
+    using uint16 = std::uint16_t;
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    enum class BlockKind
+    {
+        None,
+        BC1,
+        BC2,
+        BC3,
+        BC4U,
+        BC4S,
+        BC5U,
+        BC5S,
+        BC6HU,
+        BC6HS,
+        BC7
+    };
+
+    BlockKind GetBlockKind(DXGI_FORMAT format)
+    {
+        switch(format)
+        {
+        case DXGI_FORMAT_BC1_TYPELESS:
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:    return BlockKind::BC1;
+        case DXGI_FORMAT_BC2_TYPELESS:
+        case DXGI_FORMAT_BC2_UNORM:
+        case DXGI_FORMAT_BC2_UNORM_SRGB:    return BlockKind::BC2;
+        case DXGI_FORMAT_BC3_TYPELESS:
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:    return BlockKind::BC3;
+        case DXGI_FORMAT_BC4_TYPELESS:
+        case DXGI_FORMAT_BC4_UNORM:         return BlockKind::BC4U;
+        case DXGI_FORMAT_BC4_SNORM:         return BlockKind::BC4S;
+        case DXGI_FORMAT_BC5_TYPELESS:
+        case DXGI_FORMAT_BC5_UNORM:         return BlockKind::BC5U;
+        case DXGI_FORMAT_BC5_SNORM:         return BlockKind::BC5S;
+        case DXGI_FORMAT_BC6H_TYPELESS:
+        case DXGI_FORMAT_BC6H_UF16:         return BlockKind::BC6HU;
+        case DXGI_FORMAT_BC6H_SF16:         return BlockKind::BC6HS;
+        case DXGI_FORMAT_BC7_TYPELESS:
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:    return BlockKind::BC7;
+        default:                            return BlockKind::None;
+        }
+    }
+
+    uint32 GetBlockSize(BlockKind kind)
+    {
+        return kind == BlockKind::BC1 || kind == BlockKind::BC4U || kind == BlockKind::BC4S ? 8 : 16;
+    }
+
+    uint64 LoadU64(const uint8* data)
+    {
+        uint64 value;
+        std::memcpy(&value, data, sizeof(value));
+        return value;
+    }
+
+    uint32 PackRGBA(uint32 r, uint32 g, uint32 b, uint32 a)
+    {
+        return r | (g << 8) | (b << 16) | (a << 24);
+    }
+
+    //-----------------------------------------------------------------------------------
+    // Palette lookups shared by BC1 to BC5.  Pixels are R8G8B8A8 words, row by row.
+    //-----------------------------------------------------------------------------------
+
+#if defined(BC_DECODER_AVX2)
+    bool HasAvx2()
+    {
+#if defined(__AVX2__)
+        return true;
+#elif defined(_MSC_VER) && !defined(__clang__)
+        // AVX2 needs the instructions (CPUID 7 EBX bit 5) and an OS that saves the ymm
+        // registers (OSXSAVE, then XCR0 bits 1 and 2).
+        int info[4];
+        __cpuid(info, 0);
+        if(info[0] < 7)
+            return false;
+
+        __cpuid(info, 1);
+        const int osxsave = 1 << 27, avx = 1 << 28;
+        if((info[2] & (osxsave | avx)) != (osxsave | avx) || (_xgetbv(0) & 6) != 6)
+            return false;
+
+        __cpuidex(info, 7, 0);
+        return (info[1] & (1 << 5)) != 0;
+#else
+        return __builtin_cpu_supports("avx2") != 0;
+#endif
+    }
+
+    const bool UseAvx2 = HasAvx2();
+
+    BC_DECODER_TARGET_AVX2 void Lookup4Avx2(const uint32 palette[4], uint32 indices, uint32 pixels[16])
+    {
+        const __m256i table = _mm256_setr_epi32(palette[0], palette[1], palette[2], palette[3],
+                                                palette[0], palette[1], palette[2], palette[3]);
+        const __m256i shifts = _mm256_setr_epi32(0, 2, 4, 6, 8, 10, 12, 14);
+        const __m256i mask = _mm256_set1_epi32(3);
+
+        __m256i lo = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)(indices & 0xffff)), shifts), mask);
+        __m256i hi = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)(indices >> 16)), shifts), mask);
+        _mm256_storeu_si256((__m256i*)pixels, _mm256_permutevar8x32_epi32(table, lo));
+        _mm256_storeu_si256((__m256i*)(pixels + 8), _mm256_permutevar8x32_epi32(table, hi));
+    }
+
+    BC_DECODER_TARGET_AVX2 void Lookup8Avx2(const uint32 palette[8], uint64 indices, uint32 pixels[16])
+    {
+        const __m256i table = _mm256_loadu_si256((const __m256i*)palette);
+        const __m256i shifts = _mm256_setr_epi32(0, 3, 6, 9, 12, 15, 18, 21);
+        const __m256i mask = _mm256_set1_epi32(7);
+
+        __m256i lo = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)(indices & 0xffffff)), shifts), mask);
+        __m256i hi = _mm256_and_si256(_mm256_srlv_epi32(_mm256_set1_epi32((int)((indices >> 24) & 0xffffff)), shifts), mask);
+        _mm256_storeu_si256((__m256i*)pixels, _mm256_permutevar8x32_epi32(table, lo));
+        _mm256_storeu_si256((__m256i*)(pixels + 8), _mm256_permutevar8x32_epi32(table, hi));
+    }
+#endif
+
+    // 16 2-bit indices, pixel 0 in the low bits.
+    void Lookup4(const uint32 palette[4], uint32 indices, uint32 pixels[16])
+    {
+#if defined(BC_DECODER_AVX2)
+        if(UseAvx2)
+        {
+            Lookup4Avx2(palette, indices, pixels);
+            return;
+        }
+#endif
+        for(uint32 i = 0; i < 16; ++i)
+            pixels[i] = palette[(indices >> (2*i)) & 3];
+    }
+
+    // 16 3-bit indices in the low 48 bits, pixel 0 in the low bits.
+    void Lookup8(const uint32 palette[8], uint64 indices, uint32 pixels[16])
+    {
+#if defined(BC_DECODER_AVX2)
+        if(UseAvx2)
+        {
+            Lookup8Avx2(palette, indices, pixels);
+            return;
+        }
+#endif
+        for(uint32 i = 0; i < 16; ++i)
+            pixels[i] = palette[(indices >> (3*i)) & 7];
+    }
+
+    // The 565 color block of BC1 to BC3.  Alpha is 255, or 0 for BC1's transparent entry.
+    void DecodeColorBlock(const uint8* block, bool allowThreeColor, uint32 pixels[16])
+    {
+        uint32 c0 = block[0] | (block[1] << 8);
+        uint32 c1 = block[2] | (block[3] << 8);
+        uint32 indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32)block[7] << 24);
+
+        uint32 r0 = (c0 >> 11) & 31, g0 = (c0 >> 5) & 63, b0 = c0 & 31;
+        uint32 r1 = (c1 >> 11) & 31, g1 = (c1 >> 5) & 63, b1 = c1 & 31;
+        r0 = (r0 << 3) | (r0 >> 2); g0 = (g0 << 2) | (g0 >> 4); b0 = (b0 << 3) | (b0 >> 2);
+        r1 = (r1 << 3) | (r1 >> 2); g1 = (g1 << 2) | (g1 >> 4); b1 = (b1 << 3) | (b1 >> 2);
+
+        uint32 palette[4];
+        palette[0] = PackRGBA(r0, g0, b0, 255);
+        palette[1] = PackRGBA(r1, g1, b1, 255);
+        if(!allowThreeColor || c0 > c1)
+        {
+            palette[2] = PackRGBA((2*r0 + r1 + 1) / 3, (2*g0 + g1 + 1) / 3, (2*b0 + b1 + 1) / 3, 255);
+            palette[3] = PackRGBA((r0 + 2*r1 + 1) / 3, (g0 + 2*g1 + 1) / 3, (b0 + 2*b1 + 1) / 3, 255);
+        }
+        else
+        {
+            palette[2] = PackRGBA((r0 + r1 + 1) / 2, (g0 + g1 + 1) / 2, (b0 + b1 + 1) / 2, 255);
+            palette[3] = 0;
+        }
+
+        Lookup4(palette, indices, pixels);
+    }
+
+    // The 8-value palette of a BC4 block (also BC3 alpha and each BC5 channel).
+    void GetUnormPalette(const uint8* block, uint32 palette[8])
+    {
+        uint32 a0 = block[0];
+        uint32 a1 = block[1];
+        palette[0] = a0;
+        palette[1] = a1;
+        if(a0 > a1)
+        {
+            for(uint32 i = 1; i < 7; ++i)
+                palette[i + 1] = ((7 - i)*a0 + i*a1 + 3) / 7;
+        }
+        else
+        {
+            for(uint32 i = 1; i < 5; ++i)
+                palette[i + 1] = ((5 - i)*a0 + i*a1 + 2) / 5;
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+    }
+
+    int RoundedDivide(int numerator, int denominator)
+    {
+        return (numerator + (numerator >= 0 ? denominator / 2 : -(denominator / 2))) / denominator;
+    }
+
+    // Signed values, returned as their byte patterns.
+    void GetSnormPalette(const uint8* block, uint32 palette[8])
+    {
+        // -128 and -127 both mean -1.
+        int a0 = std::max((int)(std::int8_t)block[0], -127);
+        int a1 = std::max((int)(std::int8_t)block[1], -127);
+
+        int values[8];
+        values[0] = a0;
+        values[1] = a1;
+        if(a0 > a1)
+        {
+            for(int i = 1; i < 7; ++i)
+                values[i + 1] = RoundedDivide((7 - i)*a0 + i*a1, 7);
+        }
+        else
+        {
+            for(int i = 1; i < 5; ++i)
+                values[i + 1] = RoundedDivide((5 - i)*a0 + i*a1, 5);
+            values[6] = -127;
+            values[7] = 127;
+        }
+
+        for(int i = 0; i < 8; ++i)
+            palette[i] = (uint8)values[i];
+    }
+
+    uint64 GetValueIndices(const uint8* block)
+    {
+        return LoadU64(block) >> 16;
+    }
+
+    // One channel palette shifted into place, ORed over pixels.
+    void MergeChannel(const uint8* block, bool isSigned, uint32 shift, uint32 pixels[16])
+    {
+        uint32 palette[8];
+        if(isSigned)
+            GetSnormPalette(block, palette);
+        else
+            GetUnormPalette(block, palette);
+        for(uint32 i = 0; i < 8; ++i)
+            palette[i] <<= shift;
+
+        uint32 channel[16];
+        Lookup8(palette, GetValueIndices(block), channel);
+        for(uint32 i = 0; i < 16; ++i)
+            pixels[i] |= channel[i];
+    }
+
+    void DecodeBC1(const uint8* block, uint32 pixels[16])
+    {
+        DecodeColorBlock(block, true, pixels);
+    }
+
+    void DecodeBC2(const uint8* block, uint32 pixels[16])
+    {
+        DecodeColorBlock(block + 8, false, pixels);
+
+        uint64 alpha = LoadU64(block);
+        for(uint32 i = 0; i < 16; ++i)
+            pixels[i] = (pixels[i] & 0x00ffffff) | ((uint32)((alpha >> (4*i)) & 15) * 17 << 24);
+    }
+
+    void DecodeBC3(const uint8* block, uint32 pixels[16])
+    {
+        DecodeColorBlock(block + 8, false, pixels);
+        for(uint32 i = 0; i < 16; ++i)
+            pixels[i] &= 0x00ffffff;
+        MergeChannel(block, false, 24, pixels);
+    }
+
+    void DecodeBC4(const uint8* block, bool isSigned, uint32 pixels[16])
+    {
+        uint32 one = isSigned ? 0x7f000000u : 0xff000000u;
+        for(uint32 i = 0; i < 16; ++i)
+            pixels[i] = one;
+        MergeChannel(block, isSigned, 0, pixels);
+    }
+
+    void DecodeBC5(const uint8* block, bool isSigned, uint32 pixels[16])
+    {
+        DecodeBC4(block, isSigned, pixels);
+        MergeChannel(block + 8, isSigned, 8, pixels);
+    }
+
+    //-----------------------------------------------------------------------------------
+    // BC6H and BC7
+    //-----------------------------------------------------------------------------------
+
+    // Reads a 128-bit block from bit 0 up.
+    class BitReader
+    {
+    public:
+        explicit BitReader(const uint8* block) : mLo(LoadU64(block)), mHi(LoadU64(block + 8)) {}
+
+        uint32 Read(uint32 count)
+        {
+            if(count == 0)
+                return 0;
+
+            uint64 bits;
+            if(mPosition >= 64)
+                bits = mHi >> (mPosition - 64);
+            else if(mPosition + count <= 64)
+                bits = mLo >> mPosition;
+            else
+                bits = (mLo >> mPosition) | (mHi << (64 - mPosition));
+
+            mPosition += count;
+            return (uint32)(bits & ((1ull << count) - 1));
+        }
+
+        uint32 GetPosition() const { return mPosition; }
+        void SetPosition(uint32 position) { mPosition = position; }
+
+    private:
+        uint64 mLo;
+        uint64 mHi;
+        uint32 mPosition = 0;
+    };
+
+    // palette[k] = ((64 - w)*e0 + w*e1 + 32) >> 6 per channel, count even.
+    void InterpolateRGBA(const uint8 e0[4], const uint8 e1[4], const uint8* weights, uint32 count, uint32* palette)
+    {
+#if defined(BC_DECODER_SSE2)
+        // Two palette entries per register, four 16-bit channels each.
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i round = _mm_set1_epi16(32);
+        uint32 packed0, packed1;
+        std::memcpy(&packed0, e0, 4);
+        std::memcpy(&packed1, e1, 4);
+        __m128i v0 = _mm_unpacklo_epi8(_mm_set1_epi32((int)packed0), zero);
+        __m128i v1 = _mm_unpacklo_epi8(_mm_set1_epi32((int)packed1), zero);
+
+        for(uint32 k = 0; k < count; k += 2)
+        {
+            __m128i w = _mm_setr_epi16(weights[k], weights[k], weights[k], weights[k],
+                                       weights[k + 1], weights[k + 1], weights[k + 1], weights[k + 1]);
+            __m128i iw = _mm_sub_epi16(_mm_set1_epi16(64), w);
+            __m128i sum = _mm_add_epi16(_mm_add_epi16(_mm_mullo_epi16(v0, iw), _mm_mullo_epi16(v1, w)), round);
+            __m128i result = _mm_packus_epi16(_mm_srli_epi16(sum, 6), zero);
+            _mm_storel_epi64((__m128i*)(palette + k), result);
+        }
+#else
+        for(uint32 k = 0; k < count; ++k)
+        {
+            uint32 w = weights[k];
+            uint32 channels[4];
+            for(uint32 c = 0; c < 4; ++c)
+                channels[c] = ((64 - w)*e0[c] + w*e1[c] + 32) >> 6;
+            palette[k] = PackRGBA(channels[0], channels[1], channels[2], channels[3]);
+        }
+#endif
+    }
+
+    void DecodeBC7(const uint8* block, uint32 pixels[16])
+    {
+        uint32 modeIndex = 0;
+        while(modeIndex < 8 && !(block[0] & (1 << modeIndex)))
+            ++modeIndex;
+
+        if(modeIndex == 8)
+        {
+            std::fill(pixels, pixels + 16, 0u);
+            return;
+        }
+
+        const BC7Mode& mode = BC7Modes[modeIndex];
+        BitReader bits(block);
+        bits.SetPosition(modeIndex + 1);
+
+        uint32 partition = bits.Read(mode.PartitionBits);
+        uint32 rotation = bits.Read(mode.RotationBits);
+        uint32 indexSelection = bits.Read(mode.IndexSelectionBits);
+
+        uint32 endpointCount = 2*mode.SubsetCount;
+        uint32 endpoints[6][4];
+        for(uint32 c = 0; c < 3; ++c)
+        {
+            for(uint32 e = 0; e < endpointCount; ++e)
+                endpoints[e][c] = bits.Read(mode.ColorBits);
+        }
+        for(uint32 e = 0; e < endpointCount; ++e)
+            endpoints[e][3] = bits.Read(mode.AlphaBits);
+
+        uint32 colorBits = mode.ColorBits;
+        uint32 alphaBits = mode.AlphaBits;
+        if(mode.EndpointPBits || mode.SharedPBits)
+        {
+            uint32 pbits[6];
+            if(mode.EndpointPBits)
+            {
+                for(uint32 e = 0; e < endpointCount; ++e)
+                    pbits[e] = bits.Read(1);
+            }
+            else
+            {
+                for(uint32 s = 0; s < mode.SubsetCount; ++s)
+                    pbits[2*s] = pbits[2*s + 1] = bits.Read(1);
+            }
+
+            for(uint32 e = 0; e < endpointCount; ++e)
+            {
+                for(uint32 c = 0; c < 4; ++c)
+                    endpoints[e][c] = (endpoints[e][c] << 1) | pbits[e];
+            }
+            ++colorBits;
+            if(alphaBits)
+                ++alphaBits;
+        }
+
+        uint8 expanded[6][4];
+        for(uint32 e = 0; e < endpointCount; ++e)
+        {
+            for(uint32 c = 0; c < 3; ++c)
+                expanded[e][c] = (uint8)((endpoints[e][c] << (8 - colorBits)) | (endpoints[e][c] >> (2*colorBits - 8)));
+            expanded[e][3] = alphaBits ?
+                (uint8)((endpoints[e][3] << (8 - alphaBits)) | (endpoints[e][3] >> (2*alphaBits - 8))) : 255;
+        }
+
+        uint32 indices[16];
+        for(uint32 i = 0; i < 16; ++i)
+            indices[i] = bits.Read(mode.IndexBits - (IsAnchor(mode.SubsetCount, partition, i) ? 1 : 0));
+
+        if(mode.SecondaryIndexBits == 0)
+        {
+            uint32 colorCount = 1u << mode.IndexBits;
+            uint32 palette[3][16];
+            for(uint32 s = 0; s < mode.SubsetCount; ++s)
+                InterpolateRGBA(expanded[2*s], expanded[2*s + 1], GetWeights(mode.IndexBits), colorCount, palette[s]);
+
+            for(uint32 i = 0; i < 16; ++i)
+                pixels[i] = palette[GetSubset(mode.SubsetCount, partition, i)][indices[i]];
+        }
+        else
+        {
+            uint32 secondary[16];
+            for(uint32 i = 0; i < 16; ++i)
+                secondary[i] = bits.Read(mode.SecondaryIndexBits - (i == 0 ? 1 : 0));
+
+            // Modes 4 and 5: one subset, color and alpha with separate index sets.
+            uint32 colorIndexBits = indexSelection ? mode.SecondaryIndexBits : mode.IndexBits;
+            uint32 alphaIndexBits = indexSelection ? mode.IndexBits : mode.SecondaryIndexBits;
+            const uint32* colorIndices = indexSelection ? secondary : indices;
+            const uint32* alphaIndices = indexSelection ? indices : secondary;
+
+            uint32 colorPalette[8];
+            uint32 alphaPalette[8];
+            InterpolateRGBA(expanded[0], expanded[1], GetWeights(colorIndexBits), 1u << colorIndexBits, colorPalette);
+            InterpolateRGBA(expanded[0], expanded[1], GetWeights(alphaIndexBits), 1u << alphaIndexBits, alphaPalette);
+
+            for(uint32 i = 0; i < 16; ++i)
+                pixels[i] = (colorPalette[colorIndices[i]] & 0x00ffffff) | (alphaPalette[alphaIndices[i]] & 0xff000000);
+        }
+
+        // Rotation swaps alpha with red, green or blue.
+        if(rotation != 0)
+        {
+            uint32 shift = 8*(rotation - 1);
+            for(uint32 i = 0; i < 16; ++i)
+            {
+                uint32 a = pixels[i] >> 24;
+                uint32 c = (pixels[i] >> shift) & 0xff;
+                pixels[i] = (pixels[i] & ~(0xffu << shift) & 0x00ffffff) | (a << shift) | (c << 24);
+            }
+        }
+    }
+
+    // BC6H endpoint fields: the w (first), x, y and z endpoints of each channel, and the
+    // partition.
+    enum BC6HField : uint8
+    {
+        RW, RX, RY, RZ,
+        GW, GX, GY, GZ,
+        BW, BX, BY, BZ,
+        D
+    };
+
+    // Bits First..Last of Field, in stream order (First > Last reads them backwards).
+    struct BC6HBits
+    {
+        uint8 Field;
+        uint8 First;
+        uint8 Last;
+    };
+
+    struct BC6HMode
+    {
+        uint8 Transformed;
+        uint8 RegionCount;
+        uint8 EndpointBits;
+        uint8 DeltaBits[3];
+        uint8 LayoutCount;
+        BC6HBits Layout[24];
+    };
+
+    // Indexed by mode number; the 2-bit modes are 0 and 1, the 5-bit ones are their
+    // value.  Reserved modes have EndpointBits == 0.
+    const BC6HMode BC6HModes[32] =
+    {
+        // 0x00: 10 bits, deltas 5.5.5
+        { 1, 2, 10, { 5, 5, 5 }, 20, {
+            { GY, 4, 4 }, { BY, 4, 4 }, { BZ, 4, 4 }, { RW, 0, 9 }, { GW, 0, 9 }, { BW, 0, 9 }, { RX, 0, 4 },
+            { GZ, 4, 4 }, { GY, 0, 3 }, { GX, 0, 4 }, { BZ, 0, 0 }, { GZ, 0, 3 }, { BX, 0, 4 }, { BZ, 1, 1 },
+            { BY, 0, 3 }, { RY, 0, 4 }, { BZ, 2, 2 }, { RZ, 0, 4 }, { BZ, 3, 3 }, { D, 0, 4 } } },
+        // 0x01: 7 bits, deltas 6.6.6
+        { 1, 2, 7, { 6, 6, 6 }, 22, {
+            { GY, 5, 5 }, { GZ, 4, 5 }, { RW, 0, 6 }, { BZ, 0, 1 }, { BY, 4, 4 }, { GW, 0, 6 }, { BY, 5, 5 },
+            { BZ, 2, 2 }, { GY, 4, 4 }, { BW, 0, 6 }, { BZ, 3, 3 }, { BZ, 5, 5 }, { BZ, 4, 4 }, { RX, 0, 5 },
+            { GY, 0, 3 }, { GX, 0, 5 }, { GZ, 0, 3 }, { BX, 0, 5 }, { BY, 0, 3 }, { RY, 0, 5 }, { RZ, 0, 5 },
+            { D, 0, 4 } } },
+        // 0x02: 11 bits, deltas 5.4.4
+        { 1, 2, 11, { 5, 4, 4 }, 19, {
+            { RW, 0, 9 }, { GW, 0, 9 }, { BW, 0, 9 }, { RX, 0, 4 }, { RW, 10, 10 }, { GY, 0, 3 }, { GX, 0, 3 },
+            { GW, 10, 10 }, { BZ, 0, 0 }, { GZ, 0, 3 }, { BX, 0, 3 }, { BW, 10, 10 }, { BZ, 1, 1 }, { BY, 0, 3 },
+            { RY, 0, 4 }, { BZ, 2, 2 }, { RZ, 0, 4 }, { BZ, 3, 3 }, { D, 0, 4 } } },
+        // 0x03: one region, 10 bits, not transformed
+        { 0, 1, 10, { 10, 10, 10 }, 6, {
+            { RW, 0, 9 }, { GW, 0, 9 }, { BW, 0, 9 }, { RX, 0, 9 }, { GX, 0, 9 }, { BX, 0, 9 } } },
+        {}, {},
+        // 0x06: 11 bits, deltas 4.5.4
+        { 1, 2, 11, { 4, 5, 4 }, 21, {
+            { RW, 0, 9 }, { GW, 0, 9 }, { BW, 0, 9 }, { RX, 0, 3 }, { RW, 10, 10 }, { GZ, 4, 4 }, { GY, 0, 3 },
+            { GX, 0, 4 }, { GW, 10, 10 }, { GZ, 0, 3 }, { BX, 0, 3 }, { BW, 10, 10 }, { BZ, 1, 1 }, { BY, 0, 3 },
+            { RY, 0, 3 }, { BZ, 0, 0 }, { BZ, 2, 2 }, { RZ, 0, 3 }, { GY, 4, 4 }, { BZ, 3, 3 }, { D, 0, 4 } } },
+        // 0x07: one region, 11 bits, deltas 9
+        { 1, 1, 11, { 9, 9, 9 }, 9, {
+            { RW, 0, 9 }, { GW, 0, 9 }, { BW, 0, 9 }, { RX, 0, 8 }, { RW, 10, 10 }, { GX, 0, 8 }, { GW, 10, 10 },
+            { BX, 0, 8 }, { BW, 10, 10 } } },
+        {}, {},
+        // 0x0A: 11 bits, deltas 4.4.5
+        { 1, 2, 11, { 4, 4, 5 }, 20, {
+            { RW, 0, 9 }, { GW, 0, 9 }, { BW, 0, 9 }, { RX, 0, 3 }, { RW, 10, 10 }, { BY, 4, 4 }, { GY, 0, 3 },
+            { GX, 0, 3 }, { GW, 10, 10 }, { BZ, 0, 0 }, { GZ, 0, 3 }, { BX, 0, 4 }, { BW, 10, 10 }, { BY, 0, 3 },
+            { RY, 0, 3 }, { BZ, 1, 2 }, { RZ, 0, 3 }, { BZ, 4, 4 }, { BZ, 3, 3 }, { D, 0, 4 } } },
+        // 0x0B: one region, 12 bits, deltas 8
+        { 1, 1, 12, { 8, 8, 8 }, 9, {
+            { RW, 0, 9 }, { GW, 0, 9 }, { BW, 0, 9 }, { RX, 0, 7 }, { RW, 11, 10 }, { GX, 0, 7 }, { GW, 11, 10 },
+            { BX, 0, 7 }, { BW, 11, 10 } } },
+        {}, {},
+        // 0x0E: 9 bits, deltas 5.5.5
+        { 1, 2, 9, { 5, 5, 5 }, 20, {
+            { RW, 0, 8 }, { BY, 4, 4 }, { GW, 0, 8 }, { GY, 4, 4 }, { BW, 0, 8 }, { BZ, 4, 4 }, { RX, 0, 4 },
+            { GZ, 4, 4 }, { GY, 0, 3 }, { GX, 0, 4 }, { BZ, 0, 0 }, { GZ, 0, 3 }, { BX, 0, 4 }, { BZ, 1, 1 },
+            { BY, 0, 3 }, { RY, 0, 4 }, { BZ, 2, 2 }, { RZ, 0, 4 }, { BZ, 3, 3 }, { D, 0, 4 } } },
+        // 0x0F: one region, 16 bits, deltas 4
+        { 1, 1, 16, { 4, 4, 4 }, 9, {
+            { RW, 0, 9 }, { GW, 0, 9 }, { BW, 0, 9 }, { RX, 0, 3 }, { RW, 15, 10 }, { GX, 0, 3 }, { GW, 15, 10 },
+            { BX, 0, 3 }, { BW, 15, 10 } } },
+        {}, {},
+        // 0x12: 8 bits, deltas 6.5.5
+        { 1, 2, 8, { 6, 5, 5 }, 19, {
+            { RW, 0, 7 }, { GZ, 4, 4 }, { BY, 4, 4 }, { GW, 0, 7 }, { BZ, 2, 2 }, { GY, 4, 4 }, { BW, 0, 7 },
+            { BZ, 3, 4 }, { RX, 0, 5 }, { GY, 0, 3 }, { GX, 0, 4 }, { BZ, 0, 0 }, { GZ, 0, 3 }, { BX, 0, 4 },
+            { BZ, 1, 1 }, { BY, 0, 3 }, { RY, 0, 5 }, { RZ, 0, 5 }, { D, 0, 4 } } },
+        {}, {}, {},
+        // 0x16: 8 bits, deltas 5.6.5
+        { 1, 2, 8, { 5, 6, 5 }, 21, {
+            { RW, 0, 7 }, { BZ, 0, 0 }, { BY, 4, 4 }, { GW, 0, 7 }, { GY, 5, 4 }, { BW, 0, 7 }, { GZ, 5, 5 },
+            { BZ, 4, 4 }, { RX, 0, 4 }, { GZ, 4, 4 }, { GY, 0, 3 }, { GX, 0, 5 }, { GZ, 0, 3 }, { BX, 0, 4 },
+            { BZ, 1, 1 }, { BY, 0, 3 }, { RY, 0, 4 }, { BZ, 2, 2 }, { RZ, 0, 4 }, { BZ, 3, 3 }, { D, 0, 4 } } },
+        {}, {}, {},
+        // 0x1A: 8 bits, deltas 5.5.6
+        { 1, 2, 8, { 5, 5, 6 }, 21, {
+            { RW, 0, 7 }, { BZ, 1, 1 }, { BY, 4, 4 }, { GW, 0, 7 }, { BY, 5, 5 }, { GY, 4, 4 }, { BW, 0, 7 },
+            { BZ, 5, 4 }, { RX, 0, 4 }, { GZ, 4, 4 }, { GY, 0, 3 }, { GX, 0, 4 }, { BZ, 0, 0 }, { GZ, 0, 3 },
+            { BX, 0, 5 }, { BY, 0, 3 }, { RY, 0, 4 }, { BZ, 2, 2 }, { RZ, 0, 4 }, { BZ, 3, 3 }, { D, 0, 4 } } },
+        {}, {}, {},
+        // 0x1E: 6 bits, not transformed
+        { 0, 2, 6, { 6, 6, 6 }, 23, {
+            { RW, 0, 5 }, { GZ, 4, 4 }, { BZ, 0, 1 }, { BY, 4, 4 }, { GW, 0, 5 }, { GY, 5, 5 }, { BY, 5, 5 },
+            { BZ, 2, 2 }, { GY, 4, 4 }, { BW, 0, 5 }, { GZ, 5, 5 }, { BZ, 3, 3 }, { BZ, 5, 5 }, { BZ, 4, 4 },
+            { RX, 0, 5 }, { GY, 0, 3 }, { GX, 0, 5 }, { GZ, 0, 3 }, { BX, 0, 5 }, { BY, 0, 3 }, { RY, 0, 5 },
+            { RZ, 0, 5 }, { D, 0, 4 } } },
+        {}
+    };
+
+    int SignExtend(int value, uint32 bits)
+    {
+        int shift = 32 - (int)bits;
+        return (int)((uint32)value << shift) >> shift;
+    }
+
+    int UnquantizeBC6H(int value, uint32 bits, bool isSigned)
+    {
+        if(!isSigned)
+        {
+            if(bits >= 15 || value == 0)
+                return value;
+            if(value == (1 << bits) - 1)
+                return 0xffff;
+            return ((value << 16) + 0x8000) >> bits;
+        }
+
+        if(bits >= 16)
+            return value;
+
+        bool negative = value < 0;
+        int magnitude = negative ? -value : value;
+        int result;
+        if(magnitude == 0)
+            result = 0;
+        else if(magnitude >= (1 << (bits - 1)) - 1)
+            result = 0x7fff;
+        else
+            result = ((magnitude << 15) + 0x4000) >> (bits - 1);
+
+        return negative ? -result : result;
+    }
+
+    uint16 FinishUnquantizeBC6H(int value, bool isSigned)
+    {
+        if(!isSigned)
+            return (uint16)((value * 31) >> 6);
+
+        int magnitude = value < 0 ? ((-value) * 31) >> 5 : (value * 31) >> 5;
+        return (uint16)(value < 0 ? (0x8000 | magnitude) : magnitude);
+    }
+
+    // Four half floats per pixel.
+    void DecodeBC6H(const uint8* block, bool isSigned, uint16 pixels[16][4])
+    {
+        const uint16 halfOne = 0x3c00;
+
+        uint32 modeValue = block[0] & 3;
+        if(modeValue >= 2)
+            modeValue = block[0] & 31;
+
+        const BC6HMode& mode = BC6HModes[modeValue];
+        if(mode.EndpointBits == 0)
+        {
+            for(uint32 i = 0; i < 16; ++i)
+            {
+                pixels[i][0] = pixels[i][1] = pixels[i][2] = 0;
+                pixels[i][3] = halfOne;
+            }
+            return;
+        }
+
+        BitReader bits(block);
+        bits.SetPosition(modeValue < 2 ? 2 : 5);
+
+        int fields[13] = {};
+        for(uint32 i = 0; i < mode.LayoutCount; ++i)
+        {
+            const BC6HBits& range = mode.Layout[i];
+            if(range.First <= range.Last)
+            {
+                fields[range.Field] |= (int)bits.Read(range.Last - range.First + 1) << range.First;
+                continue;
+            }
+
+            // Reversed ranges (the 6-bit red endpoints of mode 0x0f) go a bit at a time.
+            for(int b = range.First; b >= range.Last; --b)
+                fields[range.Field] |= (int)bits.Read(1) << b;
+        }
+
+        // endpoints[region*2 + e][channel]: w,x for region 0 and y,z for region 1.
+        uint32 endpointCount = 2*mode.RegionCount;
+        int endpoints[4][3];
+        for(uint32 c = 0; c < 3; ++c)
+        {
+            int* channel = &fields[4*c];
+            uint32 endpointBits = mode.EndpointBits;
+
+            endpoints[0][c] = channel[0];
+            for(uint32 e = 1; e < endpointCount; ++e)
+                endpoints[e][c] = channel[e];
+
+            if(isSigned)
+                endpoints[0][c] = SignExtend(endpoints[0][c], endpointBits);
+
+            for(uint32 e = 1; e < endpointCount; ++e)
+            {
+                if(mode.Transformed)
+                {
+                    // Deltas from the first endpoint, wrapped to the endpoint precision.
+                    int delta = SignExtend(endpoints[e][c], mode.DeltaBits[c]);
+                    endpoints[e][c] = (endpoints[0][c] + delta) & ((1 << endpointBits) - 1);
+                }
+                if(isSigned)
+                    endpoints[e][c] = SignExtend(endpoints[e][c], endpointBits);
+            }
+        }
+
+        for(uint32 e = 0; e < endpointCount; ++e)
+        {
+            for(uint32 c = 0; c < 3; ++c)
+                endpoints[e][c] = UnquantizeBC6H(endpoints[e][c], mode.EndpointBits, isSigned);
+        }
+
+        uint32 partition = fields[D];
+        uint32 indexBits = mode.RegionCount == 2 ? 3 : 4;
+        const uint8* weights = GetWeights(indexBits);
+
+        bits.SetPosition(mode.RegionCount == 2 ? 82 : 65);
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            uint32 region = mode.RegionCount == 2 ? (Partitions2[partition] >> i) & 1 : 0;
+            bool anchor = i == 0 || (mode.RegionCount == 2 && i == Anchor2[partition]);
+            uint32 w = weights[bits.Read(indexBits - (anchor ? 1 : 0))];
+
+            const int* e0 = endpoints[2*region];
+            const int* e1 = endpoints[2*region + 1];
+            for(uint32 c = 0; c < 3; ++c)
+                pixels[i][c] = FinishUnquantizeBC6H((e0[c]*(64 - (int)w) + e1[c]*(int)w + 32) >> 6, isSigned);
+            pixels[i][3] = halfOne;
+        }
+    }
+
+    // Decodes a block into 4 rows of 4 pixels, packed (16 or 32 bytes a row).
+    void DecodeBlockPacked(BlockKind kind, const uint8* block, uint8* pixels)
+    {
+        uint32 words[16];
+        switch(kind)
+        {
+        case BlockKind::BC1:   DecodeBC1(block, words); break;
+        case BlockKind::BC2:   DecodeBC2(block, words); break;
+        case BlockKind::BC3:   DecodeBC3(block, words); break;
+        case BlockKind::BC4U:  DecodeBC4(block, false, words); break;
+        case BlockKind::BC4S:  DecodeBC4(block, true, words); break;
+        case BlockKind::BC5U:  DecodeBC5(block, false, words); break;
+        case BlockKind::BC5S:  DecodeBC5(block, true, words); break;
+        case BlockKind::BC7:   DecodeBC7(block, words); break;
+
+        case BlockKind::BC6HU:
+        case BlockKind::BC6HS:
+            DecodeBC6H(block, kind == BlockKind::BC6HS, reinterpret_cast<uint16(*)[4]>(pixels));
+            return;
+
+        default:
+            std::memset(words, 0, sizeof(words));
+            break;
+        }
+
+        std::memcpy(pixels, words, sizeof(words));
+    }
+
+    bool Fail(std::string* error, const std::string& message)
+    {
+        if(error)
+            *error = message;
+        return false;
+    }
+}
+
+bool BCDecoder::IsSupported(DXGI_FORMAT format)
+{
+    return GetBlockKind(format) != BlockKind::None;
+}
+
+DXGI_FORMAT BCDecoder::GetDecodedFormat(DXGI_FORMAT format)
+{
+    switch(format)
+    {
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC4_SNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+        return DXGI_FORMAT_R8G8B8A8_SNORM;
+
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+        return DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+    default:
+        return IsSupported(format) ? DXGI_FORMAT_R8G8B8A8_UNORM : DXGI_FORMAT_UNKNOWN;
+    }
+}
+
+BCDecoder::uint32 BCDecoder::GetDecodedPixelSize(DXGI_FORMAT format)
+{
+    BlockKind kind = GetBlockKind(format);
+    if(kind == BlockKind::None)
+        return 0;
+    return kind == BlockKind::BC6HU || kind == BlockKind::BC6HS ? 8 : 4;
+}
+
+void BCDecoder::DecodeBlock(DXGI_FORMAT format, const std::uint8_t* block, void* dest, size_t destRowPitch)
+{
+    uint8 pixels[4*4*8];
+    DecodeBlockPacked(GetBlockKind(format), block, pixels);
+
+    size_t rowSize = 4*(size_t)GetDecodedPixelSize(format);
+    for(uint32 y = 0; y < 4; ++y)
+        std::memcpy(static_cast<uint8*>(dest) + y*destRowPitch, pixels + y*rowSize, rowSize);
+}
+
+bool BCDecoder::Decode(DXGI_FORMAT format, const std::uint8_t* source, size_t sourceRowPitch,
+                       uint32 width, uint32 height, void* dest, size_t destRowPitch)
+{
+    BlockKind kind = GetBlockKind(format);
+    if(kind == BlockKind::None || source == nullptr || dest == nullptr)
+        return false;
+
+    uint32 blockSize = GetBlockSize(kind);
+    uint32 pixelSize = GetDecodedPixelSize(format);
+    uint32 blocksWide = (width + 3) / 4;
+    uint32 blocksHigh = (height + 3) / 4;
+
+    // A few bands per thread keeps the threads busy when some bands hold costlier modes.
+    ThreadPool& pool = ThreadPool::Get();
+    uint32 bandCount = std::min(blocksHigh, pool.GetThreadCount()*4);
+    if(bandCount == 0)
+        return true;
+
+    pool.ParallelFor(bandCount, [&](uint32 band)
+    {
+        uint32 firstRow = (uint32)((uint64)blocksHigh*band / bandCount);
+        uint32 lastRow = (uint32)((uint64)blocksHigh*(band + 1) / bandCount);
+
+        uint8 pixels[4*4*8];
+        for(uint32 by = firstRow; by < lastRow; ++by)
+        {
+            const uint8* block = source + by*sourceRowPitch;
+            uint8* destRow = static_cast<uint8*>(dest) + (size_t)by*4*destRowPitch;
+            uint32 rows = std::min(4u, height - by*4);
+
+            for(uint32 bx = 0; bx < blocksWide; ++bx, block += blockSize)
+            {
+                DecodeBlockPacked(kind, block, pixels);
+
+                uint32 columns = std::min(4u, width - bx*4);
+                for(uint32 y = 0; y < rows; ++y)
+                {
+                    std::memcpy(destRow + y*destRowPitch + (size_t)bx*4*pixelSize,
+                                pixels + y*4*pixelSize, (size_t)columns*pixelSize);
+                }
+            }
+        }
+    });
+
+    return true;
+}
+
+bool BCDecoder::DecodeSubresource(const std::uint8_t* fileData, uint64 fileSize, uint32 mip, uint32 slice,
+                                  Image& image, std::string* error)
+{
+    image = Image();
+
+    DDSParser::Layout layout;
+    if(DDSParser::Parse(fileData, fileSize, layout) != DDSParser::Result::Ok)
+        return Fail(error, "not a valid DDS file");
+
+    const DDSParser::TextureDesc& desc = layout.Desc;
+    if(!IsSupported(desc.Format))
+        return Fail(error, "not a block-compressed format");
+
+    bool isVolume = desc.Dimension == DDSParser::TextureDimension::Texture3D;
+    if(mip >= desc.MipCount || slice >= (isVolume ? 1 : desc.ArraySize))
+    {
+        // A volume's slices are checked against its mip's depth below.
+        if(mip >= desc.MipCount || !isVolume)
+            return Fail(error, "mip or slice out of range");
+    }
+
+    const DDSParser::Subresource& subresource = layout.Subresources[isVolume ? mip : slice*desc.MipCount + mip];
+    if(isVolume && slice >= subresource.Depth)
+        return Fail(error, "mip or slice out of range");
+
+    const std::uint8_t* source = fileData + subresource.Offset + (isVolume ? slice*subresource.SlicePitch : 0);
+
+    image.Format = GetDecodedFormat(desc.Format);
+    image.Width = subresource.Width;
+    image.Height = subresource.Height;
+    image.RowPitch = (size_t)image.Width*GetDecodedPixelSize(desc.Format);
+    image.Pixels.resize(image.RowPitch*image.Height);
+
+    return Decode(desc.Format, source, (size_t)subresource.RowPitch, image.Width, image.Height,
+                  image.Pixels.data(), image.RowPitch);
+}
+
+bool BCDecoder::DecodeFile(const std::filesystem::path& filename, uint32 mip, uint32 slice,
+                           Image& image, std::string* error)
+{
+    MappedFile file;
+    if(!file.Open(filename))
+    {
+        image = Image();
+        return Fail(error, "cannot open " + filename.string());
+    }
+
+    return DecodeSubresource(file.GetData(), file.GetSize(), mip, slice, image, error);
+}
@@ -0,0 +1,71 @@
+//***************************************************************************************
+// BCDecoder.h
+//
+// CPU decoder for the block-compressed formats (BC1 to BC7), for headless golden-image
+// comparisons, thumbnails and a fallback when the GPU lacks a format.  Blocks decode
+// independently, so Decode splits the image into bands of block rows on the
+// ThreadPool.  On x86-64 the palette lookups of BC1 to BC5 use AVX2 when the CPU has
+// it (checked once at startup, so the build does not need /arch:AVX2), and the BC7
+// endpoint interpolation uses SSE2 on x86; elsewhere the same steps run in plain C++.
+//
+// Output formats (GetDecodedFormat):
+//   BC1, BC2, BC3, BC7      R8G8B8A8_UNORM (_SRGB for the sRGB formats)
+//   BC4, BC5                R8G8B8A8_UNORM / _SNORM as R000 / RG00, alpha one
+//   BC6H                    R16G16B16A16_FLOAT, alpha one
+// TYPELESS formats decode like their UNORM (BC6H: UF16) counterparts.  Reserved BC6H
+// and BC7 modes decode to zero, as on the GPU.
+//
+// Nothing here needs Direct3D, so it runs on the Linux tool machines against the same
+// DDS files DDSTextureLoader reads.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSParser.h"
+#include <string>
+
+class BCDecoder
+{
+public:
+
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    static bool IsSupported(DXGI_FORMAT format);
+    static DXGI_FORMAT GetDecodedFormat(DXGI_FORMAT format);
+
+	///<summary>
+	/// Bytes per decoded pixel: 4, or 8 for BC6H.  0 if the format is not supported.
+	///</summary>
+    static uint32 GetDecodedPixelSize(DXGI_FORMAT format);
+
+	///<summary>
+	/// Decodes one block into the 4x4 pixels at dest, destRowPitch bytes per row.
+	///</summary>
+    static void DecodeBlock(DXGI_FORMAT format, const std::uint8_t* block, void* dest, size_t destRowPitch);
+
+	///<summary>
+	/// Decodes a width x height surface whose block rows are sourceRowPitch bytes apart
+	/// (GetSurfaceInfo's row bytes).  Edge blocks are clipped to the surface.
+	///</summary>
+    static bool Decode(DXGI_FORMAT format, const std::uint8_t* source, size_t sourceRowPitch,
+                       uint32 width, uint32 height, void* dest, size_t destRowPitch);
+
+    struct Image
+    {
+        DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+        uint32 Width = 0;
+        uint32 Height = 0;
+        size_t RowPitch = 0;
+        std::vector<std::uint8_t> Pixels;
+    };
+
+	///<summary>
+	/// Decodes one mip of one slice of a DDS file in memory.  slice is the array slice
+	/// (cube faces count as slices), or the depth slice for a volume texture.
+	///</summary>
+    static bool DecodeSubresource(const std::uint8_t* fileData, uint64 fileSize, uint32 mip, uint32 slice,
+                                  Image& image, std::string* error = nullptr);
+    static bool DecodeFile(const std::filesystem::path& filename, uint32 mip, uint32 slice,
+                           Image& image, std::string* error = nullptr);
+};
@@ -0,0 +1,1396 @@
+//***************************************************************************************
+// BCEncoder.cpp
+//
+// Endpoints start on the principal axis of the block (or subset) colors, found by power
+// iteration on the covariance matrix, and are refined by least squares against the
+// chosen indices.  Every candidate is scored with the palette BCDecoder builds, so the
+// chosen block is the best one as decoded, not as estimated.
+//***************************************************************************************
+
+#include "BCEncoder.h"
+#include "BCDecoder.h"
+#include "BCTables.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <limits>
+
+namespace
+{
+    using namespace BCTables;
+
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    enum class BlockKind
+    {
+        None,
+        BC1,
+        BC3,
+        BC5,
+        BC7
+    };
+
+    BlockKind GetBlockKind(DXGI_FORMAT format)
+    {
+        switch(format)
+        {
+        case DXGI_FORMAT_BC1_UNORM:
+        case DXGI_FORMAT_BC1_UNORM_SRGB:    return BlockKind::BC1;
+        case DXGI_FORMAT_BC3_UNORM:
+        case DXGI_FORMAT_BC3_UNORM_SRGB:    return BlockKind::BC3;
+        case DXGI_FORMAT_BC5_UNORM:         return BlockKind::BC5;
+        case DXGI_FORMAT_BC7_UNORM:
+        case DXGI_FORMAT_BC7_UNORM_SRGB:    return BlockKind::BC7;
+        default:                            return BlockKind::None;
+        }
+    }
+
+    uint32 GetBlockSize(BlockKind kind)
+    {
+        return kind == BlockKind::BC1 ? 8 : 16;
+    }
+
+    // Search effort per quality level.  Ranking BC7 partitions costs more than encoding
+    // a few of them, so Normal ranks only the first 16 of a mode.
+    struct Settings
+    {
+        uint32 RefineIterations;
+        uint32 ChannelSearchRadius;     // BC4 endpoints tried inside min and max
+        uint32 PartitionCandidates;     // BC7 partitions encoded per multi-subset mode
+        uint32 PartitionsRanked;        // BC7 partitions ranked per mode, from the first
+        bool Exhaustive;                // BC1 three-color and nudging, BC7 modes 0 to 3
+    };
+
+    Settings GetSettings(BCEncoder::Quality quality)
+    {
+        switch(quality)
+        {
+        case BCEncoder::Quality::Fast:  return { 0, 0, 0, 0, false };
+        case BCEncoder::Quality::High:  return { 2, 3, 2, 64, true };
+        default:                        return { 1, 1, 1, 16, false };
+        }
+    }
+
+    int Clamp(int value, int low, int high)
+    {
+        return value < low ? low : value > high ? high : value;
+    }
+
+    int RoundToInt(float value)
+    {
+        return (int)std::floor(value + 0.5f);
+    }
+
+    //-----------------------------------------------------------------------------------
+    // Principal axis of a set of pixels, over the first channelCount channels.
+    //-----------------------------------------------------------------------------------
+
+    struct PixelSet
+    {
+        const uint8 (*Pixels)[4];
+        uint8 Members[16];
+        uint32 Count = 0;
+        uint32 Channels = 4;
+    };
+
+    struct AxisFit
+    {
+        float Mean[4] = {};
+        float Axis[4] = {};
+        float Variance = 0.0f;      // total, the trace of the covariance
+        float AxisVariance = 0.0f;  // along Axis
+    };
+
+    AxisFit FitAxis(const PixelSet& set)
+    {
+        AxisFit fit;
+        if(set.Count == 0)
+            return fit;
+
+        for(uint32 i = 0; i < set.Count; ++i)
+        {
+            for(uint32 c = 0; c < set.Channels; ++c)
+                fit.Mean[c] += set.Pixels[set.Members[i]][c];
+        }
+        for(uint32 c = 0; c < set.Channels; ++c)
+            fit.Mean[c] /= (float)set.Count;
+
+        float covariance[4][4] = {};
+        for(uint32 i = 0; i < set.Count; ++i)
+        {
+            float d[4];
+            for(uint32 c = 0; c < set.Channels; ++c)
+                d[c] = set.Pixels[set.Members[i]][c] - fit.Mean[c];
+            for(uint32 r = 0; r < set.Channels; ++r)
+            {
+                for(uint32 c = r; c < set.Channels; ++c)
+                    covariance[r][c] += d[r]*d[c];
+            }
+        }
+        for(uint32 r = 0; r < set.Channels; ++r)
+        {
+            for(uint32 c = 0; c < r; ++c)
+                covariance[r][c] = covariance[c][r];
+            fit.Variance += covariance[r][r];
+        }
+
+        if(fit.Variance <= 0.0f)
+            return fit;
+
+        // Power iteration from the row of the largest diagonal entry, which is never
+        // orthogonal to the principal axis unless the covariance is degenerate.
+        uint32 start = 0;
+        for(uint32 c = 1; c < set.Channels; ++c)
+        {
+            if(covariance[c][c] > covariance[start][start])
+                start = c;
+        }
+
+        float v[4] = {};
+        for(uint32 c = 0; c < set.Channels; ++c)
+            v[c] = covariance[start][c];
+
+        for(uint32 iteration = 0; iteration < 8; ++iteration)
+        {
+            float next[4] = {};
+            float length = 0.0f;
+            for(uint32 r = 0; r < set.Channels; ++r)
+            {
+                for(uint32 c = 0; c < set.Channels; ++c)
+                    next[r] += covariance[r][c]*v[c];
+                length += next[r]*next[r];
+            }
+            if(length <= 0.0f)
+                break;
+
+            length = 1.0f / std::sqrt(length);
+            for(uint32 c = 0; c < set.Channels; ++c)
+                v[c] = next[c]*length;
+        }
+
+        float axisVariance = 0.0f;
+        for(uint32 r = 0; r < set.Channels; ++r)
+        {
+            for(uint32 c = 0; c < set.Channels; ++c)
+                axisVariance += v[r]*covariance[r][c]*v[c];
+        }
+
+        std::memcpy(fit.Axis, v, sizeof(v));
+        fit.AxisVariance = axisVariance;
+        return fit;
+    }
+
+    // The ends of the set's extent along the fitted axis.
+    void GetAxisEndpoints(const PixelSet& set, const AxisFit& fit, float e0[4], float e1[4])
+    {
+        float tMin = 0.0f, tMax = 0.0f;
+        for(uint32 i = 0; i < set.Count; ++i)
+        {
+            float t = 0.0f;
+            for(uint32 c = 0; c < set.Channels; ++c)
+                t += (set.Pixels[set.Members[i]][c] - fit.Mean[c])*fit.Axis[c];
+            tMin = std::min(tMin, t);
+            tMax = std::max(tMax, t);
+        }
+
+        for(uint32 c = 0; c < 4; ++c)
+        {
+            e0[c] = c < set.Channels ? std::clamp(fit.Mean[c] + fit.Axis[c]*tMin, 0.0f, 255.0f) : 255.0f;
+            e1[c] = c < set.Channels ? std::clamp(fit.Mean[c] + fit.Axis[c]*tMax, 0.0f, 255.0f) : 255.0f;
+        }
+    }
+
+    // Least-squares endpoints for fixed interpolation weights t[i] in [0, 1], one per
+    // member.  False when the weights cannot separate two endpoints.
+    bool SolveEndpoints(const PixelSet& set, const float* t, float e0[4], float e1[4])
+    {
+        float aa = 0.0f, bb = 0.0f, ab = 0.0f;
+        float ax[4] = {}, bx[4] = {};
+        for(uint32 i = 0; i < set.Count; ++i)
+        {
+            float a = 1.0f - t[i];
+            float b = t[i];
+            aa += a*a;
+            bb += b*b;
+            ab += a*b;
+            for(uint32 c = 0; c < set.Channels; ++c)
+            {
+                ax[c] += a*set.Pixels[set.Members[i]][c];
+                bx[c] += b*set.Pixels[set.Members[i]][c];
+            }
+        }
+
+        float determinant = aa*bb - ab*ab;
+        if(std::fabs(determinant) < 1e-6f)
+            return false;
+
+        float inverse = 1.0f / determinant;
+        for(uint32 c = 0; c < 4; ++c)
+        {
+            if(c >= set.Channels)
+            {
+                e0[c] = e1[c] = 255.0f;
+                continue;
+            }
+            e0[c] = std::clamp((ax[c]*bb - bx[c]*ab)*inverse, 0.0f, 255.0f);
+            e1[c] = std::clamp((bx[c]*aa - ax[c]*ab)*inverse, 0.0f, 255.0f);
+        }
+        return true;
+    }
+
+    //-----------------------------------------------------------------------------------
+    // BC1 color blocks (also the color half of BC3).
+    //-----------------------------------------------------------------------------------
+
+    uint32 To565(const float color[4])
+    {
+        uint32 r = (uint32)Clamp(RoundToInt(color[0]*31.0f/255.0f), 0, 31);
+        uint32 g = (uint32)Clamp(RoundToInt(color[1]*63.0f/255.0f), 0, 63);
+        uint32 b = (uint32)Clamp(RoundToInt(color[2]*31.0f/255.0f), 0, 31);
+        return (r << 11) | (g << 5) | b;
+    }
+
+    void Expand565(uint32 color, int rgb[3])
+    {
+        uint32 r = (color >> 11) & 31;
+        uint32 g = (color >> 5) & 63;
+        uint32 b = color & 31;
+        rgb[0] = (int)((r << 3) | (r >> 2));
+        rgb[1] = (int)((g << 2) | (g >> 4));
+        rgb[2] = (int)((b << 3) | (b >> 2));
+    }
+
+    struct ColorBlock
+    {
+        uint32 Color0 = 0;
+        uint32 Color1 = 0;
+        uint8 Indices[16] = {};
+        uint32 Error = std::numeric_limits<uint32>::max();
+    };
+
+    // Scores endpoints as the decoder reads them: four colors when color0 > color1 (or
+    // always, for BC3), otherwise three and transparent black.  transparent[i] pixels
+    // must get index 3; opaque pixels must not get it in three-color blocks.
+    ColorBlock EvaluateColors(const uint8 pixels[16][4], const bool transparent[16], uint32 color0, uint32 color1,
+                              bool alwaysFourColor)
+    {
+        ColorBlock result;
+        result.Color0 = color0;
+        result.Color1 = color1;
+
+        int c0[3], c1[3];
+        Expand565(color0, c0);
+        Expand565(color1, c1);
+
+        bool fourColor = alwaysFourColor || color0 > color1;
+        int palette[4][3];
+        for(uint32 c = 0; c < 3; ++c)
+        {
+            palette[0][c] = c0[c];
+            palette[1][c] = c1[c];
+            palette[2][c] = fourColor ? (2*c0[c] + c1[c] + 1) / 3 : (c0[c] + c1[c] + 1) / 2;
+            palette[3][c] = fourColor ? (c0[c] + 2*c1[c] + 1) / 3 : 0;
+        }
+        uint32 colorCount = fourColor ? 4 : 3;
+
+        uint32 error = 0;
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            if(transparent[i])
+            {
+                if(fourColor)
+                    return ColorBlock();
+                result.Indices[i] = 3;
+                continue;
+            }
+
+            uint32 best = std::numeric_limits<uint32>::max();
+            for(uint32 k = 0; k < colorCount; ++k)
+            {
+                int dr = palette[k][0] - pixels[i][0];
+                int dg = palette[k][1] - pixels[i][1];
+                int db = palette[k][2] - pixels[i][2];
+                uint32 d = (uint32)(dr*dr + dg*dg + db*db);
+                if(d < best)
+                {
+                    best = d;
+                    result.Indices[i] = (uint8)k;
+                }
+            }
+            error += best;
+        }
+
+        result.Error = error;
+        return result;
+    }
+
+    // Orders the endpoints for the wanted mode and scores them.  Equal endpoints can
+    // only make a three-color block, which is fine as long as index 3 is not needed.
+    ColorBlock EvaluateColorPair(const uint8 pixels[16][4], const bool transparent[16], uint32 a, uint32 b,
+                                 bool fourColor, bool alwaysFourColor)
+    {
+        if(!alwaysFourColor && (fourColor ? a < b : a > b))
+            std::swap(a, b);
+        return EvaluateColors(pixels, transparent, a, b, alwaysFourColor);
+    }
+
+    void RefineColors(const uint8 pixels[16][4], const bool transparent[16], const PixelSet& set,
+                      bool fourColor, bool alwaysFourColor, const Settings& settings, ColorBlock& best)
+    {
+        bool paletteIsFour = alwaysFourColor || best.Color0 > best.Color1;
+
+        for(uint32 iteration = 0; iteration < settings.RefineIterations; ++iteration)
+        {
+            float t[16];
+            for(uint32 i = 0; i < set.Count; ++i)
+            {
+                uint32 index = best.Indices[set.Members[i]];
+                t[i] = paletteIsFour ? (index == 0 ? 0.0f : index == 1 ? 1.0f : index == 2 ? 1.0f/3.0f : 2.0f/3.0f)
+                                     : (index == 0 ? 0.0f : index == 1 ? 1.0f : 0.5f);
+            }
+
+            float e0[4], e1[4];
+            if(!SolveEndpoints(set, t, e0, e1))
+                break;
+
+            ColorBlock candidate = EvaluateColorPair(pixels, transparent, To565(e0), To565(e1), fourColor, alwaysFourColor);
+            if(candidate.Error >= best.Error)
+                break;
+            best = candidate;
+            paletteIsFour = alwaysFourColor || best.Color0 > best.Color1;
+        }
+
+        if(!settings.Exhaustive)
+            return;
+
+        // Nudge each 565 component of each endpoint while that helps.
+        bool improved = true;
+        for(uint32 pass = 0; pass < 4 && improved; ++pass)
+        {
+            improved = false;
+            for(uint32 endpoint = 0; endpoint < 2; ++endpoint)
+            {
+                for(uint32 component = 0; component < 3; ++component)
+                {
+                    static const uint32 Shifts[3] = { 11, 5, 0 };
+                    static const uint32 Masks[3] = { 31, 63, 31 };
+                    for(int step = -1; step <= 1; step += 2)
+                    {
+                        uint32 color = endpoint == 0 ? best.Color0 : best.Color1;
+                        int value = (int)((color >> Shifts[component]) & Masks[component]) + step;
+                        if(value < 0 || value > (int)Masks[component])
+                            continue;
+
+                        color = (color & ~(Masks[component] << Shifts[component])) | ((uint32)value << Shifts[component]);
+                        uint32 a = endpoint == 0 ? color : best.Color0;
+                        uint32 b = endpoint == 0 ? best.Color1 : color;
+
+                        ColorBlock candidate = EvaluateColorPair(pixels, transparent, a, b, fourColor, alwaysFourColor);
+                        if(candidate.Error < best.Error)
+                        {
+                            best = candidate;
+                            improved = true;
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    // alwaysFourColor for BC3, whose color half ignores the endpoint order.
+    void EncodeColorBlock(const uint8 pixels[16][4], bool alwaysFourColor, const Settings& settings, uint8* block)
+    {
+        bool transparent[16] = {};
+        PixelSet set;
+        set.Pixels = pixels;
+        set.Channels = 3;
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            transparent[i] = !alwaysFourColor && pixels[i][3] < 128;
+            if(!transparent[i])
+                set.Members[set.Count++] = (uint8)i;
+        }
+
+        ColorBlock best;
+        if(set.Count == 0)
+        {
+            // Every pixel transparent: equal endpoints make a three-color block.
+            best.Color0 = best.Color1 = 0;
+            std::fill(best.Indices, best.Indices + 16, (uint8)3);
+        }
+        else
+        {
+            bool anyTransparent = set.Count < 16;
+
+            float e0[4], e1[4];
+            GetAxisEndpoints(set, FitAxis(set), e0, e1);
+            uint32 a = To565(e0);
+            uint32 b = To565(e1);
+
+            // Three-color blocks are forced by transparency, and otherwise only tried
+            // at High quality.
+            for(uint32 mode = 0; mode < 2; ++mode)
+            {
+                bool fourColor = mode == 0;
+                if(fourColor && anyTransparent)
+                    continue;
+                if(!fourColor && (alwaysFourColor || (!anyTransparent && !settings.Exhaustive)))
+                    continue;
+
+                ColorBlock candidate = EvaluateColorPair(pixels, transparent, a, b, fourColor, alwaysFourColor);
+                RefineColors(pixels, transparent, set, fourColor, alwaysFourColor, settings, candidate);
+                if(candidate.Error < best.Error)
+                    best = candidate;
+            }
+        }
+
+        uint32 indices = 0;
+        for(uint32 i = 0; i < 16; ++i)
+            indices |= (uint32)best.Indices[i] << (2*i);
+
+        block[0] = (uint8)best.Color0;
+        block[1] = (uint8)(best.Color0 >> 8);
+        block[2] = (uint8)best.Color1;
+        block[3] = (uint8)(best.Color1 >> 8);
+        std::memcpy(block + 4, &indices, 4);
+    }
+
+    //-----------------------------------------------------------------------------------
+    // BC4 channel blocks (BC3 alpha and both BC5 channels).
+    //-----------------------------------------------------------------------------------
+
+    struct ChannelBlock
+    {
+        uint8 Value0 = 0;
+        uint8 Value1 = 0;
+        uint8 Indices[16] = {};
+        uint32 Error = std::numeric_limits<uint32>::max();
+    };
+
+    // Same palette as BCDecoder's UNORM BC4.
+    ChannelBlock EvaluateChannel(const uint8 values[16], uint32 a0, uint32 a1)
+    {
+        ChannelBlock result;
+        result.Value0 = (uint8)a0;
+        result.Value1 = (uint8)a1;
+
+        int palette[8];
+        palette[0] = (int)a0;
+        palette[1] = (int)a1;
+        if(a0 > a1)
+        {
+            for(uint32 i = 1; i < 7; ++i)
+                palette[i + 1] = (int)(((7 - i)*a0 + i*a1 + 3) / 7);
+        }
+        else
+        {
+            for(uint32 i = 1; i < 5; ++i)
+                palette[i + 1] = (int)(((5 - i)*a0 + i*a1 + 2) / 5);
+            palette[6] = 0;
+            palette[7] = 255;
+        }
+
+        uint32 error = 0;
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            uint32 best = std::numeric_limits<uint32>::max();
+            for(uint32 k = 0; k < 8; ++k)
+            {
+                int d = palette[k] - values[i];
+                if((uint32)(d*d) < best)
+                {
+                    best = (uint32)(d*d);
+                    result.Indices[i] = (uint8)k;
+                }
+            }
+            error += best;
+        }
+
+        result.Error = error;
+        return result;
+    }
+
+    void EncodeChannelBlock(const uint8 values[16], const Settings& settings, uint8* block)
+    {
+        uint32 low = 255, high = 0;
+        uint32 innerLow = 255, innerHigh = 0;
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            low = std::min<uint32>(low, values[i]);
+            high = std::max<uint32>(high, values[i]);
+            if(values[i] != 0 && values[i] != 255)
+            {
+                innerLow = std::min<uint32>(innerLow, values[i]);
+                innerHigh = std::max<uint32>(innerHigh, values[i]);
+            }
+        }
+
+        ChannelBlock best;
+        if(low == high)
+        {
+            best.Value0 = best.Value1 = (uint8)low;
+            best.Error = 0;
+        }
+        else
+        {
+            // Eight-value blocks, with the endpoints pulled in by up to the radius:
+            // the interpolated values round, so the extremes are not always best.
+            uint32 radius = std::min(settings.ChannelSearchRadius, (high - low - 1) / 2);
+            for(uint32 d0 = 0; d0 <= radius; ++d0)
+            {
+                for(uint32 d1 = 0; d1 <= radius; ++d1)
+                {
+                    ChannelBlock candidate = EvaluateChannel(values, high - d0, low + d1);
+                    if(candidate.Error < best.Error)
+                        best = candidate;
+                }
+            }
+
+            // Six-value blocks have exact 0 and 255 for free.
+            if(settings.ChannelSearchRadius > 0 && innerLow <= innerHigh && (low == 0 || high == 255))
+            {
+                ChannelBlock candidate = EvaluateChannel(values, innerLow, innerHigh);
+                if(candidate.Error < best.Error)
+                    best = candidate;
+            }
+        }
+
+        uint64 indices = 0;
+        for(uint32 i = 0; i < 16; ++i)
+            indices |= (uint64)best.Indices[i] << (3*i);
+
+        block[0] = best.Value0;
+        block[1] = best.Value1;
+        for(uint32 i = 0; i < 6; ++i)
+            block[2 + i] = (uint8)(indices >> (8*i));
+    }
+
+    //-----------------------------------------------------------------------------------
+    // BC7.
+    //-----------------------------------------------------------------------------------
+
+    class BitWriter
+    {
+    public:
+        void Write(uint32 value, uint32 count)
+        {
+            if(count == 0)
+                return;
+
+            uint64 bits = value & ((1ull << count) - 1);
+            if(mPosition >= 64)
+            {
+                mHi |= bits << (mPosition - 64);
+            }
+            else
+            {
+                mLo |= bits << mPosition;
+                if(mPosition + count > 64)
+                    mHi |= bits >> (64 - mPosition);
+            }
+            mPosition += count;
+        }
+
+        void Store(uint8* block) const
+        {
+            std::memcpy(block, &mLo, 8);
+            std::memcpy(block + 8, &mHi, 8);
+        }
+
+    private:
+        uint64 mLo = 0;
+        uint64 mHi = 0;
+        uint32 mPosition = 0;
+    };
+
+    uint32 ExpandBits(uint32 value, uint32 bits)
+    {
+        return (value << (8 - bits)) | (value >> (2*bits - 8));
+    }
+
+    // Stored value (without the p-bit) whose expansion is nearest to target.
+    uint32 QuantizeChannel(float target, uint32 bits, int pbit)
+    {
+        uint32 stored = pbit >= 0 ? bits - 1 : bits;
+        int maxValue = (1 << stored) - 1;
+        int guess = RoundToInt(target*(float)((1 << stored) - 1)/255.0f);
+
+        uint32 best = 0;
+        float bestError = std::numeric_limits<float>::max();
+        for(int q = std::max(guess - 1, 0); q <= std::min(guess + 1, maxValue); ++q)
+        {
+            uint32 full = pbit >= 0 ? ((uint32)q << 1) | (uint32)pbit : (uint32)q;
+            float error = std::fabs((float)ExpandBits(full, bits) - target);
+            if(error < bestError)
+            {
+                bestError = error;
+                best = (uint32)q;
+            }
+        }
+        return best;
+    }
+
+    struct SubsetEncoding
+    {
+        uint32 Endpoints[2][4] = {};    // stored values, without p-bits
+        uint32 PBits[2] = {};
+        uint8 Indices[16] = {};         // per member
+        uint32 Error = std::numeric_limits<uint32>::max();
+    };
+
+    // Scores quantized endpoints against the set with the mode's palette.
+    uint32 EvaluateSubset(const PixelSet& set, const BC7Mode& mode, SubsetEncoding& encoding)
+    {
+        bool hasPBits = mode.EndpointPBits || mode.SharedPBits;
+        uint32 colorBits = mode.ColorBits + (hasPBits ? 1 : 0);
+        uint32 alphaBits = mode.AlphaBits ? mode.AlphaBits + (hasPBits ? 1 : 0) : 0;
+
+        int expanded[2][4];
+        for(uint32 e = 0; e < 2; ++e)
+        {
+            for(uint32 c = 0; c < 4; ++c)
+            {
+                uint32 bits = c < 3 ? colorBits : alphaBits;
+                if(bits == 0)
+                {
+                    expanded[e][c] = 255;
+                    continue;
+                }
+                uint32 full = hasPBits ? (encoding.Endpoints[e][c] << 1) | encoding.PBits[e] : encoding.Endpoints[e][c];
+                expanded[e][c] = (int)ExpandBits(full, bits);
+            }
+        }
+
+        const uint8* weights = GetWeights(mode.IndexBits);
+        uint32 colorCount = 1u << mode.IndexBits;
+        int palette[16][4];
+        for(uint32 k = 0; k < colorCount; ++k)
+        {
+            for(uint32 c = 0; c < 4; ++c)
+                palette[k][c] = ((64 - weights[k])*expanded[0][c] + weights[k]*expanded[1][c] + 32) >> 6;
+        }
+
+        // The palette lies on a line and its weights are nearly even, so the nearest
+        // entry is within one of the projection of the pixel onto that line.
+        int direction[4];
+        int lengthSquared = 0;
+        for(uint32 c = 0; c < 4; ++c)
+        {
+            direction[c] = expanded[1][c] - expanded[0][c];
+            lengthSquared += direction[c]*direction[c];
+        }
+        float scale = lengthSquared > 0 ? (float)(colorCount - 1) / (float)lengthSquared : 0.0f;
+
+        uint32 error = 0;
+        for(uint32 i = 0; i < set.Count; ++i)
+        {
+            const uint8* pixel = set.Pixels[set.Members[i]];
+
+            int dot = 0;
+            for(uint32 c = 0; c < 4; ++c)
+                dot += (pixel[c] - expanded[0][c])*direction[c];
+            int guess = Clamp(RoundToInt((float)dot*scale), 0, (int)colorCount - 1);
+
+            uint32 best = std::numeric_limits<uint32>::max();
+            for(uint32 k = (uint32)std::max(guess - 1, 0); k <= std::min((uint32)guess + 1, colorCount - 1); ++k)
+            {
+                uint32 d = 0;
+                for(uint32 c = 0; c < 4; ++c)
+                {
+                    int delta = palette[k][c] - pixel[c];
+                    d += (uint32)(delta*delta);
+                }
+                if(d < best)
+                {
+                    best = d;
+                    encoding.Indices[i] = (uint8)k;
+                }
+            }
+            error += best;
+        }
+
+        encoding.Error = error;
+        return error;
+    }
+
+    // Quantizes float endpoints with every allowed p-bit choice and keeps the best.
+    SubsetEncoding QuantizeSubset(const PixelSet& set, const BC7Mode& mode, const float e0[4], const float e1[4])
+    {
+        const float* targets[2] = { e0, e1 };
+        uint32 combinations = mode.EndpointPBits ? 4 : mode.SharedPBits ? 2 : 1;
+
+        // Alpha of 255 needs p-bits of 1.  Opaque subsets keep it even where a zero
+        // p-bit would fit the color better, so opaque textures stay opaque.
+        bool opaque = mode.AlphaBits > 0 && mode.EndpointPBits;
+        for(uint32 i = 0; i < set.Count && opaque; ++i)
+            opaque = set.Pixels[set.Members[i]][3] == 255;
+
+        SubsetEncoding best;
+        for(uint32 combination = 0; combination < combinations; ++combination)
+        {
+            if(opaque && combination != 3)
+                continue;
+
+            SubsetEncoding candidate;
+            for(uint32 e = 0; e < 2; ++e)
+            {
+                int pbit = -1;
+                if(mode.EndpointPBits)
+                    pbit = (int)((combination >> e) & 1);
+                else if(mode.SharedPBits)
+                    pbit = (int)combination;
+                candidate.PBits[e] = pbit > 0 ? 1 : 0;
+
+                for(uint32 c = 0; c < 4; ++c)
+                {
+                    uint32 bits = c < 3 ? mode.ColorBits : mode.AlphaBits;
+                    if(bits == 0)
+                        continue;
+                    candidate.Endpoints[e][c] = QuantizeChannel(targets[e][c], pbit >= 0 ? bits + 1 : bits, pbit);
+                }
+            }
+
+            if(EvaluateSubset(set, mode, candidate) < best.Error)
+                best = candidate;
+        }
+        return best;
+    }
+
+    SubsetEncoding EncodeSubset(const PixelSet& set, const BC7Mode& mode, const Settings& settings)
+    {
+        float e0[4], e1[4];
+        GetAxisEndpoints(set, FitAxis(set), e0, e1);
+        SubsetEncoding best = QuantizeSubset(set, mode, e0, e1);
+
+        const uint8* weights = GetWeights(mode.IndexBits);
+        for(uint32 iteration = 0; iteration < settings.RefineIterations && best.Error > 0; ++iteration)
+        {
+            float t[16];
+            for(uint32 i = 0; i < set.Count; ++i)
+                t[i] = weights[best.Indices[i]] / 64.0f;
+
+            if(!SolveEndpoints(set, t, e0, e1))
+                break;
+
+            SubsetEncoding candidate = QuantizeSubset(set, mode, e0, e1);
+            if(candidate.Error >= best.Error)
+                break;
+            best = candidate;
+        }
+        return best;
+    }
+
+    struct BC7Block
+    {
+        uint32 Mode = 0;
+        uint32 Partition = 0;
+        SubsetEncoding Subsets[3];
+        uint32 Error = std::numeric_limits<uint32>::max();
+    };
+
+    void GetSubsets(const uint8 pixels[16][4], uint32 subsetCount, uint32 partition, uint32 channels, PixelSet sets[3])
+    {
+        for(uint32 s = 0; s < 3; ++s)
+        {
+            sets[s].Pixels = pixels;
+            sets[s].Count = 0;
+            sets[s].Channels = channels;
+        }
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            PixelSet& set = sets[GetSubset(subsetCount, partition, i)];
+            set.Members[set.Count++] = (uint8)i;
+        }
+    }
+
+    BC7Block EncodeBC7Mode(const uint8 pixels[16][4], uint32 modeIndex, uint32 partition, const Settings& settings)
+    {
+        const BC7Mode& mode = BC7Modes[modeIndex];
+
+        BC7Block result;
+        result.Mode = modeIndex;
+        result.Partition = partition;
+        result.Error = 0;
+
+        PixelSet sets[3];
+        GetSubsets(pixels, mode.SubsetCount, partition, mode.AlphaBits ? 4 : 3, sets);
+        for(uint32 s = 0; s < mode.SubsetCount; ++s)
+        {
+            result.Subsets[s] = EncodeSubset(sets[s], mode, settings);
+            result.Error += result.Subsets[s].Error;
+        }
+        return result;
+    }
+
+    // Sum of squared distances from the best-fit line, from the sums of the channels
+    // (moments[0..3]) and of their pairwise products (moments[4..13], row by row of the
+    // upper triangle).  Two power iterations are plenty for ranking.
+    float GetLineResidual(const float moments[14], uint32 count, uint32 channels)
+    {
+        if(count < 2)
+            return 0.0f;
+
+        float covariance[4][4] = {};
+        float trace = 0.0f;
+        uint32 k = 4;
+        for(uint32 r = 0; r < 4; ++r)
+        {
+            for(uint32 c = r; c < 4; ++c, ++k)
+            {
+                if(r >= channels || c >= channels)
+                    continue;
+                covariance[r][c] = covariance[c][r] = moments[k] - moments[r]*moments[c] / (float)count;
+            }
+            trace += covariance[r][r];
+        }
+
+        uint32 start = 0;
+        for(uint32 c = 1; c < channels; ++c)
+        {
+            if(covariance[c][c] > covariance[start][start])
+                start = c;
+        }
+
+        float v[4];
+        std::memcpy(v, covariance[start], sizeof(v));
+        for(uint32 iteration = 0; iteration < 2; ++iteration)
+        {
+            float next[4] = {};
+            float length = 0.0f;
+            for(uint32 r = 0; r < 4; ++r)
+            {
+                for(uint32 c = 0; c < 4; ++c)
+                    next[r] += covariance[r][c]*v[c];
+                length += next[r]*next[r];
+            }
+            if(length <= 0.0f)
+                return 0.0f;
+
+            length = 1.0f / std::sqrt(length);
+            for(uint32 c = 0; c < 4; ++c)
+                v[c] = next[c]*length;
+        }
+
+        float axisVariance = 0.0f;
+        for(uint32 r = 0; r < 4; ++r)
+        {
+            for(uint32 c = 0; c < 4; ++c)
+                axisVariance += v[r]*covariance[r][c]*v[c];
+        }
+        return trace - axisVariance;
+    }
+
+    // The first partitionCount partitions of a multi-subset mode ordered by how well
+    // each subset fits a line, the part of the error that quantization does not add.
+    // The tables list the most useful partitions first.
+    void RankPartitions(const uint8 pixels[16][4], const BC7Mode& mode, uint32 partitionCount,
+                        uint32 count, uint32* ranked)
+    {
+        uint32 channels = mode.AlphaBits ? 4 : 3;
+
+        float pixelMoments[16][14];
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            uint32 k = 4;
+            for(uint32 r = 0; r < 4; ++r)
+            {
+                pixelMoments[i][r] = pixels[i][r];
+                for(uint32 c = r; c < 4; ++c, ++k)
+                    pixelMoments[i][k] = (float)(pixels[i][r]*pixels[i][c]);
+            }
+        }
+
+        float total[14] = {};
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            for(uint32 k = 0; k < 14; ++k)
+                total[k] += pixelMoments[i][k];
+        }
+
+        float residuals[64];
+        uint32 order[64];
+        for(uint32 p = 0; p < partitionCount; ++p)
+        {
+            // Subset 0 is whatever the others leave.
+            float moments[3][14] = {};
+            uint32 counts[3] = { 16, 0, 0 };
+            for(uint32 i = 0; i < 16; ++i)
+            {
+                uint32 subset = GetSubset(mode.SubsetCount, p, i);
+                if(subset == 0)
+                    continue;
+                for(uint32 k = 0; k < 14; ++k)
+                    moments[subset][k] += pixelMoments[i][k];
+                ++counts[subset];
+                --counts[0];
+            }
+            for(uint32 k = 0; k < 14; ++k)
+                moments[0][k] = total[k] - moments[1][k] - moments[2][k];
+
+            residuals[p] = 0.0f;
+            for(uint32 s = 0; s < mode.SubsetCount; ++s)
+                residuals[p] += GetLineResidual(moments[s], counts[s], channels);
+            order[p] = p;
+        }
+
+        count = std::min(count, partitionCount);
+        std::partial_sort(order, order + count, order + partitionCount,
+                          [&](uint32 a, uint32 b) { return residuals[a] < residuals[b]; });
+        std::copy(order, order + count, ranked);
+    }
+
+    void WriteBC7Block(BC7Block& encoded, const uint8 pixels[16][4], uint8* block)
+    {
+        const BC7Mode& mode = BC7Modes[encoded.Mode];
+
+        PixelSet sets[3];
+        GetSubsets(pixels, mode.SubsetCount, encoded.Partition, 4, sets);
+
+        // The anchor pixel of each subset stores its index without the top bit, so
+        // swap the endpoints of subsets whose anchor index has it set.
+        uint8 indices[16];
+        uint32 highBit = 1u << (mode.IndexBits - 1);
+        uint32 maxIndex = (1u << mode.IndexBits) - 1;
+        for(uint32 s = 0; s < mode.SubsetCount; ++s)
+        {
+            SubsetEncoding& subset = encoded.Subsets[s];
+            uint32 anchor = s == 0 ? 0 : mode.SubsetCount == 2 ? Anchor2[encoded.Partition] :
+                            s == 1 ? Anchor3Second[encoded.Partition] : Anchor3Third[encoded.Partition];
+
+            uint32 anchorIndex = 0;
+            for(uint32 i = 0; i < sets[s].Count; ++i)
+            {
+                if(sets[s].Members[i] == anchor)
+                    anchorIndex = subset.Indices[i];
+            }
+
+            if(anchorIndex & highBit)
+            {
+                for(uint32 c = 0; c < 4; ++c)
+                    std::swap(subset.Endpoints[0][c], subset.Endpoints[1][c]);
+                std::swap(subset.PBits[0], subset.PBits[1]);
+                for(uint32 i = 0; i < sets[s].Count; ++i)
+                    subset.Indices[i] = (uint8)(maxIndex - subset.Indices[i]);
+            }
+
+            for(uint32 i = 0; i < sets[s].Count; ++i)
+                indices[sets[s].Members[i]] = subset.Indices[i];
+        }
+
+        BitWriter bits;
+        bits.Write(1u << encoded.Mode, encoded.Mode + 1);
+        bits.Write(encoded.Partition, mode.PartitionBits);
+
+        for(uint32 c = 0; c < 4; ++c)
+        {
+            uint32 channelBits = c < 3 ? mode.ColorBits : mode.AlphaBits;
+            for(uint32 s = 0; s < mode.SubsetCount; ++s)
+            {
+                bits.Write(encoded.Subsets[s].Endpoints[0][c], channelBits);
+                bits.Write(encoded.Subsets[s].Endpoints[1][c], channelBits);
+            }
+        }
+
+        for(uint32 s = 0; s < mode.SubsetCount; ++s)
+        {
+            if(mode.EndpointPBits)
+            {
+                bits.Write(encoded.Subsets[s].PBits[0], 1);
+                bits.Write(encoded.Subsets[s].PBits[1], 1);
+            }
+            else if(mode.SharedPBits)
+            {
+                bits.Write(encoded.Subsets[s].PBits[0], 1);
+            }
+        }
+
+        for(uint32 i = 0; i < 16; ++i)
+            bits.Write(indices[i], mode.IndexBits - (IsAnchor(mode.SubsetCount, encoded.Partition, i) ? 1 : 0));
+
+        bits.Store(block);
+    }
+
+    void EncodeBC7(const uint8 pixels[16][4], const Settings& settings, uint8* block)
+    {
+        bool opaque = true;
+        for(uint32 i = 0; i < 16; ++i)
+            opaque = opaque && pixels[i][3] == 255;
+
+        BC7Block best = EncodeBC7Mode(pixels, 6, 0, settings);
+
+        // Multi-subset modes are only searched when mode 6 is not already exact.  Blocks
+        // with alpha only have mode 7, where searching wider than Normal does gains next
+        // to nothing, so High widens the search for opaque blocks only.
+        Settings search = settings;
+        uint32 modes[4];
+        uint32 modeCount = 0;
+        if(settings.PartitionCandidates > 0 && best.Error > 0)
+        {
+            if(!opaque)
+            {
+                Settings normal = GetSettings(BCEncoder::Quality::Normal);
+                search.PartitionsRanked = std::min(search.PartitionsRanked, normal.PartitionsRanked);
+                search.PartitionCandidates = std::min(search.PartitionCandidates, normal.PartitionCandidates);
+                modes[modeCount++] = 7;
+            }
+            else if(settings.Exhaustive)
+            {
+                modes[modeCount++] = 0;
+                modes[modeCount++] = 1;
+                modes[modeCount++] = 2;
+                modes[modeCount++] = 3;
+            }
+            else
+            {
+                modes[modeCount++] = 1;
+            }
+        }
+
+        // Candidates are compared unrefined; only the winner gets the refinement passes.
+        Settings candidateSettings = settings;
+        candidateSettings.RefineIterations = 0;
+        bool partitioned = false;
+
+        for(uint32 m = 0; m < modeCount; ++m)
+        {
+            const BC7Mode& mode = BC7Modes[modes[m]];
+            uint32 ranked[64];
+            uint32 partitionCount = std::min(search.PartitionsRanked, mode.PartitionBits == 4 ? 16u : 64u);
+            uint32 candidates = std::min(search.PartitionCandidates, partitionCount);
+            RankPartitions(pixels, mode, partitionCount, candidates, ranked);
+
+            for(uint32 p = 0; p < candidates; ++p)
+            {
+                BC7Block candidate = EncodeBC7Mode(pixels, modes[m], ranked[p], candidateSettings);
+                if(candidate.Error < best.Error)
+                {
+                    best = candidate;
+                    partitioned = true;
+                }
+            }
+        }
+
+        if(partitioned && settings.RefineIterations > 0)
+        {
+            BC7Block refined = EncodeBC7Mode(pixels, best.Mode, best.Partition, settings);
+            if(refined.Error < best.Error)
+                best = refined;
+        }
+
+        WriteBC7Block(best, pixels, block);
+    }
+
+    //-----------------------------------------------------------------------------------
+
+    void EncodeBlockPixels(BlockKind kind, const uint8 pixels[16][4], const Settings& settings, uint8* block)
+    {
+        uint8 channel[16];
+        switch(kind)
+        {
+        case BlockKind::BC1:
+            EncodeColorBlock(pixels, false, settings, block);
+            break;
+
+        case BlockKind::BC3:
+            for(uint32 i = 0; i < 16; ++i)
+                channel[i] = pixels[i][3];
+            EncodeChannelBlock(channel, settings, block);
+            EncodeColorBlock(pixels, true, settings, block + 8);
+            break;
+
+        case BlockKind::BC5:
+            for(uint32 c = 0; c < 2; ++c)
+            {
+                for(uint32 i = 0; i < 16; ++i)
+                    channel[i] = pixels[i][c];
+                EncodeChannelBlock(channel, settings, block + 8*c);
+            }
+            break;
+
+        case BlockKind::BC7:
+            EncodeBC7(pixels, settings, block);
+            break;
+
+        default:
+            break;
+        }
+    }
+
+    bool Fail(std::string* error, const std::string& message)
+    {
+        if(error)
+            *error = message;
+        return false;
+    }
+
+    bool IsSRGB(DXGI_FORMAT format)
+    {
+        return format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ||
+               format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+               format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+    }
+
+    // Squared error over the channels format stores, and how many values it covers.
+    struct ErrorSum
+    {
+        double SquaredError = 0.0;
+        uint64 Count = 0;
+
+        double GetPSNR() const
+        {
+            if(Count == 0)
+                return 0.0;
+            if(SquaredError == 0.0)
+                return std::numeric_limits<double>::infinity();
+            double mse = SquaredError / (double)Count;
+            return 10.0*std::log10(255.0*255.0 / mse);
+        }
+    };
+
+    bool AccumulateError(DXGI_FORMAT format, const uint8* source, size_t sourceRowPitch, uint32 width, uint32 height,
+                         const uint8* encoded, size_t encodedRowPitch, ErrorSum& sum)
+    {
+        size_t decodedRowPitch = (size_t)width*4;
+        std::vector<uint8> decoded(decodedRowPitch*height);
+        if(!BCDecoder::Decode(format, encoded, encodedRowPitch, width, height, decoded.data(), decodedRowPitch))
+            return false;
+
+        // BC1 alpha is a cutout, so only the color of the pixels it keeps counts.
+        BlockKind kind = GetBlockKind(format);
+        uint32 channels = kind == BlockKind::BC5 ? 2 : kind == BlockKind::BC1 ? 3 : 4;
+        for(uint32 y = 0; y < height; ++y)
+        {
+            const uint8* a = source + y*sourceRowPitch;
+            const uint8* b = decoded.data() + y*decodedRowPitch;
+            uint64 rowError = 0;
+            for(uint32 x = 0; x < width; ++x)
+            {
+                if(kind == BlockKind::BC1 && a[4*x + 3] < 128)
+                    continue;
+
+                for(uint32 c = 0; c < channels; ++c)
+                {
+                    int d = (int)a[4*x + c] - (int)b[4*x + c];
+                    rowError += (uint64)(d*d);
+                }
+                sum.Count += channels;
+            }
+            sum.SquaredError += (double)rowError;
+        }
+        return true;
+    }
+}
+
+bool BCEncoder::IsSupported(DXGI_FORMAT format)
+{
+    return GetBlockKind(format) != BlockKind::None;
+}
+
+bool BCEncoder::IsSupportedSource(DXGI_FORMAT format)
+{
+    switch(format)
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+        return true;
+    default:
+        return false;
+    }
+}
+
+void BCEncoder::EncodeBlock(DXGI_FORMAT format, Quality quality, const std::uint8_t pixels[64], std::uint8_t* block)
+{
+    uint8 blockPixels[16][4];
+    std::memcpy(blockPixels, pixels, sizeof(blockPixels));
+    EncodeBlockPixels(GetBlockKind(format), blockPixels, GetSettings(quality), block);
+}
+
+bool BCEncoder::Encode(DXGI_FORMAT format, Quality quality, const std::uint8_t* source, size_t sourceRowPitch,
+                       uint32 width, uint32 height, void* dest, size_t destRowPitch)
+{
+    BlockKind kind = GetBlockKind(format);
+    if(kind == BlockKind::None)
+        return false;
+
+    const uint32 TileBlocks = 16;
+    uint32 blocksWide = (width + 3) / 4;
+    uint32 blocksHigh = (height + 3) / 4;
+    uint32 tilesWide = (blocksWide + TileBlocks - 1) / TileBlocks;
+    uint32 tilesHigh = (blocksHigh + TileBlocks - 1) / TileBlocks;
+    uint32 blockSize = GetBlockSize(kind);
+    Settings settings = GetSettings(quality);
+
+    ThreadPool::Get().ParallelFor(tilesWide*tilesHigh, [&](uint32 tile)
+    {
+        uint32 firstX = (tile % tilesWide)*TileBlocks;
+        uint32 firstY = (tile / tilesWide)*TileBlocks;
+        uint32 lastX = std::min(firstX + TileBlocks, blocksWide);
+        uint32 lastY = std::min(firstY + TileBlocks, blocksHigh);
+
+        uint8 pixels[16][4];
+        for(uint32 by = firstY; by < lastY; ++by)
+        {
+            uint8* destRow = static_cast<uint8*>(dest) + (size_t)by*destRowPitch;
+            for(uint32 bx = firstX; bx < lastX; ++bx)
+            {
+                for(uint32 y = 0; y < 4; ++y)
+                {
+                    const uint8* row = source + (size_t)std::min(by*4 + y, height - 1)*sourceRowPitch;
+                    for(uint32 x = 0; x < 4; ++x)
+                        std::memcpy(pixels[4*y + x], row + (size_t)std::min(bx*4 + x, width - 1)*4, 4);
+                }
+
+                EncodeBlockPixels(kind, pixels, settings, destRow + (size_t)bx*blockSize);
+            }
+        }
+    });
+
+    return true;
+}
+
+double BCEncoder::ComputePSNR(DXGI_FORMAT format, const std::uint8_t* source, size_t sourceRowPitch,
+                              uint32 width, uint32 height, const std::uint8_t* encoded, size_t encodedRowPitch)
+{
+    ErrorSum sum;
+    if(!AccumulateError(format, source, sourceRowPitch, width, height, encoded, encodedRowPitch, sum))
+        return 0.0;
+    return sum.GetPSNR();
+}
+
+bool BCEncoder::EncodeDDS(const std::uint8_t* fileData, uint64 fileSize, const Options& options,
+                          std::vector<std::uint8_t>& output, Stats* stats, std::string* error)
+{
+    output.clear();
+    if(stats)
+        *stats = Stats();
+
+    DDSParser::Layout layout;
+    if(DDSParser::Parse(fileData, fileSize, layout) != DDSParser::Result::Ok)
+        return Fail(error, "not a valid DDS file");
+
+    const DDSParser::TextureDesc& desc = layout.Desc;
+    if(!IsSupportedSource(desc.Format))
+        return Fail(error, "source is not an 8-bit RGBA format");
+    if(!IsSupported(options.Format))
+        return Fail(error, "unsupported target format");
+    if(desc.Dimension != DDSParser::TextureDimension::Texture2D && desc.Dimension != DDSParser::TextureDimension::Texture3D)
+        return Fail(error, "1D textures cannot be block-compressed");
+    if(desc.Width % 4 != 0 || desc.Height % 4 != 0)
+        return Fail(error, "width and height must be multiples of 4");
+
+    DXGI_FORMAT format = options.Format;
+    if(IsSRGB(desc.Format))
+        format = DDSParser::MakeSRGB(format);
+
+    bool swapRedBlue = desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM && desc.Format != DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+    bool forceOpaque = desc.Format == DXGI_FORMAT_B8G8R8X8_UNORM || desc.Format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+
+    // Output layout: the same subresources in the same order, block-compressed.
+    std::vector<uint64> offsets(layout.Subresources.size());
+    uint64 dataOffset = DDSParser::DX10HeaderSize;
+    uint64 outputSize = dataOffset;
+    for(size_t i = 0; i < layout.Subresources.size(); ++i)
+    {
+        const DDSParser::Subresource& subresource = layout.Subresources[i];
+        size_t numBytes = 0;
+        DDSParser::GetSurfaceInfo(subresource.Width, subresource.Height, format, &numBytes, nullptr, nullptr);
+        offsets[i] = outputSize;
+        outputSize += (uint64)numBytes*subresource.Depth;
+    }
+    output.resize((size_t)outputSize);
+
+    DDSParser::TextureDesc outputDesc = desc;
+    outputDesc.Format = format;
+    DDSParser::WriteHeader(outputDesc, output.data());
+
+    // Pixels, one depth slice of one subresource at a time.
+    ErrorSum errorSum;
+    double seconds = 0.0;
+    uint64 sourceBytes = 0;
+    std::vector<uint8> converted;
+    for(size_t i = 0; i < layout.Subresources.size(); ++i)
+    {
+        const DDSParser::Subresource& subresource = layout.Subresources[i];
+        size_t numBytes = 0, rowBytes = 0;
+        DDSParser::GetSurfaceInfo(subresource.Width, subresource.Height, format, &numBytes, &rowBytes, nullptr);
+
+        for(uint32 z = 0; z < subresource.Depth; ++z)
+        {
+            const uint8* source = fileData + subresource.Offset + z*subresource.SlicePitch;
+            size_t sourceRowPitch = (size_t)subresource.RowPitch;
+
+            if(swapRedBlue || forceOpaque)
+            {
+                sourceRowPitch = (size_t)subresource.Width*4;
+                converted.resize(sourceRowPitch*subresource.Height);
+                for(uint32 y = 0; y < subresource.Height; ++y)
+                {
+                    const uint8* in = source + y*subresource.RowPitch;
+                    uint8* out = converted.data() + y*sourceRowPitch;
+                    for(uint32 x = 0; x < subresource.Width; ++x, in += 4, out += 4)
+                    {
+                        out[0] = in[2];
+                        out[1] = in[1];
+                        out[2] = in[0];
+                        out[3] = forceOpaque ? 255 : in[3];
+                    }
+                }
+                source = converted.data();
+            }
+
+            uint8* dest = output.data() + offsets[i] + z*numBytes;
+
+            auto start = std::chrono::steady_clock::now();
+            Encode(format, options.Level, source, sourceRowPitch, subresource.Width, subresource.Height, dest, rowBytes);
+            seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            sourceBytes += (uint64)subresource.Width*subresource.Height*4;
+
+            if(options.ComputePSNR)
+                AccumulateError(format, source, sourceRowPitch, subresource.Width, subresource.Height, dest, rowBytes, errorSum);
+        }
+    }
+
+    if(stats)
+    {
+        stats->Format = format;
+        stats->SourceBytes = sourceBytes;
+        stats->EncodedBytes = outputSize - dataOffset;
+        stats->Seconds = seconds;
+        stats->MBytesPerSecond = seconds > 0.0 ? (double)sourceBytes / seconds * 1e-6 : 0.0;
+        stats->PSNR = options.ComputePSNR ? errorSum.GetPSNR() : 0.0;
+    }
+    return true;
+}
+
+bool BCEncoder::EncodeFile(const std::filesystem::path& source, const std::filesystem::path& dest, const Options& options,
+                           Stats* stats, std::string* error)
+{
+    std::vector<uint8> output;
+    {
+        MappedFile file;
+        if(!file.Open(source))
+            return Fail(error, "cannot open " + source.string());
+        if(!EncodeDDS(file.GetData(), file.GetSize(), options, output, stats, error))
+            return false;
+    }
+
+    std::ofstream out(dest, std::ios::binary | std::ios::trunc);
+    if(!out)
+        return Fail(error, "cannot create " + dest.string());
+
+    out.write(reinterpret_cast<const char*>(output.data()), (std::streamsize)output.size());
+    if(!out.flush())
+        return Fail(error, "write failed for " + dest.string());
+
+    return true;
+}
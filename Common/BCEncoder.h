@@ -0,0 +1,116 @@
+//***************************************************************************************
+// BCEncoder.h
+//
+// CPU encoder for the texture bake step: turns uncompressed 8-bit RGBA DDS files into
+// BC1, BC3, BC5 or BC7, which DDSTextureLoader uploads as is at an eighth (BC1) or a
+// quarter (the others) of the size.  Surfaces are cut into tiles of 16x16 blocks that
+// the ThreadPool encodes in parallel.
+//
+// Quality trades time for error:
+//   Fast     principal-axis endpoints, BC7 mode 6 only
+//   Normal   plus least-squares endpoint refinement, a wider BC4 endpoint search and
+//            the best of the first 16 partitions of BC7 mode 1 (opaque) or mode 7
+//            (alpha)
+//   High     plus BC1 three-color blocks and endpoint nudging, and for opaque BC7
+//            blocks modes 0 to 3 with the best two of all partitions of each
+// BC7 partitions are ranked by how well their subsets fit a line, and only the
+// chosen candidate is refined.  Tests/BCEncoderBenchmark measures the levels.
+// BC7 modes 4 and 5 (separate alpha indices and channel rotation) are never written.
+//
+// Typical use in a bake tool:
+//     BCEncoder::Options options;
+//     options.Format = DXGI_FORMAT_BC7_UNORM;
+//     BCEncoder::Stats stats;
+//     if(BCEncoder::EncodeFile("Textures/bricks_rgba.dds", "Textures/bricks.dds", options, &stats))
+//         printf("%.1f dB, %.1f MB/s\n", stats.PSNR, stats.MBytesPerSecond);
+//
+// Blocks are checked with BCDecoder, so the PSNR is that of what the sampler returns
+// up to the decoder's rounding.  Nothing here needs Direct3D.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSParser.h"
+#include <string>
+
+class BCEncoder
+{
+public:
+
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    enum class Quality
+    {
+        Fast,
+        Normal,
+        High
+    };
+
+	///<summary>
+	/// BC1, BC3 and BC7 (UNORM or _SRGB) and BC5_UNORM.
+	///</summary>
+    static bool IsSupported(DXGI_FORMAT format);
+
+	///<summary>
+	/// R8G8B8A8, B8G8R8A8 and B8G8R8X8, UNORM or _SRGB.
+	///</summary>
+    static bool IsSupportedSource(DXGI_FORMAT format);
+
+	///<summary>
+	/// Encodes 16 R8G8B8A8 pixels, row by row, into one block.  BC1 marks pixels with
+	/// alpha below 128 transparent; BC5 stores red and green.
+	///</summary>
+    static void EncodeBlock(DXGI_FORMAT format, Quality quality, const std::uint8_t pixels[64], std::uint8_t* block);
+
+	///<summary>
+	/// Encodes a width x height R8G8B8A8 surface into block rows destRowPitch bytes
+	/// apart.  Edge blocks repeat the last row and column.
+	///</summary>
+    static bool Encode(DXGI_FORMAT format, Quality quality, const std::uint8_t* source, size_t sourceRowPitch,
+                       uint32 width, uint32 height, void* dest, size_t destRowPitch);
+
+	///<summary>
+	/// Peak signal-to-noise ratio in dB of an encoded surface against its R8G8B8A8
+	/// source, over the channels the format stores: RGBA, RG for BC5, and for BC1 the
+	/// RGB of the pixels with alpha of 128 or more.  Infinity when they are identical.
+	///</summary>
+    static double ComputePSNR(DXGI_FORMAT format, const std::uint8_t* source, size_t sourceRowPitch,
+                              uint32 width, uint32 height, const std::uint8_t* encoded, size_t encodedRowPitch);
+
+	///<summary>
+	/// Format is made _SRGB when the source is.  ComputePSNR decodes every encoded
+	/// surface again, which costs about as much as a Fast encode.
+	///</summary>
+    struct Options
+    {
+        DXGI_FORMAT Format = DXGI_FORMAT_BC7_UNORM;
+        Quality Level = Quality::Normal;
+        bool ComputePSNR = true;
+    };
+
+	///<summary>
+	/// Seconds covers the encoding only; MBytesPerSecond is source bytes over it.  PSNR
+	/// is over every mip and slice together, 0 when not computed.
+	///</summary>
+    struct Stats
+    {
+        DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+        uint64 SourceBytes = 0;
+        uint64 EncodedBytes = 0;
+        double Seconds = 0.0;
+        double MBytesPerSecond = 0.0;
+        double PSNR = 0.0;
+    };
+
+	///<summary>
+	/// Encodes every mip and slice of a DDS file in memory into a new DDS file (with a
+	/// DX10 header) in output.  2D textures, arrays, cube maps and volumes are
+	/// supported; the top level must be a multiple of 4 in width and height, as
+	/// Direct3D 12 requires for block-compressed textures.
+	///</summary>
+    static bool EncodeDDS(const std::uint8_t* fileData, uint64 fileSize, const Options& options,
+                          std::vector<std::uint8_t>& output, Stats* stats = nullptr, std::string* error = nullptr);
+    static bool EncodeFile(const std::filesystem::path& source, const std::filesystem::path& dest, const Options& options,
+                           Stats* stats = nullptr, std::string* error = nullptr);
+};
@@ -0,0 +1,477 @@
+//***************************************************************************************
+// BoundsBuilder.cpp
+//***************************************************************************************
+
+#include "BoundsBuilder.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+#include <numeric>
+#include <vector>
+
+#if defined(_WIN32)
+#include "d3dUtil.h"
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    // Points summed in float before the partial sum is added to the double total.
+    const std::uint32_t SumBlockSize = 1024;
+
+    // Shrink factor and visiting orders of the sphere refinement passes.
+    const float SphereShrink = 0.95f;
+    const std::uint32_t SphereOrderSteps[] = { 1, 3, 7, 31, 127, 8191, 131071, 524287 };
+
+    inline XMVECTOR LoadPosition(const XMFLOAT3* positions, std::uint32_t stride, std::uint32_t i)
+    {
+        return XMLoadFloat3(reinterpret_cast<const XMFLOAT3*>(
+            reinterpret_cast<const std::uint8_t*>(positions) + (size_t)i*stride));
+    }
+
+    // Grows the sphere just enough to contain p.  The new sphere contains the old one,
+    // so the points visited before stay inside.
+    inline void GrowSphere(XMVECTOR& center, float& radius, FXMVECTOR p)
+    {
+        XMVECTOR d = p - center;
+        float distSq = XMVectorGetX(XMVector3LengthSq(d));
+        if(distSq > radius*radius)
+        {
+            float dist = std::sqrt(distSq);
+            float newRadius = 0.5f*(radius + dist);
+            center = XMVectorMultiplyAdd(d, XMVectorReplicate((newRadius - radius)/dist), center);
+            radius = newRadius;
+        }
+    }
+
+    float MaxDistance(const XMFLOAT3* positions, std::uint32_t stride, std::uint32_t count, FXMVECTOR center)
+    {
+        XMVECTOR maxDistSq = XMVectorZero();
+        for(std::uint32_t i = 0; i < count; ++i)
+            maxDistSq = XMVectorMax(maxDistSq, XMVector3LengthSq(LoadPosition(positions, stride, i) - center));
+
+        return std::sqrt(XMVectorGetX(maxDistSq));
+    }
+
+    // Eigenvectors of the symmetric matrix a by cyclic Jacobi rotations, as the columns
+    // of vectors.  a is diagonalized in place.
+    void JacobiEigenvectors(double a[3][3], double vectors[3][3])
+    {
+        for(int i = 0; i < 3; ++i)
+        {
+            for(int j = 0; j < 3; ++j)
+                vectors[i][j] = i == j ? 1.0 : 0.0;
+        }
+
+        for(int sweep = 0; sweep < 32; ++sweep)
+        {
+            double offDiagonal = a[0][1]*a[0][1] + a[0][2]*a[0][2] + a[1][2]*a[1][2];
+            double diagonal = a[0][0]*a[0][0] + a[1][1]*a[1][1] + a[2][2]*a[2][2];
+            if(offDiagonal <= 1e-24*diagonal || offDiagonal == 0.0)
+                break;
+
+            for(int p = 0; p < 2; ++p)
+            {
+                for(int q = p + 1; q < 3; ++q)
+                {
+                    if(a[p][q] == 0.0)
+                        continue;
+
+                    // Rotation that zeroes a[p][q].
+                    double theta = (a[q][q] - a[p][p])/(2.0*a[p][q]);
+                    double t = (theta >= 0.0 ? 1.0 : -1.0)/(std::fabs(theta) + std::sqrt(theta*theta + 1.0));
+                    double c = 1.0/std::sqrt(t*t + 1.0);
+                    double s = t*c;
+
+                    for(int k = 0; k < 3; ++k)
+                    {
+                        double akp = a[k][p], akq = a[k][q];
+                        a[k][p] = c*akp - s*akq;
+                        a[k][q] = s*akp + c*akq;
+                    }
+                    for(int k = 0; k < 3; ++k)
+                    {
+                        double apk = a[p][k], aqk = a[q][k];
+                        a[p][k] = c*apk - s*aqk;
+                        a[q][k] = s*apk + c*aqk;
+                    }
+                    for(int k = 0; k < 3; ++k)
+                    {
+                        double vkp = vectors[k][p], vkq = vectors[k][q];
+                        vectors[k][p] = c*vkp - s*vkq;
+                        vectors[k][q] = s*vkp + c*vkq;
+                    }
+                }
+            }
+        }
+    }
+
+    float Volume(const BoundingBox& box)
+    {
+        return 8.0f*box.Extents.x*box.Extents.y*box.Extents.z;
+    }
+
+    float Volume(const BoundingSphere& sphere)
+    {
+        return 4.0f/3.0f*XM_PI*sphere.Radius*sphere.Radius*sphere.Radius;
+    }
+
+    float Volume(const BoundingOrientedBox& box)
+    {
+        return 8.0f*box.Extents.x*box.Extents.y*box.Extents.z;
+    }
+
+    template<typename IndexType>
+    MeshBounds ComputeIndexedT(const XMFLOAT3* positions, std::uint32_t positionStride, std::uint32_t vertexCount,
+                               const IndexType* indices, std::uint32_t indexCount)
+    {
+        // Gather the referenced vertices once each.
+        std::vector<bool> referenced(vertexCount, false);
+        std::vector<XMFLOAT3> gathered;
+        gathered.reserve(std::min(vertexCount, indexCount));
+
+        for(std::uint32_t i = 0; i < indexCount; ++i)
+        {
+            std::uint32_t v = indices[i];
+            if(v < vertexCount && !referenced[v])
+            {
+                referenced[v] = true;
+                XMStoreFloat3(&gathered.emplace_back(), LoadPosition(positions, positionStride, v));
+            }
+        }
+
+        return BoundsBuilder::Compute(gathered.data(), sizeof(XMFLOAT3), (std::uint32_t)gathered.size());
+    }
+}
+
+BoundingBox BoundsBuilder::ComputeBox(const XMFLOAT3* positions, uint32 positionStride, uint32 count)
+{
+    BoundingBox box(XMFLOAT3(0.0f, 0.0f, 0.0f), XMFLOAT3(0.0f, 0.0f, 0.0f));
+    if(count == 0)
+        return box;
+
+    // Two independent min/max chains, so consecutive loads do not wait on each other.
+    XMVECTOR vMin0 = XMVectorReplicate(+FLT_MAX), vMin1 = vMin0;
+    XMVECTOR vMax0 = XMVectorReplicate(-FLT_MAX), vMax1 = vMax0;
+
+    uint32 i = 0;
+    for(; i + 1 < count; i += 2)
+    {
+        XMVECTOR p0 = LoadPosition(positions, positionStride, i);
+        XMVECTOR p1 = LoadPosition(positions, positionStride, i + 1);
+        vMin0 = XMVectorMin(vMin0, p0);
+        vMax0 = XMVectorMax(vMax0, p0);
+        vMin1 = XMVectorMin(vMin1, p1);
+        vMax1 = XMVectorMax(vMax1, p1);
+    }
+    if(i < count)
+    {
+        XMVECTOR p = LoadPosition(positions, positionStride, i);
+        vMin0 = XMVectorMin(vMin0, p);
+        vMax0 = XMVectorMax(vMax0, p);
+    }
+
+    BoundingBox::CreateFromPoints(box, XMVectorMin(vMin0, vMin1), XMVectorMax(vMax0, vMax1));
+    return box;
+}
+
+BoundingSphere BoundsBuilder::ComputeSphere(const XMFLOAT3* positions, uint32 positionStride, uint32 count)
+{
+    BoundingSphere sphere(XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f);
+    if(count == 0)
+        return sphere;
+
+    // Ritter: start with the most distant pair of the six axis-extreme points.
+    uint32 minIndex[3] = { 0, 0, 0 };
+    uint32 maxIndex[3] = { 0, 0, 0 };
+    XMFLOAT3 first;
+    XMStoreFloat3(&first, LoadPosition(positions, positionStride, 0));
+    float minValue[3] = { first.x, first.y, first.z };
+    float maxValue[3] = { first.x, first.y, first.z };
+
+    for(uint32 i = 1; i < count; ++i)
+    {
+        XMFLOAT3 p;
+        XMStoreFloat3(&p, LoadPosition(positions, positionStride, i));
+        const float value[3] = { p.x, p.y, p.z };
+        for(int axis = 0; axis < 3; ++axis)
+        {
+            if(value[axis] < minValue[axis]) { minValue[axis] = value[axis]; minIndex[axis] = i; }
+            if(value[axis] > maxValue[axis]) { maxValue[axis] = value[axis]; maxIndex[axis] = i; }
+        }
+    }
+
+    XMVECTOR a = XMVectorZero();
+    XMVECTOR b = XMVectorZero();
+    float maxDistSq = -1.0f;
+    for(int axis = 0; axis < 3; ++axis)
+    {
+        XMVECTOR pMin = LoadPosition(positions, positionStride, minIndex[axis]);
+        XMVECTOR pMax = LoadPosition(positions, positionStride, maxIndex[axis]);
+        float distSq = XMVectorGetX(XMVector3LengthSq(pMax - pMin));
+        if(distSq > maxDistSq)
+        {
+            maxDistSq = distSq;
+            a = pMin;
+            b = pMax;
+        }
+    }
+
+    XMVECTOR bestCenter = 0.5f*(a + b);
+    float bestRadius = 0.5f*std::sqrt(maxDistSq);
+    for(uint32 i = 0; i < count; ++i)
+        GrowSphere(bestCenter, bestRadius, LoadPosition(positions, positionStride, i));
+
+    // Refinement: shrink the best sphere a little and regrow it over the points in
+    // another order.  Keep the result whenever it comes out smaller.
+    for(uint32 step : SphereOrderSteps)
+    {
+        if(std::gcd(step, count) != 1)
+            continue;
+
+        XMVECTOR center = bestCenter;
+        float radius = SphereShrink*bestRadius;
+
+        uint32 index = 0;
+        for(uint32 i = 0; i < count; ++i)
+        {
+            GrowSphere(center, radius, LoadPosition(positions, positionStride, index));
+            index = (uint32)(((std::uint64_t)index + step) % count);
+        }
+
+        if(radius < bestRadius)
+        {
+            bestCenter = center;
+            bestRadius = radius;
+        }
+    }
+
+    // Exact radius around the center, which also absorbs the rounding of the grow steps.
+    bestRadius = MaxDistance(positions, positionStride, count, bestCenter);
+
+    // The sphere around the box center wins for some shapes, e.g. boxes and grids.
+    BoundingBox box = ComputeBox(positions, positionStride, count);
+    XMVECTOR boxCenter = XMLoadFloat3(&box.Center);
+    float boxRadius = MaxDistance(positions, positionStride, count, boxCenter);
+    if(boxRadius <= bestRadius)
+    {
+        bestCenter = boxCenter;
+        bestRadius = boxRadius;
+    }
+
+    XMStoreFloat3(&sphere.Center, bestCenter);
+    sphere.Radius = bestRadius;
+
+    return sphere;
+}
+
+BoundingOrientedBox BoundsBuilder::ComputeOrientedBox(const XMFLOAT3* positions, uint32 positionStride, uint32 count)
+{
+    BoundingBox box = ComputeBox(positions, positionStride, count);
+
+    BoundingOrientedBox orientedBox;
+    orientedBox.Center = box.Center;
+    orientedBox.Extents = box.Extents;
+    orientedBox.Orientation = XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f);
+    if(count < 3)
+        return orientedBox;
+
+    // Mean and covariance, summed in float per block and in double across blocks.
+    double mean[3] = { 0.0, 0.0, 0.0 };
+    for(uint32 start = 0; start < count; start += SumBlockSize)
+    {
+        uint32 end = std::min(count, start + SumBlockSize);
+        XMVECTOR sum = XMVectorZero();
+        for(uint32 i = start; i < end; ++i)
+            sum += LoadPosition(positions, positionStride, i);
+
+        mean[0] += XMVectorGetX(sum);
+        mean[1] += XMVectorGetY(sum);
+        mean[2] += XMVectorGetZ(sum);
+    }
+    for(int k = 0; k < 3; ++k)
+        mean[k] /= count;
+
+    // Center the points on the mean so the float sums stay small.
+    XMVECTOR vMean = XMVectorSet((float)mean[0], (float)mean[1], (float)mean[2], 0.0f);
+
+    double covariance[3][3] = {};
+    for(uint32 start = 0; start < count; start += SumBlockSize)
+    {
+        uint32 end = std::min(count, start + SumBlockSize);
+
+        // (xx, yy, zz) and (xy, yz, zx).
+        XMVECTOR diagonal = XMVectorZero();
+        XMVECTOR offDiagonal = XMVectorZero();
+        for(uint32 i = start; i < end; ++i)
+        {
+            XMVECTOR d = LoadPosition(positions, positionStride, i) - vMean;
+            XMVECTOR dShifted = XMVectorSet(XMVectorGetY(d), XMVectorGetZ(d), XMVectorGetX(d), 0.0f);
+            diagonal = XMVectorMultiplyAdd(d, d, diagonal);
+            offDiagonal = XMVectorMultiplyAdd(d, dShifted, offDiagonal);
+        }
+
+        covariance[0][0] += XMVectorGetX(diagonal);
+        covariance[1][1] += XMVectorGetY(diagonal);
+        covariance[2][2] += XMVectorGetZ(diagonal);
+        covariance[0][1] += XMVectorGetX(offDiagonal);
+        covariance[1][2] += XMVectorGetY(offDiagonal);
+        covariance[0][2] += XMVectorGetZ(offDiagonal);
+    }
+    covariance[1][0] = covariance[0][1];
+    covariance[2][1] = covariance[1][2];
+    covariance[2][0] = covariance[0][2];
+
+    double vectors[3][3];
+    JacobiEigenvectors(covariance, vectors);
+
+    // Rows of the rotation are the box axes; the third is the cross product of the
+    // first two so the rotation is proper.
+    XMVECTOR axis0 = XMVector3Normalize(XMVectorSet((float)vectors[0][0], (float)vectors[1][0], (float)vectors[2][0], 0.0f));
+    XMVECTOR axis1 = XMVector3Normalize(XMVectorSet((float)vectors[0][1], (float)vectors[1][1], (float)vectors[2][1], 0.0f));
+    axis1 = XMVector3Normalize(axis1 - XMVector3Dot(axis1, axis0)*axis0);
+    XMVECTOR axis2 = XMVector3Cross(axis0, axis1);
+
+    XMMATRIX rotation;
+    rotation.r[0] = axis0;
+    rotation.r[1] = axis1;
+    rotation.r[2] = axis2;
+    rotation.r[3] = XMVectorSet(0.0f, 0.0f, 0.0f, 1.0f);
+
+    // Transforming by the transpose projects onto the three axes at once.
+    XMMATRIX toLocal = XMMatrixTranspose(rotation);
+
+    XMVECTOR vMin = XMVectorReplicate(+FLT_MAX);
+    XMVECTOR vMax = XMVectorReplicate(-FLT_MAX);
+    for(uint32 i = 0; i < count; ++i)
+    {
+        XMVECTOR p = XMVector3TransformNormal(LoadPosition(positions, positionStride, i), toLocal);
+        vMin = XMVectorMin(vMin, p);
+        vMax = XMVectorMax(vMax, p);
+    }
+
+    BoundingOrientedBox pcaBox;
+    XMStoreFloat3(&pcaBox.Center, XMVector3TransformNormal(0.5f*(vMin + vMax), rotation));
+    XMStoreFloat3(&pcaBox.Extents, 0.5f*(vMax - vMin));
+    XMStoreFloat4(&pcaBox.Orientation, XMQuaternionRotationMatrix(rotation));
+
+    if(Volume(pcaBox) < Volume(box))
+        orientedBox = pcaBox;
+
+    return orientedBox;
+}
+
+MeshBounds BoundsBuilder::Compute(const XMFLOAT3* positions, uint32 positionStride, uint32 count)
+{
+    MeshBounds bounds;
+    if(count == 0)
+        return bounds;
+
+    bounds.Box = ComputeBox(positions, positionStride, count);
+    bounds.Sphere = ComputeSphere(positions, positionStride, count);
+    bounds.OrientedBox = ComputeOrientedBox(positions, positionStride, count);
+    bounds.Tightest = ChooseVolume(bounds);
+
+    return bounds;
+}
+
+MeshBounds BoundsBuilder::Compute(const XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                                  const uint32* indices, uint32 indexCount)
+{
+    return ComputeIndexedT(positions, positionStride, vertexCount, indices, indexCount);
+}
+
+MeshBounds BoundsBuilder::Compute(const XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                                  const uint16* indices, uint32 indexCount)
+{
+    return ComputeIndexedT(positions, positionStride, vertexCount, indices, indexCount);
+}
+
+BoundingVolume BoundsBuilder::ChooseVolume(const MeshBounds& bounds)
+{
+    BoundingVolume volume = BoundingVolume::Box;
+    float smallest = Volume(bounds.Box);
+
+    if(Volume(bounds.Sphere) < smallest)
+    {
+        volume = BoundingVolume::Sphere;
+        smallest = Volume(bounds.Sphere);
+    }
+
+    if(Volume(bounds.OrientedBox) < 0.9f*smallest)
+        volume = BoundingVolume::OrientedBox;
+
+    return volume;
+}
+
+bool BoundsBuilder::IsVisible(const MeshBounds& bounds, const BoundingFrustum& frustum)
+{
+    switch(bounds.Tightest)
+    {
+    case BoundingVolume::Sphere:
+        return frustum.Intersects(bounds.Sphere);
+    case BoundingVolume::OrientedBox:
+        return frustum.Intersects(bounds.OrientedBox);
+    default:
+        return frustum.Intersects(bounds.Box);
+    }
+}
+
+#if defined(_WIN32)
+void BoundsBuilder::Apply(const MeshBounds& bounds, SubmeshGeometry& submesh)
+{
+    submesh.Bounds = bounds.Box;
+    submesh.SphereBounds = bounds.Sphere;
+    submesh.OrientedBounds = bounds.OrientedBox;
+    submesh.CullVolume = bounds.Tightest;
+}
+
+void BoundsBuilder::ComputeSubmeshBounds(MeshGeometry& geometry)
+{
+    if(geometry.VertexBufferCPU == nullptr || geometry.IndexBufferCPU == nullptr || geometry.VertexByteStride == 0)
+        return;
+
+    const std::uint8_t* vertexData = static_cast<const std::uint8_t*>(geometry.VertexBufferCPU->GetBufferPointer());
+    const void* indexData = geometry.IndexBufferCPU->GetBufferPointer();
+    uint32 totalVertexCount = (uint32)(geometry.VertexBufferCPU->GetBufferSize() / geometry.VertexByteStride);
+
+    for(auto& it : geometry.DrawArgs)
+    {
+        SubmeshGeometry& submesh = it.second;
+        if(submesh.BaseVertexLocation < 0 || (uint32)submesh.BaseVertexLocation >= totalVertexCount)
+            continue;
+
+        const XMFLOAT3* positions = reinterpret_cast<const XMFLOAT3*>(
+            vertexData + (size_t)submesh.BaseVertexLocation*geometry.VertexByteStride);
+        uint32 vertexCount = totalVertexCount - submesh.BaseVertexLocation;
+
+        MeshBounds bounds;
+        if(geometry.IndexFormat == DXGI_FORMAT_R16_UINT)
+        {
+            bounds = Compute(positions, geometry.VertexByteStride, vertexCount,
+                static_cast<const uint16*>(indexData) + submesh.StartIndexLocation, submesh.IndexCount);
+        }
+        else
+        {
+            bounds = Compute(positions, geometry.VertexByteStride, vertexCount,
+                static_cast<const uint32*>(indexData) + submesh.StartIndexLocation, submesh.IndexCount);
+        }
+
+        Apply(bounds, submesh);
+    }
+}
+
+bool BoundsBuilder::IsVisible(const SubmeshGeometry& submesh, const BoundingFrustum& frustum)
+{
+    switch(submesh.CullVolume)
+    {
+    case BoundingVolume::Sphere:
+        return frustum.Intersects(submesh.SphereBounds);
+    case BoundingVolume::OrientedBox:
+        return frustum.Intersects(submesh.OrientedBounds);
+    default:
+        return frustum.Intersects(submesh.Bounds);
+    }
+}
+#endif
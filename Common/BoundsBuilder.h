@@ -0,0 +1,99 @@
+//***************************************************************************************
+// BoundsBuilder.h
+//
+// Computes the bounding volumes of a set of positions: an axis-aligned box, a sphere
+// (Ritter's algorithm with iterative refinement) and a PCA-fitted oriented box.
+// GeometryGenerator fills MeshData::Bounds with it, and ComputeSubmeshBounds fills
+// the DrawArgs of a MeshGeometry from its CPU copies.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <DirectXCollision.h>
+#include <DirectXMath.h>
+
+struct MeshGeometry;
+struct SubmeshGeometry;
+
+enum class BoundingVolume
+{
+    Box,
+    Sphere,
+    OrientedBox
+};
+
+struct MeshBounds
+{
+    DirectX::BoundingBox Box = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f } };
+    DirectX::BoundingSphere Sphere = { { 0.0f, 0.0f, 0.0f }, 0.0f };
+    DirectX::BoundingOrientedBox OrientedBox = { { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f }, { 0.0f, 0.0f, 0.0f, 1.0f } };
+
+    // Volume to cull with, see BoundsBuilder::ChooseVolume.
+    BoundingVolume Tightest = BoundingVolume::Box;
+};
+
+class BoundsBuilder
+{
+public:
+
+    using uint16 = std::uint16_t;
+    using uint32 = std::uint32_t;
+
+	///<summary>
+	/// positionStride is the distance in bytes between two positions.  All three return
+	/// a zero-sized volume at the origin for an empty set.
+	///</summary>
+    static DirectX::BoundingBox ComputeBox(const DirectX::XMFLOAT3* positions, uint32 positionStride, uint32 count);
+
+	///<summary>
+	/// Ritter's sphere, then a few shrink-and-regrow passes that usually bring it within
+	/// a few percent of the minimal sphere.  Never larger than the sphere around the box.
+	///</summary>
+    static DirectX::BoundingSphere ComputeSphere(const DirectX::XMFLOAT3* positions, uint32 positionStride, uint32 count);
+
+	///<summary>
+	/// Box along the principal axes of the point covariance.  Falls back to the
+	/// axis-aligned box when that one is not larger (e.g. for isotropic point sets,
+	/// where the principal axes are arbitrary).
+	///</summary>
+    static DirectX::BoundingOrientedBox ComputeOrientedBox(const DirectX::XMFLOAT3* positions, uint32 positionStride, uint32 count);
+
+    static MeshBounds Compute(const DirectX::XMFLOAT3* positions, uint32 positionStride, uint32 count);
+
+	///<summary>
+	/// Bounds of the vertices referenced by an index range only, as for a submesh that
+	/// shares its vertex buffer with others.  Indices are relative to positions.
+	///</summary>
+    static MeshBounds Compute(const DirectX::XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                              const uint32* indices, uint32 indexCount);
+    static MeshBounds Compute(const DirectX::XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                              const uint16* indices, uint32 indexCount);
+
+	///<summary>
+	/// Picks the volume with the least volume.  The oriented box has to be 10% smaller
+	/// than the others to be picked, since its frustum test costs about three box tests.
+	///</summary>
+    static BoundingVolume ChooseVolume(const MeshBounds& bounds);
+
+	///<summary>
+	/// Frustum test with the Tightest volume.  Transform the frustum into the space of
+	/// the positions first, as for MeshletBuilder::IsVisible.
+	///</summary>
+    static bool IsVisible(const MeshBounds& bounds, const DirectX::BoundingFrustum& frustum);
+
+#if defined(_WIN32)
+	///<summary>
+	/// Copies bounds into Bounds, SphereBounds, OrientedBounds and CullVolume.
+	///</summary>
+    static void Apply(const MeshBounds& bounds, SubmeshGeometry& submesh);
+
+	///<summary>
+	/// Computes the bounds of every DrawArgs entry from VertexBufferCPU and
+	/// IndexBufferCPU.  The vertex format must start with an XMFLOAT3 position.
+	///</summary>
+    static void ComputeSubmeshBounds(MeshGeometry& geometry);
+
+    static bool IsVisible(const SubmeshGeometry& submesh, const DirectX::BoundingFrustum& frustum);
+#endif
+};
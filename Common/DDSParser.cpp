@@ -0,0 +1,935 @@
+//***************************************************************************************
+// DDSParser.cpp
+//
+// BitsPerPixel, GetSurfaceInfo, GetDXGIFormat and MakeSRGB are moved unchanged from
+// DDSTextureLoader.cpp (Copyright (c) Microsoft Corporation, see that file).
+//***************************************************************************************
+
+#include "DDSParser.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstring>
+
+namespace
+{
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    // Direct3D 12 hardware limits (D3D12_REQ_*), so the parser gives the same answer as
+    // the loader without d3d12.h.
+    const uint32 MaxMipLevels = 15;
+    const uint32 MaxTexture1DArraySize = 2048;
+    const uint32 MaxTexture1DWidth = 16384;
+    const uint32 MaxTexture2DArraySize = 2048;
+    const uint32 MaxTexture2DSize = 16384;
+    const uint32 MaxTextureCubeSize = 16384;
+    const uint32 MaxTexture3DSize = 2048;
+
+    // D3D11_RESOURCE_MISC_TEXTURECUBE
+    const uint32 MiscTextureCube = 0x4;
+
+    // DirectX::DDS_ALPHA_MODE
+    const uint32 AlphaModeUnknown = 0;
+    const uint32 AlphaModeStraight = 1;
+    const uint32 AlphaModePremultiplied = 2;
+    const uint32 AlphaModeOpaque = 3;
+    const uint32 AlphaModeCustom = 4;
+
+    bool HasDX10Header(const DDS_HEADER* header)
+    {
+        return (header->ddspf.flags & DDS_FOURCC) && MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC;
+    }
+}
+
+DDSParser::Result DDSParser::ReadHeader(const std::uint8_t* data, uint64 size, const DDS_HEADER** header, uint64* dataOffset)
+{
+    // Need at least enough data to fill the header and magic number to be a valid DDS
+    if(data == nullptr || size < sizeof(uint32) + sizeof(DDS_HEADER))
+        return Result::InvalidData;
+
+    // DDS files always start with the same magic number ("DDS ")
+    uint32 magic;
+    std::memcpy(&magic, data, sizeof(uint32));
+    if(magic != DDS_MAGIC)
+        return Result::InvalidData;
+
+    auto hdr = reinterpret_cast<const DDS_HEADER*>(data + sizeof(uint32));
+    if(hdr->size != sizeof(DDS_HEADER) || hdr->ddspf.size != sizeof(DDS_PIXELFORMAT))
+        return Result::InvalidData;
+
+    uint64 offset = sizeof(uint32) + sizeof(DDS_HEADER);
+    if(HasDX10Header(hdr))
+    {
+        offset += sizeof(DDS_HEADER_DXT10);
+        if(size < offset)
+            return Result::InvalidData;
+    }
+
+    if(header)
+        *header = hdr;
+    if(dataOffset)
+        *dataOffset = offset;
+
+    return Result::Ok;
+}
+
+DDSParser::Result DDSParser::ParseHeader(const DDS_HEADER* header, TextureDesc& desc)
+{
+    desc = TextureDesc();
+
+    uint32 width = header->width;
+    uint32 height = header->height;
+    uint32 depth = header->depth;
+    uint32 arraySize = 1;
+    uint32 mipCount = header->mipMapCount == 0 ? 1 : header->mipMapCount;
+    bool isCubeMap = false;
+    TextureDimension dimension = TextureDimension::Unknown;
+    DXGI_FORMAT format = DXGI_FORMAT_UNKNOWN;
+
+    if(HasDX10Header(header))
+    {
+        auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>((const char*)header + sizeof(DDS_HEADER));
+
+        arraySize = d3d10ext->arraySize;
+        if(arraySize == 0)
+            return Result::InvalidData;
+
+        switch(d3d10ext->dxgiFormat)
+        {
+        case DXGI_FORMAT_AI44:
+        case DXGI_FORMAT_IA44:
+        case DXGI_FORMAT_P8:
+        case DXGI_FORMAT_A8P8:
+            return Result::NotSupported;
+
+        default:
+            if(BitsPerPixel(d3d10ext->dxgiFormat) == 0)
+                return Result::NotSupported;
+        }
+
+        format = d3d10ext->dxgiFormat;
+
+        switch(d3d10ext->resourceDimension)
+        {
+        case (uint32)TextureDimension::Texture1D:
+            if((header->flags & DDS_HEIGHT) && height != 1)
+                return Result::InvalidData;
+            height = depth = 1;
+            dimension = TextureDimension::Texture1D;
+            break;
+
+        case (uint32)TextureDimension::Texture2D:
+            if(d3d10ext->miscFlag & MiscTextureCube)
+            {
+                if(arraySize > MaxTexture2DArraySize / 6)
+                    return Result::NotSupported;
+                arraySize *= 6;
+                isCubeMap = true;
+            }
+            depth = 1;
+            dimension = TextureDimension::Texture2D;
+            break;
+
+        case (uint32)TextureDimension::Texture3D:
+            if(!(header->flags & DDS_HEADER_FLAGS_VOLUME))
+                return Result::InvalidData;
+            if(arraySize > 1)
+                return Result::NotSupported;
+            dimension = TextureDimension::Texture3D;
+            break;
+
+        default:
+            return Result::NotSupported;
+        }
+    }
+    else
+    {
+        format = GetDXGIFormat(header->ddspf);
+        if(format == DXGI_FORMAT_UNKNOWN)
+            return Result::NotSupported;
+
+        if(header->flags & DDS_HEADER_FLAGS_VOLUME)
+        {
+            dimension = TextureDimension::Texture3D;
+        }
+        else
+        {
+            if(header->caps2 & DDS_CUBEMAP)
+            {
+                // We require all six faces to be defined
+                if((header->caps2 & DDS_CUBEMAP_ALLFACES) != DDS_CUBEMAP_ALLFACES)
+                    return Result::NotSupported;
+                arraySize = 6;
+                isCubeMap = true;
+            }
+
+            depth = 1;
+            dimension = TextureDimension::Texture2D;
+        }
+    }
+
+    // Bound sizes (for security purposes we don't trust DDS file metadata larger than the
+    // hardware requirements)
+    if(mipCount > MaxMipLevels)
+        return Result::NotSupported;
+
+    switch(dimension)
+    {
+    case TextureDimension::Texture1D:
+        if(arraySize > MaxTexture1DArraySize || width > MaxTexture1DWidth)
+            return Result::NotSupported;
+        break;
+
+    case TextureDimension::Texture2D:
+        if(isCubeMap)
+        {
+            // arraySize is NumCubes*6 here
+            if(arraySize > MaxTexture2DArraySize || width > MaxTextureCubeSize || height > MaxTextureCubeSize)
+                return Result::NotSupported;
+        }
+        else if(arraySize > MaxTexture2DArraySize || width > MaxTexture2DSize || height > MaxTexture2DSize)
+        {
+            return Result::NotSupported;
+        }
+        break;
+
+    case TextureDimension::Texture3D:
+        if(arraySize > 1 || width > MaxTexture3DSize || height > MaxTexture3DSize || depth > MaxTexture3DSize)
+            return Result::NotSupported;
+        break;
+
+    default:
+        return Result::NotSupported;
+    }
+
+    if(width == 0 || height == 0 || depth == 0)
+        return Result::InvalidData;
+
+    desc.Dimension = dimension;
+    desc.Format = format;
+    desc.Width = width;
+    desc.Height = height;
+    desc.Depth = depth;
+    desc.ArraySize = arraySize;
+    desc.MipCount = mipCount;
+    desc.IsCubeMap = isCubeMap;
+    desc.AlphaMode = GetAlphaMode(header);
+
+    return Result::Ok;
+}
+
+DDSParser::Result DDSParser::Parse(const std::uint8_t* data, uint64 size, Layout& layout)
+{
+    layout = Layout();
+
+    const DDS_HEADER* header = nullptr;
+    uint64 dataOffset = 0;
+    Result result = ReadHeader(data, size, &header, &dataOffset);
+    if(result != Result::Ok)
+        return result;
+
+    TextureDesc desc;
+    result = ParseHeader(header, desc);
+    if(result != Result::Ok)
+        return result;
+
+    return ComputeLayout(desc, dataOffset, size, layout);
+}
+
+DDSParser::Result DDSParser::ComputeLayout(const TextureDesc& desc, uint64 dataOffset, uint64 fileSize, Layout& layout)
+{
+    layout = Layout();
+    layout.Desc = desc;
+    layout.DataOffset = dataOffset;
+    layout.Subresources.resize((size_t)desc.ArraySize * desc.MipCount);
+
+    // Same walk as FillInitData12: every mip of slice 0, then every mip of slice 1, ...
+    uint64 offset = dataOffset;
+    Subresource* subresource = layout.Subresources.data();
+    for(uint32 slice = 0; slice < desc.ArraySize; ++slice)
+    {
+        uint32 w = desc.Width;
+        uint32 h = desc.Height;
+        uint32 d = desc.Depth;
+        for(uint32 mip = 0; mip < desc.MipCount; ++mip, ++subresource)
+        {
+            size_t numBytes = 0;
+            size_t rowBytes = 0;
+            size_t numRows = 0;
+            GetSurfaceInfo(w, h, desc.Format, &numBytes, &rowBytes, &numRows);
+
+            subresource->Offset = offset;
+            subresource->RowPitch = rowBytes;
+            subresource->SlicePitch = numBytes;
+            subresource->NumRows = (uint32)numRows;
+            subresource->Width = w;
+            subresource->Height = h;
+            subresource->Depth = d;
+
+            offset += (uint64)numBytes * d;
+            if(offset > fileSize)
+            {
+                layout.Subresources.clear();
+                return Result::Truncated;
+            }
+
+            w = std::max(w >> 1, 1u);
+            h = std::max(h >> 1, 1u);
+            d = std::max(d >> 1, 1u);
+        }
+    }
+
+    layout.DataSize = offset - dataOffset;
+
+    return Result::Ok;
+}
+
+DDSParser::Result DDSParser::ParseFile(const std::filesystem::path& filename, Layout& layout)
+{
+    // Parse only reads the header, so mapping the file touches one page whatever its size.
+    MappedFile file;
+    if(!file.Open(filename))
+    {
+        layout = Layout();
+        return Result::InvalidData;
+    }
+
+    return Parse(file.GetData(), file.GetSize(), layout);
+}
+
+void DDSParser::WriteHeader(const TextureDesc& desc, std::uint8_t* dest)
+{
+    // DDSD_* and DDSCAPS* values not needed by the reader.
+    const uint32 FlagsCaps = 0x1;
+    const uint32 FlagsPitch = 0x8;
+    const uint32 FlagsPixelFormat = 0x1000;
+    const uint32 FlagsMipCount = 0x20000;
+    const uint32 FlagsLinearSize = 0x80000;
+    const uint32 CapsComplex = 0x8;
+    const uint32 CapsTexture = 0x1000;
+    const uint32 CapsMipMap = 0x400000;
+    const uint32 Caps2Volume = 0x200000;
+
+    bool isVolume = desc.Dimension == TextureDimension::Texture3D;
+    bool isCompressed = IsCompressed(desc.Format);
+
+    DDS_HEADER header = {};
+    header.size = sizeof(DDS_HEADER);
+    header.flags = FlagsCaps | DDS_HEIGHT | DDS_WIDTH | FlagsPixelFormat | FlagsMipCount |
+                   (isCompressed ? FlagsLinearSize : FlagsPitch) | (isVolume ? DDS_HEADER_FLAGS_VOLUME : 0);
+    header.height = desc.Height;
+    header.width = desc.Width;
+    header.depth = isVolume ? desc.Depth : 0;
+    header.mipMapCount = desc.MipCount;
+    header.ddspf.size = sizeof(DDS_PIXELFORMAT);
+    header.ddspf.flags = DDS_FOURCC;
+    header.ddspf.fourCC = MAKEFOURCC('D', 'X', '1', '0');
+    header.caps = CapsTexture | (desc.MipCount > 1 ? CapsMipMap | CapsComplex : 0);
+    header.caps2 = (desc.IsCubeMap ? DDS_CUBEMAP_ALLFACES : 0) | (isVolume ? Caps2Volume : 0);
+
+    size_t numBytes = 0, rowBytes = 0;
+    GetSurfaceInfo(desc.Width, desc.Height, desc.Format, &numBytes, &rowBytes, nullptr);
+    header.pitchOrLinearSize = (uint32)(isCompressed ? numBytes : rowBytes);
+
+    DDS_HEADER_DXT10 extension = {};
+    extension.dxgiFormat = desc.Format;
+    extension.resourceDimension = (uint32)desc.Dimension;
+    extension.miscFlag = desc.IsCubeMap ? MiscTextureCube : 0;
+    extension.arraySize = desc.IsCubeMap ? desc.ArraySize / 6 : desc.ArraySize;
+    extension.miscFlags2 = desc.AlphaMode & DDS_MISC_FLAGS2_ALPHA_MODE_MASK;
+
+    std::memcpy(dest, &DDS_MAGIC, sizeof(uint32));
+    std::memcpy(dest + sizeof(uint32), &header, sizeof(header));
+    std::memcpy(dest + sizeof(uint32) + sizeof(header), &extension, sizeof(extension));
+}
+
+DDSParser::uint32 DDSParser::GetAlphaMode(const DDS_HEADER* header)
+{
+    if(header->ddspf.flags & DDS_FOURCC)
+    {
+        if(MAKEFOURCC('D', 'X', '1', '0') == header->ddspf.fourCC)
+        {
+            auto d3d10ext = reinterpret_cast<const DDS_HEADER_DXT10*>((const char*)header + sizeof(DDS_HEADER));
+            uint32 mode = d3d10ext->miscFlags2 & DDS_MISC_FLAGS2_ALPHA_MODE_MASK;
+            switch(mode)
+            {
+            case AlphaModeStraight:
+            case AlphaModePremultiplied:
+            case AlphaModeOpaque:
+            case AlphaModeCustom:
+                return mode;
+            }
+        }
+        else if(MAKEFOURCC('D', 'X', 'T', '2') == header->ddspf.fourCC ||
+                MAKEFOURCC('D', 'X', 'T', '4') == header->ddspf.fourCC)
+        {
+            return AlphaModePremultiplied;
+        }
+    }
+
+    return AlphaModeUnknown;
+}
+
+bool DDSParser::IsCompressed(DXGI_FORMAT fmt)
+{
+    switch(fmt)
+    {
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return true;
+
+    default:
+        return false;
+    }
+}
+
+//--------------------------------------------------------------------------------------
+// Return the BPP for a particular format
+//--------------------------------------------------------------------------------------
+size_t DDSParser::BitsPerPixel( DXGI_FORMAT fmt )
+{
+    switch( fmt )
+    {
+    case DXGI_FORMAT_R32G32B32A32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32A32_FLOAT:
+    case DXGI_FORMAT_R32G32B32A32_UINT:
+    case DXGI_FORMAT_R32G32B32A32_SINT:
+        return 128;
+
+    case DXGI_FORMAT_R32G32B32_TYPELESS:
+    case DXGI_FORMAT_R32G32B32_FLOAT:
+    case DXGI_FORMAT_R32G32B32_UINT:
+    case DXGI_FORMAT_R32G32B32_SINT:
+        return 96;
+
+    case DXGI_FORMAT_R16G16B16A16_TYPELESS:
+    case DXGI_FORMAT_R16G16B16A16_FLOAT:
+    case DXGI_FORMAT_R16G16B16A16_UNORM:
+    case DXGI_FORMAT_R16G16B16A16_UINT:
+    case DXGI_FORMAT_R16G16B16A16_SNORM:
+    case DXGI_FORMAT_R16G16B16A16_SINT:
+    case DXGI_FORMAT_R32G32_TYPELESS:
+    case DXGI_FORMAT_R32G32_FLOAT:
+    case DXGI_FORMAT_R32G32_UINT:
+    case DXGI_FORMAT_R32G32_SINT:
+    case DXGI_FORMAT_R32G8X24_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT_S8X24_UINT:
+    case DXGI_FORMAT_R32_FLOAT_X8X24_TYPELESS:
+    case DXGI_FORMAT_X32_TYPELESS_G8X24_UINT:
+    case DXGI_FORMAT_Y416:
+    case DXGI_FORMAT_Y210:
+    case DXGI_FORMAT_Y216:
+        return 64;
+
+    case DXGI_FORMAT_R10G10B10A2_TYPELESS:
+    case DXGI_FORMAT_R10G10B10A2_UNORM:
+    case DXGI_FORMAT_R10G10B10A2_UINT:
+    case DXGI_FORMAT_R11G11B10_FLOAT:
+    case DXGI_FORMAT_R8G8B8A8_TYPELESS:
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+    case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+    case DXGI_FORMAT_R8G8B8A8_UINT:
+    case DXGI_FORMAT_R8G8B8A8_SNORM:
+    case DXGI_FORMAT_R8G8B8A8_SINT:
+    case DXGI_FORMAT_R16G16_TYPELESS:
+    case DXGI_FORMAT_R16G16_FLOAT:
+    case DXGI_FORMAT_R16G16_UNORM:
+    case DXGI_FORMAT_R16G16_UINT:
+    case DXGI_FORMAT_R16G16_SNORM:
+    case DXGI_FORMAT_R16G16_SINT:
+    case DXGI_FORMAT_R32_TYPELESS:
+    case DXGI_FORMAT_D32_FLOAT:
+    case DXGI_FORMAT_R32_FLOAT:
+    case DXGI_FORMAT_R32_UINT:
+    case DXGI_FORMAT_R32_SINT:
+    case DXGI_FORMAT_R24G8_TYPELESS:
+    case DXGI_FORMAT_D24_UNORM_S8_UINT:
+    case DXGI_FORMAT_R24_UNORM_X8_TYPELESS:
+    case DXGI_FORMAT_X24_TYPELESS_G8_UINT:
+    case DXGI_FORMAT_R9G9B9E5_SHAREDEXP:
+    case DXGI_FORMAT_R8G8_B8G8_UNORM:
+    case DXGI_FORMAT_G8R8_G8B8_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+    case DXGI_FORMAT_R10G10B10_XR_BIAS_A2_UNORM:
+    case DXGI_FORMAT_B8G8R8A8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:
+    case DXGI_FORMAT_B8G8R8X8_TYPELESS:
+    case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:
+    case DXGI_FORMAT_AYUV:
+    case DXGI_FORMAT_Y410:
+    case DXGI_FORMAT_YUY2:
+        return 32;
+
+    case DXGI_FORMAT_P010:
+    case DXGI_FORMAT_P016:
+        return 24;
+
+    case DXGI_FORMAT_R8G8_TYPELESS:
+    case DXGI_FORMAT_R8G8_UNORM:
+    case DXGI_FORMAT_R8G8_UINT:
+    case DXGI_FORMAT_R8G8_SNORM:
+    case DXGI_FORMAT_R8G8_SINT:
+    case DXGI_FORMAT_R16_TYPELESS:
+    case DXGI_FORMAT_R16_FLOAT:
+    case DXGI_FORMAT_D16_UNORM:
+    case DXGI_FORMAT_R16_UNORM:
+    case DXGI_FORMAT_R16_UINT:
+    case DXGI_FORMAT_R16_SNORM:
+    case DXGI_FORMAT_R16_SINT:
+    case DXGI_FORMAT_B5G6R5_UNORM:
+    case DXGI_FORMAT_B5G5R5A1_UNORM:
+    case DXGI_FORMAT_A8P8:
+    case DXGI_FORMAT_B4G4R4A4_UNORM:
+        return 16;
+
+    case DXGI_FORMAT_NV12:
+    case DXGI_FORMAT_420_OPAQUE:
+    case DXGI_FORMAT_NV11:
+        return 12;
+
+    case DXGI_FORMAT_R8_TYPELESS:
+    case DXGI_FORMAT_R8_UNORM:
+    case DXGI_FORMAT_R8_UINT:
+    case DXGI_FORMAT_R8_SNORM:
+    case DXGI_FORMAT_R8_SINT:
+    case DXGI_FORMAT_A8_UNORM:
+    case DXGI_FORMAT_AI44:
+    case DXGI_FORMAT_IA44:
+    case DXGI_FORMAT_P8:
+        return 8;
+
+    case DXGI_FORMAT_R1_UNORM:
+        return 1;
+
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        return 4;
+
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        return 8;
+
+    default:
+        return 0;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+// Get surface information for a particular format
+//--------------------------------------------------------------------------------------
+void DDSParser::GetSurfaceInfo( size_t width,
+                                size_t height,
+                                DXGI_FORMAT fmt,
+                                size_t* outNumBytes,
+                                size_t* outRowBytes,
+                                size_t* outNumRows )
+{
+    size_t numBytes = 0;
+    size_t rowBytes = 0;
+    size_t numRows = 0;
+
+    bool bc = false;
+    bool packed = false;
+    bool planar = false;
+    size_t bpe = 0;
+    switch (fmt)
+    {
+    case DXGI_FORMAT_BC1_TYPELESS:
+    case DXGI_FORMAT_BC1_UNORM:
+    case DXGI_FORMAT_BC1_UNORM_SRGB:
+    case DXGI_FORMAT_BC4_TYPELESS:
+    case DXGI_FORMAT_BC4_UNORM:
+    case DXGI_FORMAT_BC4_SNORM:
+        bc=true;
+        bpe = 8;
+        break;
+
+    case DXGI_FORMAT_BC2_TYPELESS:
+    case DXGI_FORMAT_BC2_UNORM:
+    case DXGI_FORMAT_BC2_UNORM_SRGB:
+    case DXGI_FORMAT_BC3_TYPELESS:
+    case DXGI_FORMAT_BC3_UNORM:
+    case DXGI_FORMAT_BC3_UNORM_SRGB:
+    case DXGI_FORMAT_BC5_TYPELESS:
+    case DXGI_FORMAT_BC5_UNORM:
+    case DXGI_FORMAT_BC5_SNORM:
+    case DXGI_FORMAT_BC6H_TYPELESS:
+    case DXGI_FORMAT_BC6H_UF16:
+    case DXGI_FORMAT_BC6H_SF16:
+    case DXGI_FORMAT_BC7_TYPELESS:
+    case DXGI_FORMAT_BC7_UNORM:
+    case DXGI_FORMAT_BC7_UNORM_SRGB:
+        bc = true;
+        bpe = 16;
+        break;
+
+    case DXGI_FORMAT_R8G8_B8G8_UNORM:
+    case DXGI_FORMAT_G8R8_G8B8_UNORM:
+    case DXGI_FORMAT_YUY2:
+        packed = true;
+        bpe = 4;
+        break;
+
+    case DXGI_FORMAT_Y210:
+    case DXGI_FORMAT_Y216:
+        packed = true;
+        bpe = 8;
+        break;
+
+    case DXGI_FORMAT_NV12:
+    case DXGI_FORMAT_420_OPAQUE:
+        planar = true;
+        bpe = 2;
+        break;
+
+    case DXGI_FORMAT_P010:
+    case DXGI_FORMAT_P016:
+        planar = true;
+        bpe = 4;
+        break;
+
+    default:
+        break;
+    }
+
+    if (bc)
+    {
+        size_t numBlocksWide = 0;
+        if (width > 0)
+        {
+            numBlocksWide = std::max<size_t>( 1, (width + 3) / 4 );
+        }
+        size_t numBlocksHigh = 0;
+        if (height > 0)
+        {
+            numBlocksHigh = std::max<size_t>( 1, (height + 3) / 4 );
+        }
+        rowBytes = numBlocksWide * bpe;
+        numRows = numBlocksHigh;
+        numBytes = rowBytes * numBlocksHigh;
+    }
+    else if (packed)
+    {
+        rowBytes = ( ( width + 1 ) >> 1 ) * bpe;
+        numRows = height;
+        numBytes = rowBytes * height;
+    }
+    else if ( fmt == DXGI_FORMAT_NV11 )
+    {
+        rowBytes = ( ( width + 3 ) >> 2 ) * 4;
+        numRows = height * 2; // Direct3D makes this simplifying assumption, although it is larger than the 4:1:1 data
+        numBytes = rowBytes * numRows;
+    }
+    else if (planar)
+    {
+        rowBytes = ( ( width + 1 ) >> 1 ) * bpe;
+        numBytes = ( rowBytes * height ) + ( ( rowBytes * height + 1 ) >> 1 );
+        numRows = height + ( ( height + 1 ) >> 1 );
+    }
+    else
+    {
+        size_t bpp = BitsPerPixel( fmt );
+        rowBytes = ( width * bpp + 7 ) / 8; // round up to nearest byte
+        numRows = height;
+        numBytes = rowBytes * height;
+    }
+
+    if (outNumBytes)
+    {
+        *outNumBytes = numBytes;
+    }
+    if (outRowBytes)
+    {
+        *outRowBytes = rowBytes;
+    }
+    if (outNumRows)
+    {
+        *outNumRows = numRows;
+    }
+}
+
+
+//--------------------------------------------------------------------------------------
+#define ISBITMASK( r,g,b,a ) ( ddpf.RBitMask == r && ddpf.GBitMask == g && ddpf.BBitMask == b && ddpf.ABitMask == a )
+
+DXGI_FORMAT DDSParser::GetDXGIFormat( const DDS_PIXELFORMAT& ddpf )
+{
+    if (ddpf.flags & DDS_RGB)
+    {
+        // Note that sRGB formats are written using the "DX10" extended header
+
+        switch (ddpf.RGBBitCount)
+        {
+        case 32:
+            if (ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0xff000000))
+            {
+                return DXGI_FORMAT_R8G8B8A8_UNORM;
+            }
+
+            if (ISBITMASK(0x00ff0000,0x0000ff00,0x000000ff,0xff000000))
+            {
+                return DXGI_FORMAT_B8G8R8A8_UNORM;
+            }
+
+            if (ISBITMASK(0x00ff0000,0x0000ff00,0x000000ff,0x00000000))
+            {
+                return DXGI_FORMAT_B8G8R8X8_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x000000ff,0x0000ff00,0x00ff0000,0x00000000) aka D3DFMT_X8B8G8R8
+
+            // Note that many common DDS reader/writers (including D3DX) swap the
+            // the RED/BLUE masks for 10:10:10:2 formats. We assume
+            // below that the 'backwards' header mask is being used since it is most
+            // likely written by D3DX. The more robust solution is to use the 'DX10'
+            // header extension and specify the DXGI_FORMAT_R10G10B10A2_UNORM format directly
+
+            // For 'correct' writers, this should be 0x000003ff,0x000ffc00,0x3ff00000 for RGB data
+            if (ISBITMASK(0x3ff00000,0x000ffc00,0x000003ff,0xc0000000))
+            {
+                return DXGI_FORMAT_R10G10B10A2_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x000003ff,0x000ffc00,0x3ff00000,0xc0000000) aka D3DFMT_A2R10G10B10
+
+            if (ISBITMASK(0x0000ffff,0xffff0000,0x00000000,0x00000000))
+            {
+                return DXGI_FORMAT_R16G16_UNORM;
+            }
+
+            if (ISBITMASK(0xffffffff,0x00000000,0x00000000,0x00000000))
+            {
+                // Only 32-bit color channel format in D3D9 was R32F
+                return DXGI_FORMAT_R32_FLOAT; // D3DX writes this out as a FourCC of 114
+            }
+            break;
+
+        case 24:
+            // No 24bpp DXGI formats aka D3DFMT_R8G8B8
+            break;
+
+        case 16:
+            if (ISBITMASK(0x7c00,0x03e0,0x001f,0x8000))
+            {
+                return DXGI_FORMAT_B5G5R5A1_UNORM;
+            }
+            if (ISBITMASK(0xf800,0x07e0,0x001f,0x0000))
+            {
+                return DXGI_FORMAT_B5G6R5_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x7c00,0x03e0,0x001f,0x0000) aka D3DFMT_X1R5G5B5
+
+            if (ISBITMASK(0x0f00,0x00f0,0x000f,0xf000))
+            {
+                return DXGI_FORMAT_B4G4R4A4_UNORM;
+            }
+
+            // No DXGI format maps to ISBITMASK(0x0f00,0x00f0,0x000f,0x0000) aka D3DFMT_X4R4G4B4
+
+            // No 3:3:2, 3:3:2:8, or paletted DXGI formats aka D3DFMT_A8R3G3B2, D3DFMT_R3G3B2, D3DFMT_P8, D3DFMT_A8P8, etc.
+            break;
+        }
+    }
+    else if (ddpf.flags & DDS_LUMINANCE)
+    {
+        if (8 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x000000ff,0x00000000,0x00000000,0x00000000))
+            {
+                return DXGI_FORMAT_R8_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+
+            // No DXGI format maps to ISBITMASK(0x0f,0x00,0x00,0xf0) aka D3DFMT_A4L4
+        }
+
+        if (16 == ddpf.RGBBitCount)
+        {
+            if (ISBITMASK(0x0000ffff,0x00000000,0x00000000,0x00000000))
+            {
+                return DXGI_FORMAT_R16_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+            if (ISBITMASK(0x000000ff,0x00000000,0x00000000,0x0000ff00))
+            {
+                return DXGI_FORMAT_R8G8_UNORM; // D3DX10/11 writes this out as DX10 extension
+            }
+        }
+    }
+    else if (ddpf.flags & DDS_ALPHA)
+    {
+        if (8 == ddpf.RGBBitCount)
+        {
+            return DXGI_FORMAT_A8_UNORM;
+        }
+    }
+    else if (ddpf.flags & DDS_FOURCC)
+    {
+        if (MAKEFOURCC( 'D', 'X', 'T', '1' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC1_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '3' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC2_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '5' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC3_UNORM;
+        }
+
+        // While pre-multiplied alpha isn't directly supported by the DXGI formats,
+        // they are basically the same as these BC formats so they can be mapped
+        if (MAKEFOURCC( 'D', 'X', 'T', '2' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC2_UNORM;
+        }
+        if (MAKEFOURCC( 'D', 'X', 'T', '4' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC3_UNORM;
+        }
+
+        if (MAKEFOURCC( 'A', 'T', 'I', '1' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '4', 'U' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '4', 'S' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC4_SNORM;
+        }
+
+        if (MAKEFOURCC( 'A', 'T', 'I', '2' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '5', 'U' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_UNORM;
+        }
+        if (MAKEFOURCC( 'B', 'C', '5', 'S' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_BC5_SNORM;
+        }
+
+        // BC6H and BC7 are written using the "DX10" extended header
+
+        if (MAKEFOURCC( 'R', 'G', 'B', 'G' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_R8G8_B8G8_UNORM;
+        }
+        if (MAKEFOURCC( 'G', 'R', 'G', 'B' ) == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_G8R8_G8B8_UNORM;
+        }
+
+        if (MAKEFOURCC('Y','U','Y','2') == ddpf.fourCC)
+        {
+            return DXGI_FORMAT_YUY2;
+        }
+
+        // Check for D3DFORMAT enums being set here
+        switch( ddpf.fourCC )
+        {
+        case 36: // D3DFMT_A16B16G16R16
+            return DXGI_FORMAT_R16G16B16A16_UNORM;
+
+        case 110: // D3DFMT_Q16W16V16U16
+            return DXGI_FORMAT_R16G16B16A16_SNORM;
+
+        case 111: // D3DFMT_R16F
+            return DXGI_FORMAT_R16_FLOAT;
+
+        case 112: // D3DFMT_G16R16F
+            return DXGI_FORMAT_R16G16_FLOAT;
+
+        case 113: // D3DFMT_A16B16G16R16F
+            return DXGI_FORMAT_R16G16B16A16_FLOAT;
+
+        case 114: // D3DFMT_R32F
+            return DXGI_FORMAT_R32_FLOAT;
+
+        case 115: // D3DFMT_G32R32F
+            return DXGI_FORMAT_R32G32_FLOAT;
+
+        case 116: // D3DFMT_A32B32G32R32F
+            return DXGI_FORMAT_R32G32B32A32_FLOAT;
+        }
+    }
+
+    return DXGI_FORMAT_UNKNOWN;
+}
+
+
+//--------------------------------------------------------------------------------------
+DXGI_FORMAT DDSParser::MakeSRGB( DXGI_FORMAT format )
+{
+    switch( format )
+    {
+    case DXGI_FORMAT_R8G8B8A8_UNORM:
+        return DXGI_FORMAT_R8G8B8A8_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC1_UNORM:
+        return DXGI_FORMAT_BC1_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC2_UNORM:
+        return DXGI_FORMAT_BC2_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC3_UNORM:
+        return DXGI_FORMAT_BC3_UNORM_SRGB;
+
+    case DXGI_FORMAT_B8G8R8A8_UNORM:
+        return DXGI_FORMAT_B8G8R8A8_UNORM_SRGB;
+
+    case DXGI_FORMAT_B8G8R8X8_UNORM:
+        return DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+
+    case DXGI_FORMAT_BC7_UNORM:
+        return DXGI_FORMAT_BC7_UNORM_SRGB;
+
+    default:
+        return format;
+    }
+}
+
+
@@ -0,0 +1,215 @@
+//***************************************************************************************
+// DDSParser.h
+//
+// Device-independent half of DDSTextureLoader: DDS header validation, format
+// detection and the layout of every mip level and array slice in the file.  Nothing
+// here needs Direct3D or Windows, so asset tools can validate and index DDS files on
+// any platform, and the parser can be measured on its own.  DDSTextureLoader uses it
+// for everything up to creating the resource.
+//
+// The structure definitions follow DDS.h in the 'Texconv' sample and the 'DirectXTex'
+// library.
+//***************************************************************************************
+
+#pragma once
+
+#include "DxgiFormat.h"
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <vector>
+
+#ifndef MAKEFOURCC
+    #define MAKEFOURCC(ch0, ch1, ch2, ch3)                              \
+                ((uint32_t)(uint8_t)(ch0) | ((uint32_t)(uint8_t)(ch1) << 8) |       \
+                ((uint32_t)(uint8_t)(ch2) << 16) | ((uint32_t)(uint8_t)(ch3) << 24 ))
+#endif /* defined(MAKEFOURCC) */
+
+//--------------------------------------------------------------------------------------
+// DDS file structure definitions
+//--------------------------------------------------------------------------------------
+#pragma pack(push,1)
+
+const uint32_t DDS_MAGIC = 0x20534444; // "DDS "
+
+struct DDS_PIXELFORMAT
+{
+    uint32_t    size;
+    uint32_t    flags;
+    uint32_t    fourCC;
+    uint32_t    RGBBitCount;
+    uint32_t    RBitMask;
+    uint32_t    GBitMask;
+    uint32_t    BBitMask;
+    uint32_t    ABitMask;
+};
+
+#define DDS_FOURCC      0x00000004  // DDPF_FOURCC
+#define DDS_RGB         0x00000040  // DDPF_RGB
+#define DDS_LUMINANCE   0x00020000  // DDPF_LUMINANCE
+#define DDS_ALPHA       0x00000002  // DDPF_ALPHA
+
+#define DDS_HEADER_FLAGS_VOLUME         0x00800000  // DDSD_DEPTH
+
+#define DDS_HEIGHT 0x00000002 // DDSD_HEIGHT
+#define DDS_WIDTH  0x00000004 // DDSD_WIDTH
+
+#define DDS_CUBEMAP_POSITIVEX 0x00000600 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEX
+#define DDS_CUBEMAP_NEGATIVEX 0x00000a00 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEX
+#define DDS_CUBEMAP_POSITIVEY 0x00001200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEY
+#define DDS_CUBEMAP_NEGATIVEY 0x00002200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEY
+#define DDS_CUBEMAP_POSITIVEZ 0x00004200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_POSITIVEZ
+#define DDS_CUBEMAP_NEGATIVEZ 0x00008200 // DDSCAPS2_CUBEMAP | DDSCAPS2_CUBEMAP_NEGATIVEZ
+
+#define DDS_CUBEMAP_ALLFACES ( DDS_CUBEMAP_POSITIVEX | DDS_CUBEMAP_NEGATIVEX |\
+                               DDS_CUBEMAP_POSITIVEY | DDS_CUBEMAP_NEGATIVEY |\
+                               DDS_CUBEMAP_POSITIVEZ | DDS_CUBEMAP_NEGATIVEZ )
+
+#define DDS_CUBEMAP 0x00000200 // DDSCAPS2_CUBEMAP
+
+enum DDS_MISC_FLAGS2
+{
+    DDS_MISC_FLAGS2_ALPHA_MODE_MASK = 0x7L,
+};
+
+struct DDS_HEADER
+{
+    uint32_t        size;
+    uint32_t        flags;
+    uint32_t        height;
+    uint32_t        width;
+    uint32_t        pitchOrLinearSize;
+    uint32_t        depth; // only if DDS_HEADER_FLAGS_VOLUME is set in flags
+    uint32_t        mipMapCount;
+    uint32_t        reserved1[11];
+    DDS_PIXELFORMAT ddspf;
+    uint32_t        caps;
+    uint32_t        caps2;
+    uint32_t        caps3;
+    uint32_t        caps4;
+    uint32_t        reserved2;
+};
+
+struct DDS_HEADER_DXT10
+{
+    DXGI_FORMAT     dxgiFormat;
+    uint32_t        resourceDimension;
+    uint32_t        miscFlag; // see D3D11_RESOURCE_MISC_FLAG
+    uint32_t        arraySize;
+    uint32_t        miscFlags2;
+};
+
+#pragma pack(pop)
+
+class DDSParser
+{
+public:
+
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    enum class Result
+    {
+        Ok,
+        InvalidData,    // not a DDS file, or inconsistent header
+        NotSupported,   // valid, but not a format or size Direct3D 12 can create
+        Truncated       // the file ends before the last subresource
+    };
+
+    // Same values as D3D12_RESOURCE_DIMENSION (and D3D11_RESOURCE_DIMENSION).
+    enum class TextureDimension : uint32
+    {
+        Unknown = 0,
+        Texture1D = 2,
+        Texture2D = 3,
+        Texture3D = 4
+    };
+
+	///<summary>
+	/// What the header describes.  ArraySize counts cube faces (6 per cube).  AlphaMode
+	/// is a DirectX::DDS_ALPHA_MODE value.
+	///</summary>
+    struct TextureDesc
+    {
+        TextureDimension Dimension = TextureDimension::Unknown;
+        DXGI_FORMAT Format = DXGI_FORMAT_UNKNOWN;
+        uint32 Width = 0;
+        uint32 Height = 0;
+        uint32 Depth = 0;
+        uint32 ArraySize = 0;
+        uint32 MipCount = 0;
+        bool IsCubeMap = false;
+        uint32 AlphaMode = 0;
+    };
+
+	///<summary>
+	/// One mip level of one array slice.  Offset is from the start of the file;
+	/// SlicePitch is the size of one depth slice, so the subresource is
+	/// SlicePitch*Depth bytes.
+	///</summary>
+    struct Subresource
+    {
+        uint64 Offset = 0;
+        uint64 RowPitch = 0;
+        uint64 SlicePitch = 0;
+        uint32 NumRows = 0;
+        uint32 Width = 0;
+        uint32 Height = 0;
+        uint32 Depth = 0;
+    };
+
+	///<summary>
+	/// Subresources are in Direct3D order, mip + arraySlice*MipCount, which is also the
+	/// order they are stored in the file.  DataSize is the byte count they cover.
+	///</summary>
+    struct Layout
+    {
+        TextureDesc Desc;
+        uint64 DataOffset = 0;
+        uint64 DataSize = 0;
+        std::vector<Subresource> Subresources;
+    };
+
+	///<summary>
+	/// Checks the magic number and header sizes of a whole file in memory, and finds
+	/// where the pixel data starts.
+	///</summary>
+    static Result ReadHeader(const std::uint8_t* data, uint64 size, const DDS_HEADER** header, uint64* dataOffset);
+
+	///<summary>
+	/// Validates a header (followed by its DX10 extension, if it has one) against the
+	/// Direct3D 12 limits and fills desc.
+	///</summary>
+    static Result ParseHeader(const DDS_HEADER* header, TextureDesc& desc);
+
+	///<summary>
+	/// ReadHeader + ParseHeader + the position of every subresource, checked against
+	/// the file size.
+	///</summary>
+    static Result Parse(const std::uint8_t* data, uint64 size, Layout& layout);
+    static Result ParseFile(const std::filesystem::path& filename, Layout& layout);
+
+	///<summary>
+	/// The subresource part of Parse, for callers that only read the header: lays out
+	/// desc's subresources from dataOffset and checks them against fileSize.
+	///</summary>
+    static Result ComputeLayout(const TextureDesc& desc, uint64 dataOffset, uint64 fileSize, Layout& layout);
+
+    // Magic number, DDS_HEADER and DDS_HEADER_DXT10.
+    static constexpr uint64 DX10HeaderSize = sizeof(uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10);
+
+	///<summary>
+	/// For tools that write DDS files: the magic number, a header and a DX10 extension
+	/// describing desc, into the DX10HeaderSize bytes at dest.  The subresources follow
+	/// in Layout order.
+	///</summary>
+    static void WriteHeader(const TextureDesc& desc, std::uint8_t* dest);
+
+    static size_t BitsPerPixel(DXGI_FORMAT fmt);
+    static void GetSurfaceInfo(size_t width, size_t height, DXGI_FORMAT fmt,
+                               size_t* outNumBytes, size_t* outRowBytes, size_t* outNumRows);
+    static DXGI_FORMAT GetDXGIFormat(const DDS_PIXELFORMAT& ddpf);
+    static DXGI_FORMAT MakeSRGB(DXGI_FORMAT format);
+    static uint32 GetAlphaMode(const DDS_HEADER* header);
+    static bool IsCompressed(DXGI_FORMAT fmt);
+};
@@ -0,0 +1,356 @@
+//***************************************************************************************
+// DDSStreamer.cpp
+//***************************************************************************************
+
+#include "DDSStreamer.h"
+#include <algorithm>
+#include <cstring>
+
+#if defined(_WIN32)
+#include "d3dUtil.h"
+#endif
+
+namespace
+{
+    const char* GetResultString(DDSParser::Result result)
+    {
+        switch(result)
+        {
+        case DDSParser::Result::InvalidData:  return "not a valid DDS file";
+        case DDSParser::Result::NotSupported: return "DDS format or size not supported";
+        case DDSParser::Result::Truncated:    return "DDS file is truncated";
+        default:                              return "";
+        }
+    }
+
+    bool Fail(std::string* error, const std::string& message)
+    {
+        if(error)
+            *error = message;
+        return false;
+    }
+}
+
+bool DDSStreamer::Open(const std::filesystem::path& filename, uint32 maxsize, std::string* error)
+{
+    mLayout = DDSParser::Layout();
+    mFirstMip = 0;
+    mResidentMip = 0;
+
+    if(!mFile.Open(filename))
+        return Fail(error, "cannot open " + filename.string());
+
+    // Magic, header and DX10 extension; ReadHeader checks how much of it is really there.
+    std::uint8_t header[sizeof(std::uint32_t) + sizeof(DDS_HEADER) + sizeof(DDS_HEADER_DXT10)];
+    uint64 headerSize = std::min<uint64>(sizeof(header), mFile.GetSize());
+    if(!mFile.Read(0, header, headerSize))
+        return Fail(error, "cannot read " + filename.string());
+
+    const DDS_HEADER* ddsHeader = nullptr;
+    uint64 dataOffset = 0;
+    DDSParser::TextureDesc desc;
+    DDSParser::Result result = DDSParser::ReadHeader(header, headerSize, &ddsHeader, &dataOffset);
+    if(result == DDSParser::Result::Ok)
+        result = DDSParser::ParseHeader(ddsHeader, desc);
+    if(result == DDSParser::Result::Ok)
+        result = DDSParser::ComputeLayout(desc, dataOffset, mFile.GetSize(), mLayout);
+    if(result != DDSParser::Result::Ok)
+    {
+        mFile.Close();
+        return Fail(error, filename.string() + ": " + GetResultString(result));
+    }
+
+    // Same rule as FillInitData12, except that the smallest mip is kept even if it is
+    // still above maxsize.
+    if(maxsize > 0)
+    {
+        while(mFirstMip + 1 < desc.MipCount)
+        {
+            const DDSParser::Subresource& top = mLayout.Subresources[mFirstMip];
+            if(top.Width <= maxsize && top.Height <= maxsize && top.Depth <= maxsize)
+                break;
+            ++mFirstMip;
+        }
+    }
+
+    mResidentMip = desc.MipCount;
+
+    return true;
+}
+
+DDSStreamer::uint64 DDSStreamer::GetMipRangeSize(uint32 firstMip, uint32 lastMip) const
+{
+    const DDSParser::TextureDesc& desc = mLayout.Desc;
+    if(firstMip >= lastMip || lastMip > desc.MipCount)
+        return 0;
+
+    uint64 size = 0;
+    for(uint32 slice = 0; slice < desc.ArraySize; ++slice)
+    {
+        const DDSParser::Subresource& first = mLayout.Subresources[slice*desc.MipCount + firstMip];
+        const DDSParser::Subresource& last = mLayout.Subresources[slice*desc.MipCount + lastMip - 1];
+        size += last.Offset + last.SlicePitch*last.Depth - first.Offset;
+    }
+
+    return size;
+}
+
+bool DDSStreamer::ReadMips(uint32 firstMip, uint32 lastMip, MipData& mips) const
+{
+    const DDSParser::TextureDesc& desc = mLayout.Desc;
+    if(!mFile.IsOpen() || firstMip >= lastMip || lastMip > desc.MipCount)
+        return false;
+
+    uint32 levelCount = lastMip - firstMip;
+
+    mips.FirstMip = firstMip;
+    mips.LastMip = lastMip;
+    mips.Data.resize((size_t)GetMipRangeSize(firstMip, lastMip));
+    mips.Subresources.resize((size_t)levelCount*desc.ArraySize);
+
+    // The levels of one slice are contiguous in the file: one read per slice.
+    uint64 dataOffset = 0;
+    for(uint32 slice = 0; slice < desc.ArraySize; ++slice)
+    {
+        const DDSParser::Subresource* source = &mLayout.Subresources[slice*desc.MipCount + firstMip];
+        const DDSParser::Subresource& last = source[levelCount - 1];
+        uint64 begin = source->Offset;
+        uint64 size = last.Offset + last.SlicePitch*last.Depth - begin;
+
+        if(!mFile.Read(begin, mips.Data.data() + dataOffset, size))
+            return false;
+
+        for(uint32 level = 0; level < levelCount; ++level)
+        {
+            DDSParser::Subresource& subresource = mips.Subresources[slice*levelCount + level];
+            subresource = source[level];
+            subresource.Offset = dataOffset + (source[level].Offset - begin);
+        }
+
+        dataOffset += size;
+    }
+
+    return true;
+}
+
+bool DDSStreamer::ReadNextMips(MipData& mips, uint64 byteBudget)
+{
+    if(IsComplete())
+        return false;
+
+    uint32 lastMip = mResidentMip;
+    uint32 firstMip = lastMip - 1;
+    while(firstMip > mFirstMip && GetMipRangeSize(firstMip - 1, lastMip) <= byteBudget)
+        --firstMip;
+
+    if(!ReadMips(firstMip, lastMip, mips))
+        return false;
+
+    mResidentMip = firstMip;
+    return true;
+}
+
+#if defined(_WIN32)
+
+void DDSStreamer::CreateTexture(ID3D12Device* device)
+{
+    const DDSParser::TextureDesc& desc = mLayout.Desc;
+    const DDSParser::Subresource& top = mLayout.Subresources[mFirstMip];
+
+    D3D12_RESOURCE_DESC texDesc = {};
+    texDesc.Dimension = static_cast<D3D12_RESOURCE_DIMENSION>(desc.Dimension);
+    texDesc.Width = top.Width;
+    texDesc.Height = top.Height;
+    texDesc.DepthOrArraySize = (UINT16)(desc.Dimension == DDSParser::TextureDimension::Texture3D ? top.Depth : desc.ArraySize);
+    texDesc.MipLevels = (UINT16)GetMipCount();
+    texDesc.Format = desc.Format;
+    texDesc.SampleDesc.Count = 1;
+    texDesc.Layout = D3D12_TEXTURE_LAYOUT_UNKNOWN;
+    texDesc.Flags = D3D12_RESOURCE_FLAG_NONE;
+
+    mDevice = device;
+    mTexture = nullptr;
+    mResidentMip = desc.MipCount;
+
+    ThrowIfFailed(device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+        D3D12_HEAP_FLAG_NONE,
+        &texDesc,
+        D3D12_RESOURCE_STATE_COPY_DEST,
+        nullptr,
+        IID_PPV_ARGS(mTexture.GetAddressOf())));
+}
+
+bool DDSStreamer::UploadNextMips(ID3D12GraphicsCommandList* cmdList, UINT64 fenceValue, uint64 byteBudget)
+{
+    assert(mTexture != nullptr);
+
+    MipData mips;
+    if(!ReadNextMips(mips, byteBudget))
+        return false;
+
+    D3D12_RESOURCE_DESC texDesc = mTexture->GetDesc();
+    uint32 arraySize = mLayout.Desc.ArraySize;
+    uint32 levelCount = mips.LastMip - mips.FirstMip;
+    uint32 count = levelCount*arraySize;
+
+    // Footprints in MipData order: the levels of slice 0, then of slice 1, ...
+    std::vector<D3D12_PLACED_SUBRESOURCE_FOOTPRINT> footprints(count);
+    std::vector<UINT> numRows(count);
+    std::vector<UINT64> rowSizes(count);
+    std::vector<UINT> subresourceIndices(count);
+
+    UINT64 uploadSize = 0;
+    for(uint32 slice = 0; slice < arraySize; ++slice)
+    {
+        UINT firstSubresource = (mips.FirstMip - mFirstMip) + slice*GetMipCount();
+        for(uint32 level = 0; level < levelCount; ++level)
+            subresourceIndices[slice*levelCount + level] = firstSubresource + level;
+
+        UINT64 sliceSize = 0;
+        mDevice->GetCopyableFootprints(&texDesc, firstSubresource, levelCount, uploadSize,
+            &footprints[slice*levelCount], &numRows[slice*levelCount], &rowSizes[slice*levelCount], &sliceSize);
+
+        uploadSize = (uploadSize + sliceSize + D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1) &
+            ~(UINT64)(D3D12_TEXTURE_DATA_PLACEMENT_ALIGNMENT - 1);
+    }
+
+    PendingUpload upload;
+    upload.FenceValue = fenceValue;
+    ThrowIfFailed(mDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(uploadSize),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(upload.Buffer.GetAddressOf())));
+
+    // The file's rows are packed; the footprints' rows are 256-byte aligned.
+    BYTE* mapped = nullptr;
+    CD3DX12_RANGE readRange(0, 0);
+    ThrowIfFailed(upload.Buffer->Map(0, &readRange, reinterpret_cast<void**>(&mapped)));
+    for(uint32 i = 0; i < count; ++i)
+    {
+        const D3D12_PLACED_SUBRESOURCE_FOOTPRINT& footprint = footprints[i];
+        const DDSParser::Subresource& source = mips.Subresources[i];
+        UINT64 destSlicePitch = (UINT64)footprint.Footprint.RowPitch*numRows[i];
+
+        for(uint32 z = 0; z < source.Depth; ++z)
+        {
+            BYTE* dest = mapped + footprint.Offset + z*destSlicePitch;
+            const std::uint8_t* src = mips.Data.data() + source.Offset + z*source.SlicePitch;
+            for(UINT row = 0; row < numRows[i]; ++row)
+                memcpy(dest + (UINT64)row*footprint.Footprint.RowPitch, src + row*source.RowPitch, (size_t)rowSizes[i]);
+        }
+    }
+    upload.Buffer->Unmap(0, nullptr);
+
+    std::vector<D3D12_RESOURCE_BARRIER> barriers(count);
+    for(uint32 i = 0; i < count; ++i)
+    {
+        CD3DX12_TEXTURE_COPY_LOCATION dest(mTexture.Get(), subresourceIndices[i]);
+        CD3DX12_TEXTURE_COPY_LOCATION src(upload.Buffer.Get(), footprints[i]);
+        cmdList->CopyTextureRegion(&dest, 0, 0, 0, &src, nullptr);
+
+        barriers[i] = CD3DX12_RESOURCE_BARRIER::Transition(mTexture.Get(),
+            D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_PIXEL_SHADER_RESOURCE, subresourceIndices[i]);
+    }
+    cmdList->ResourceBarrier(count, barriers.data());
+
+    mPendingUploads.push_back(std::move(upload));
+
+    return true;
+}
+
+D3D12_SHADER_RESOURCE_VIEW_DESC DDSStreamer::GetSrvDesc() const
+{
+    // Only meaningful once the first step is uploaded.
+    assert(mResidentMip < mLayout.Desc.MipCount);
+
+    const DDSParser::TextureDesc& desc = mLayout.Desc;
+    UINT mostDetailedMip = mResidentMip - mFirstMip;
+    UINT mipLevels = GetMipCount() - mostDetailedMip;
+
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = {};
+    srvDesc.Format = desc.Format;
+    srvDesc.Shader4ComponentMapping = D3D12_DEFAULT_SHADER_4_COMPONENT_MAPPING;
+
+    switch(desc.Dimension)
+    {
+    case DDSParser::TextureDimension::Texture1D:
+        if(desc.ArraySize > 1)
+        {
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE1DARRAY;
+            srvDesc.Texture1DArray.MostDetailedMip = mostDetailedMip;
+            srvDesc.Texture1DArray.MipLevels = mipLevels;
+            srvDesc.Texture1DArray.ArraySize = desc.ArraySize;
+        }
+        else
+        {
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE1D;
+            srvDesc.Texture1D.MostDetailedMip = mostDetailedMip;
+            srvDesc.Texture1D.MipLevels = mipLevels;
+        }
+        break;
+
+    case DDSParser::TextureDimension::Texture2D:
+        if(desc.IsCubeMap)
+        {
+            if(desc.ArraySize > 6)
+            {
+                srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBEARRAY;
+                srvDesc.TextureCubeArray.MostDetailedMip = mostDetailedMip;
+                srvDesc.TextureCubeArray.MipLevels = mipLevels;
+                srvDesc.TextureCubeArray.NumCubes = desc.ArraySize / 6;
+            }
+            else
+            {
+                srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURECUBE;
+                srvDesc.TextureCube.MostDetailedMip = mostDetailedMip;
+                srvDesc.TextureCube.MipLevels = mipLevels;
+            }
+        }
+        else if(desc.ArraySize > 1)
+        {
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2DARRAY;
+            srvDesc.Texture2DArray.MostDetailedMip = mostDetailedMip;
+            srvDesc.Texture2DArray.MipLevels = mipLevels;
+            srvDesc.Texture2DArray.ArraySize = desc.ArraySize;
+        }
+        else
+        {
+            srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE2D;
+            srvDesc.Texture2D.MostDetailedMip = mostDetailedMip;
+            srvDesc.Texture2D.MipLevels = mipLevels;
+        }
+        break;
+
+    case DDSParser::TextureDimension::Texture3D:
+        srvDesc.ViewDimension = D3D12_SRV_DIMENSION_TEXTURE3D;
+        srvDesc.Texture3D.MostDetailedMip = mostDetailedMip;
+        srvDesc.Texture3D.MipLevels = mipLevels;
+        break;
+
+    default:
+        break;
+    }
+
+    return srvDesc;
+}
+
+void DDSStreamer::CreateSrv(ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE handle) const
+{
+    D3D12_SHADER_RESOURCE_VIEW_DESC srvDesc = GetSrvDesc();
+    device->CreateShaderResourceView(mTexture.Get(), &srvDesc, handle);
+}
+
+void DDSStreamer::ReleaseCompleted(UINT64 completedFenceValue)
+{
+    auto uploadEnd = std::remove_if(mPendingUploads.begin(), mPendingUploads.end(), [&](const PendingUpload& upload)
+    {
+        return upload.FenceValue <= completedFenceValue;
+    });
+    mPendingUploads.erase(uploadEnd, mPendingUploads.end());
+}
+
+#endif
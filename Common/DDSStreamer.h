@@ -0,0 +1,145 @@
+//***************************************************************************************
+// DDSStreamer.h
+//
+// Progressive DDS loading.  Open reads only the header; after that each step reads the
+// byte ranges of the next mip levels, smallest first, so a texture can be drawn at low
+// resolution a few kilobytes into the file and sharpen as the larger mips arrive.  Mips
+// above maxsize are never read at all (CreateDDSTextureFromFile12 reads them and then
+// drops them).  Within one array slice the mips sit next to each other in the file, so
+// a step costs one positional read per slice however many levels it covers.  Reads go
+// through FileReader, so files over 4GB are fine.
+//
+// Typical use, one step per frame, with one SRV descriptor per frame resource.  The
+// descriptor of mCurrFrameResourceIndex is free to rewrite once Update has waited for
+// that frame resource's fence; the other frames in flight may still be sampling theirs.
+//     DDSStreamer stream;
+//     stream.Open(L"Textures/terrain.dds");
+//     stream.CreateTexture(md3dDevice.Get());
+//     ...
+//     if(!stream.IsComplete())
+//         stream.UploadNextMips(mCommandList.Get(), mCurrentFence + 1);
+//     stream.CreateSrv(md3dDevice.Get(), srvHandles[mCurrFrameResourceIndex]);
+//     stream.ReleaseCompleted(mFence->GetCompletedValue());
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSParser.h"
+#include "FileReader.h"
+#include <string>
+
+#if defined(_WIN32)
+#include <d3d12.h>
+#include <wrl.h>
+#endif
+
+class DDSStreamer
+{
+public:
+
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    // Default for UploadNextMips: every mip of a 256x256 BC7 texture and below in the
+    // first step, then one level per step.
+    static constexpr uint64 DefaultByteBudget = 128 * 1024;
+
+	///<summary>
+	/// Mip levels [FirstMip, LastMip) of every array slice.  Subresources are in
+	/// Direct3D order for that range, (mip - FirstMip) + slice*(LastMip - FirstMip), with
+	/// offsets into Data.
+	///</summary>
+    struct MipData
+    {
+        uint32 FirstMip = 0;
+        uint32 LastMip = 0;
+        std::vector<std::uint8_t> Data;
+        std::vector<DDSParser::Subresource> Subresources;
+    };
+
+	///<summary>
+	/// Reads and validates the header.  Mips with a dimension above maxsize (0 for no
+	/// limit) are skipped; the smallest mip is always kept.
+	///</summary>
+    bool Open(const std::filesystem::path& filename, uint32 maxsize = 0, std::string* error = nullptr);
+
+    const DDSParser::Layout& GetLayout() const { return mLayout; }
+    const DDSParser::TextureDesc& GetDesc() const { return mLayout.Desc; }
+
+	///<summary>
+	/// The texture's mips are the file's mips from GetFirstMip() on.
+	///</summary>
+    uint32 GetFirstMip() const { return mFirstMip; }
+    uint32 GetMipCount() const { return mLayout.Desc.MipCount - mFirstMip; }
+
+	///<summary>
+	/// The largest file mip read so far, GetDesc().MipCount before the first step.
+	///</summary>
+    uint32 GetResidentMip() const { return mResidentMip; }
+    bool IsComplete() const { return mResidentMip == mFirstMip; }
+
+	///<summary>
+	/// Bytes of file mips [firstMip, lastMip) over every slice.
+	///</summary>
+    uint64 GetMipRangeSize(uint32 firstMip, uint32 lastMip) const;
+
+	///<summary>
+	/// Reads file mips [firstMip, lastMip) into mips.  Does not change the resident mip,
+	/// and may be called from any thread.
+	///</summary>
+    bool ReadMips(uint32 firstMip, uint32 lastMip, MipData& mips) const;
+
+	///<summary>
+	/// Reads the next levels toward GetFirstMip(): the next one, and more while the
+	/// total stays within byteBudget.  Returns false when complete or on a read error.
+	///</summary>
+    bool ReadNextMips(MipData& mips, uint64 byteBudget = DefaultByteBudget);
+
+#if defined(_WIN32)
+	///<summary>
+	/// Creates the GPU texture with GetMipCount() levels, every subresource in
+	/// COPY_DEST.  Nothing is read from the file.
+	///</summary>
+    void CreateTexture(ID3D12Device* device);
+
+    ID3D12Resource* GetResource() const { return mTexture.Get(); }
+
+	///<summary>
+	/// ReadNextMips, then records the copy of those levels into the texture on cmdList
+	/// and moves them to PIXEL_SHADER_RESOURCE.  The upload buffer is kept until
+	/// ReleaseCompleted sees fenceValue.
+	///</summary>
+    bool UploadNextMips(ID3D12GraphicsCommandList* cmdList, UINT64 fenceValue, uint64 byteBudget = DefaultByteBudget);
+
+	///<summary>
+	/// SRV over the resident mips only (MostDetailedMip is the resident level), so
+	/// nothing still in COPY_DEST is ever sampled.  It is valid for work submitted
+	/// after the last step's command list.  Never rewrite a descriptor the GPU may
+	/// still read: write the current frame resource's own descriptor every frame, so
+	/// each one catches up with the resident mip the next time its frame comes round.
+	///</summary>
+    D3D12_SHADER_RESOURCE_VIEW_DESC GetSrvDesc() const;
+    void CreateSrv(ID3D12Device* device, D3D12_CPU_DESCRIPTOR_HANDLE handle) const;
+
+    void ReleaseCompleted(UINT64 completedFenceValue);
+#endif
+
+private:
+    FileReader mFile;
+    DDSParser::Layout mLayout;
+
+    uint32 mFirstMip = 0;
+    uint32 mResidentMip = 0;
+
+#if defined(_WIN32)
+    struct PendingUpload
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> Buffer;
+        UINT64 FenceValue = 0;
+    };
+
+    ID3D12Device* mDevice = nullptr;
+    Microsoft::WRL::ComPtr<ID3D12Resource> mTexture;
+    std::vector<PendingUpload> mPendingUploads;
+#endif
+};
@@ -55,6 +55,16 @@ namespace DirectX
         DDS_ALPHA_MODE_CUSTOM        = 4,
     };
 
+    // Options of the Direct3D 12 loaders.  DDS_LOADER_MIP_AUTOGEN builds a box-filtered
+    // mip chain on the CPU before upload for a 2D texture that is stored without mips,
+    // in a format MipGenerator supports.  Files from the bake step already carry their
+    // chain, so it is off by default.
+    enum DDS_LOADER_FLAGS
+    {
+        DDS_LOADER_DEFAULT      = 0,
+        DDS_LOADER_MIP_AUTOGEN  = 0x1,
+    };
+
     // Standard version
     HRESULT CreateDDSTextureFromMemory( _In_ ID3D11Device* d3dDevice,
                                         _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
@@ -65,6 +75,7 @@ namespace DirectX
                                         _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
                                       );
 
+	// Direct3D 12 versions.  loadFlags is a combination of DDS_LOADER_FLAGS.
 	HRESULT CreateDDSTextureFromMemory12(_In_ ID3D12Device* device,
 		                                 _In_ ID3D12GraphicsCommandList* cmdList,
 		                                 _In_reads_bytes_(ddsDataSize) const uint8_t* ddsData,
@@ -72,7 +83,8 @@ namespace DirectX
 		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
 		                                 _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
 		                                 _In_ size_t maxsize = 0,
-		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                                 _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                                 _In_ unsigned int loadFlags = DDS_LOADER_DEFAULT
 		                                 );
 
     HRESULT CreateDDSTextureFromFile( _In_ ID3D11Device* d3dDevice,
@@ -89,7 +101,8 @@ namespace DirectX
 		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& texture,
 		                               _Out_ Microsoft::WRL::ComPtr<ID3D12Resource>& textureUploadHeap,
 		                               _In_ size_t maxsize = 0,
-		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr
+		                               _Out_opt_ DDS_ALPHA_MODE* alphaMode = nullptr,
+		                               _In_ unsigned int loadFlags = DDS_LOADER_DEFAULT
 		                               );
 
     // Standard version with optional auto-gen mipmap support
@@ -10,6 +10,9 @@
 using namespace std;
 
 // Windows
+#ifndef NOMINMAX
+#define NOMINMAX    // keep std::min/std::max usable
+#endif
 #include <windows.h>
 #include <cstdint>
 #include <fstream>
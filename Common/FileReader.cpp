@@ -0,0 +1,168 @@
+//***************************************************************************************
+// FileReader.cpp
+//***************************************************************************************
+
+#include "FileReader.h"
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+    // ReadFile takes a DWORD and pread may return short above 2GB; larger reads are split.
+    const std::uint64_t MaxReadSize = 1ull << 30;
+}
+
+FileReader::~FileReader()
+{
+    Close();
+}
+
+FileReader::FileReader(FileReader&& rhs) noexcept
+{
+    *this = std::move(rhs);
+}
+
+FileReader& FileReader::operator=(FileReader&& rhs) noexcept
+{
+    if(this != &rhs)
+    {
+        Close();
+
+        mSize = std::exchange(rhs.mSize, 0);
+        mOpen = std::exchange(rhs.mOpen, false);
+#if defined(_WIN32)
+        mFile = std::exchange(rhs.mFile, nullptr);
+#else
+        mFile = std::exchange(rhs.mFile, -1);
+#endif
+    }
+
+    return *this;
+}
+
+#if defined(_WIN32)
+
+bool FileReader::Open(const std::filesystem::path& path)
+{
+    Close();
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    mFile = file;
+    mSize = (std::uint64_t)size.QuadPart;
+    mOpen = true;
+    return true;
+}
+
+void FileReader::Close()
+{
+    if(mFile != nullptr)
+        CloseHandle(mFile);
+
+    mFile = nullptr;
+    mSize = 0;
+    mOpen = false;
+}
+
+bool FileReader::Read(std::uint64_t offset, void* dest, std::uint64_t size) const
+{
+    if(!mOpen || offset > mSize || size > mSize - offset)
+        return false;
+
+    auto out = static_cast<std::uint8_t*>(dest);
+    while(size > 0)
+    {
+        DWORD chunk = (DWORD)(size < MaxReadSize ? size : MaxReadSize);
+
+        // With a synchronous handle the offset in OVERLAPPED is where the read starts.
+        OVERLAPPED overlapped = {};
+        overlapped.Offset = (DWORD)offset;
+        overlapped.OffsetHigh = (DWORD)(offset >> 32);
+
+        DWORD bytesRead = 0;
+        if(!ReadFile(mFile, out, chunk, &bytesRead, &overlapped) || bytesRead == 0)
+            return false;
+
+        out += bytesRead;
+        offset += bytesRead;
+        size -= bytesRead;
+    }
+
+    return true;
+}
+
+#else
+
+bool FileReader::Open(const std::filesystem::path& path)
+{
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    mFile = fd;
+    mSize = (std::uint64_t)info.st_size;
+    mOpen = true;
+    return true;
+}
+
+void FileReader::Close()
+{
+    if(mFile >= 0)
+        close(mFile);
+
+    mFile = -1;
+    mSize = 0;
+    mOpen = false;
+}
+
+bool FileReader::Read(std::uint64_t offset, void* dest, std::uint64_t size) const
+{
+    if(!mOpen || offset > mSize || size > mSize - offset)
+        return false;
+
+    auto out = static_cast<std::uint8_t*>(dest);
+    while(size > 0)
+    {
+        size_t chunk = (size_t)(size < MaxReadSize ? size : MaxReadSize);
+        ssize_t bytesRead = pread(mFile, out, chunk, (off_t)offset);
+        if(bytesRead < 0 && errno == EINTR)
+            continue;
+        if(bytesRead <= 0)
+            return false;
+
+        out += bytesRead;
+        offset += (std::uint64_t)bytesRead;
+        size -= (std::uint64_t)bytesRead;
+    }
+
+    return true;
+}
+
+#endif
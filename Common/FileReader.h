@@ -0,0 +1,53 @@
+//***************************************************************************************
+// FileReader.h
+//
+// Positional reads from a file opened for reading (ReadFile with an OVERLAPPED offset on
+// Windows, pread elsewhere).  Use it instead of MappedFile when only a few ranges of a
+// large file are needed, or when they are read in an order the OS would not prefetch.
+// Offsets and sizes are 64-bit, so files over 4GB read like any other, and Read does
+// not move a shared file pointer, so several threads can read through one reader.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+class FileReader
+{
+public:
+
+    FileReader() = default;
+    ~FileReader();
+
+    FileReader(const FileReader& rhs) = delete;
+    FileReader& operator=(const FileReader& rhs) = delete;
+    FileReader(FileReader&& rhs) noexcept;
+    FileReader& operator=(FileReader&& rhs) noexcept;
+
+	///<summary>
+	/// Opens the file, closing any file opened before.  Returns false if it cannot be
+	/// opened.
+	///</summary>
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    bool IsOpen() const { return mOpen; }
+    std::uint64_t GetSize() const { return mSize; }
+
+	///<summary>
+	/// Reads size bytes at offset into dest.  Returns false on an I/O error or if the
+	/// range does not lie inside the file.
+	///</summary>
+    bool Read(std::uint64_t offset, void* dest, std::uint64_t size) const;
+
+private:
+    std::uint64_t mSize = 0;
+    bool mOpen = false;
+
+#if defined(_WIN32)
+    void* mFile = nullptr;
+#else
+    int mFile = -1;
+#endif
+};
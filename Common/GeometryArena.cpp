@@ -0,0 +1,185 @@
+//***************************************************************************************
+// GeometryArena.cpp
+//***************************************************************************************
+
+#include "GeometryArena.h"
+
+#if defined(_WIN32)
+
+#include "d3dUtil.h"
+#include <cstring>
+#include <stdexcept>
+
+GeometryArena::GeometryArena(ID3D12Device* device, uint32 vertexCapacity, uint32 vertexByteStride,
+                             uint32 indexCapacity, DXGI_FORMAT indexFormat) :
+    mDevice(device),
+    mVertexByteStride(vertexByteStride),
+    mIndexFormat(indexFormat),
+    mIndexByteSize(indexFormat == DXGI_FORMAT_R16_UINT ? 2 : 4),
+    mVertexAllocator(vertexCapacity),
+    mIndexAllocator(indexCapacity)
+{
+    ThrowIfFailed(device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer((UINT64)vertexCapacity*vertexByteStride),
+        mBufferState,
+        nullptr,
+        IID_PPV_ARGS(mVertexBuffer.GetAddressOf())));
+
+    ThrowIfFailed(device->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_DEFAULT),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer((UINT64)indexCapacity*mIndexByteSize),
+        mBufferState,
+        nullptr,
+        IID_PPV_ARGS(mIndexBuffer.GetAddressOf())));
+}
+
+GeometryArena::Mesh GeometryArena::Add(ID3D12GraphicsCommandList* cmdList, const void* vertices, uint32 vertexCount,
+                                       const void* indices, uint32 indexCount, UINT64 fenceValue)
+{
+    Mesh mesh;
+    mesh.Vertices = mVertexAllocator.Allocate(vertexCount);
+    mesh.Indices = mIndexAllocator.Allocate(indexCount);
+    if(!mesh.IsValid())
+    {
+        mVertexAllocator.Free(mesh.Vertices);
+        mIndexAllocator.Free(mesh.Indices);
+        return Mesh();
+    }
+
+    UINT64 vbByteSize = (UINT64)vertexCount*mVertexByteStride;
+    UINT64 ibByteSize = (UINT64)indexCount*mIndexByteSize;
+
+    // One upload buffer holds both, the indices right after the vertices.
+    PendingUpload upload;
+    upload.FenceValue = fenceValue;
+    ThrowIfFailed(mDevice->CreateCommittedResource(
+        &CD3DX12_HEAP_PROPERTIES(D3D12_HEAP_TYPE_UPLOAD),
+        D3D12_HEAP_FLAG_NONE,
+        &CD3DX12_RESOURCE_DESC::Buffer(vbByteSize + ibByteSize),
+        D3D12_RESOURCE_STATE_GENERIC_READ,
+        nullptr,
+        IID_PPV_ARGS(upload.Buffer.GetAddressOf())));
+
+    BYTE* mapped = nullptr;
+    CD3DX12_RANGE readRange(0, 0);
+    ThrowIfFailed(upload.Buffer->Map(0, &readRange, reinterpret_cast<void**>(&mapped)));
+    memcpy(mapped, vertices, (size_t)vbByteSize);
+    memcpy(mapped + vbByteSize, indices, (size_t)ibByteSize);
+    upload.Buffer->Unmap(0, nullptr);
+
+    if(mBufferState != D3D12_RESOURCE_STATE_COPY_DEST)
+    {
+        D3D12_RESOURCE_BARRIER barriers[2] =
+        {
+            CD3DX12_RESOURCE_BARRIER::Transition(mVertexBuffer.Get(), mBufferState, D3D12_RESOURCE_STATE_COPY_DEST),
+            CD3DX12_RESOURCE_BARRIER::Transition(mIndexBuffer.Get(), mBufferState, D3D12_RESOURCE_STATE_COPY_DEST)
+        };
+        cmdList->ResourceBarrier(2, barriers);
+    }
+
+    cmdList->CopyBufferRegion(mVertexBuffer.Get(), (UINT64)mesh.Vertices.Offset*mVertexByteStride,
+        upload.Buffer.Get(), 0, vbByteSize);
+    cmdList->CopyBufferRegion(mIndexBuffer.Get(), (UINT64)mesh.Indices.Offset*mIndexByteSize,
+        upload.Buffer.Get(), vbByteSize, ibByteSize);
+
+    D3D12_RESOURCE_BARRIER barriers[2] =
+    {
+        CD3DX12_RESOURCE_BARRIER::Transition(mVertexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ),
+        CD3DX12_RESOURCE_BARRIER::Transition(mIndexBuffer.Get(), D3D12_RESOURCE_STATE_COPY_DEST, D3D12_RESOURCE_STATE_GENERIC_READ)
+    };
+    cmdList->ResourceBarrier(2, barriers);
+    mBufferState = D3D12_RESOURCE_STATE_GENERIC_READ;
+
+    mPendingUploads.push_back(std::move(upload));
+
+    return mesh;
+}
+
+GeometryArena::Mesh GeometryArena::Add(ID3D12GraphicsCommandList* cmdList, const GeometryGenerator::MeshData& meshData,
+                                       UINT64 fenceValue)
+{
+    assert(mVertexByteStride == sizeof(GeometryGenerator::Vertex));
+
+    uint32 vertexCount = (uint32)meshData.Vertices.size();
+    uint32 indexCount = (uint32)meshData.Indices32.size();
+
+    if(mIndexFormat != DXGI_FORMAT_R16_UINT)
+        return Add(cmdList, meshData.Vertices.data(), vertexCount, meshData.Indices32.data(), indexCount, fenceValue);
+
+    std::vector<std::uint16_t> indices16(indexCount);
+    for(uint32 i = 0; i < indexCount; ++i)
+    {
+        if(meshData.Indices32[i] > 0xffff)
+            throw std::out_of_range("GeometryArena::Add: index does not fit in 16 bits");
+
+        indices16[i] = (std::uint16_t)meshData.Indices32[i];
+    }
+
+    return Add(cmdList, meshData.Vertices.data(), vertexCount, indices16.data(), indexCount, fenceValue);
+}
+
+void GeometryArena::Remove(const Mesh& mesh, UINT64 fenceValue)
+{
+    if(!mesh.IsValid())
+        return;
+
+    Retired retired;
+    retired.Handle = mesh;
+    retired.FenceValue = fenceValue;
+    mRetired.push_back(retired);
+}
+
+void GeometryArena::ReleaseCompleted(UINT64 completedFenceValue)
+{
+    auto retiredEnd = std::remove_if(mRetired.begin(), mRetired.end(), [&](const Retired& retired)
+    {
+        if(retired.FenceValue > completedFenceValue)
+            return false;
+
+        mVertexAllocator.Free(retired.Handle.Vertices);
+        mIndexAllocator.Free(retired.Handle.Indices);
+        return true;
+    });
+    mRetired.erase(retiredEnd, mRetired.end());
+
+    auto uploadEnd = std::remove_if(mPendingUploads.begin(), mPendingUploads.end(), [&](const PendingUpload& upload)
+    {
+        return upload.FenceValue <= completedFenceValue;
+    });
+    mPendingUploads.erase(uploadEnd, mPendingUploads.end());
+}
+
+SubmeshGeometry GeometryArena::GetSubmesh(const Mesh& mesh) const
+{
+    SubmeshGeometry submesh;
+    submesh.IndexCount = mesh.Indices.Size;
+    submesh.StartIndexLocation = mesh.Indices.Offset;
+    submesh.BaseVertexLocation = (INT)mesh.Vertices.Offset;
+
+    return submesh;
+}
+
+D3D12_VERTEX_BUFFER_VIEW GeometryArena::VertexBufferView() const
+{
+    D3D12_VERTEX_BUFFER_VIEW vbv;
+    vbv.BufferLocation = mVertexBuffer->GetGPUVirtualAddress();
+    vbv.StrideInBytes = mVertexByteStride;
+    vbv.SizeInBytes = mVertexAllocator.GetSize()*mVertexByteStride;
+
+    return vbv;
+}
+
+D3D12_INDEX_BUFFER_VIEW GeometryArena::IndexBufferView() const
+{
+    D3D12_INDEX_BUFFER_VIEW ibv;
+    ibv.BufferLocation = mIndexBuffer->GetGPUVirtualAddress();
+    ibv.Format = mIndexFormat;
+    ibv.SizeInBytes = mIndexAllocator.GetSize()*mIndexByteSize;
+
+    return ibv;
+}
+
+#endif
@@ -0,0 +1,120 @@
+//***************************************************************************************
+// GeometryArena.h
+//
+// One large vertex buffer and one large index buffer shared by many meshes.  Each mesh
+// is a vertex range and an index range handed out by RangeAllocator, so meshes can be
+// added and removed at runtime.  Everything is drawn with one IASetVertexBuffers /
+// IASetIndexBuffer pair, using GetSubmesh for BaseVertexLocation and
+// StartIndexLocation.  All meshes share the vertex stride and the index format.
+//
+// The GPU may still read a removed mesh, and an upload buffer is needed until its
+// copy has executed.  Both are therefore tied to a fence value and only released by
+// ReleaseCompleted:
+//     auto mesh = arena.Add(cmdList, geoGen.CreateSphere(0.5f, 20, 20), mCurrentFence + 1);
+//     ...
+//     arena.Remove(mesh, mCurrentFence + 1);
+//     arena.ReleaseCompleted(mFence->GetCompletedValue());
+//***************************************************************************************
+
+#pragma once
+
+#if defined(_WIN32)
+
+#include "GeometryGenerator.h"
+#include "RangeAllocator.h"
+#include <d3d12.h>
+#include <wrl.h>
+
+struct SubmeshGeometry;
+
+class GeometryArena
+{
+public:
+
+    using uint32 = std::uint32_t;
+
+	///<summary>
+	/// Handle of one mesh.  Offsets are in vertices and indices.
+	///</summary>
+    struct Mesh
+    {
+        RangeAllocator::Allocation Vertices;
+        RangeAllocator::Allocation Indices;
+
+        bool IsValid() const { return Vertices.IsValid() && Indices.IsValid(); }
+    };
+
+	///<summary>
+	/// Creates the two default-heap buffers.  indexFormat is DXGI_FORMAT_R16_UINT or
+	/// DXGI_FORMAT_R32_UINT; indices are relative to the mesh's first vertex either way.
+	///</summary>
+    GeometryArena(ID3D12Device* device, uint32 vertexCapacity, uint32 vertexByteStride,
+                  uint32 indexCapacity, DXGI_FORMAT indexFormat = DXGI_FORMAT_R32_UINT);
+
+    GeometryArena(const GeometryArena& rhs) = delete;
+    GeometryArena& operator=(const GeometryArena& rhs) = delete;
+
+	///<summary>
+	/// Allocates ranges and records the copy of the data into them on cmdList.  indices
+	/// are in the arena's index format.  Returns an invalid Mesh when either buffer has
+	/// no large enough free range.
+	///</summary>
+    Mesh Add(ID3D12GraphicsCommandList* cmdList, const void* vertices, uint32 vertexCount,
+             const void* indices, uint32 indexCount, UINT64 fenceValue);
+
+	///<summary>
+	/// Adds a generated mesh.  The vertex stride must be sizeof(GeometryGenerator::Vertex).
+	/// Throws std::out_of_range if the arena uses 16-bit indices and an index does not fit.
+	///</summary>
+    Mesh Add(ID3D12GraphicsCommandList* cmdList, const GeometryGenerator::MeshData& meshData, UINT64 fenceValue);
+
+	///<summary>
+	/// The ranges become free once the GPU has passed fenceValue.
+	///</summary>
+    void Remove(const Mesh& mesh, UINT64 fenceValue);
+
+	///<summary>
+	/// Frees the ranges of removed meshes and the upload buffers whose fence value has
+	/// been reached.  Call once per frame with the completed fence value.
+	///</summary>
+    void ReleaseCompleted(UINT64 completedFenceValue);
+
+    SubmeshGeometry GetSubmesh(const Mesh& mesh) const;
+
+    D3D12_VERTEX_BUFFER_VIEW VertexBufferView() const;
+    D3D12_INDEX_BUFFER_VIEW IndexBufferView() const;
+
+    const RangeAllocator& GetVertexAllocator() const { return mVertexAllocator; }
+    const RangeAllocator& GetIndexAllocator() const { return mIndexAllocator; }
+
+private:
+    struct Retired
+    {
+        Mesh Handle;
+        UINT64 FenceValue = 0;
+    };
+
+    struct PendingUpload
+    {
+        Microsoft::WRL::ComPtr<ID3D12Resource> Buffer;
+        UINT64 FenceValue = 0;
+    };
+
+    ID3D12Device* mDevice = nullptr;
+
+    uint32 mVertexByteStride = 0;
+    DXGI_FORMAT mIndexFormat = DXGI_FORMAT_R32_UINT;
+    uint32 mIndexByteSize = 4;
+
+    Microsoft::WRL::ComPtr<ID3D12Resource> mVertexBuffer;
+    Microsoft::WRL::ComPtr<ID3D12Resource> mIndexBuffer;
+    D3D12_RESOURCE_STATES mBufferState = D3D12_RESOURCE_STATE_COMMON;
+
+    RangeAllocator mVertexAllocator;
+    RangeAllocator mIndexAllocator;
+
+    std::vector<Retired> mRetired;
+    std::vector<PendingUpload> mPendingUploads;
+};
+
+#endif
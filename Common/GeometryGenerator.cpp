@@ -3,7 +3,15 @@
 //***************************************************************************************
 
 #include "GeometryGenerator.h"
+#include "PrimitiveTables.h"
+#include "ThreadPool.h"
 #include <algorithm>
+#include <mutex>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#include "d3dUtil.h"
+#endif
 
 using namespace DirectX;
 
@@ -11,92 +19,22 @@ GeometryGenerator::MeshData GeometryGenerator::CreateBox(float width, float heig
 {
     MeshData meshData;
 
-    //
-	// Create the vertices.
-	//
-
-	Vertex v[24];
-
-	float w2 = 0.5f*width;
-	float h2 = 0.5f*height;
-	float d2 = 0.5f*depth;
-    
-	// Fill in the front face vertex data.
-	v[0] = Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[1] = Vertex(-w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[2] = Vertex(+w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-	v[3] = Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-
-	// Fill in the back face vertex data.
-	v[4] = Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[5] = Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[6] = Vertex(+w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[7] = Vertex(-w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the top face vertex data.
-	v[8]  = Vertex(-w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[9]  = Vertex(-w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[10] = Vertex(+w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-	v[11] = Vertex(+w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-
-	// Fill in the bottom face vertex data.
-	v[12] = Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f);
-	v[13] = Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
-	v[14] = Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
-	v[15] = Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f);
-
-	// Fill in the left face vertex data.
-	v[16] = Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f);
-	v[17] = Vertex(-w2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f);
-	v[18] = Vertex(-w2, +h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f);
-	v[19] = Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f);
-
-	// Fill in the right face vertex data.
-	v[20] = Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f);
-	v[21] = Vertex(+w2, +h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f);
-	v[22] = Vertex(+w2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f);
-	v[23] = Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f);
-
-	meshData.Vertices.assign(&v[0], &v[24]);
- 
-	//
-	// Create the indices.
-	//
-
-	uint32 i[36];
-
-	// Fill in the front face index data
-	i[0] = 0; i[1] = 1; i[2] = 2;
-	i[3] = 0; i[4] = 2; i[5] = 3;
-
-	// Fill in the back face index data
-	i[6] = 4; i[7]  = 5; i[8]  = 6;
-	i[9] = 4; i[10] = 6; i[11] = 7;
-
-	// Fill in the top face index data
-	i[12] = 8; i[13] =  9; i[14] = 10;
-	i[15] = 8; i[16] = 10; i[17] = 11;
-
-	// Fill in the bottom face index data
-	i[18] = 12; i[19] = 13; i[20] = 14;
-	i[21] = 12; i[22] = 14; i[23] = 15;
-
-	// Fill in the left face index data
-	i[24] = 16; i[25] = 17; i[26] = 18;
-	i[27] = 16; i[28] = 18; i[29] = 19;
-
-	// Fill in the right face index data
-	i[30] = 20; i[31] = 21; i[32] = 22;
-	i[33] = 20; i[34] = 22; i[35] = 23;
-
-	meshData.Indices32.assign(&i[0], &i[36]);
+    // The unsubdivided box is the fixed 24-vertex table.
+    auto box = PrimitiveTables::MakeBox(width, height, depth);
+    meshData.Vertices.assign(box.Vertices.begin(), box.Vertices.end());
+    meshData.Indices32.assign(box.Indices.begin(), box.Indices.end());
 
     // Put a cap on the number of subdivisions.
     numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
 
+    // Reserve the final size so the subdivision levels never reallocate the vertices.
+    meshData.Vertices.reserve(GetBoxSize(numSubdivisions).VertexCount);
+
     for(uint32 i = 0; i < numSubdivisions; ++i)
         Subdivide(meshData);
 
+    ComputeBounds(meshData);
+
     return meshData;
 }
 
@@ -104,6 +42,18 @@ GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32
 {
     MeshData meshData;
 
+    MeshSize size = GetSphereSize(sliceCount, stackCount);
+    meshData.Vertices.resize(size.VertexCount);
+    meshData.Indices32.resize(size.IndexCount);
+
+    CreateSphere(radius, sliceCount, stackCount, meshData.Vertices.data(), meshData.Indices32.data());
+    ComputeBounds(meshData);
+
+    return meshData;
+}
+
+void GeometryGenerator::CreateSphere(float radius, uint32 sliceCount, uint32 stackCount, Vertex* vertices, uint32* indices)
+{
 	//
 	// Compute the vertices stating at the top pole and moving down the stacks.
 	//
@@ -114,58 +64,68 @@ GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32
 	Vertex topVertex(0.0f, +radius, 0.0f, 0.0f, +1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f);
 	Vertex bottomVertex(0.0f, -radius, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f);
 
-	meshData.Vertices.push_back( topVertex );
+	uint32 vertexCount = 0;
+	vertices[vertexCount++] = topVertex;
 
 	float phiStep   = XM_PI/stackCount;
 	float thetaStep = 2.0f*XM_PI/sliceCount;
 
+	// Every ring uses the same slice angles, so evaluate them once.  They are kept in
+	// the tangents of the first ring, (-sin(theta), 0, cos(theta)), which the other
+	// rings read back, so no table has to be allocated.
+	const Vertex* firstRing = vertices + vertexCount;
+	BuildSliceTangents(sliceCount+1, thetaStep, vertices + vertexCount);
+
+	float invSliceCount = 1.0f/sliceCount;
+
 	// Compute vertices for each stack ring (do not count the poles as rings).
 	for(uint32 i = 1; i <= stackCount-1; ++i)
 	{
 		float phi = i*phiStep;
 
+		float sinPhi, cosPhi;
+		XMScalarSinCos(&sinPhi, &cosPhi, phi);
+
+		float y = radius*cosPhi;
+		float v = phi / XM_PI;
+
 		// Vertices of ring.
         for(uint32 j = 0; j <= sliceCount; ++j)
 		{
-			float theta = j*thetaStep;
-
-			Vertex v;
-
-			// spherical to cartesian
-			v.Position.x = radius*sinf(phi)*cosf(theta);
-			v.Position.y = radius*cosf(phi);
-			v.Position.z = radius*sinf(phi)*sinf(theta);
-
-			// Partial derivative of P with respect to theta
-			v.TangentU.x = -radius*sinf(phi)*sinf(theta);
-			v.TangentU.y = 0.0f;
-			v.TangentU.z = +radius*sinf(phi)*cosf(theta);
+			Vertex& vertex = vertices[vertexCount++];
 
-			XMVECTOR T = XMLoadFloat3(&v.TangentU);
-			XMStoreFloat3(&v.TangentU, XMVector3Normalize(T));
+			// Partial derivative of P with respect to theta, normalized.
+			XMFLOAT3 tangent = firstRing[j].TangentU;
+			float sinTheta = -tangent.x;
+			float cosTheta = tangent.z;
 
-			XMVECTOR p = XMLoadFloat3(&v.Position);
-			XMStoreFloat3(&v.Normal, XMVector3Normalize(p));
+			// spherical to cartesian.  The unit normal is the position over the radius.
+			float nx = sinPhi*cosTheta;
+			float nz = sinPhi*sinTheta;
 
-			v.TexC.x = theta / XM_2PI;
-			v.TexC.y = phi / XM_PI;
+			vertex.Position = XMFLOAT3(radius*nx, y, radius*nz);
+			vertex.Normal = XMFLOAT3(nx, cosPhi, nz);
+			vertex.TangentU = tangent;
 
-			meshData.Vertices.push_back( v );
+			vertex.TexC = XMFLOAT2(j*invSliceCount, v);
 		}
 	}
 
-	meshData.Vertices.push_back( bottomVertex );
+	vertices[vertexCount++] = bottomVertex;
 
 	//
 	// Compute indices for top stack.  The top stack was written first to the vertex buffer
 	// and connects the top pole to the first ring.
 	//
 
+	uint32 k = 0;
     for(uint32 i = 1; i <= sliceCount; ++i)
 	{
-		meshData.Indices32.push_back(0);
-		meshData.Indices32.push_back(i+1);
-		meshData.Indices32.push_back(i);
+		indices[k]   = 0;
+		indices[k+1] = i+1;
+		indices[k+2] = i;
+
+		k += 3;
 	}
 	
 	//
@@ -180,13 +140,15 @@ GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32
 	{
 		for(uint32 j = 0; j < sliceCount; ++j)
 		{
-			meshData.Indices32.push_back(baseIndex + i*ringVertexCount + j);
-			meshData.Indices32.push_back(baseIndex + i*ringVertexCount + j+1);
-			meshData.Indices32.push_back(baseIndex + (i+1)*ringVertexCount + j);
+			indices[k]   = baseIndex + i*ringVertexCount + j;
+			indices[k+1] = baseIndex + i*ringVertexCount + j+1;
+			indices[k+2] = baseIndex + (i+1)*ringVertexCount + j;
+
+			indices[k+3] = baseIndex + (i+1)*ringVertexCount + j;
+			indices[k+4] = baseIndex + i*ringVertexCount + j+1;
+			indices[k+5] = baseIndex + (i+1)*ringVertexCount + j+1;
 
-			meshData.Indices32.push_back(baseIndex + (i+1)*ringVertexCount + j);
-			meshData.Indices32.push_back(baseIndex + i*ringVertexCount + j+1);
-			meshData.Indices32.push_back(baseIndex + (i+1)*ringVertexCount + j+1);
+			k += 6;
 		}
 	}
 
@@ -196,29 +158,27 @@ GeometryGenerator::MeshData GeometryGenerator::CreateSphere(float radius, uint32
 	//
 
 	// South pole vertex was added last.
-	uint32 southPoleIndex = (uint32)meshData.Vertices.size()-1;
+	uint32 southPoleIndex = vertexCount-1;
 
 	// Offset the indices to the index of the first vertex in the last ring.
 	baseIndex = southPoleIndex - ringVertexCount;
 	
 	for(uint32 i = 0; i < sliceCount; ++i)
 	{
-		meshData.Indices32.push_back(southPoleIndex);
-		meshData.Indices32.push_back(baseIndex+i);
-		meshData.Indices32.push_back(baseIndex+i+1);
-	}
+		indices[k]   = southPoleIndex;
+		indices[k+1] = baseIndex+i;
+		indices[k+2] = baseIndex+i+1;
 
-    return meshData;
+		k += 3;
+	}
 }
  
 void GeometryGenerator::Subdivide(MeshData& meshData)
 {
-	// Save a copy of the input geometry.
-	MeshData inputCopy = meshData;
-
-
-	meshData.Vertices.resize(0);
-	meshData.Indices32.resize(0);
+	// Save a copy of the input indices.  The input vertices stay where they are
+	// and the new edge midpoints are appended after them.
+	std::vector<uint32> inputIndices;
+	inputIndices.swap(meshData.Indices32);
 
 	//       v1
 	//       *
@@ -230,47 +190,69 @@ void GeometryGenerator::Subdivide(MeshData& meshData)
 	// *-----*-----*
 	// v0    m2     v2
 
-	uint32 numTris = (uint32)inputCopy.Indices32.size()/3;
+	uint32 numTris = (uint32)inputIndices.size()/3;
+
+	// An edge shared by two triangles must produce one midpoint vertex, not two,
+	// so midpoints are cached by their (unordered) edge.  A closed mesh has
+	// 3/2 edges per triangle.
+	std::unordered_map<std::uint64_t, uint32> midPointCache;
+	midPointCache.reserve(numTris*3/2);
+
+	meshData.Vertices.reserve(meshData.Vertices.size() + numTris*3/2);
+	meshData.Indices32.reserve(numTris*12);
+
+	auto midPointIndex = [&](uint32 i0, uint32 i1) -> uint32
+	{
+		if(i0 > i1)
+			std::swap(i0, i1);
+
+		std::uint64_t key = ((std::uint64_t)i0 << 32) | i1;
+
+		auto it = midPointCache.find(key);
+		if(it != midPointCache.end())
+			return it->second;
+
+		uint32 index = (uint32)meshData.Vertices.size();
+		Vertex m = MidPoint(meshData.Vertices[i0], meshData.Vertices[i1]);
+		meshData.Vertices.push_back(m);
+
+		midPointCache.emplace(key, index);
+		return index;
+	};
+
 	for(uint32 i = 0; i < numTris; ++i)
 	{
-		Vertex v0 = inputCopy.Vertices[ inputCopy.Indices32[i*3+0] ];
-		Vertex v1 = inputCopy.Vertices[ inputCopy.Indices32[i*3+1] ];
-		Vertex v2 = inputCopy.Vertices[ inputCopy.Indices32[i*3+2] ];
+		uint32 v0 = inputIndices[i*3+0];
+		uint32 v1 = inputIndices[i*3+1];
+		uint32 v2 = inputIndices[i*3+2];
 
 		//
-		// Generate the midpoints.
+		// Generate (or reuse) the midpoints.
 		//
 
-        Vertex m0 = MidPoint(v0, v1);
-        Vertex m1 = MidPoint(v1, v2);
-        Vertex m2 = MidPoint(v0, v2);
+		uint32 m0 = midPointIndex(v0, v1);
+		uint32 m1 = midPointIndex(v1, v2);
+		uint32 m2 = midPointIndex(v0, v2);
 
 		//
 		// Add new geometry.
 		//
 
-		meshData.Vertices.push_back(v0); // 0
-		meshData.Vertices.push_back(v1); // 1
-		meshData.Vertices.push_back(v2); // 2
-		meshData.Vertices.push_back(m0); // 3
-		meshData.Vertices.push_back(m1); // 4
-		meshData.Vertices.push_back(m2); // 5
- 
-		meshData.Indices32.push_back(i*6+0);
-		meshData.Indices32.push_back(i*6+3);
-		meshData.Indices32.push_back(i*6+5);
+		meshData.Indices32.push_back(v0);
+		meshData.Indices32.push_back(m0);
+		meshData.Indices32.push_back(m2);
 
-		meshData.Indices32.push_back(i*6+3);
-		meshData.Indices32.push_back(i*6+4);
-		meshData.Indices32.push_back(i*6+5);
+		meshData.Indices32.push_back(m0);
+		meshData.Indices32.push_back(m1);
+		meshData.Indices32.push_back(m2);
 
-		meshData.Indices32.push_back(i*6+5);
-		meshData.Indices32.push_back(i*6+4);
-		meshData.Indices32.push_back(i*6+2);
+		meshData.Indices32.push_back(m2);
+		meshData.Indices32.push_back(m1);
+		meshData.Indices32.push_back(v2);
 
-		meshData.Indices32.push_back(i*6+3);
-		meshData.Indices32.push_back(i*6+1);
-		meshData.Indices32.push_back(i*6+4);
+		meshData.Indices32.push_back(m0);
+		meshData.Indices32.push_back(v1);
+		meshData.Indices32.push_back(m1);
 	}
 }
 
@@ -308,9 +290,64 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGeosphere(float radius, uin
 {
     MeshData meshData;
 
-	// Put a cap on the number of subdivisions.
+    MeshSize size = GetGeosphereSize(numSubdivisions);
+    meshData.Vertices.resize(size.VertexCount);
+    meshData.Indices32.resize(size.IndexCount);
+
+    CreateGeosphere(radius, numSubdivisions, meshData.Vertices.data(), meshData.Indices32.data());
+
+    // The template's bounds scale with the radius; the orientation does not change.
+    const MeshBounds& unitBounds = GetUnitGeosphere(numSubdivisions).Bounds;
+    auto scale = [radius](const XMFLOAT3& v) { return XMFLOAT3(radius*v.x, radius*v.y, radius*v.z); };
+
+    meshData.Bounds = unitBounds;
+    meshData.Bounds.Box.Center = scale(unitBounds.Box.Center);
+    meshData.Bounds.Box.Extents = scale(unitBounds.Box.Extents);
+    meshData.Bounds.Sphere.Center = scale(unitBounds.Sphere.Center);
+    meshData.Bounds.Sphere.Radius = radius*unitBounds.Sphere.Radius;
+    meshData.Bounds.OrientedBox.Center = scale(unitBounds.OrientedBox.Center);
+    meshData.Bounds.OrientedBox.Extents = scale(unitBounds.OrientedBox.Extents);
+
+    return meshData;
+}
+
+void GeometryGenerator::CreateGeosphere(float radius, uint32 numSubdivisions, Vertex* vertices, uint32* indices)
+{
+    const MeshData& unitSphere = GetUnitGeosphere(numSubdivisions);
+
+    // Only the positions depend on the radius.
+    std::copy(unitSphere.Vertices.begin(), unitSphere.Vertices.end(), vertices);
+    std::copy(unitSphere.Indices32.begin(), unitSphere.Indices32.end(), indices);
+
+    uint32 vertexCount = (uint32)unitSphere.Vertices.size();
+    for(uint32 i = 0; i < vertexCount; ++i)
+    {
+        XMFLOAT3& p = vertices[i].Position;
+        p = XMFLOAT3(radius*p.x, radius*p.y, radius*p.z);
+    }
+}
+
+const GeometryGenerator::MeshData& GeometryGenerator::GetUnitGeosphere(uint32 numSubdivisions)
+{
+    // Put a cap on the number of subdivisions.
     numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
 
+    // One template per level, built on first use and kept for the life of the process.
+    static std::once_flag builtFlags[7];
+    static MeshData templates[7];
+
+    std::call_once(builtFlags[numSubdivisions], [numSubdivisions]()
+    {
+        templates[numSubdivisions] = BuildUnitGeosphere(numSubdivisions);
+    });
+
+    return templates[numSubdivisions];
+}
+
+GeometryGenerator::MeshData GeometryGenerator::BuildUnitGeosphere(uint32 numSubdivisions)
+{
+    MeshData meshData;
+
 	// Approximate a sphere by tessellating an icosahedron.
 
 	const float X = 0.525731f; 
@@ -334,6 +371,9 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGeosphere(float radius, uin
 		10,1,6, 11,0,9, 2,11,9, 5,2,9,  11,2,7 
 	};
 
+    // Reserve the final size so the subdivision levels never reallocate the vertices.
+    meshData.Vertices.reserve(GetGeosphereSize(numSubdivisions).VertexCount);
+
     meshData.Vertices.resize(12);
     meshData.Indices32.assign(&k[0], &k[60]);
 
@@ -343,16 +383,13 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGeosphere(float radius, uin
 	for(uint32 i = 0; i < numSubdivisions; ++i)
 		Subdivide(meshData);
 
-	// Project vertices onto sphere and scale.
+	// Project vertices onto the unit sphere.
 	for(uint32 i = 0; i < meshData.Vertices.size(); ++i)
 	{
 		// Project onto unit sphere.
 		XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&meshData.Vertices[i].Position));
 
-		// Project onto sphere.
-		XMVECTOR p = radius*n;
-
-		XMStoreFloat3(&meshData.Vertices[i].Position, p);
+		XMStoreFloat3(&meshData.Vertices[i].Position, n);
 		XMStoreFloat3(&meshData.Vertices[i].Normal, n);
 
 		// Derive texture coordinates from spherical coordinates.
@@ -362,20 +399,22 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGeosphere(float radius, uin
         if(theta < 0.0f)
             theta += XM_2PI;
 
-		float phi = acosf(meshData.Vertices[i].Position.y / radius);
+		float phi = acosf(meshData.Vertices[i].Position.y);
 
 		meshData.Vertices[i].TexC.x = theta/XM_2PI;
 		meshData.Vertices[i].TexC.y = phi/XM_PI;
 
 		// Partial derivative of P with respect to theta
-		meshData.Vertices[i].TangentU.x = -radius*sinf(phi)*sinf(theta);
+		meshData.Vertices[i].TangentU.x = -sinf(phi)*sinf(theta);
 		meshData.Vertices[i].TangentU.y = 0.0f;
-		meshData.Vertices[i].TangentU.z = +radius*sinf(phi)*cosf(theta);
+		meshData.Vertices[i].TangentU.z = +sinf(phi)*cosf(theta);
 
 		XMVECTOR T = XMLoadFloat3(&meshData.Vertices[i].TangentU);
 		XMStoreFloat3(&meshData.Vertices[i].TangentU, XMVector3Normalize(T));
 	}
 
+    ComputeBounds(meshData);
+
     return meshData;
 }
 
@@ -383,6 +422,20 @@ GeometryGenerator::MeshData GeometryGenerator::CreateCylinder(float bottomRadius
 {
     MeshData meshData;
 
+    MeshSize size = GetCylinderSize(sliceCount, stackCount);
+    meshData.Vertices.resize(size.VertexCount);
+    meshData.Indices32.resize(size.IndexCount);
+
+    CreateCylinder(bottomRadius, topRadius, height, sliceCount, stackCount,
+        meshData.Vertices.data(), meshData.Indices32.data());
+    ComputeBounds(meshData);
+
+    return meshData;
+}
+
+void GeometryGenerator::CreateCylinder(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount,
+                                       Vertex* vertices, uint32* indices)
+{
 	//
 	// Build Stacks.
 	// 
@@ -394,57 +447,63 @@ GeometryGenerator::MeshData GeometryGenerator::CreateCylinder(float bottomRadius
 
 	uint32 ringCount = stackCount+1;
 
+	// The side rings and both caps share the slice angles.  They are kept in the
+	// tangents of the bottom ring, (-sin(t), 0, cos(t)), so no table is allocated.
+	float dTheta = 2.0f*XM_PI/sliceCount;
+	const Vertex* firstRing = vertices;
+	BuildSliceTangents(sliceCount+1, dTheta, vertices);
+
+	// Cylinder can be parameterized as follows, where we introduce v
+	// parameter that goes in the same direction as the v tex-coord
+	// so that the bitangent goes in the same direction as the v tex-coord.
+	//   Let r0 be the bottom radius and let r1 be the top radius.
+	//   y(v) = h - hv for v in [0,1].
+	//   r(v) = r1 + (r0-r1)v
+	//
+	//   x(t, v) = r(v)*cos(t)
+	//   y(t, v) = h - hv
+	//   z(t, v) = r(v)*sin(t)
+	// 
+	//  dx/dt = -r(v)*sin(t)
+	//  dy/dt = 0
+	//  dz/dt = +r(v)*cos(t)
+	//
+	//  dx/dv = (r0-r1)*cos(t)
+	//  dy/dv = -h
+	//  dz/dv = (r0-r1)*sin(t)
+	//
+	// N = T x B = (h*cos(t), r0-r1, h*sin(t)) normalized, so it only depends on the
+	// slice and is the same for every ring.
+	float dr = bottomRadius-topRadius;
+	float invLength = 1.0f/sqrtf(height*height + dr*dr);
+	float normalY = dr*invLength;
+	float normalXZ = height*invLength;
+
+	float invSliceCount = 1.0f/sliceCount;
+
 	// Compute vertices for each stack ring starting at the bottom and moving up.
+	uint32 vertexCount = 0;
 	for(uint32 i = 0; i < ringCount; ++i)
 	{
 		float y = -0.5f*height + i*stackHeight;
 		float r = bottomRadius + i*radiusStep;
+		float v = 1.0f - (float)i/stackCount;
 
 		// vertices of ring
-		float dTheta = 2.0f*XM_PI/sliceCount;
 		for(uint32 j = 0; j <= sliceCount; ++j)
 		{
-			Vertex vertex;
-
-			float c = cosf(j*dTheta);
-			float s = sinf(j*dTheta);
-
-			vertex.Position = XMFLOAT3(r*c, y, r*s);
-
-			vertex.TexC.x = (float)j/sliceCount;
-			vertex.TexC.y = 1.0f - (float)i/stackCount;
-
-			// Cylinder can be parameterized as follows, where we introduce v
-			// parameter that goes in the same direction as the v tex-coord
-			// so that the bitangent goes in the same direction as the v tex-coord.
-			//   Let r0 be the bottom radius and let r1 be the top radius.
-			//   y(v) = h - hv for v in [0,1].
-			//   r(v) = r1 + (r0-r1)v
-			//
-			//   x(t, v) = r(v)*cos(t)
-			//   y(t, v) = h - hv
-			//   z(t, v) = r(v)*sin(t)
-			// 
-			//  dx/dt = -r(v)*sin(t)
-			//  dy/dt = 0
-			//  dz/dt = +r(v)*cos(t)
-			//
-			//  dx/dv = (r0-r1)*cos(t)
-			//  dy/dv = -h
-			//  dz/dv = (r0-r1)*sin(t)
+			Vertex& vertex = vertices[vertexCount++];
 
 			// This is unit length.
-			vertex.TangentU = XMFLOAT3(-s, 0.0f, c);
-
-			float dr = bottomRadius-topRadius;
-			XMFLOAT3 bitangent(dr*c, -height, dr*s);
+			XMFLOAT3 tangent = firstRing[j].TangentU;
+			float c = tangent.z;
+			float s = -tangent.x;
 
-			XMVECTOR T = XMLoadFloat3(&vertex.TangentU);
-			XMVECTOR B = XMLoadFloat3(&bitangent);
-			XMVECTOR N = XMVector3Normalize(XMVector3Cross(T, B));
-			XMStoreFloat3(&vertex.Normal, N);
+			vertex.Position = XMFLOAT3(r*c, y, r*s);
+			vertex.Normal = XMFLOAT3(normalXZ*c, normalY, normalXZ*s);
+			vertex.TangentU = tangent;
 
-			meshData.Vertices.push_back(vertex);
+			vertex.TexC = XMFLOAT2(j*invSliceCount, v);
 		}
 	}
 
@@ -453,98 +512,104 @@ GeometryGenerator::MeshData GeometryGenerator::CreateCylinder(float bottomRadius
 	uint32 ringVertexCount = sliceCount+1;
 
 	// Compute indices for each stack.
+	uint32 k = 0;
 	for(uint32 i = 0; i < stackCount; ++i)
 	{
 		for(uint32 j = 0; j < sliceCount; ++j)
 		{
-			meshData.Indices32.push_back(i*ringVertexCount + j);
-			meshData.Indices32.push_back((i+1)*ringVertexCount + j);
-			meshData.Indices32.push_back((i+1)*ringVertexCount + j+1);
+			indices[k]   = i*ringVertexCount + j;
+			indices[k+1] = (i+1)*ringVertexCount + j;
+			indices[k+2] = (i+1)*ringVertexCount + j+1;
+
+			indices[k+3] = i*ringVertexCount + j;
+			indices[k+4] = (i+1)*ringVertexCount + j+1;
+			indices[k+5] = i*ringVertexCount + j+1;
 
-			meshData.Indices32.push_back(i*ringVertexCount + j);
-			meshData.Indices32.push_back((i+1)*ringVertexCount + j+1);
-			meshData.Indices32.push_back(i*ringVertexCount + j+1);
+			k += 6;
 		}
 	}
 
-	BuildCylinderTopCap(bottomRadius, topRadius, height, sliceCount, stackCount, meshData);
-	BuildCylinderBottomCap(bottomRadius, topRadius, height, sliceCount, stackCount, meshData);
+	// Each cap is a ring of sliceCount+1 vertices plus a center vertex, and sliceCount triangles.
+	uint32 capVertexCount = sliceCount+2;
+	uint32 capIndexCount = 3*sliceCount;
 
-    return meshData;
+	BuildCylinderTopCap(bottomRadius, topRadius, height, sliceCount, stackCount, firstRing,
+		vertexCount, vertices + vertexCount, indices + k);
+	BuildCylinderBottomCap(bottomRadius, topRadius, height, sliceCount, stackCount, firstRing,
+		vertexCount + capVertexCount, vertices + vertexCount + capVertexCount, indices + k + capIndexCount);
 }
 
 void GeometryGenerator::BuildCylinderTopCap(float bottomRadius, float topRadius, float height,
-											uint32 sliceCount, uint32 stackCount, MeshData& meshData)
+											uint32 sliceCount, uint32 stackCount,
+											const Vertex* sideRing,
+											uint32 baseIndex, Vertex* vertices, uint32* indices)
 {
-	uint32 baseIndex = (uint32)meshData.Vertices.size();
-
 	float y = 0.5f*height;
-	float dTheta = 2.0f*XM_PI/sliceCount;
 
 	// Duplicate cap ring vertices because the texture coordinates and normals differ.
 	for(uint32 i = 0; i <= sliceCount; ++i)
 	{
-		float x = topRadius*cosf(i*dTheta);
-		float z = topRadius*sinf(i*dTheta);
+		float x = topRadius*sideRing[i].TangentU.z;
+		float z = -topRadius*sideRing[i].TangentU.x;
 
 		// Scale down by the height to try and make top cap texture coord area
 		// proportional to base.
 		float u = x/height + 0.5f;
 		float v = z/height + 0.5f;
 
-		meshData.Vertices.push_back( Vertex(x, y, z, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v) );
+		vertices[i] = Vertex(x, y, z, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v);
 	}
 
 	// Cap center vertex.
-	meshData.Vertices.push_back( Vertex(0.0f, y, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f) );
+	vertices[sliceCount+1] = Vertex(0.0f, y, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f);
 
 	// Index of center vertex.
-	uint32 centerIndex = (uint32)meshData.Vertices.size()-1;
+	uint32 centerIndex = baseIndex + sliceCount+1;
 
 	for(uint32 i = 0; i < sliceCount; ++i)
 	{
-		meshData.Indices32.push_back(centerIndex);
-		meshData.Indices32.push_back(baseIndex + i+1);
-		meshData.Indices32.push_back(baseIndex + i);
+		indices[i*3+0] = centerIndex;
+		indices[i*3+1] = baseIndex + i+1;
+		indices[i*3+2] = baseIndex + i;
 	}
 }
 
 void GeometryGenerator::BuildCylinderBottomCap(float bottomRadius, float topRadius, float height,
-											   uint32 sliceCount, uint32 stackCount, MeshData& meshData)
+											   uint32 sliceCount, uint32 stackCount,
+											   const Vertex* sideRing,
+											   uint32 baseIndex, Vertex* vertices, uint32* indices)
 {
 	// 
 	// Build bottom cap.
 	//
 
-	uint32 baseIndex = (uint32)meshData.Vertices.size();
 	float y = -0.5f*height;
 
 	// vertices of ring
-	float dTheta = 2.0f*XM_PI/sliceCount;
 	for(uint32 i = 0; i <= sliceCount; ++i)
 	{
-		float x = bottomRadius*cosf(i*dTheta);
-		float z = bottomRadius*sinf(i*dTheta);
+		float x = bottomRadius*sideRing[i].TangentU.z;
+		float z = -bottomRadius*sideRing[i].TangentU.x;
 
 		// Scale down by the height to try and make top cap texture coord area
 		// proportional to base.
 		float u = x/height + 0.5f;
 		float v = z/height + 0.5f;
 
-		meshData.Vertices.push_back( Vertex(x, y, z, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v) );
+		vertices[i] = Vertex(x, y, z, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, u, v);
 	}
 
 	// Cap center vertex.
-	meshData.Vertices.push_back( Vertex(0.0f, y, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f) );
+	vertices[sliceCount+1] = Vertex(0.0f, y, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f);
 
 	// Cache the index of center vertex.
-	uint32 centerIndex = (uint32)meshData.Vertices.size()-1;
+	uint32 centerIndex = baseIndex + sliceCount+1;
 
 	for(uint32 i = 0; i < sliceCount; ++i)
 	{
-		meshData.Indices32.push_back(centerIndex);
-		meshData.Indices32.push_back(baseIndex + i);
-		meshData.Indices32.push_back(baseIndex + i+1);
+		indices[i*3+0] = centerIndex;
+		indices[i*3+1] = baseIndex + i;
+		indices[i*3+2] = baseIndex + i+1;
 	}
 }
 
@@ -552,9 +617,18 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGrid(float width, float dep
 {
     MeshData meshData;
 
-	uint32 vertexCount = m*n;
-	uint32 faceCount   = (m-1)*(n-1)*2;
+    MeshSize size = GetGridSize(m, n);
+    meshData.Vertices.resize(size.VertexCount);
+    meshData.Indices32.resize(size.IndexCount);
+
+    CreateGrid(width, depth, m, n, meshData.Vertices.data(), meshData.Indices32.data());
+    ComputeBounds(meshData);
 
+    return meshData;
+}
+
+void GeometryGenerator::CreateGrid(float width, float depth, uint32 m, uint32 n, Vertex* vertices, uint32* indices)
+{
 	//
 	// Create the vertices.
 	//
@@ -568,7 +642,6 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGrid(float width, float dep
 	float du = 1.0f / (n-1);
 	float dv = 1.0f / (m-1);
 
-	meshData.Vertices.resize(vertexCount);
 	for(uint32 i = 0; i < m; ++i)
 	{
 		float z = halfDepth - i*dz;
@@ -576,13 +649,13 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGrid(float width, float dep
 		{
 			float x = -halfWidth + j*dx;
 
-			meshData.Vertices[i*n+j].Position = XMFLOAT3(x, 0.0f, z);
-			meshData.Vertices[i*n+j].Normal   = XMFLOAT3(0.0f, 1.0f, 0.0f);
-			meshData.Vertices[i*n+j].TangentU = XMFLOAT3(1.0f, 0.0f, 0.0f);
+			vertices[i*n+j].Position = XMFLOAT3(x, 0.0f, z);
+			vertices[i*n+j].Normal   = XMFLOAT3(0.0f, 1.0f, 0.0f);
+			vertices[i*n+j].TangentU = XMFLOAT3(1.0f, 0.0f, 0.0f);
 
 			// Stretch texture over grid.
-			meshData.Vertices[i*n+j].TexC.x = j*du;
-			meshData.Vertices[i*n+j].TexC.y = i*dv;
+			vertices[i*n+j].TexC.x = j*du;
+			vertices[i*n+j].TexC.y = i*dv;
 		}
 	}
  
@@ -590,68 +663,312 @@ GeometryGenerator::MeshData GeometryGenerator::CreateGrid(float width, float dep
 	// Create the indices.
 	//
 
-	meshData.Indices32.resize(faceCount*3); // 3 indices per face
-
 	// Iterate over each quad and compute indices.
 	uint32 k = 0;
 	for(uint32 i = 0; i < m-1; ++i)
 	{
 		for(uint32 j = 0; j < n-1; ++j)
 		{
-			meshData.Indices32[k]   = i*n+j;
-			meshData.Indices32[k+1] = i*n+j+1;
-			meshData.Indices32[k+2] = (i+1)*n+j;
+			indices[k]   = i*n+j;
+			indices[k+1] = i*n+j+1;
+			indices[k+2] = (i+1)*n+j;
 
-			meshData.Indices32[k+3] = (i+1)*n+j;
-			meshData.Indices32[k+4] = i*n+j+1;
-			meshData.Indices32[k+5] = (i+1)*n+j+1;
+			indices[k+3] = (i+1)*n+j;
+			indices[k+4] = i*n+j+1;
+			indices[k+5] = (i+1)*n+j+1;
 
 			k += 6; // next quad
 		}
 	}
+}
 
-    return meshData;
+GeometryGenerator::TiledMeshData GeometryGenerator::CreateGridTiled(float width, float depth, uint32 m, uint32 n, uint32 tileQuads)
+{
+	TiledMeshData grid;
+
+	if(m < 2 || n < 2)
+		return grid;
+
+	uint32 maxTileQuads = MaxGridTileQuads;
+	tileQuads = std::max(1u, std::min(tileQuads, maxTileQuads));
+
+	uint32 tileRows = (m-1 + tileQuads-1) / tileQuads;
+	uint32 tileColumns = (n-1 + tileQuads-1) / tileQuads;
+
+	//
+	// Lay out the tiles serially so every tile knows where its data goes.
+	//
+
+	grid.Tiles.resize(tileRows*tileColumns);
+
+	uint32 vertexCount = 0;
+	uint32 indexCount = 0;
+	for(uint32 r = 0; r < tileRows; ++r)
+	{
+		for(uint32 c = 0; c < tileColumns; ++c)
+		{
+			uint32 rowQuads = std::min(tileQuads, m-1 - r*tileQuads);
+			uint32 columnQuads = std::min(tileQuads, n-1 - c*tileQuads);
+
+			GridTile& tile = grid.Tiles[r*tileColumns + c];
+			tile.Row = r;
+			tile.Column = c;
+			tile.BaseVertexLocation = (std::int32_t)vertexCount;
+			tile.VertexCount = (rowQuads+1)*(columnQuads+1);
+			tile.StartIndexLocation = indexCount;
+			tile.IndexCount = 6*rowQuads*columnQuads;
+
+			vertexCount += tile.VertexCount;
+			indexCount += tile.IndexCount;
+		}
+	}
+
+	grid.Vertices.resize(vertexCount);
+	grid.Indices16.resize(indexCount);
+
+	//
+	// Fill the tiles in parallel, with the same vertices and winding as CreateGrid.
+	//
+
+	float halfWidth = 0.5f*width;
+	float halfDepth = 0.5f*depth;
+
+	float dx = width / (n-1);
+	float dz = depth / (m-1);
+
+	float du = 1.0f / (n-1);
+	float dv = 1.0f / (m-1);
+
+	ThreadPool::Get().ParallelFor((uint32)grid.Tiles.size(), [&](uint32 t)
+	{
+		GridTile& tile = grid.Tiles[t];
+
+		uint32 firstRow = tile.Row*tileQuads;
+		uint32 firstColumn = tile.Column*tileQuads;
+		uint32 rowQuads = std::min(tileQuads, m-1 - firstRow);
+		uint32 columnQuads = std::min(tileQuads, n-1 - firstColumn);
+		uint32 tileN = columnQuads+1;
+
+		Vertex* vertices = &grid.Vertices[tile.BaseVertexLocation];
+		for(uint32 i = 0; i <= rowQuads; ++i)
+		{
+			float z = halfDepth - (firstRow+i)*dz;
+			for(uint32 j = 0; j <= columnQuads; ++j)
+			{
+				float x = -halfWidth + (firstColumn+j)*dx;
+
+				Vertex& v = vertices[i*tileN+j];
+				v.Position = XMFLOAT3(x, 0.0f, z);
+				v.Normal   = XMFLOAT3(0.0f, 1.0f, 0.0f);
+				v.TangentU = XMFLOAT3(1.0f, 0.0f, 0.0f);
+				v.TexC     = XMFLOAT2((firstColumn+j)*du, (firstRow+i)*dv);
+			}
+		}
+
+		uint16* indices = &grid.Indices16[tile.StartIndexLocation];
+		uint32 k = 0;
+		for(uint32 i = 0; i < rowQuads; ++i)
+		{
+			for(uint32 j = 0; j < columnQuads; ++j)
+			{
+				indices[k]   = (uint16)(i*tileN+j);
+				indices[k+1] = (uint16)(i*tileN+j+1);
+				indices[k+2] = (uint16)((i+1)*tileN+j);
+
+				indices[k+3] = (uint16)((i+1)*tileN+j);
+				indices[k+4] = (uint16)(i*tileN+j+1);
+				indices[k+5] = (uint16)((i+1)*tileN+j+1);
+
+				k += 6;
+			}
+		}
+
+		const XMFLOAT3& first = vertices[0].Position;
+		const XMFLOAT3& last = vertices[tile.VertexCount-1].Position;
+		tile.Bounds.Center = XMFLOAT3(0.5f*(first.x + last.x), 0.0f, 0.5f*(first.z + last.z));
+		tile.Bounds.Extents = XMFLOAT3(0.5f*(last.x - first.x), 0.0f, 0.5f*(first.z - last.z));
+	});
+
+	return grid;
+}
+
+#if defined(_WIN32)
+void GeometryGenerator::AddGridTileSubmeshes(MeshGeometry& geometry, const std::string& name, const TiledMeshData& grid,
+                                             uint32 startIndexLocation, std::int32_t baseVertexLocation)
+{
+	uint32 tileColumns = 0;
+	for(const GridTile& tile : grid.Tiles)
+		tileColumns = std::max(tileColumns, tile.Column+1);
+
+	for(const GridTile& tile : grid.Tiles)
+	{
+		SubmeshGeometry submesh;
+		submesh.IndexCount = tile.IndexCount;
+		submesh.StartIndexLocation = startIndexLocation + tile.StartIndexLocation;
+		submesh.BaseVertexLocation = baseVertexLocation + tile.BaseVertexLocation;
+		BoundsBuilder::Apply(BoundsBuilder::Compute(&grid.Vertices[tile.BaseVertexLocation].Position,
+			sizeof(Vertex), tile.VertexCount), submesh);
+
+		geometry.DrawArgs[name + "_tile" + std::to_string(tile.Row*tileColumns + tile.Column)] = submesh;
+	}
 }
+#endif
 
 GeometryGenerator::MeshData GeometryGenerator::CreateQuad(float x, float y, float w, float h, float depth)
 {
     MeshData meshData;
 
-	meshData.Vertices.resize(4);
-	meshData.Indices32.resize(6);
-
-	// Position coordinates specified in NDC space.
-	meshData.Vertices[0] = Vertex(
-        x, y - h, depth,
-		0.0f, 0.0f, -1.0f,
-		1.0f, 0.0f, 0.0f,
-		0.0f, 1.0f);
-
-	meshData.Vertices[1] = Vertex(
-		x, y, depth,
-		0.0f, 0.0f, -1.0f,
-		1.0f, 0.0f, 0.0f,
-		0.0f, 0.0f);
-
-	meshData.Vertices[2] = Vertex(
-		x+w, y, depth,
-		0.0f, 0.0f, -1.0f,
-		1.0f, 0.0f, 0.0f,
-		1.0f, 0.0f);
-
-	meshData.Vertices[3] = Vertex(
-		x+w, y-h, depth,
-		0.0f, 0.0f, -1.0f,
-		1.0f, 0.0f, 0.0f,
-		1.0f, 1.0f);
-
-	meshData.Indices32[0] = 0;
-	meshData.Indices32[1] = 1;
-	meshData.Indices32[2] = 2;
-
-	meshData.Indices32[3] = 0;
-	meshData.Indices32[4] = 2;
-	meshData.Indices32[5] = 3;
+    MeshSize size = GetQuadSize();
+    meshData.Vertices.resize(size.VertexCount);
+    meshData.Indices32.resize(size.IndexCount);
+
+    CreateQuad(x, y, w, h, depth, meshData.Vertices.data(), meshData.Indices32.data());
+    ComputeBounds(meshData);
 
     return meshData;
 }
+
+void GeometryGenerator::CreateQuad(float x, float y, float w, float h, float depth, Vertex* vertices, uint32* indices)
+{
+	auto quad = PrimitiveTables::MakeQuad(x, y, w, h, depth);
+	std::copy(quad.Vertices.begin(), quad.Vertices.end(), vertices);
+	std::copy(quad.Indices.begin(), quad.Indices.end(), indices);
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::GetBoxSize(uint32 numSubdivisions)
+{
+    numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
+
+    // Each face starts as a 2x2 vertex quad, and every subdivision level doubles
+    // the number of quads along each side of the face.
+    uint32 side = (1u << numSubdivisions) + 1;
+
+    MeshSize size;
+    size.VertexCount = 6*side*side;
+    size.IndexCount = 36u << (2*numSubdivisions);
+    return size;
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::GetSphereSize(uint32 sliceCount, uint32 stackCount)
+{
+    MeshSize size;
+    size.VertexCount = (stackCount-1)*(sliceCount+1) + 2;
+    size.IndexCount = 6*sliceCount*(stackCount-1);
+    return size;
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::GetGeosphereSize(uint32 numSubdivisions)
+{
+    numSubdivisions = std::min<uint32>(numSubdivisions, 6u);
+
+    // Euler's formula for a closed triangle mesh: V = F/2 + 2, with F = 20*4^n.
+    MeshSize size;
+    size.VertexCount = (10u << (2*numSubdivisions)) + 2;
+    size.IndexCount = 60u << (2*numSubdivisions);
+    return size;
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::GetCylinderSize(uint32 sliceCount, uint32 stackCount)
+{
+    MeshSize size;
+    size.VertexCount = (stackCount+1)*(sliceCount+1) + 2*(sliceCount+2);
+    size.IndexCount = 6*sliceCount*stackCount + 2*3*sliceCount;
+    return size;
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::GetGridSize(uint32 m, uint32 n)
+{
+    MeshSize size;
+    size.VertexCount = m*n;
+    size.IndexCount = (m-1)*(n-1)*2*3;
+    return size;
+}
+
+GeometryGenerator::MeshSize GeometryGenerator::GetQuadSize()
+{
+    MeshSize size;
+    size.VertexCount = 4;
+    size.IndexCount = 6;
+    return size;
+}
+
+void GeometryGenerator::BuildSliceTangents(uint32 count, float step, Vertex* ring)
+{
+	// Angles are i*step rather than a running sum so the error does not grow along the ring.
+	XMVECTOR offsets = XMVectorSet(0.0f, step, 2.0f*step, 3.0f*step);
+
+	uint32 i = 0;
+	for(; i + 4 <= count; i += 4)
+	{
+		XMVECTOR s, c;
+		XMVectorSinCos(&s, &c, XMVectorAdd(XMVectorReplicate(i*step), offsets));
+
+		XMFLOAT4 sines, cosines;
+		XMStoreFloat4(&sines, s);
+		XMStoreFloat4(&cosines, c);
+
+		ring[i+0].TangentU = XMFLOAT3(-sines.x, 0.0f, cosines.x);
+		ring[i+1].TangentU = XMFLOAT3(-sines.y, 0.0f, cosines.y);
+		ring[i+2].TangentU = XMFLOAT3(-sines.z, 0.0f, cosines.z);
+		ring[i+3].TangentU = XMFLOAT3(-sines.w, 0.0f, cosines.w);
+	}
+
+	for(; i < count; ++i)
+	{
+		float sine, cosine;
+		XMScalarSinCos(&sine, &cosine, i*step);
+		ring[i].TangentU = XMFLOAT3(-sine, 0.0f, cosine);
+	}
+}
+
+void GeometryGenerator::ComputeBounds(MeshData& meshData)
+{
+    const XMFLOAT3* positions = meshData.Vertices.empty() ? nullptr : &meshData.Vertices[0].Position;
+    meshData.Bounds = BoundsBuilder::Compute(positions, sizeof(Vertex), (uint32)meshData.Vertices.size());
+}
+
+GeometryGenerator::MeshDataSoA GeometryGenerator::ToSoA(const MeshData& meshData)
+{
+    MeshDataSoA soa;
+
+    uint32 vertexCount = (uint32)meshData.Vertices.size();
+    soa.Positions.resize(vertexCount);
+    soa.Normals.resize(vertexCount);
+    soa.TangentUs.resize(vertexCount);
+    soa.TexCs.resize(vertexCount);
+    soa.Indices32 = meshData.Indices32;
+
+    SplitStreams(meshData.Vertices.data(), vertexCount,
+        soa.Positions.data(), soa.Normals.data(), soa.TangentUs.data(), soa.TexCs.data());
+
+    return soa;
+}
+
+void GeometryGenerator::SplitStreams(const Vertex* vertices, uint32 vertexCount,
+    XMFLOAT3* positions, XMFLOAT3* normals, XMFLOAT3* tangentUs, XMFLOAT2* texCs)
+{
+    // One pass per stream keeps every write sequential.
+    if(positions)
+    {
+        for(uint32 i = 0; i < vertexCount; ++i)
+            positions[i] = vertices[i].Position;
+    }
+
+    if(normals)
+    {
+        for(uint32 i = 0; i < vertexCount; ++i)
+            normals[i] = vertices[i].Normal;
+    }
+
+    if(tangentUs)
+    {
+        for(uint32 i = 0; i < vertexCount; ++i)
+            tangentUs[i] = vertices[i].TangentU;
+    }
+
+    if(texCs)
+    {
+        for(uint32 i = 0; i < vertexCount; ++i)
+            texCs[i] = vertices[i].TexC;
+    }
+}
@@ -14,10 +14,16 @@
 
 #pragma once
 
+#include "BoundsBuilder.h"
 #include <cstdint>
+#include <DirectXCollision.h>
 #include <DirectXMath.h>
+#include <stdexcept>
+#include <string>
 #include <vector>
 
+struct MeshGeometry;
+
 class GeometryGenerator
 {
 public:
@@ -28,7 +34,7 @@ public:
 	struct Vertex
 	{
 		Vertex(){}
-        Vertex(
+        constexpr Vertex(
             const DirectX::XMFLOAT3& p, 
             const DirectX::XMFLOAT3& n, 
             const DirectX::XMFLOAT3& t, 
@@ -37,7 +43,7 @@ public:
             Normal(n), 
             TangentU(t), 
             TexC(uv){}
-		Vertex(
+		constexpr Vertex(
 			float px, float py, float pz, 
 			float nx, float ny, float nz,
 			float tx, float ty, float tz,
@@ -58,22 +64,97 @@ public:
 		std::vector<Vertex> Vertices;
         std::vector<uint32> Indices32;
 
+        // Box, sphere and oriented box of the vertices, filled by the Create* functions.
+        // Call GeometryGenerator::ComputeBounds again after editing Vertices.
+        MeshBounds Bounds;
+
+        // 16-bit copy of Indices32, converted on first use and cached.  A change in the
+        // index count is picked up, but rewriting Indices32 in place needs a call to
+        // InvalidateIndices16 first (the MeshOptimizer passes make it themselves).
+        // Throws std::out_of_range if an index does not fit in 16 bits; split such meshes
+        // with MeshGeometryBuilder instead.
         std::vector<uint16>& GetIndices16()
         {
-			if(mIndices16.empty())
+			if(mIndices16.size() != Indices32.size())
 			{
-				mIndices16.resize(Indices32.size());
+				std::vector<uint16> indices16(Indices32.size());
 				for(size_t i = 0; i < Indices32.size(); ++i)
-					mIndices16[i] = static_cast<uint16>(Indices32[i]);
+				{
+					if(Indices32[i] > 0xffff)
+						throw std::out_of_range("MeshData::GetIndices16: index does not fit in 16 bits");
+
+					indices16[i] = static_cast<uint16>(Indices32[i]);
+				}
+
+				mIndices16.swap(indices16);
 			}
 
 			return mIndices16;
         }
 
+        // Drops the 16-bit copy made by GetIndices16, so the next call converts again.
+        void InvalidateIndices16()
+        {
+            std::vector<uint16>().swap(mIndices16);
+        }
+
 	private:
 		std::vector<uint16> mIndices16;
 	};
 
+	///<summary>
+	/// Structure-of-arrays version of MeshData.  Every attribute is its own contiguous
+	/// stream, so each can go into its own vertex buffer.  A depth-only or shadow pass
+	/// then fetches 12 bytes of Positions per vertex instead of a whole 44-byte Vertex,
+	/// and CPU-side bounds/culling code can run over a packed float3 array.
+	///</summary>
+	struct MeshDataSoA
+	{
+		std::vector<DirectX::XMFLOAT3> Positions;
+		std::vector<DirectX::XMFLOAT3> Normals;
+		std::vector<DirectX::XMFLOAT3> TangentUs;
+		std::vector<DirectX::XMFLOAT2> TexCs;
+		std::vector<uint32> Indices32;
+	};
+
+	///<summary>
+	/// Exact number of vertices and indices a Create* call writes for a set of
+	/// parameters, so storage can be sized once up front.
+	///</summary>
+	struct MeshSize
+	{
+		uint32 VertexCount = 0;
+		uint32 IndexCount = 0;
+	};
+
+	///<summary>
+	/// One tile of a tiled grid.  Its indices are 16-bit and relative to
+	/// BaseVertexLocation, so the fields map one to one onto SubmeshGeometry.  Bounds
+	/// covers the flat tile; recompute it after displacing the heights.
+	///</summary>
+	struct GridTile
+	{
+		uint32 IndexCount = 0;
+		uint32 StartIndexLocation = 0;
+		std::int32_t BaseVertexLocation = 0;
+		uint32 VertexCount = 0;
+
+		uint32 Row = 0;
+		uint32 Column = 0;
+
+		DirectX::BoundingBox Bounds;
+	};
+
+	struct TiledMeshData
+	{
+		std::vector<Vertex> Vertices;
+		std::vector<uint16> Indices16;
+		std::vector<GridTile> Tiles;
+	};
+
+	// Largest tile edge in quads that keeps (edge+1)^2 vertices addressable by 16-bit indices.
+	static const uint32 MaxGridTileQuads = 255;
+
 	///<summary>
 	/// Creates a box centered at the origin with the given dimensions, where each
     /// face has m rows and n columns of vertices.
@@ -105,15 +186,88 @@ public:
 	///</summary>
     MeshData CreateGrid(float width, float depth, uint32 m, uint32 n);
 
+	///<summary>
+	/// Same grid as CreateGrid, split into tiles of at most tileQuads x tileQuads quads.
+	/// Each tile has its own vertices (edges are duplicated between neighbors) and
+	/// 16-bit indices, and the tiles are built in parallel on ThreadPool::Get().
+	/// Works for grids far beyond 65536 vertices, e.g. a 4096x4096 terrain.
+	///</summary>
+    TiledMeshData CreateGridTiled(float width, float depth, uint32 m, uint32 n, uint32 tileQuads = MaxGridTileQuads);
+
+#if defined(_WIN32)
+	///<summary>
+	/// Adds a DrawArgs entry name_tileN (N = Row*columns + Column) per tile, for tiles
+	/// whose vertices and indices were copied into geometry at baseVertexLocation and
+	/// startIndexLocation.
+	///</summary>
+    static void AddGridTileSubmeshes(MeshGeometry& geometry, const std::string& name, const TiledMeshData& grid,
+                                     uint32 startIndexLocation, std::int32_t baseVertexLocation);
+#endif
+
 	///<summary>
 	/// Creates a quad aligned with the screen.  This is useful for postprocessing and screen effects.
 	///</summary>
     MeshData CreateQuad(float x, float y, float w, float h, float depth);
 
+	///<summary>
+	/// Streaming versions of the Create* functions above.  They write exactly
+	/// Get*Size() vertices and indices into caller-provided storage (for example a
+	/// mapped upload buffer, a pooled arena or an ID3DBlob) and never allocate.
+	///</summary>
+    void CreateSphere(float radius, uint32 sliceCount, uint32 stackCount, Vertex* vertices, uint32* indices);
+    void CreateGeosphere(float radius, uint32 numSubdivisions, Vertex* vertices, uint32* indices);
+    void CreateCylinder(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, Vertex* vertices, uint32* indices);
+    void CreateGrid(float width, float depth, uint32 m, uint32 n, Vertex* vertices, uint32* indices);
+    void CreateQuad(float x, float y, float w, float h, float depth, Vertex* vertices, uint32* indices);
+
+	///<summary>
+	/// Returns the exact vertex/index counts of the matching Create* call.
+	///</summary>
+    static MeshSize GetBoxSize(uint32 numSubdivisions);
+    static MeshSize GetSphereSize(uint32 sliceCount, uint32 stackCount);
+    static MeshSize GetGeosphereSize(uint32 numSubdivisions);
+    static MeshSize GetCylinderSize(uint32 sliceCount, uint32 stackCount);
+    static MeshSize GetGridSize(uint32 m, uint32 n);
+    static MeshSize GetQuadSize();
+
+	///<summary>
+	/// Radius 1 geosphere shared by every CreateGeosphere call at that level.  It is
+	/// built once per process (thread-safe) and never changes, so many geospheres of one
+	/// level can also share a single GPU buffer and get their radius from the world matrix.
+	///</summary>
+    static const MeshData& GetUnitGeosphere(uint32 numSubdivisions);
+
+	///<summary>
+	/// Recomputes meshData.Bounds from its vertices with BoundsBuilder.
+	///</summary>
+    static void ComputeBounds(MeshData& meshData);
+
+	///<summary>
+	/// Converts an interleaved mesh to the structure-of-arrays layout.
+	///</summary>
+    static MeshDataSoA ToSoA(const MeshData& meshData);
+
+	///<summary>
+	/// Splits interleaved vertices into separate attribute streams.  Any output pointer
+	/// can be null to skip that stream, e.g. to write only positions into a mapped buffer.
+	///</summary>
+    static void SplitStreams(const Vertex* vertices, uint32 vertexCount,
+        DirectX::XMFLOAT3* positions, DirectX::XMFLOAT3* normals,
+        DirectX::XMFLOAT3* tangentUs, DirectX::XMFLOAT2* texCs);
+
 private:
-	void Subdivide(MeshData& meshData);
-    Vertex MidPoint(const Vertex& v0, const Vertex& v1);
-    void BuildCylinderTopCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData);
-    void BuildCylinderBottomCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount, MeshData& meshData);
+	static void Subdivide(MeshData& meshData);
+    static Vertex MidPoint(const Vertex& v0, const Vertex& v1);
+    static MeshData BuildUnitGeosphere(uint32 numSubdivisions);
+    void BuildCylinderTopCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount,
+                             const Vertex* sideRing,
+                             uint32 baseIndex, Vertex* vertices, uint32* indices);
+    void BuildCylinderBottomCap(float bottomRadius, float topRadius, float height, uint32 sliceCount, uint32 stackCount,
+                                const Vertex* sideRing,
+                                uint32 baseIndex, Vertex* vertices, uint32* indices);
+
+    // ring[i].TangentU = (-sin(i*step), 0, cos(i*step)) for i < count, four angles at a
+    // time.  The ring generators read their slice angles back from these tangents.
+    static void BuildSliceTangents(uint32 count, float step, Vertex* ring);
 };
 
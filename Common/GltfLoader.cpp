@@ -0,0 +1,1043 @@
+//***************************************************************************************
+// GltfLoader.cpp
+//***************************************************************************************
+
+#include "GltfLoader.h"
+#include "TangentGenerator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <charconv>
+#include <cstddef>
+#include <cstring>
+
+#if defined(_WIN32)
+#include "d3dUtil.h"
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+    using Vertex = GeometryGenerator::Vertex;
+
+    const uint32 GlbMagic = 0x46546C67;     // "glTF"
+    const uint32 JsonChunkType = 0x4E4F534A; // "JSON"
+    const uint32 BinChunkType = 0x004E4942;  // "BIN\0"
+
+    const int MaxJsonDepth = 64;
+
+    //
+    // Minimal JSON document, enough for the glTF scene description.
+    //
+
+    struct JsonValue
+    {
+        enum class Type { Null, Bool, Number, String, Array, Object };
+
+        Type Kind = Type::Null;
+        bool Bool = false;
+        double Number = 0.0;
+        std::string String;
+
+        // Array elements, or object values with their names in Keys.
+        std::vector<JsonValue> Items;
+        std::vector<std::string> Keys;
+
+        const JsonValue* Find(const char* key) const
+        {
+            for(size_t i = 0; i < Keys.size(); ++i)
+            {
+                if(Keys[i] == key)
+                    return &Items[i];
+            }
+            return nullptr;
+        }
+
+        const JsonValue* FindArray(const char* key) const
+        {
+            const JsonValue* value = Find(key);
+            return value != nullptr && value->Kind == Type::Array ? value : nullptr;
+        }
+
+        double GetNumber(const char* key, double fallback) const
+        {
+            const JsonValue* value = Find(key);
+            return value != nullptr && value->Kind == Type::Number ? value->Number : fallback;
+        }
+
+        int GetInt(const char* key, int fallback) const
+        {
+            return (int)GetNumber(key, fallback);
+        }
+
+        std::string GetString(const char* key) const
+        {
+            const JsonValue* value = Find(key);
+            return value != nullptr && value->Kind == Type::String ? value->String : std::string();
+        }
+    };
+
+    class JsonParser
+    {
+    public:
+        JsonParser(const char* begin, const char* end) : mP(begin), mEnd(end) { }
+
+        bool Parse(JsonValue& value)
+        {
+            if(!ParseValue(value, 0))
+                return false;
+
+            SkipSpaces();
+            return mP == mEnd;
+        }
+
+    private:
+        void SkipSpaces()
+        {
+            while(mP < mEnd && (*mP == ' ' || *mP == '\t' || *mP == '\n' || *mP == '\r'))
+                ++mP;
+        }
+
+        bool Match(const char* literal)
+        {
+            size_t length = std::strlen(literal);
+            if((size_t)(mEnd - mP) < length || std::memcmp(mP, literal, length) != 0)
+                return false;
+
+            mP += length;
+            return true;
+        }
+
+        static void AppendUtf8(std::string& s, uint32 c)
+        {
+            if(c < 0x80)
+                s += (char)c;
+            else if(c < 0x800)
+            {
+                s += (char)(0xC0 | (c >> 6));
+                s += (char)(0x80 | (c & 0x3F));
+            }
+            else if(c < 0x10000)
+            {
+                s += (char)(0xE0 | (c >> 12));
+                s += (char)(0x80 | ((c >> 6) & 0x3F));
+                s += (char)(0x80 | (c & 0x3F));
+            }
+            else
+            {
+                s += (char)(0xF0 | (c >> 18));
+                s += (char)(0x80 | ((c >> 12) & 0x3F));
+                s += (char)(0x80 | ((c >> 6) & 0x3F));
+                s += (char)(0x80 | (c & 0x3F));
+            }
+        }
+
+        bool ParseHex4(uint32& c)
+        {
+            if(mEnd - mP < 4)
+                return false;
+
+            auto result = std::from_chars(mP, mP + 4, c, 16);
+            if(result.ec != std::errc() || result.ptr != mP + 4)
+                return false;
+
+            mP += 4;
+            return true;
+        }
+
+        bool ParseString(std::string& s)
+        {
+            if(mP == mEnd || *mP != '"')
+                return false;
+            ++mP;
+
+            for(;;)
+            {
+                const char* run = mP;
+                while(mP < mEnd && *mP != '"' && *mP != '\\')
+                    ++mP;
+                s.append(run, mP);
+
+                if(mP == mEnd)
+                    return false;
+                if(*mP++ == '"')
+                    return true;
+                if(mP == mEnd)
+                    return false;
+
+                char escape = *mP++;
+                switch(escape)
+                {
+                case '"': case '\\': case '/': s += escape; break;
+                case 'b': s += '\b'; break;
+                case 'f': s += '\f'; break;
+                case 'n': s += '\n'; break;
+                case 'r': s += '\r'; break;
+                case 't': s += '\t'; break;
+                case 'u':
+                {
+                    uint32 c = 0;
+                    if(!ParseHex4(c))
+                        return false;
+
+                    // Surrogate pair.
+                    if(c >= 0xD800 && c < 0xDC00 && Match("\\u"))
+                    {
+                        uint32 low = 0;
+                        if(!ParseHex4(low) || low < 0xDC00 || low >= 0xE000)
+                            return false;
+                        c = 0x10000 + ((c - 0xD800) << 10) + (low - 0xDC00);
+                    }
+
+                    AppendUtf8(s, c);
+                    break;
+                }
+                default:
+                    return false;
+                }
+            }
+        }
+
+        bool ParseValue(JsonValue& value, int depth)
+        {
+            if(depth > MaxJsonDepth)
+                return false;
+
+            SkipSpaces();
+            if(mP == mEnd)
+                return false;
+
+            switch(*mP)
+            {
+            case '{':
+            {
+                value.Kind = JsonValue::Type::Object;
+                ++mP;
+                SkipSpaces();
+                if(mP < mEnd && *mP == '}')
+                {
+                    ++mP;
+                    return true;
+                }
+
+                for(;;)
+                {
+                    SkipSpaces();
+                    value.Keys.emplace_back();
+                    if(!ParseString(value.Keys.back()))
+                        return false;
+
+                    SkipSpaces();
+                    if(mP == mEnd || *mP++ != ':')
+                        return false;
+
+                    value.Items.emplace_back();
+                    if(!ParseValue(value.Items.back(), depth + 1))
+                        return false;
+
+                    SkipSpaces();
+                    if(mP == mEnd)
+                        return false;
+                    if(*mP == '}')
+                    {
+                        ++mP;
+                        return true;
+                    }
+                    if(*mP++ != ',')
+                        return false;
+                }
+            }
+            case '[':
+            {
+                value.Kind = JsonValue::Type::Array;
+                ++mP;
+                SkipSpaces();
+                if(mP < mEnd && *mP == ']')
+                {
+                    ++mP;
+                    return true;
+                }
+
+                for(;;)
+                {
+                    value.Items.emplace_back();
+                    if(!ParseValue(value.Items.back(), depth + 1))
+                        return false;
+
+                    SkipSpaces();
+                    if(mP == mEnd)
+                        return false;
+                    if(*mP == ']')
+                    {
+                        ++mP;
+                        return true;
+                    }
+                    if(*mP++ != ',')
+                        return false;
+                }
+            }
+            case '"':
+                value.Kind = JsonValue::Type::String;
+                return ParseString(value.String);
+            case 't':
+                value.Kind = JsonValue::Type::Bool;
+                value.Bool = true;
+                return Match("true");
+            case 'f':
+                value.Kind = JsonValue::Type::Bool;
+                return Match("false");
+            case 'n':
+                return Match("null");
+            default:
+            {
+                value.Kind = JsonValue::Type::Number;
+                auto result = std::from_chars(mP, mEnd, value.Number);
+                if(result.ec != std::errc())
+                    return false;
+
+                mP = result.ptr;
+                return true;
+            }
+            }
+        }
+
+        const char* mP;
+        const char* mEnd;
+    };
+
+    //
+    // Accessor helpers.
+    //
+
+    uint32 GetComponentSize(uint32 componentType)
+    {
+        switch(componentType)
+        {
+        case GltfLoader::Byte:
+        case GltfLoader::UnsignedByte: return 1;
+        case GltfLoader::Short:
+        case GltfLoader::UnsignedShort: return 2;
+        case GltfLoader::UnsignedInt:
+        case GltfLoader::Float: return 4;
+        default: return 0;
+        }
+    }
+
+    uint32 GetComponentCount(const std::string& type)
+    {
+        if(type == "SCALAR") return 1;
+        if(type == "VEC2") return 2;
+        if(type == "VEC3") return 3;
+        if(type == "VEC4") return 4;
+        if(type == "MAT2") return 4;
+        if(type == "MAT3") return 9;
+        if(type == "MAT4") return 16;
+        return 0;
+    }
+
+    bool IsFloat3(const GltfLoader::Accessor& accessor)
+    {
+        return accessor.ComponentType == GltfLoader::Float && accessor.ComponentCount == 3;
+    }
+
+    // Writes a primitive's triangle list with the second and third index of every
+    // triangle swapped, so the triangles are clockwise after GetToLeftHanded().
+    template<typename T>
+    void WriteIndices(const GltfLoader::Accessor* indices, uint32 vertexCount, T* dest)
+    {
+        uint32 count = indices != nullptr ? indices->Count : vertexCount;
+        for(uint32 i = 0; i < count; ++i)
+            dest[i] = (T)(indices != nullptr ? indices->ReadIndex(i) : i);
+
+        for(uint32 i = 0; i + 2 < count; i += 3)
+            std::swap(dest[i+1], dest[i+2]);
+    }
+
+    // Repacks a primitive into engine vertices, generating tangents when the file has
+    // none but has normals and uvs.
+    void WriteVertices(const std::vector<GltfLoader::Accessor>& accessors, const GltfLoader::Primitive& primitive,
+                       Vertex* vertices)
+    {
+        const GltfLoader::Accessor& positions = accessors[primitive.Position];
+        const GltfLoader::Accessor* normals = primitive.Normal >= 0 ? &accessors[primitive.Normal] : nullptr;
+        const GltfLoader::Accessor* tangents = primitive.Tangent >= 0 ? &accessors[primitive.Tangent] : nullptr;
+        const GltfLoader::Accessor* texCs = primitive.TexC >= 0 ? &accessors[primitive.TexC] : nullptr;
+
+        for(uint32 i = 0; i < positions.Count; ++i)
+        {
+            Vertex& v = vertices[i];
+            v.Position = XMFLOAT3(0.0f, 0.0f, 0.0f);
+            v.Normal = XMFLOAT3(0.0f, 0.0f, 0.0f);
+            v.TangentU = XMFLOAT3(0.0f, 0.0f, 0.0f);
+            v.TexC = XMFLOAT2(0.0f, 0.0f);
+
+            positions.ReadFloats(i, &v.Position.x, 3);
+            if(normals != nullptr)
+                normals->ReadFloats(i, &v.Normal.x, 3);
+            if(tangents != nullptr)
+                tangents->ReadFloats(i, &v.TangentU.x, 3);
+            if(texCs != nullptr)
+                texCs->ReadFloats(i, &v.TexC.x, 2);
+        }
+
+        if(tangents == nullptr && normals != nullptr && texCs != nullptr)
+        {
+            uint32 vertexCount = positions.Count;
+            const GltfLoader::Accessor* indexAccessor = primitive.Indices >= 0 ? &accessors[primitive.Indices] : nullptr;
+
+            std::vector<uint32> indices(indexAccessor != nullptr ? indexAccessor->Count : vertexCount);
+            WriteIndices(indexAccessor, vertexCount, indices.data());
+
+            std::vector<XMFLOAT4> generated(vertexCount);
+            TangentGenerator::Generate(&vertices[0].Position, sizeof(Vertex), &vertices[0].Normal, sizeof(Vertex),
+                &vertices[0].TexC, sizeof(Vertex), vertexCount, indices.data(), (uint32)indices.size(), generated.data());
+
+            for(uint32 i = 0; i < vertexCount; ++i)
+                vertices[i].TangentU = XMFLOAT3(generated[i].x, generated[i].y, generated[i].z);
+        }
+    }
+}
+
+uint32 GltfLoader::Accessor::GetElementSize() const
+{
+    return GetComponentSize(ComponentType)*ComponentCount;
+}
+
+GltfLoader::uint64 GltfLoader::Accessor::GetByteSize() const
+{
+    return Count == 0 ? 0 : (uint64)(Count - 1)*ByteStride + GetElementSize();
+}
+
+void GltfLoader::Accessor::ReadFloats(uint32 index, float* values, uint32 count) const
+{
+    const std::uint8_t* element = Data + (size_t)index*ByteStride;
+    count = std::min(count, ComponentCount);
+
+    for(uint32 c = 0; c < count; ++c)
+    {
+        switch(ComponentType)
+        {
+        case Float:
+            std::memcpy(&values[c], element + c*4, 4);
+            break;
+        case UnsignedByte:
+        {
+            std::uint8_t x = element[c];
+            values[c] = Normalized ? x/255.0f : (float)x;
+            break;
+        }
+        case Byte:
+        {
+            std::int8_t x = (std::int8_t)element[c];
+            values[c] = Normalized ? std::max(x/127.0f, -1.0f) : (float)x;
+            break;
+        }
+        case UnsignedShort:
+        {
+            std::uint16_t x;
+            std::memcpy(&x, element + c*2, 2);
+            values[c] = Normalized ? x/65535.0f : (float)x;
+            break;
+        }
+        case Short:
+        {
+            std::int16_t x;
+            std::memcpy(&x, element + c*2, 2);
+            values[c] = Normalized ? std::max(x/32767.0f, -1.0f) : (float)x;
+            break;
+        }
+        case UnsignedInt:
+        {
+            uint32 x;
+            std::memcpy(&x, element + c*4, 4);
+            values[c] = (float)x;
+            break;
+        }
+        }
+    }
+}
+
+GltfLoader::uint32 GltfLoader::Accessor::ReadIndex(uint32 index) const
+{
+    const std::uint8_t* element = Data + (size_t)index*ByteStride;
+
+    switch(ComponentType)
+    {
+    case UnsignedByte:
+        return element[0];
+    case UnsignedShort:
+    {
+        std::uint16_t x;
+        std::memcpy(&x, element, 2);
+        return x;
+    }
+    case UnsignedInt:
+    {
+        uint32 x;
+        std::memcpy(&x, element, 4);
+        return x;
+    }
+    default:
+        return 0;
+    }
+}
+
+bool GltfLoader::Open(const std::filesystem::path& filename, std::string* error)
+{
+    mAccessors.clear();
+    mMeshes.clear();
+    mMaterials.clear();
+    mImages.clear();
+
+    auto fail = [&](const std::string& message)
+    {
+        if(error != nullptr)
+            *error = message;
+        mFile.Close();
+        return false;
+    };
+
+    if(!mFile.Open(filename))
+        return fail("cannot open " + filename.string());
+
+    //
+    // Header and chunks.
+    //
+
+    const std::uint8_t* file = mFile.GetData();
+    uint64 fileSize = mFile.GetSize();
+
+    uint32 header[3] = {};
+    if(fileSize < 20)
+        return fail("not a .glb file");
+    std::memcpy(header, file, sizeof(header));
+    if(header[0] != GlbMagic || header[1] != 2 || header[2] > fileSize)
+        return fail("not a glTF 2.0 binary file");
+
+    const char* json = nullptr;
+    uint64 jsonSize = 0;
+    const std::uint8_t* bin = nullptr;
+    uint64 binSize = 0;
+
+    for(uint64 offset = 12; offset + 8 <= header[2]; )
+    {
+        uint32 chunk[2];
+        std::memcpy(chunk, file + offset, sizeof(chunk));
+        offset += 8;
+        if(offset + chunk[0] > header[2])
+            return fail("truncated chunk");
+
+        if(chunk[1] == JsonChunkType && json == nullptr)
+        {
+            json = reinterpret_cast<const char*>(file + offset);
+            jsonSize = chunk[0];
+        }
+        else if(chunk[1] == BinChunkType && bin == nullptr)
+        {
+            bin = file + offset;
+            binSize = chunk[0];
+        }
+
+        offset += chunk[0];
+    }
+
+    JsonValue document;
+    if(json == nullptr || !JsonParser(json, json + jsonSize).Parse(document) || document.Kind != JsonValue::Type::Object)
+        return fail("invalid JSON chunk");
+
+    //
+    // Buffers and buffer views.  Only the binary chunk (a buffer without uri) is
+    // available; views of external buffers resolve to nothing.
+    //
+
+    struct View
+    {
+        const std::uint8_t* Data = nullptr;
+        uint64 Size = 0;
+        uint32 ByteStride = 0;
+    };
+
+    std::vector<uint64> bufferSizes;
+    if(const JsonValue* buffers = document.FindArray("buffers"))
+    {
+        for(const JsonValue& buffer : buffers->Items)
+        {
+            bool embedded = bufferSizes.empty() && buffer.Find("uri") == nullptr;
+            uint64 byteLength = (uint64)buffer.GetNumber("byteLength", 0);
+            if(embedded && byteLength > binSize)
+                return fail("buffer 0 is larger than the binary chunk");
+
+            bufferSizes.push_back(embedded ? byteLength : 0);
+        }
+    }
+
+    std::vector<View> views;
+    if(const JsonValue* bufferViews = document.FindArray("bufferViews"))
+    {
+        for(const JsonValue& bufferView : bufferViews->Items)
+        {
+            int buffer = bufferView.GetInt("buffer", -1);
+            uint64 byteOffset = (uint64)bufferView.GetNumber("byteOffset", 0);
+            uint64 byteLength = (uint64)bufferView.GetNumber("byteLength", 0);
+
+            View view;
+            if(buffer >= 0 && buffer < (int)bufferSizes.size() && bufferSizes[buffer] > 0)
+            {
+                if(byteOffset + byteLength > bufferSizes[buffer])
+                    return fail("buffer view outside its buffer");
+
+                view.Data = bin + byteOffset;
+                view.Size = byteLength;
+            }
+            view.ByteStride = (uint32)bufferView.GetInt("byteStride", 0);
+            views.push_back(view);
+        }
+    }
+
+    //
+    // Accessors.
+    //
+
+    if(const JsonValue* accessors = document.FindArray("accessors"))
+    {
+        for(const JsonValue& value : accessors->Items)
+        {
+            Accessor accessor;
+            accessor.ComponentType = (uint32)value.GetInt("componentType", 0);
+            accessor.ComponentCount = GetComponentCount(value.GetString("type"));
+            accessor.Count = (uint32)value.GetNumber("count", 0);
+            if(const JsonValue* normalized = value.Find("normalized"))
+                accessor.Normalized = normalized->Bool;
+
+            int viewIndex = value.GetInt("bufferView", -1);
+            if(value.Find("sparse") != nullptr)
+                return fail("sparse accessors are not supported");
+            if(accessor.GetElementSize() == 0)
+                return fail("accessor with an unknown type");
+
+            if(viewIndex >= 0 && viewIndex < (int)views.size() && views[viewIndex].Data != nullptr)
+            {
+                const View& view = views[viewIndex];
+                uint64 byteOffset = (uint64)value.GetNumber("byteOffset", 0);
+
+                accessor.Data = view.Data + byteOffset;
+                accessor.ByteStride = view.ByteStride != 0 ? view.ByteStride : accessor.GetElementSize();
+                if(byteOffset + accessor.GetByteSize() > view.Size)
+                    return fail("accessor outside its buffer view");
+            }
+            else
+            {
+                accessor.ByteStride = accessor.GetElementSize();
+                accessor.Count = 0;
+            }
+
+            mAccessors.push_back(accessor);
+        }
+    }
+
+    auto findAccessor = [&](const JsonValue* object, const char* key) -> int
+    {
+        int index = object != nullptr ? object->GetInt(key, -1) : -1;
+        return index >= 0 && index < (int)mAccessors.size() ? index : -1;
+    };
+
+    //
+    // Meshes.  Non-triangle primitives are dropped; the rest are checked so that a bad
+    // index fails here rather than on the GPU.
+    //
+
+    if(const JsonValue* meshes = document.FindArray("meshes"))
+    {
+        for(const JsonValue& value : meshes->Items)
+        {
+            Mesh mesh;
+            mesh.Name = value.GetString("name");
+
+            if(const JsonValue* primitives = value.FindArray("primitives"))
+            {
+                for(const JsonValue& primitiveValue : primitives->Items)
+                {
+                    const JsonValue* attributes = primitiveValue.Find("attributes");
+
+                    Primitive primitive;
+                    primitive.Position = findAccessor(attributes, "POSITION");
+                    primitive.Normal = findAccessor(attributes, "NORMAL");
+                    primitive.Tangent = findAccessor(attributes, "TANGENT");
+                    primitive.TexC = findAccessor(attributes, "TEXCOORD_0");
+                    primitive.Indices = findAccessor(&primitiveValue, "indices");
+                    primitive.Material = primitiveValue.GetInt("material", -1);
+
+                    if(primitiveValue.GetInt("mode", 4) != 4 || primitive.Position < 0)
+                        continue;
+
+                    const Accessor& positions = mAccessors[primitive.Position];
+                    if(!IsFloat3(positions))
+                        return fail("POSITION must be float3");
+
+                    for(int attribute : { primitive.Normal, primitive.Tangent, primitive.TexC })
+                    {
+                        if(attribute >= 0 && mAccessors[attribute].Count != positions.Count)
+                            return fail("attribute count differs from POSITION");
+                    }
+
+                    if(primitive.Indices >= 0)
+                    {
+                        const Accessor& indices = mAccessors[primitive.Indices];
+                        if(indices.ComponentCount != 1 || indices.ComponentType == Byte ||
+                           indices.ComponentType == Short || indices.ComponentType == Float)
+                            return fail("indices must be unsigned integers");
+
+                        for(uint32 i = 0; i < indices.Count; ++i)
+                        {
+                            if(indices.ReadIndex(i) >= positions.Count)
+                                return fail("index out of range");
+                        }
+                    }
+
+                    mesh.Primitives.push_back(primitive);
+                }
+            }
+
+            mMeshes.push_back(std::move(mesh));
+        }
+    }
+
+    //
+    // Images, textures and materials.
+    //
+
+    if(const JsonValue* images = document.FindArray("images"))
+    {
+        for(const JsonValue& value : images->Items)
+        {
+            Image image;
+            image.Name = value.GetString("name");
+            image.MimeType = value.GetString("mimeType");
+            image.Uri = value.GetString("uri");
+
+            int viewIndex = value.GetInt("bufferView", -1);
+            if(viewIndex >= 0 && viewIndex < (int)views.size())
+            {
+                image.Data = views[viewIndex].Data;
+                image.Size = image.Data != nullptr ? views[viewIndex].Size : 0;
+            }
+
+            mImages.push_back(image);
+        }
+    }
+
+    std::vector<int> textureImages;
+    if(const JsonValue* textures = document.FindArray("textures"))
+    {
+        for(const JsonValue& value : textures->Items)
+        {
+            int source = value.GetInt("source", -1);
+            textureImages.push_back(source < (int)mImages.size() ? source : -1);
+        }
+    }
+
+    auto findImage = [&](const JsonValue* textureInfo)
+    {
+        int texture = textureInfo != nullptr ? textureInfo->GetInt("index", -1) : -1;
+        return texture >= 0 && texture < (int)textureImages.size() ? textureImages[texture] : -1;
+    };
+
+    if(const JsonValue* materials = document.FindArray("materials"))
+    {
+        for(const JsonValue& value : materials->Items)
+        {
+            MaterialDesc material;
+            material.Name = value.GetString("name");
+            material.NormalImage = findImage(value.Find("normalTexture"));
+
+            if(const JsonValue* pbr = value.Find("pbrMetallicRoughness"))
+            {
+                if(const JsonValue* factor = pbr->FindArray("baseColorFactor"))
+                {
+                    float* color = &material.BaseColorFactor.x;
+                    for(size_t i = 0; i < 4 && i < factor->Items.size(); ++i)
+                        color[i] = (float)factor->Items[i].Number;
+                }
+
+                material.MetallicFactor = (float)pbr->GetNumber("metallicFactor", 1.0);
+                material.RoughnessFactor = (float)pbr->GetNumber("roughnessFactor", 1.0);
+                material.BaseColorImage = findImage(pbr->Find("baseColorTexture"));
+            }
+
+            mMaterials.push_back(material);
+        }
+    }
+
+    for(const Mesh& mesh : mMeshes)
+    {
+        for(const Primitive& primitive : mesh.Primitives)
+        {
+            if(primitive.Material < -1 || primitive.Material >= (int)mMaterials.size())
+                return fail("material out of range");
+        }
+    }
+
+    return true;
+}
+
+bool GltfLoader::MatchesVertexLayout(const Primitive& primitive) const
+{
+    if(primitive.Position < 0 || primitive.Normal < 0 || primitive.Tangent < 0 || primitive.TexC < 0)
+        return false;
+
+    const Accessor& positions = mAccessors[primitive.Position];
+    const Accessor& normals = mAccessors[primitive.Normal];
+    const Accessor& tangents = mAccessors[primitive.Tangent];
+    const Accessor& texCs = mAccessors[primitive.TexC];
+
+    auto matches = [&](const Accessor& accessor, uint32 componentCount, size_t offset)
+    {
+        return accessor.ComponentType == Float && accessor.ComponentCount == componentCount &&
+               accessor.ByteStride == sizeof(Vertex) && accessor.Data == positions.Data + offset;
+    };
+
+    return matches(positions, 3, offsetof(Vertex, Position)) && matches(normals, 3, offsetof(Vertex, Normal)) &&
+           matches(tangents, 3, offsetof(Vertex, TangentU)) && matches(texCs, 2, offsetof(Vertex, TexC));
+}
+
+GeometryGenerator::MeshData GltfLoader::GetMeshData(const Primitive& primitive) const
+{
+    GeometryGenerator::MeshData meshData;
+    if(primitive.Position < 0)
+        return meshData;
+
+    uint32 vertexCount = mAccessors[primitive.Position].Count;
+    const Accessor* indices = primitive.Indices >= 0 ? &mAccessors[primitive.Indices] : nullptr;
+
+    meshData.Vertices.resize(vertexCount);
+    if(vertexCount > 0)
+        WriteVertices(mAccessors, primitive, meshData.Vertices.data());
+
+    meshData.Indices32.resize(indices != nullptr ? indices->Count : vertexCount);
+    WriteIndices(indices, vertexCount, meshData.Indices32.data());
+
+    GeometryGenerator::ComputeBounds(meshData);
+
+    return meshData;
+}
+
+XMFLOAT4X4 GltfLoader::GetToLeftHanded()
+{
+    return XMFLOAT4X4(
+        1.0f, 0.0f,  0.0f, 0.0f,
+        0.0f, 1.0f,  0.0f, 0.0f,
+        0.0f, 0.0f, -1.0f, 0.0f,
+        0.0f, 0.0f,  0.0f, 1.0f);
+}
+
+#if defined(_WIN32)
+namespace
+{
+    // First byte of the accessors if they are all of one type, ByteStride apart, and each
+    // one starts right where the previous one ends; nullptr otherwise.
+    const std::uint8_t* FindContiguous(const std::vector<const GltfLoader::Accessor*>& accessors,
+                                       uint32 componentType, uint32 componentCount, uint32 byteStride)
+    {
+        if(accessors.empty())
+            return nullptr;
+
+        for(size_t i = 0; i < accessors.size(); ++i)
+        {
+            const GltfLoader::Accessor* accessor = accessors[i];
+            if(accessor == nullptr || accessor->ComponentType != componentType ||
+               accessor->ComponentCount != componentCount || accessor->ByteStride != byteStride)
+                return nullptr;
+
+            if(i > 0 && accessor->Data != accessors[i-1]->Data + (size_t)accessors[i-1]->Count*byteStride)
+                return nullptr;
+        }
+
+        return accessors[0]->Data;
+    }
+}
+
+std::unique_ptr<MeshGeometry> GltfLoader::BuildGeometry(const std::string& name, ID3D12Device* device,
+                                                        ID3D12GraphicsCommandList* cmdList, bool cpuCopies) const
+{
+    struct Draw
+    {
+        const Primitive* Source = nullptr;
+        std::string Name;
+        uint32 VertexCount = 0;
+        uint32 IndexCount = 0;
+        uint32 BaseVertexLocation = 0;
+        uint32 StartIndexLocation = 0;
+    };
+
+    //
+    // Lay the primitives out one after another.
+    //
+
+    std::vector<Draw> draws;
+    uint32 vertexCount = 0;
+    uint32 indexCount = 0;
+    bool use16Bit = true;
+
+    for(size_t m = 0; m < mMeshes.size(); ++m)
+    {
+        const Mesh& mesh = mMeshes[m];
+        std::string meshName = mesh.Name.empty() ? "mesh" + std::to_string(m) : mesh.Name;
+
+        for(size_t p = 0; p < mesh.Primitives.size(); ++p)
+        {
+            const Primitive& primitive = mesh.Primitives[p];
+            const Accessor* indices = primitive.Indices >= 0 ? &mAccessors[primitive.Indices] : nullptr;
+
+            Draw draw;
+            draw.Source = &primitive;
+            draw.Name = mesh.Primitives.size() == 1 ? meshName : meshName + "_" + std::to_string(p);
+            draw.VertexCount = mAccessors[primitive.Position].Count;
+            draw.IndexCount = indices != nullptr ? indices->Count : draw.VertexCount;
+            draw.BaseVertexLocation = vertexCount;
+            draw.StartIndexLocation = indexCount;
+
+            if(indices != nullptr ? indices->ComponentType == UnsignedInt : draw.VertexCount > 65536)
+                use16Bit = false;
+
+            vertexCount += draw.VertexCount;
+            indexCount += draw.IndexCount;
+            draws.push_back(draw);
+        }
+    }
+
+    std::vector<const Accessor*> positionAccessors;
+    std::vector<const Accessor*> indexAccessors;
+    bool interleaved = true;
+    for(const Draw& draw : draws)
+    {
+        positionAccessors.push_back(&mAccessors[draw.Source->Position]);
+        indexAccessors.push_back(draw.Source->Indices >= 0 ? &mAccessors[draw.Source->Indices] : nullptr);
+        interleaved = interleaved && MatchesVertexLayout(*draw.Source);
+    }
+
+    const UINT vbByteSize = vertexCount*(UINT)sizeof(Vertex);
+    const UINT positionByteSize = vertexCount*(UINT)sizeof(XMFLOAT3);
+    const UINT indexByteSize = indexCount*(use16Bit ? 2 : 4);
+
+    //
+    // Use each stream in place when its layout is already right, otherwise repack it.
+    //
+
+    std::vector<Vertex> packedVertices;
+    const void* vertexData = interleaved ? FindContiguous(positionAccessors, Float, 3, sizeof(Vertex)) : nullptr;
+    if(vertexData == nullptr)
+    {
+        packedVertices.resize(vertexCount);
+        ThreadPool::Get().ParallelFor((uint32)draws.size(), [&](uint32 i)
+        {
+            if(draws[i].VertexCount > 0)
+                WriteVertices(mAccessors, *draws[i].Source, &packedVertices[draws[i].BaseVertexLocation]);
+        });
+        vertexData = packedVertices.data();
+    }
+
+    std::vector<XMFLOAT3> packedPositions;
+    const void* positionData = FindContiguous(positionAccessors, Float, 3, sizeof(XMFLOAT3));
+    if(positionData == nullptr)
+    {
+        packedPositions.resize(vertexCount);
+        GeometryGenerator::SplitStreams(static_cast<const Vertex*>(vertexData), vertexCount,
+            packedPositions.data(), nullptr, nullptr, nullptr);
+        positionData = packedPositions.data();
+    }
+
+    // Indices are always repacked: the winding changes (see GltfLoader.h).
+    std::vector<std::uint16_t> packedIndices16;
+    std::vector<uint32> packedIndices32;
+    if(use16Bit)
+        packedIndices16.resize(indexCount);
+    else
+        packedIndices32.resize(indexCount);
+
+    for(size_t i = 0; i < draws.size(); ++i)
+    {
+        if(use16Bit)
+            WriteIndices(indexAccessors[i], draws[i].VertexCount, packedIndices16.data() + draws[i].StartIndexLocation);
+        else
+            WriteIndices(indexAccessors[i], draws[i].VertexCount, packedIndices32.data() + draws[i].StartIndexLocation);
+    }
+
+    const void* indexData = use16Bit ? (const void*)packedIndices16.data() : (const void*)packedIndices32.data();
+
+    //
+    // Buffers.
+    //
+
+    auto geo = std::make_unique<MeshGeometry>();
+    geo->Name = name;
+
+    if(cpuCopies)
+    {
+        ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
+        CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), vertexData, vbByteSize);
+
+        ThrowIfFailed(D3DCreateBlob(indexByteSize, &geo->IndexBufferCPU));
+        CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indexData, indexByteSize);
+
+        ThrowIfFailed(D3DCreateBlob(positionByteSize, &geo->PositionBufferCPU));
+        CopyMemory(geo->PositionBufferCPU->GetBufferPointer(), positionData, positionByteSize);
+    }
+
+    geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(device, cmdList, vertexData, vbByteSize, geo->VertexBufferUploader);
+    geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(device, cmdList, indexData, indexByteSize, geo->IndexBufferUploader);
+    geo->PositionBufferGPU = d3dUtil::CreateDefaultBuffer(device, cmdList, positionData, positionByteSize, geo->PositionBufferUploader);
+
+    geo->VertexByteStride = sizeof(Vertex);
+    geo->VertexBufferByteSize = vbByteSize;
+    geo->IndexFormat = use16Bit ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    geo->IndexBufferByteSize = indexByteSize;
+    geo->PositionByteStride = sizeof(XMFLOAT3);
+    geo->PositionBufferByteSize = positionByteSize;
+
+    const XMFLOAT3* positions = static_cast<const XMFLOAT3*>(positionData);
+    for(const Draw& draw : draws)
+    {
+        SubmeshGeometry submesh;
+        submesh.IndexCount = draw.IndexCount;
+        submesh.StartIndexLocation = draw.StartIndexLocation;
+        submesh.BaseVertexLocation = (INT)draw.BaseVertexLocation;
+        submesh.MaterialIndex = draw.Source->Material;
+
+        if(draw.VertexCount > 0)
+            BoundsBuilder::Apply(BoundsBuilder::Compute(positions + draw.BaseVertexLocation, sizeof(XMFLOAT3), draw.VertexCount), submesh);
+
+        geo->DrawArgs[draw.Name] = submesh;
+    }
+
+    return geo;
+}
+
+std::vector<std::unique_ptr<Material>> GltfLoader::BuildMaterials(int firstMatCBIndex, int firstSrvHeapIndex) const
+{
+    std::vector<std::unique_ptr<Material>> materials;
+
+    for(size_t i = 0; i < mMaterials.size(); ++i)
+    {
+        const MaterialDesc& desc = mMaterials[i];
+
+        auto material = std::make_unique<Material>();
+        material->Name = desc.Name.empty() ? "material" + std::to_string(i) : desc.Name;
+        material->MatCBIndex = firstMatCBIndex + (int)i;
+        material->DiffuseSrvHeapIndex = desc.BaseColorImage >= 0 ? firstSrvHeapIndex + desc.BaseColorImage : -1;
+        material->NormalSrvHeapIndex = desc.NormalImage >= 0 ? firstSrvHeapIndex + desc.NormalImage : -1;
+        material->DiffuseAlbedo = desc.BaseColorFactor;
+        material->Roughness = desc.RoughnessFactor;
+
+        // Metals reflect their base color; dielectrics about 4%.
+        XMVECTOR dielectric = XMVectorReplicate(0.04f);
+        XMVECTOR fresnel = XMVectorLerp(dielectric, XMLoadFloat4(&desc.BaseColorFactor), desc.MetallicFactor);
+        XMStoreFloat3(&material->FresnelR0, fresnel);
+
+        materials.push_back(std::move(material));
+    }
+
+    return materials;
+}
+#endif
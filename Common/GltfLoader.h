@@ -0,0 +1,192 @@
+//***************************************************************************************
+// GltfLoader.h
+//
+// Binary glTF 2.0 (.glb) loader.  The file stays memory-mapped for the lifetime of the
+// loader and every accessor, buffer view and embedded image is exposed as a pointer
+// into the mapping, so nothing is copied until a stream actually has to change
+// layout.  BuildGeometry hands a stream straight to d3dUtil::CreateDefaultBuffer when
+// the file already stores it the way the engine draws it:
+//   - the position-only stream, for tightly packed float3 positions laid out the same way;
+//   - the interleaved vertex buffer, for files whose attributes already form a
+//     GeometryGenerator::Vertex (see MatchesVertexLayout).
+// Anything else is repacked into GeometryGenerator::Vertex, in parallel per primitive.
+// Indices are always repacked (glTF indices are relative to the primitive, which is
+// exactly what BaseVertexLocation expects, but the winding has to change).
+//
+// Vertices stay in glTF's right-handed space; put GetToLeftHanded() in the world matrix.
+// Mirroring z keeps the on-screen winding, so glTF's counter-clockwise front faces
+// would be culled by the PSOs, which expect clockwise ones.  The loader therefore
+// swaps the second and third index of every triangle.  ObjLoader uses the same
+// convention.
+//
+// Only triangle-list primitives are loaded; node transforms, skins, morph targets and
+// sparse accessors are not supported.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include "MappedFile.h"
+#include <memory>
+#include <string>
+
+#if defined(_WIN32)
+#include <d3d12.h>
+#endif
+
+struct MeshGeometry;
+struct Material;
+
+class GltfLoader
+{
+public:
+
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    // glTF component types (the OpenGL enums the file uses).
+    enum ComponentType : uint32
+    {
+        Byte = 5120,
+        UnsignedByte = 5121,
+        Short = 5122,
+        UnsignedShort = 5123,
+        UnsignedInt = 5125,
+        Float = 5126
+    };
+
+	///<summary>
+	/// Typed view of a buffer view.  Data points into the mapping at the first element;
+	/// elements are ByteStride apart.
+	///</summary>
+    struct Accessor
+    {
+        const std::uint8_t* Data = nullptr;
+        uint32 Count = 0;
+        uint32 ByteStride = 0;
+        uint32 ComponentType = 0;
+        uint32 ComponentCount = 0;
+        bool Normalized = false;
+
+        uint32 GetElementSize() const;
+        bool IsTightlyPacked() const { return ByteStride == GetElementSize(); }
+
+        // Bytes from the start of the first element to the end of the last one.
+        uint64 GetByteSize() const;
+
+        // Converts element index to floats (normalized integers map to [0,1] or [-1,1]).
+        // Reads min(count, ComponentCount) components.
+        void ReadFloats(uint32 index, float* values, uint32 count) const;
+
+        // Reads a SCALAR unsigned integer element.
+        uint32 ReadIndex(uint32 index) const;
+    };
+
+	///<summary>
+	/// One draw call.  Attribute fields are accessor indices and Material indexes
+	/// GetMaterials(); all are -1 when absent.
+	///</summary>
+    struct Primitive
+    {
+        int Position = -1;
+        int Normal = -1;
+        int Tangent = -1;
+        int TexC = -1;
+        int Indices = -1;
+        int Material = -1;
+    };
+
+    struct Mesh
+    {
+        std::string Name;
+        std::vector<Primitive> Primitives;
+    };
+
+	///<summary>
+	/// The metallic-roughness material as stored in the file.  Image fields index
+	/// GetImages(), -1 when the material has no such texture.
+	///</summary>
+    struct MaterialDesc
+    {
+        std::string Name;
+        DirectX::XMFLOAT4 BaseColorFactor = { 1.0f, 1.0f, 1.0f, 1.0f };
+        float MetallicFactor = 1.0f;
+        float RoughnessFactor = 1.0f;
+        int BaseColorImage = -1;
+        int NormalImage = -1;
+    };
+
+	///<summary>
+	/// An image embedded in the binary chunk (png, jpeg, dds, ...), still encoded.
+	/// Images referenced by uri are listed with Data == nullptr.
+	///</summary>
+    struct Image
+    {
+        std::string Name;
+        std::string MimeType;
+        std::string Uri;
+        const std::uint8_t* Data = nullptr;
+        uint64 Size = 0;
+    };
+
+	///<summary>
+	/// Maps filename and parses its JSON chunk.  Returns false, with error saying why,
+	/// if the file is not a valid .glb or an accessor lies outside its buffer.
+	///</summary>
+    bool Open(const std::filesystem::path& filename, std::string* error = nullptr);
+
+    const std::vector<Accessor>& GetAccessors() const { return mAccessors; }
+    const std::vector<Mesh>& GetMeshes() const { return mMeshes; }
+    const std::vector<MaterialDesc>& GetMaterials() const { return mMaterials; }
+    const std::vector<Image>& GetImages() const { return mImages; }
+
+	///<summary>
+	/// True when the primitive's POSITION, NORMAL, TANGENT and TEXCOORD_0 interleave in one
+	/// buffer view exactly as GeometryGenerator::Vertex does.  That needs a float3
+	/// TANGENT, which only files written for this engine have; standard exporters write
+	/// float4 tangents and take the repacking path.
+	///</summary>
+    bool MatchesVertexLayout(const Primitive& primitive) const;
+
+	///<summary>
+	/// Copies a primitive into engine vertices and 32-bit indices, wound for
+	/// GetToLeftHanded().  Missing normals are left zero; missing tangents are generated
+	/// when the primitive has uvs.
+	///</summary>
+    GeometryGenerator::MeshData GetMeshData(const Primitive& primitive) const;
+
+	///<summary>
+	/// Mirrors z, taking the loaded right-handed vertices into the engine's left-handed
+	/// world.  Concatenate it in front of the object's own world matrix.
+	///</summary>
+    static DirectX::XMFLOAT4X4 GetToLeftHanded();
+
+#if defined(_WIN32)
+	///<summary>
+	/// Puts every triangle-list primitive into one MeshGeometry, with a position-only
+	/// stream, and registers DrawArgs meshName (or meshName_i for a mesh with several
+	/// primitives; meshes without a name are called mesh0, mesh1, ...).  Each submesh
+	/// keeps its primitive's material in MaterialIndex, which indexes BuildMaterials()
+	/// as well as GetMaterials().  The CPU blobs are only filled when cpuCopies is set;
+	/// the loader's accessors already give CPU access while it is alive.  Upload buffers must outlive the command list, as with
+	/// d3dUtil::CreateDefaultBuffer.
+	///</summary>
+    std::unique_ptr<MeshGeometry> BuildGeometry(const std::string& name, ID3D12Device* device,
+                                                ID3D12GraphicsCommandList* cmdList, bool cpuCopies = false) const;
+
+	///<summary>
+	/// One Material per file material, with MatCBIndex counting up from firstMatCBIndex.
+	/// Texture heap indices assume the images were loaded, in GetImages() order, into
+	/// consecutive descriptors starting at firstSrvHeapIndex.
+	///</summary>
+    std::vector<std::unique_ptr<Material>> BuildMaterials(int firstMatCBIndex, int firstSrvHeapIndex) const;
+#endif
+
+private:
+    MappedFile mFile;
+
+    std::vector<Accessor> mAccessors;
+    std::vector<Mesh> mMeshes;
+    std::vector<MaterialDesc> mMaterials;
+    std::vector<Image> mImages;
+};
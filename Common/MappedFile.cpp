@@ -0,0 +1,172 @@
+//***************************************************************************************
+// MappedFile.cpp
+//***************************************************************************************
+
+#include "MappedFile.h"
+#include <utility>
+
+#if defined(_WIN32)
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+MappedFile::MappedFile(MappedFile&& rhs) noexcept
+{
+    *this = std::move(rhs);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& rhs) noexcept
+{
+    if(this != &rhs)
+    {
+        Close();
+
+        mData = std::exchange(rhs.mData, nullptr);
+        mSize = std::exchange(rhs.mSize, 0);
+        mOpen = std::exchange(rhs.mOpen, false);
+#if defined(_WIN32)
+        mFile = std::exchange(rhs.mFile, nullptr);
+        mMapping = std::exchange(rhs.mMapping, nullptr);
+#endif
+    }
+
+    return *this;
+}
+
+#if defined(_WIN32)
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+
+    HANDLE file = CreateFileW(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING,
+        FILE_ATTRIBUTE_NORMAL | FILE_FLAG_SEQUENTIAL_SCAN, nullptr);
+    if(file == INVALID_HANDLE_VALUE)
+        return false;
+
+    LARGE_INTEGER size;
+    if(!GetFileSizeEx(file, &size))
+    {
+        CloseHandle(file);
+        return false;
+    }
+
+    mFile = file;
+    mSize = (std::uint64_t)size.QuadPart;
+    mOpen = true;
+
+    // Zero-length files cannot be mapped.
+    if(mSize == 0)
+        return true;
+
+    mMapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if(mMapping != nullptr)
+        mData = static_cast<const std::uint8_t*>(MapViewOfFile(mMapping, FILE_MAP_READ, 0, 0, 0));
+
+    if(mData == nullptr)
+    {
+        Close();
+        return false;
+    }
+
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if(mData != nullptr)
+        UnmapViewOfFile(mData);
+    if(mMapping != nullptr)
+        CloseHandle(mMapping);
+    if(mFile != nullptr)
+        CloseHandle(mFile);
+
+    mData = nullptr;
+    mMapping = nullptr;
+    mFile = nullptr;
+    mSize = 0;
+    mOpen = false;
+}
+
+void MappedFile::Prefetch(std::uint64_t offset, std::uint64_t size) const
+{
+    if(mData == nullptr || offset >= mSize)
+        return;
+
+    WIN32_MEMORY_RANGE_ENTRY range;
+    range.VirtualAddress = const_cast<std::uint8_t*>(mData + offset);
+    range.NumberOfBytes = (SIZE_T)(size < mSize - offset ? size : mSize - offset);
+    PrefetchVirtualMemory(GetCurrentProcess(), 1, &range, 0);
+}
+
+#else
+
+bool MappedFile::Open(const std::filesystem::path& path)
+{
+    Close();
+
+    int fd = open(path.c_str(), O_RDONLY);
+    if(fd < 0)
+        return false;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0)
+    {
+        close(fd);
+        return false;
+    }
+
+    mSize = (std::uint64_t)info.st_size;
+    mOpen = true;
+
+    if(mSize > 0)
+    {
+        void* data = mmap(nullptr, (size_t)mSize, PROT_READ, MAP_PRIVATE, fd, 0);
+        if(data == MAP_FAILED)
+        {
+            close(fd);
+            mSize = 0;
+            mOpen = false;
+            return false;
+        }
+
+        mData = static_cast<const std::uint8_t*>(data);
+    }
+
+    // The mapping stays valid after the descriptor is closed.
+    close(fd);
+    return true;
+}
+
+void MappedFile::Close()
+{
+    if(mData != nullptr)
+        munmap(const_cast<std::uint8_t*>(mData), (size_t)mSize);
+
+    mData = nullptr;
+    mSize = 0;
+    mOpen = false;
+}
+
+void MappedFile::Prefetch(std::uint64_t offset, std::uint64_t size) const
+{
+    if(mData == nullptr || offset >= mSize)
+        return;
+
+    // madvise wants a page-aligned start.
+    long pageSize = sysconf(_SC_PAGESIZE);
+    std::uint64_t begin = offset & ~(std::uint64_t)(pageSize - 1);
+    std::uint64_t end = offset + (size < mSize - offset ? size : mSize - offset);
+    madvise(const_cast<std::uint8_t*>(mData + begin), (size_t)(end - begin), MADV_WILLNEED);
+}
+
+#endif
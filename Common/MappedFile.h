@@ -0,0 +1,52 @@
+//***************************************************************************************
+// MappedFile.h
+//
+// Read-only memory mapping of a whole file (CreateFileMapping on Windows, mmap
+// elsewhere).  Loaders parse straight out of the mapping instead of reading the file
+// into a buffer first, and pages are only brought in when they are touched.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+
+class MappedFile
+{
+public:
+
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile& rhs) = delete;
+    MappedFile& operator=(const MappedFile& rhs) = delete;
+    MappedFile(MappedFile&& rhs) noexcept;
+    MappedFile& operator=(MappedFile&& rhs) noexcept;
+
+	///<summary>
+	/// Maps the file, closing any file mapped before.  Returns false if the file cannot
+	/// be opened or mapped.  An empty file opens with GetData() == nullptr.
+	///</summary>
+    bool Open(const std::filesystem::path& path);
+    void Close();
+
+    bool IsOpen() const { return mOpen; }
+    const std::uint8_t* GetData() const { return mData; }
+    std::uint64_t GetSize() const { return mSize; }
+
+	///<summary>
+	/// Hints that the range will be read soon (and sequentially), so the OS can start
+	/// reading it in.  Does nothing where not supported.
+	///</summary>
+    void Prefetch(std::uint64_t offset, std::uint64_t size) const;
+
+private:
+    const std::uint8_t* mData = nullptr;
+    std::uint64_t mSize = 0;
+    bool mOpen = false;
+
+#if defined(_WIN32)
+    void* mFile = nullptr;
+    void* mMapping = nullptr;
+#endif
+};
@@ -0,0 +1,209 @@
+//***************************************************************************************
+// MeshGeometryBuilder.cpp
+//***************************************************************************************
+
+#include "MeshGeometryBuilder.h"
+#include <algorithm>
+#include <cassert>
+
+#if defined(_WIN32)
+#include "d3dUtil.h"
+#endif
+
+using namespace DirectX;
+
+MeshGeometryBuilder::MeshGeometryBuilder(IndexMode mode, uint32 maxPartVertices) :
+    mMode(mode),
+    mMaxPartVertices(std::min(std::max(maxPartVertices, 3u), 65536u))
+{
+}
+
+void MeshGeometryBuilder::AddSubmesh(const std::string& name, GeometryGenerator::MeshData meshData)
+{
+    Source source;
+    source.Name = name;
+    source.MeshData = std::move(meshData);
+    mSources.push_back(std::move(source));
+}
+
+void MeshGeometryBuilder::Finalize()
+{
+    mVertices.clear();
+    mIndices16.clear();
+    mIndices32.clear();
+    mSubmeshes.clear();
+
+    bool anyOversized = false;
+    for(const Source& source : mSources)
+        anyOversized |= source.MeshData.Vertices.size() > mMaxPartVertices;
+
+    mUse16Bit = mMode == IndexMode::Prefer16 || (mMode == IndexMode::Auto && !anyOversized);
+
+    std::vector<uint32> partVertices;
+    std::vector<uint16> partIndices;
+
+    for(const Source& source : mSources)
+    {
+        const std::vector<GeometryGenerator::Vertex>& vertices = source.MeshData.Vertices;
+        const std::vector<uint32>& indices = source.MeshData.Indices32;
+
+        Submesh submesh;
+        submesh.Name = source.Name;
+
+        uint32 baseVertex = (uint32)mVertices.size();
+        uint32 startIndex = (uint32)(mUse16Bit ? mIndices16.size() : mIndices32.size());
+
+        if(!mUse16Bit || vertices.size() <= mMaxPartVertices)
+        {
+            // Fits as is: the indices are already relative to the submesh's first vertex.
+            Part part;
+            part.IndexCount = (uint32)indices.size();
+            part.StartIndexLocation = startIndex;
+            part.BaseVertexLocation = (std::int32_t)baseVertex;
+            part.VertexCount = (uint32)vertices.size();
+            submesh.Parts.push_back(part);
+
+            mVertices.insert(mVertices.end(), vertices.begin(), vertices.end());
+
+            if(mUse16Bit)
+                mIndices16.insert(mIndices16.end(), indices.begin(), indices.end());
+            else
+                mIndices32.insert(mIndices32.end(), indices.begin(), indices.end());
+        }
+        else
+        {
+            std::vector<Part> parts = Split(indices.data(), (uint32)indices.size(), (uint32)vertices.size(),
+                mMaxPartVertices, partVertices, partIndices);
+
+            for(Part& part : parts)
+            {
+                part.StartIndexLocation += startIndex;
+                part.BaseVertexLocation += (std::int32_t)baseVertex;
+                submesh.Parts.push_back(part);
+            }
+
+            for(uint32 v : partVertices)
+                mVertices.push_back(vertices[v]);
+
+            mIndices16.insert(mIndices16.end(), partIndices.begin(), partIndices.end());
+        }
+
+        mSubmeshes.push_back(std::move(submesh));
+    }
+}
+
+std::vector<MeshGeometryBuilder::Part> MeshGeometryBuilder::Split(const uint32* indices, uint32 indexCount, uint32 vertexCount,
+                                                                  uint32 maxPartVertices,
+                                                                  std::vector<uint32>& partVertices, std::vector<uint16>& partIndices)
+{
+    assert(maxPartVertices >= 3 && maxPartVertices <= 65536);
+
+    std::vector<Part> parts;
+    partVertices.clear();
+    partIndices.clear();
+    partIndices.reserve(indexCount);
+
+    // Local index of each source vertex in the current part, ~0u if not in it yet.
+    std::vector<uint32> localIndex(vertexCount, ~0u);
+
+    Part current;
+
+    auto flush = [&]()
+    {
+        if(current.IndexCount == 0)
+            return;
+
+        for(uint32 i = 0; i < current.VertexCount; ++i)
+            localIndex[partVertices[current.BaseVertexLocation + i]] = ~0u;
+
+        parts.push_back(current);
+
+        current = Part();
+        current.StartIndexLocation = (uint32)partIndices.size();
+        current.BaseVertexLocation = (std::int32_t)partVertices.size();
+    };
+
+    for(uint32 t = 0; t + 3 <= indexCount; t += 3)
+    {
+        uint32 newVertices = 0;
+        for(uint32 k = 0; k < 3; ++k)
+        {
+            if(localIndex[indices[t+k]] == ~0u)
+                newVertices++;
+        }
+
+        if(current.VertexCount + newVertices > maxPartVertices)
+            flush();
+
+        for(uint32 k = 0; k < 3; ++k)
+        {
+            uint32 v = indices[t+k];
+            if(localIndex[v] == ~0u)
+            {
+                localIndex[v] = current.VertexCount++;
+                partVertices.push_back(v);
+            }
+
+            partIndices.push_back((uint16)localIndex[v]);
+        }
+
+        current.IndexCount += 3;
+    }
+
+    flush();
+
+    return parts;
+}
+
+#if defined(_WIN32)
+std::unique_ptr<MeshGeometry> MeshGeometryBuilder::Build(const std::string& name, ID3D12Device* device,
+                                                         ID3D12GraphicsCommandList* cmdList)
+{
+    Finalize();
+
+    const void* indexData = mUse16Bit ? (const void*)mIndices16.data() : (const void*)mIndices32.data();
+    const UINT vbByteSize = (UINT)mVertices.size() * sizeof(GeometryGenerator::Vertex);
+    const UINT ibByteSize = mUse16Bit ? (UINT)mIndices16.size() * sizeof(uint16) : (UINT)mIndices32.size() * sizeof(uint32);
+
+    auto geo = std::make_unique<MeshGeometry>();
+    geo->Name = name;
+
+    ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
+    CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), mVertices.data(), vbByteSize);
+
+    ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
+    CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), indexData, ibByteSize);
+
+    geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(device, cmdList, mVertices.data(), vbByteSize, geo->VertexBufferUploader);
+    geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(device, cmdList, indexData, ibByteSize, geo->IndexBufferUploader);
+
+    geo->VertexByteStride = sizeof(GeometryGenerator::Vertex);
+    geo->VertexBufferByteSize = vbByteSize;
+    geo->IndexFormat = GetIndexFormat();
+    geo->IndexBufferByteSize = ibByteSize;
+
+    for(const Submesh& submesh : mSubmeshes)
+    {
+        for(size_t i = 0; i < submesh.Parts.size(); ++i)
+        {
+            const Part& part = submesh.Parts[i];
+
+            SubmeshGeometry args;
+            args.IndexCount = part.IndexCount;
+            args.StartIndexLocation = part.StartIndexLocation;
+            args.BaseVertexLocation = part.BaseVertexLocation;
+
+            if(part.VertexCount > 0)
+            {
+                BoundsBuilder::Apply(BoundsBuilder::Compute(&mVertices[part.BaseVertexLocation].Position,
+                    sizeof(GeometryGenerator::Vertex), part.VertexCount), args);
+            }
+
+            std::string argsName = submesh.Parts.size() == 1 ? submesh.Name : submesh.Name + "_part" + std::to_string(i);
+            geo->DrawArgs[argsName] = args;
+        }
+    }
+
+    return geo;
+}
+#endif
@@ -0,0 +1,131 @@
+//***************************************************************************************
+// MeshGeometryBuilder.h
+//
+// Packs several GeometryGenerator::MeshData into one vertex buffer and one index buffer
+// and picks the index format.  Every submesh gets its own BaseVertexLocation, so its
+// indices only have to address its own vertices; a submesh with more than 65536
+// vertices is either split into parts that each fit in 16 bits, or the whole buffer
+// falls back to 32-bit indices, depending on the IndexMode.
+//
+// Typical use:
+//     MeshGeometryBuilder builder;
+//     builder.AddSubmesh("grid", geoGen.CreateGrid(160.0f, 160.0f, 500, 500));
+//     builder.AddSubmesh("sphere", geoGen.CreateSphere(0.5f, 20, 20));
+//     auto geo = builder.Build("shapeGeo", device, commandList);
+//     // geo->DrawArgs["sphere"], geo->DrawArgs["grid_part0"], geo->DrawArgs["grid_part1"]
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include <memory>
+#include <string>
+
+#if defined(_WIN32)
+#include <d3d12.h>
+#endif
+
+struct MeshGeometry;
+
+class MeshGeometryBuilder
+{
+public:
+
+    using uint16 = std::uint16_t;
+    using uint32 = std::uint32_t;
+
+    enum class IndexMode
+    {
+        // 16-bit indices; submeshes with too many vertices are split into parts.
+        Prefer16,
+
+        // 16-bit indices if every submesh fits, otherwise 32-bit for the whole buffer.
+        Auto,
+
+        // Always 32-bit, never split.
+        Always32
+    };
+
+	///<summary>
+	/// One draw call: the fields map one to one onto SubmeshGeometry.
+	///</summary>
+    struct Part
+    {
+        uint32 IndexCount = 0;
+        uint32 StartIndexLocation = 0;
+        std::int32_t BaseVertexLocation = 0;
+        uint32 VertexCount = 0;
+    };
+
+	///<summary>
+	/// A submesh that fits is a single part registered under its own name.  A split
+	/// submesh is registered as name_part0, name_part1, ...
+	///</summary>
+    struct Submesh
+    {
+        std::string Name;
+        std::vector<Part> Parts;
+    };
+
+	///<summary>
+	/// maxPartVertices is the most vertices one 16-bit part may address.  Pass 65535 when
+	/// drawing strips with D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFF, which reserves it.
+	///</summary>
+    explicit MeshGeometryBuilder(IndexMode mode = IndexMode::Prefer16, uint32 maxPartVertices = 65536);
+
+	///<summary>
+	/// Takes a copy of the mesh; std::move it in to avoid one.
+	///</summary>
+    void AddSubmesh(const std::string& name, GeometryGenerator::MeshData meshData);
+
+	///<summary>
+	/// Lays out the buffers.  Called by Build; call it directly to get at the CPU data.
+	///</summary>
+    void Finalize();
+
+    bool Uses16BitIndices() const { return mUse16Bit; }
+
+    const std::vector<GeometryGenerator::Vertex>& GetVertices() const { return mVertices; }
+    const std::vector<uint16>& GetIndices16() const { return mIndices16; }
+    const std::vector<uint32>& GetIndices32() const { return mIndices32; }
+    const std::vector<Submesh>& GetSubmeshes() const { return mSubmeshes; }
+
+	///<summary>
+	/// Splits a triangle list into parts of at most maxPartVertices vertices, keeping the
+	/// triangle order.  partVertices receives the source vertex of every part vertex, in
+	/// part order, and partIndices the part-local indices.  Part ranges are relative to
+	/// the start of partVertices and partIndices.
+	///</summary>
+    static std::vector<Part> Split(const uint32* indices, uint32 indexCount, uint32 vertexCount, uint32 maxPartVertices,
+                                   std::vector<uint32>& partVertices, std::vector<uint16>& partIndices);
+
+#if defined(_WIN32)
+    DXGI_FORMAT GetIndexFormat() const { return mUse16Bit ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT; }
+
+	///<summary>
+	/// Creates the MeshGeometry with CPU copies, default-heap buffers, IndexFormat and
+	/// DrawArgs (with Bounds) filled in.  The upload buffers must stay alive until the
+	/// command list has executed, as with d3dUtil::CreateDefaultBuffer.
+	///</summary>
+    std::unique_ptr<MeshGeometry> Build(const std::string& name, ID3D12Device* device, ID3D12GraphicsCommandList* cmdList);
+#endif
+
+private:
+
+    struct Source
+    {
+        std::string Name;
+        GeometryGenerator::MeshData MeshData;
+    };
+
+    IndexMode mMode;
+    uint32 mMaxPartVertices;
+
+    std::vector<Source> mSources;
+
+    bool mUse16Bit = true;
+    std::vector<GeometryGenerator::Vertex> mVertices;
+    std::vector<uint16> mIndices16;
+    std::vector<uint32> mIndices32;
+    std::vector<Submesh> mSubmeshes;
+};
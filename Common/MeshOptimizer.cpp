@@ -0,0 +1,516 @@
+//***************************************************************************************
+// MeshOptimizer.cpp
+//***************************************************************************************
+
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+
+namespace
+{
+    // Size of the post-transform cache in front of the simulated vertex fetch.
+    const std::uint32_t FetchVertexCacheSize = 16;
+
+    template<typename IndexType>
+    MeshOptimizer::VertexFetchStats AnalyzeVertexFetchT(const IndexType* indices, std::uint32_t indexCount,
+        std::uint32_t vertexCount, std::uint32_t vertexStride, std::uint32_t cacheLineSize, std::uint32_t cacheLineCount)
+    {
+        using uint32 = std::uint32_t;
+
+        MeshOptimizer::VertexFetchStats stats;
+        if(indexCount == 0 || vertexStride == 0 || cacheLineSize == 0 || cacheLineCount == 0)
+            return stats;
+
+        uint32 lineCount = (uint32)(((std::uint64_t)vertexCount*vertexStride + cacheLineSize - 1) / cacheLineSize);
+
+        // FIFO caches as push timestamps, see AnalyzeVertexCache.
+        std::vector<uint32> vertexPushTime(vertexCount, 0);
+        std::vector<uint32> linePushTime(lineCount, 0);
+        std::vector<bool> referenced(vertexCount, false);
+        uint32 vertexTime = FetchVertexCacheSize + 1;
+        uint32 lineTime = cacheLineCount + 1;
+
+        for(uint32 i = 0; i < indexCount; ++i)
+        {
+            uint32 v = indices[i];
+            referenced[v] = true;
+
+            if(vertexTime - vertexPushTime[v] <= FetchVertexCacheSize)
+                continue;
+
+            vertexPushTime[v] = vertexTime++;
+
+            uint32 firstLine = (uint32)((std::uint64_t)v*vertexStride / cacheLineSize);
+            uint32 lastLine = (uint32)(((std::uint64_t)v*vertexStride + vertexStride - 1) / cacheLineSize);
+            for(uint32 line = firstLine; line <= lastLine; ++line)
+            {
+                if(lineTime - linePushTime[line] > cacheLineCount)
+                {
+                    linePushTime[line] = lineTime++;
+                    stats.CacheLineFetches++;
+                }
+            }
+        }
+
+        uint32 referencedCount = (uint32)std::count(referenced.begin(), referenced.end(), true);
+        stats.BytesFetched = stats.CacheLineFetches*cacheLineSize;
+        stats.Overfetch = (float)stats.BytesFetched / ((float)referencedCount*vertexStride);
+
+        return stats;
+    }
+
+    template<typename IndexType>
+    std::uint32_t BuildVertexFetchRemapT(std::uint32_t* remap, const IndexType* indices, std::uint32_t indexCount,
+        std::uint32_t vertexCount)
+    {
+        std::fill(remap, remap + vertexCount, ~0u);
+
+        std::uint32_t next = 0;
+        for(std::uint32_t i = 0; i < indexCount; ++i)
+        {
+            std::uint32_t v = indices[i];
+            if(remap[v] == ~0u)
+                remap[v] = next++;
+        }
+
+        return next;
+    }
+
+    template<typename IndexType>
+    void RemapIndicesT(IndexType* indices, std::uint32_t indexCount, const std::uint32_t* remap)
+    {
+        for(std::uint32_t i = 0; i < indexCount; ++i)
+            indices[i] = static_cast<IndexType>(remap[indices[i]]);
+    }
+
+    template<typename IndexType>
+    std::uint32_t StripifyT(IndexType* destination, const IndexType* indices, std::uint32_t indexCount, std::uint32_t vertexCount)
+    {
+        using uint32 = std::uint32_t;
+
+        const IndexType restart = (IndexType)~IndexType(0);
+        uint32 triangleCount = indexCount/3;
+
+        // Vertex->triangle adjacency, as in OptimizeVertexCache.
+        std::vector<uint32> adjacencyOffsets(vertexCount + 1, 0);
+        for(uint32 i = 0; i < triangleCount*3; ++i)
+            adjacencyOffsets[indices[i] + 1]++;
+        for(uint32 v = 0; v < vertexCount; ++v)
+            adjacencyOffsets[v+1] += adjacencyOffsets[v];
+
+        std::vector<uint32> adjacency(triangleCount*3);
+        std::vector<uint32> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+        for(uint32 t = 0; t < triangleCount; ++t)
+        {
+            for(uint32 k = 0; k < 3; ++k)
+                adjacency[fill[indices[t*3+k]]++] = t;
+        }
+
+        std::vector<bool> emitted(triangleCount, false);
+
+        // Degenerate triangles draw nothing, drop them up front.
+        for(uint32 t = 0; t < triangleCount; ++t)
+        {
+            const IndexType* tri = &indices[t*3];
+            if(tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0])
+                emitted[t] = true;
+        }
+
+        // Finds an unused triangle with the directed edge a->b and returns the vertex
+        // that follows b in it, or ~0u.
+        auto findNext = [&](uint32 a, uint32 b, uint32& triangle) -> uint32
+        {
+            for(uint32 i = adjacencyOffsets[a]; i < adjacencyOffsets[a+1]; ++i)
+            {
+                uint32 t = adjacency[i];
+                if(emitted[t])
+                    continue;
+
+                const IndexType* tri = &indices[t*3];
+                for(uint32 k = 0; k < 3; ++k)
+                {
+                    if(tri[k] == a && tri[(k+1)%3] == b)
+                    {
+                        triangle = t;
+                        return tri[(k+2)%3];
+                    }
+                }
+            }
+            return ~0u;
+        };
+
+        uint32 count = 0;
+        uint32 next = 0;
+
+        for(;;)
+        {
+            while(next < triangleCount && emitted[next])
+                next++;
+            if(next == triangleCount)
+                break;
+
+            const IndexType* tri = &indices[next*3];
+            emitted[next] = true;
+
+            // Start with the rotation whose second edge has a neighbor, so the strip can
+            // grow.  The second triangle of a strip is odd and needs the edge c->b.
+            uint32 rotation = 0;
+            for(uint32 r = 0; r < 3; ++r)
+            {
+                uint32 unused;
+                if(findNext(tri[(r+2)%3], tri[(r+1)%3], unused) != ~0u)
+                {
+                    rotation = r;
+                    break;
+                }
+            }
+
+            if(count > 0)
+                destination[count++] = restart;
+
+            IndexType* strip = &destination[count];
+            strip[0] = tri[rotation];
+            strip[1] = tri[(rotation+1)%3];
+            strip[2] = tri[(rotation+2)%3];
+            uint32 length = 3;
+
+            for(;;)
+            {
+                // Triangle n of the strip is (s[n], s[n+1], w) when n is even and
+                // (s[n+1], s[n], w) when n is odd.
+                uint32 n = length - 2;
+                uint32 a = (n & 1) ? strip[length-1] : strip[length-2];
+                uint32 b = (n & 1) ? strip[length-2] : strip[length-1];
+
+                uint32 triangle = 0;
+                uint32 w = findNext(a, b, triangle);
+                if(w == ~0u)
+                    break;
+
+                emitted[triangle] = true;
+                strip[length++] = (IndexType)w;
+            }
+
+            count += length;
+        }
+
+        return count;
+    }
+}
+
+MeshOptimizer::VertexCacheStats MeshOptimizer::AnalyzeVertexCache(const uint32* indices, uint32 indexCount, uint32 vertexCount,
+                                                                  uint32 cacheSize, CacheModel model)
+{
+    VertexCacheStats stats;
+    stats.TriangleCount = indexCount/3;
+
+    // A trailing partial triangle is never drawn.
+    indexCount = stats.TriangleCount*3;
+    if(indexCount == 0 || cacheSize == 0)
+        return stats;
+
+    std::vector<bool> referenced(vertexCount, false);
+
+    if(model == CacheModel::Fifo)
+    {
+        // A vertex is still in a FIFO cache if fewer than cacheSize other vertices
+        // were pushed since it was pushed itself, so a push timestamp per vertex is enough.
+        std::vector<uint32> pushTime(vertexCount, 0);
+        uint32 time = cacheSize + 1;
+
+        for(uint32 i = 0; i < indexCount; ++i)
+        {
+            uint32 v = indices[i];
+            referenced[v] = true;
+
+            if(time - pushTime[v] > cacheSize)
+            {
+                pushTime[v] = time++;
+                stats.TransformCount++;
+            }
+        }
+    }
+    else
+    {
+        // Most recently used entry first.
+        std::vector<uint32> cache;
+        cache.reserve(cacheSize + 1);
+
+        for(uint32 i = 0; i < indexCount; ++i)
+        {
+            uint32 v = indices[i];
+            referenced[v] = true;
+
+            auto it = std::find(cache.begin(), cache.end(), v);
+            if(it == cache.end())
+            {
+                stats.TransformCount++;
+                cache.insert(cache.begin(), v);
+                if(cache.size() > cacheSize)
+                    cache.pop_back();
+            }
+            else
+            {
+                std::rotate(cache.begin(), it, it + 1);
+            }
+        }
+    }
+
+    stats.VertexCount = (uint32)std::count(referenced.begin(), referenced.end(), true);
+    stats.ACMR = (float)stats.TransformCount / stats.TriangleCount;
+    stats.ATVR = (float)stats.TransformCount / stats.VertexCount;
+
+    return stats;
+}
+
+void MeshOptimizer::OptimizeVertexCache(uint32* destination, const uint32* indices, uint32 indexCount,
+                                        uint32 vertexCount, uint32 cacheSize)
+{
+    uint32 triangleCount = indexCount/3;
+
+    // Indices past the last whole triangle draw nothing; keep them at the end as they are.
+    // Counting them as live would leave their vertices live forever.
+    std::copy(indices + triangleCount*3, indices + indexCount, destination + triangleCount*3);
+    indexCount = triangleCount*3;
+
+    //
+    // Build vertex->triangle adjacency in compressed (offset + list) form.
+    //
+
+    std::vector<uint32> liveTriangles(vertexCount, 0);
+    for(uint32 i = 0; i < indexCount; ++i)
+        liveTriangles[indices[i]]++;
+
+    std::vector<uint32> adjacencyOffsets(vertexCount + 1, 0);
+    for(uint32 v = 0; v < vertexCount; ++v)
+        adjacencyOffsets[v+1] = adjacencyOffsets[v] + liveTriangles[v];
+
+    std::vector<uint32> adjacency(indexCount);
+    std::vector<uint32> fill(adjacencyOffsets.begin(), adjacencyOffsets.end() - 1);
+    for(uint32 t = 0; t < triangleCount; ++t)
+    {
+        adjacency[fill[indices[t*3+0]]++] = t;
+        adjacency[fill[indices[t*3+1]]++] = t;
+        adjacency[fill[indices[t*3+2]]++] = t;
+    }
+
+    //
+    // Tipsify.  Fan around the current vertex, then move to the candidate vertex
+    // that is still in the cache and will stay there the longest.
+    //
+
+    std::vector<uint32> cacheTime(vertexCount, 0);
+    std::vector<bool> emitted(triangleCount, false);
+    std::vector<uint32> deadEnd;
+    std::vector<uint32> candidates;
+
+    deadEnd.reserve(indexCount);
+    candidates.reserve(64);
+
+    uint32 time = cacheSize + 1;
+    uint32 cursor = 0;
+    uint32 outputCount = 0;
+
+    // Returns the next vertex with live triangles, first from the dead-end stack
+    // (recently used, probably still in the cache) and then in input order.
+    auto skipDeadEnd = [&]() -> int
+    {
+        while(!deadEnd.empty())
+        {
+            uint32 d = deadEnd.back();
+            deadEnd.pop_back();
+
+            if(liveTriangles[d] > 0)
+                return (int)d;
+        }
+
+        while(cursor < vertexCount)
+        {
+            if(liveTriangles[cursor] > 0)
+                return (int)cursor;
+
+            ++cursor;
+        }
+
+        return -1;
+    };
+
+    int fanning = vertexCount > 0 ? 0 : -1;
+    while(fanning >= 0)
+    {
+        candidates.clear();
+
+        for(uint32 a = adjacencyOffsets[fanning]; a < adjacencyOffsets[fanning+1]; ++a)
+        {
+            uint32 t = adjacency[a];
+            if(emitted[t])
+                continue;
+
+            for(uint32 k = 0; k < 3; ++k)
+            {
+                uint32 v = indices[t*3+k];
+                destination[outputCount++] = v;
+
+                deadEnd.push_back(v);
+                candidates.push_back(v);
+                liveTriangles[v]--;
+
+                if(time - cacheTime[v] > cacheSize)
+                    cacheTime[v] = time++;
+            }
+
+            emitted[t] = true;
+        }
+
+        // Pick the candidate that stays in the cache after its remaining triangles are emitted,
+        // preferring the one that entered the cache the earliest.
+        int next = -1;
+        uint32 bestPriority = 0;
+        for(uint32 v : candidates)
+        {
+            if(liveTriangles[v] == 0)
+                continue;
+
+            uint32 priority = 0;
+            if(time - cacheTime[v] + 2*liveTriangles[v] <= cacheSize)
+                priority = time - cacheTime[v];
+
+            if(priority > bestPriority)
+            {
+                bestPriority = priority;
+                next = (int)v;
+            }
+        }
+
+        if(next < 0)
+            next = skipDeadEnd();
+
+        fanning = next;
+    }
+}
+
+MeshOptimizer::VertexCacheResult MeshOptimizer::OptimizeVertexCache(GeometryGenerator::MeshData& meshData, uint32 cacheSize,
+                                                                    CacheModel model)
+{
+    VertexCacheResult result;
+
+    uint32 indexCount = (uint32)meshData.Indices32.size();
+    uint32 vertexCount = (uint32)meshData.Vertices.size();
+
+    result.Before = AnalyzeVertexCache(meshData.Indices32.data(), indexCount, vertexCount, cacheSize, model);
+
+    std::vector<uint32> optimized(indexCount);
+    OptimizeVertexCache(optimized.data(), meshData.Indices32.data(), indexCount, vertexCount, cacheSize);
+    meshData.Indices32.swap(optimized);
+    meshData.InvalidateIndices16();
+
+    result.After = AnalyzeVertexCache(meshData.Indices32.data(), indexCount, vertexCount, cacheSize, model);
+
+    return result;
+}
+
+MeshOptimizer::VertexFetchStats MeshOptimizer::AnalyzeVertexFetch(const uint32* indices, uint32 indexCount, uint32 vertexCount,
+                                                                  uint32 vertexStride, uint32 cacheLineSize, uint32 cacheLineCount)
+{
+    return AnalyzeVertexFetchT(indices, indexCount, vertexCount, vertexStride, cacheLineSize, cacheLineCount);
+}
+
+MeshOptimizer::VertexFetchStats MeshOptimizer::AnalyzeVertexFetch(const uint16* indices, uint32 indexCount, uint32 vertexCount,
+                                                                  uint32 vertexStride, uint32 cacheLineSize, uint32 cacheLineCount)
+{
+    return AnalyzeVertexFetchT(indices, indexCount, vertexCount, vertexStride, cacheLineSize, cacheLineCount);
+}
+
+std::uint32_t MeshOptimizer::BuildVertexFetchRemap(uint32* remap, const uint32* indices, uint32 indexCount, uint32 vertexCount)
+{
+    return BuildVertexFetchRemapT(remap, indices, indexCount, vertexCount);
+}
+
+std::uint32_t MeshOptimizer::BuildVertexFetchRemap(uint32* remap, const uint16* indices, uint32 indexCount, uint32 vertexCount)
+{
+    return BuildVertexFetchRemapT(remap, indices, indexCount, vertexCount);
+}
+
+void MeshOptimizer::RemapIndices(uint32* indices, uint32 indexCount, const uint32* remap)
+{
+    RemapIndicesT(indices, indexCount, remap);
+}
+
+void MeshOptimizer::RemapIndices(uint16* indices, uint32 indexCount, const uint32* remap)
+{
+    RemapIndicesT(indices, indexCount, remap);
+}
+
+void MeshOptimizer::RemapVertices(void* destination, const void* vertices, uint32 vertexCount, uint32 vertexStride,
+                                  const uint32* remap)
+{
+    auto dst = static_cast<std::uint8_t*>(destination);
+    auto src = static_cast<const std::uint8_t*>(vertices);
+
+    for(uint32 i = 0; i < vertexCount; ++i)
+    {
+        if(remap[i] != ~0u)
+            std::memcpy(dst + (size_t)remap[i]*vertexStride, src + (size_t)i*vertexStride, vertexStride);
+    }
+}
+
+MeshOptimizer::VertexFetchResult MeshOptimizer::OptimizeVertexFetch(GeometryGenerator::MeshData& meshData,
+                                                                    uint32 cacheLineSize, uint32 cacheLineCount)
+{
+    using Vertex = GeometryGenerator::Vertex;
+
+    VertexFetchResult result;
+
+    uint32 indexCount = (uint32)meshData.Indices32.size();
+    uint32 vertexCount = (uint32)meshData.Vertices.size();
+
+    result.Before = AnalyzeVertexFetch(meshData.Indices32.data(), indexCount, vertexCount, sizeof(Vertex),
+        cacheLineSize, cacheLineCount);
+
+    std::vector<uint32> remap(vertexCount);
+    result.VertexCount = BuildVertexFetchRemap(remap.data(), meshData.Indices32.data(), indexCount, vertexCount);
+
+    std::vector<Vertex> vertices(result.VertexCount);
+    RemapVertices(vertices.data(), meshData.Vertices.data(), vertexCount, sizeof(Vertex), remap.data());
+    RemapIndices(meshData.Indices32.data(), indexCount, remap.data());
+
+    meshData.Vertices.swap(vertices);
+    meshData.InvalidateIndices16();
+
+    // Dropping unreferenced vertices can shrink the bounds.
+    GeometryGenerator::ComputeBounds(meshData);
+
+    result.After = AnalyzeVertexFetch(meshData.Indices32.data(), indexCount, result.VertexCount, sizeof(Vertex),
+        cacheLineSize, cacheLineCount);
+
+    return result;
+}
+
+MeshOptimizer::uint32 MeshOptimizer::Stripify(uint32* destination, const uint32* indices, uint32 indexCount, uint32 vertexCount)
+{
+    return StripifyT(destination, indices, indexCount, vertexCount);
+}
+
+MeshOptimizer::uint32 MeshOptimizer::Stripify(uint16* destination, const uint16* indices, uint32 indexCount, uint32 vertexCount)
+{
+    assert(vertexCount <= 0xffff);
+    return StripifyT(destination, indices, indexCount, vertexCount);
+}
+
+MeshOptimizer::StripStats MeshOptimizer::Stripify(const GeometryGenerator::MeshData& meshData, std::vector<uint32>& strip)
+{
+    uint32 indexCount = (uint32)meshData.Indices32.size();
+
+    strip.resize(GetStripifyBound(indexCount));
+    uint32 stripIndexCount = Stripify(strip.data(), meshData.Indices32.data(), indexCount, (uint32)meshData.Vertices.size());
+    strip.resize(stripIndexCount);
+
+    StripStats stats;
+    stats.ListIndexCount = indexCount;
+    stats.StripIndexCount = stripIndexCount;
+    stats.StripCount = stripIndexCount > 0 ? 1 + (uint32)std::count(strip.begin(), strip.end(), ~0u) : 0;
+    stats.Reduction = indexCount > 0 ? 1.0f - (float)stripIndexCount/indexCount : 0.0f;
+
+    return stats;
+}
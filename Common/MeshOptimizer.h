@@ -0,0 +1,167 @@
+//***************************************************************************************
+// MeshOptimizer.h
+//
+// Post-processing passes that reorder GeometryGenerator::MeshData for the GPU.
+// Run them on generated or imported meshes before the index/vertex data is handed
+// to d3dUtil::CreateDefaultBuffer.
+//
+// The passes only depend on the standard library and DirectXMath, so they (and the
+// cache simulations used to measure them) also run in Linux tools.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+
+class MeshOptimizer
+{
+public:
+
+    using uint16 = std::uint16_t;
+    using uint32 = std::uint32_t;
+
+	///<summary>
+	/// Replacement policy of the simulated post-transform vertex cache.
+	///</summary>
+    enum class CacheModel
+    {
+        Fifo,
+        Lru
+    };
+
+	///<summary>
+	/// Result of a post-transform cache simulation.
+	///   ACMR: average cache miss ratio, transformed vertices per triangle (lower is better, ~0.5 is ideal).
+	///   ATVR: average transform to vertex ratio, transformed vertices per referenced vertex (1.0 is ideal).
+	///</summary>
+    struct VertexCacheStats
+    {
+        uint32 TriangleCount = 0;
+        uint32 VertexCount = 0;
+        uint32 TransformCount = 0;
+        float ACMR = 0.0f;
+        float ATVR = 0.0f;
+    };
+
+    struct VertexCacheResult
+    {
+        VertexCacheStats Before;
+        VertexCacheStats After;
+    };
+
+	///<summary>
+	/// Result of a vertex fetch simulation.  Every post-transform cache miss reads its
+	/// vertex through a FIFO cache of cacheLineCount lines of cacheLineSize bytes.
+	///   Overfetch: bytes read from memory per byte of referenced vertex data (1.0 is ideal).
+	///</summary>
+    struct VertexFetchStats
+    {
+        uint32 CacheLineFetches = 0;
+        uint32 BytesFetched = 0;
+        float Overfetch = 0.0f;
+    };
+
+    struct VertexFetchResult
+    {
+        VertexFetchStats Before;
+        VertexFetchStats After;
+        uint32 VertexCount = 0;
+    };
+
+	///<summary>
+	/// Size of a triangle list and of the strip made from it.  Reduction is the fraction
+	/// of indices saved (0.5 means half the index memory).
+	///</summary>
+    struct StripStats
+    {
+        uint32 ListIndexCount = 0;
+        uint32 StripIndexCount = 0;
+        uint32 StripCount = 0;
+        float Reduction = 0.0f;
+    };
+
+	///<summary>
+	/// Simulates a post-transform vertex cache of cacheSize entries over a triangle list.
+	///</summary>
+    static VertexCacheStats AnalyzeVertexCache(const uint32* indices, uint32 indexCount, uint32 vertexCount,
+                                               uint32 cacheSize = 16, CacheModel model = CacheModel::Fifo);
+
+	///<summary>
+	/// Reorders the triangles of a triangle list for post-transform cache reuse using
+	/// Tipsify (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality
+	/// and Reduced Overdraw", 2007).  Runs in linear time.  The winding of every triangle
+	/// is preserved.  destination must not alias indices.  When indexCount is not a
+	/// multiple of 3 the leftover indices are copied to the end unchanged.
+	///</summary>
+    static void OptimizeVertexCache(uint32* destination, const uint32* indices, uint32 indexCount,
+                                    uint32 vertexCount, uint32 cacheSize = 16);
+
+	///<summary>
+	/// Optimizes meshData.Indices32 in place and reports the cache behaviour before
+	/// and after.
+	///</summary>
+    static VertexCacheResult OptimizeVertexCache(GeometryGenerator::MeshData& meshData, uint32 cacheSize = 16,
+                                                 CacheModel model = CacheModel::Fifo);
+
+	///<summary>
+	/// Simulates vertex fetch for an index buffer over vertices of vertexStride bytes.
+	///</summary>
+    static VertexFetchStats AnalyzeVertexFetch(const uint32* indices, uint32 indexCount, uint32 vertexCount, uint32 vertexStride,
+                                               uint32 cacheLineSize = 64, uint32 cacheLineCount = 64);
+    static VertexFetchStats AnalyzeVertexFetch(const uint16* indices, uint32 indexCount, uint32 vertexCount, uint32 vertexStride,
+                                               uint32 cacheLineSize = 64, uint32 cacheLineCount = 64);
+
+	///<summary>
+	/// Builds a table that renumbers vertices in the order the index buffer first uses
+	/// them, so vertex fetch walks memory mostly forward.  remap[old] is the new index, or
+	/// ~0u for vertices no triangle references.  Returns the number of referenced vertices.
+	/// Run it after OptimizeVertexCache so it follows the final triangle order.
+	///</summary>
+    static uint32 BuildVertexFetchRemap(uint32* remap, const uint32* indices, uint32 indexCount, uint32 vertexCount);
+    static uint32 BuildVertexFetchRemap(uint32* remap, const uint16* indices, uint32 indexCount, uint32 vertexCount);
+
+	///<summary>
+	/// Applies a remap table to an index buffer in place.
+	///</summary>
+    static void RemapIndices(uint32* indices, uint32 indexCount, const uint32* remap);
+    static void RemapIndices(uint16* indices, uint32 indexCount, const uint32* remap);
+
+	///<summary>
+	/// Applies a remap table to a vertex buffer of any layout.  Unreferenced vertices are
+	/// dropped.  destination must not alias vertices.
+	///</summary>
+    static void RemapVertices(void* destination, const void* vertices, uint32 vertexCount, uint32 vertexStride,
+                              const uint32* remap);
+
+	///<summary>
+	/// Reorders meshData.Vertices by first use, drops unreferenced vertices and remaps
+	/// Indices32, then recomputes meshData.Bounds from the vertices that are left.
+	/// Reports the simulated fetch cost before and after.
+	///</summary>
+    static VertexFetchResult OptimizeVertexFetch(GeometryGenerator::MeshData& meshData,
+                                                 uint32 cacheLineSize = 64, uint32 cacheLineCount = 64);
+
+	///<summary>
+	/// Largest number of indices Stripify can write for indexCount list indices.
+	///</summary>
+    static uint32 GetStripifyBound(uint32 indexCount) { return indexCount/3*4; }
+
+	///<summary>
+	/// Converts a triangle list to triangle strips separated by the primitive restart
+	/// index (0xFFFF or 0xFFFFFFFF, all bits of the index type set).  Strips grow by
+	/// looking up the triangle on the far side of the last edge, whose direction
+	/// alternates with the strip parity, so the winding of every triangle is kept.
+	/// New strips start at the first unused triangle in list order.
+	/// destination needs GetStripifyBound(indexCount) entries; returns the count written.
+	/// For 16-bit indices vertexCount must be below 65536, since 0xFFFF is the cut value.
+	/// Draw with D3D_PRIMITIVE_TOPOLOGY_TRIANGLESTRIP and a PSO whose IBStripCutValue
+	/// matches the index format (d3dUtil::GetStripCutValue).
+	///</summary>
+    static uint32 Stripify(uint32* destination, const uint32* indices, uint32 indexCount, uint32 vertexCount);
+    static uint32 Stripify(uint16* destination, const uint16* indices, uint32 indexCount, uint32 vertexCount);
+
+	///<summary>
+	/// Stripifies meshData.Indices32 into strip (32-bit, cut value 0xFFFFFFFF).
+	///</summary>
+    static StripStats Stripify(const GeometryGenerator::MeshData& meshData, std::vector<uint32>& strip);
+};
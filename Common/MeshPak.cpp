@@ -0,0 +1,451 @@
+//***************************************************************************************
+// MeshPak.cpp
+//***************************************************************************************
+
+#include "MeshPak.h"
+#include "MeshGeometryBuilder.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+
+#if defined(_WIN32)
+#include "d3dUtil.h"
+#endif
+
+using namespace DirectX;
+
+// The records are read straight out of the mapping.
+static_assert(sizeof(MeshPak::Header) == 96, "MeshPak::Header layout changed");
+static_assert(sizeof(MeshPak::DrawArg) == 112, "MeshPak::DrawArg layout changed");
+
+namespace
+{
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    uint64 AlignSection(uint64 offset)
+    {
+        return (offset + MeshPak::SectionAlignment - 1) & ~(uint64)(MeshPak::SectionAlignment - 1);
+    }
+
+    // Pads the stream with zeros up to offset.
+    void PadTo(std::ofstream& out, uint64 offset)
+    {
+        static const char zeros[MeshPak::SectionAlignment] = {};
+
+        uint64 position = (uint64)out.tellp();
+        while(position < offset)
+        {
+            uint64 count = std::min<uint64>(offset - position, sizeof(zeros));
+            out.write(zeros, (std::streamsize)count);
+            position += count;
+        }
+    }
+
+    bool InFile(uint64 offset, uint64 size, uint64 fileSize)
+    {
+        return offset <= fileSize && size <= fileSize - offset;
+    }
+}
+
+MeshPak::uint64 MeshPak::HashName(std::string_view name)
+{
+    uint64 hash = 14695981039346656037ull;
+    for(char c : name)
+    {
+        hash ^= (std::uint8_t)c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+bool MeshPak::Write(const std::filesystem::path& filename, const Contents& contents, std::string* error)
+{
+    auto fail = [&](const std::string& message)
+    {
+        if(error != nullptr)
+            *error = message;
+        return false;
+    };
+
+    uint32 drawArgCount = (uint32)contents.Submeshes.size();
+    uint32 hashSlotCount = 1;
+    while(hashSlotCount < drawArgCount*2)
+        hashSlotCount *= 2;
+
+    //
+    // Records, hash table and names.
+    //
+
+    std::string names = contents.Name;
+    std::vector<DrawArg> drawArgs(drawArgCount);
+    std::vector<uint32> hashSlots(hashSlotCount, EmptySlot);
+
+    for(uint32 i = 0; i < drawArgCount; ++i)
+    {
+        const Submesh& submesh = contents.Submeshes[i];
+
+        DrawArg& drawArg = drawArgs[i];
+        drawArg.NameHash = HashName(submesh.Name);
+        drawArg.NameOffset = (uint32)names.size();
+        drawArg.NameLength = (uint32)submesh.Name.size();
+        drawArg.IndexCount = submesh.IndexCount;
+        drawArg.StartIndexLocation = submesh.StartIndexLocation;
+        drawArg.BaseVertexLocation = submesh.BaseVertexLocation;
+        drawArg.CullVolume = submesh.Bounds.Tightest;
+        drawArg.Box = submesh.Bounds.Box;
+        drawArg.Sphere = submesh.Bounds.Sphere;
+        drawArg.OrientedBox = submesh.Bounds.OrientedBox;
+        names += submesh.Name;
+
+        uint32 slot = (uint32)drawArg.NameHash & (hashSlotCount - 1);
+        while(hashSlots[slot] != EmptySlot)
+        {
+            if(contents.Submeshes[hashSlots[slot]].Name == submesh.Name)
+                return fail("duplicate submesh name " + submesh.Name);
+            slot = (slot + 1) & (hashSlotCount - 1);
+        }
+        hashSlots[slot] = i;
+    }
+
+    //
+    // Section layout.
+    //
+
+    uint64 vertexSize = (uint64)contents.VertexCount*contents.VertexByteStride;
+    uint64 indexSize = (uint64)contents.IndexCount*contents.IndexByteSize;
+    uint64 positionSize = contents.Positions != nullptr ? (uint64)contents.VertexCount*sizeof(XMFLOAT3) : 0;
+
+    Header header;
+    std::memset(&header, 0, sizeof(header));
+    header.Magic = Magic;
+    header.Version = Version;
+    header.VertexByteStride = contents.VertexByteStride;
+    header.VertexCount = contents.VertexCount;
+    header.IndexByteSize = contents.IndexByteSize;
+    header.IndexCount = contents.IndexCount;
+    header.DrawArgCount = drawArgCount;
+    header.HashSlotCount = hashSlotCount;
+    header.NameOffset = 0;
+    header.NameLength = (uint32)contents.Name.size();
+    header.DrawArgsOffset = AlignSection(sizeof(Header));
+    header.HashSlotsOffset = AlignSection(header.DrawArgsOffset + drawArgCount*sizeof(DrawArg));
+    header.NamesOffset = AlignSection(header.HashSlotsOffset + hashSlotCount*sizeof(uint32));
+    header.NamesSize = names.size();
+    header.VertexOffset = AlignSection(header.NamesOffset + header.NamesSize);
+    header.IndexOffset = AlignSection(header.VertexOffset + vertexSize);
+    header.PositionOffset = positionSize > 0 ? AlignSection(header.IndexOffset + indexSize) : 0;
+
+    //
+    // Write.
+    //
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if(!out)
+        return fail("cannot create " + filename.string());
+
+    out.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    PadTo(out, header.DrawArgsOffset);
+    out.write(reinterpret_cast<const char*>(drawArgs.data()), (std::streamsize)(drawArgs.size()*sizeof(DrawArg)));
+    PadTo(out, header.HashSlotsOffset);
+    out.write(reinterpret_cast<const char*>(hashSlots.data()), (std::streamsize)(hashSlots.size()*sizeof(uint32)));
+    PadTo(out, header.NamesOffset);
+    out.write(names.data(), (std::streamsize)names.size());
+    PadTo(out, header.VertexOffset);
+    out.write(static_cast<const char*>(contents.Vertices), (std::streamsize)vertexSize);
+    PadTo(out, header.IndexOffset);
+    out.write(static_cast<const char*>(contents.Indices), (std::streamsize)indexSize);
+    if(positionSize > 0)
+    {
+        PadTo(out, header.PositionOffset);
+        out.write(reinterpret_cast<const char*>(contents.Positions), (std::streamsize)positionSize);
+    }
+
+    if(!out.flush())
+        return fail("cannot write " + filename.string());
+
+    return true;
+}
+
+MeshPak::Contents MeshPak::GetContents(const MeshGeometryBuilder& builder, const std::string& name)
+{
+    const std::vector<GeometryGenerator::Vertex>& vertices = builder.GetVertices();
+
+    Contents contents;
+    contents.Name = name;
+    contents.Vertices = vertices.data();
+    contents.VertexByteStride = sizeof(GeometryGenerator::Vertex);
+    contents.VertexCount = (uint32)vertices.size();
+
+    if(builder.Uses16BitIndices())
+    {
+        contents.Indices = builder.GetIndices16().data();
+        contents.IndexByteSize = 2;
+        contents.IndexCount = (uint32)builder.GetIndices16().size();
+    }
+    else
+    {
+        contents.Indices = builder.GetIndices32().data();
+        contents.IndexByteSize = 4;
+        contents.IndexCount = (uint32)builder.GetIndices32().size();
+    }
+
+    for(const MeshGeometryBuilder::Submesh& source : builder.GetSubmeshes())
+    {
+        for(size_t i = 0; i < source.Parts.size(); ++i)
+        {
+            const MeshGeometryBuilder::Part& part = source.Parts[i];
+
+            Submesh submesh;
+            submesh.Name = source.Parts.size() == 1 ? source.Name : source.Name + "_part" + std::to_string(i);
+            submesh.IndexCount = part.IndexCount;
+            submesh.StartIndexLocation = part.StartIndexLocation;
+            submesh.BaseVertexLocation = part.BaseVertexLocation;
+
+            if(part.VertexCount > 0)
+            {
+                submesh.Bounds = BoundsBuilder::Compute(&vertices[part.BaseVertexLocation].Position,
+                    sizeof(GeometryGenerator::Vertex), part.VertexCount);
+            }
+
+            contents.Submeshes.push_back(submesh);
+        }
+    }
+
+    return contents;
+}
+
+bool MeshPak::Open(const std::filesystem::path& filename, std::string* error)
+{
+    mHeader = nullptr;
+    mDrawArgs = nullptr;
+    mHashSlots = nullptr;
+    mNames = nullptr;
+
+    auto fail = [&](const std::string& message)
+    {
+        if(error != nullptr)
+            *error = message;
+        mFile.Close();
+        return false;
+    };
+
+    if(!mFile.Open(filename))
+        return fail("cannot open " + filename.string());
+
+    const std::uint8_t* data = mFile.GetData();
+    uint64 fileSize = mFile.GetSize();
+    if(fileSize < sizeof(Header))
+        return fail("not a .meshpak file");
+
+    const Header* header = reinterpret_cast<const Header*>(data);
+    if(header->Magic != Magic || header->Version != Version)
+        return fail("not a .meshpak file of version " + std::to_string(Version));
+
+    uint32 slotCount = header->HashSlotCount;
+    bool ok =
+        (header->IndexByteSize == 2 || header->IndexByteSize == 4) &&
+        slotCount != 0 && (slotCount & (slotCount - 1)) == 0 && slotCount >= header->DrawArgCount &&
+        (uint64)header->NameOffset + header->NameLength <= header->NamesSize &&
+        InFile(header->DrawArgsOffset, (uint64)header->DrawArgCount*sizeof(DrawArg), fileSize) &&
+        InFile(header->HashSlotsOffset, (uint64)slotCount*sizeof(uint32), fileSize) &&
+        InFile(header->NamesOffset, header->NamesSize, fileSize) &&
+        InFile(header->VertexOffset, (uint64)header->VertexCount*header->VertexByteStride, fileSize) &&
+        InFile(header->IndexOffset, (uint64)header->IndexCount*header->IndexByteSize, fileSize) &&
+        (header->PositionOffset == 0 || InFile(header->PositionOffset, (uint64)header->VertexCount*sizeof(XMFLOAT3), fileSize)) &&
+        header->DrawArgsOffset % alignof(DrawArg) == 0 && header->HashSlotsOffset % alignof(uint32) == 0;
+    if(!ok)
+        return fail("corrupt .meshpak header");
+
+    const DrawArg* drawArgs = reinterpret_cast<const DrawArg*>(data + header->DrawArgsOffset);
+    const uint32* hashSlots = reinterpret_cast<const uint32*>(data + header->HashSlotsOffset);
+
+    // A draw range outside the buffers would read past them on the GPU.  The index
+    // values themselves are not scanned, which would touch every page of the file.
+    for(uint32 i = 0; i < header->DrawArgCount; ++i)
+    {
+        const DrawArg& drawArg = drawArgs[i];
+        bool validDrawArg =
+            (uint64)drawArg.NameOffset + drawArg.NameLength <= header->NamesSize &&
+            (uint64)drawArg.StartIndexLocation + drawArg.IndexCount <= header->IndexCount &&
+            drawArg.BaseVertexLocation >= 0 &&
+            (drawArg.IndexCount == 0 || (uint32)drawArg.BaseVertexLocation < header->VertexCount);
+        if(!validDrawArg)
+            return fail("corrupt .meshpak DrawArg");
+    }
+
+    for(uint32 i = 0; i < slotCount; ++i)
+    {
+        if(hashSlots[i] != EmptySlot && hashSlots[i] >= header->DrawArgCount)
+            return fail("corrupt .meshpak hash table");
+    }
+
+    mHeader = header;
+    mDrawArgs = drawArgs;
+    mHashSlots = hashSlots;
+    mNames = reinterpret_cast<const char*>(data + header->NamesOffset);
+
+    return true;
+}
+
+std::string_view MeshPak::GetName() const
+{
+    return std::string_view(mNames + mHeader->NameOffset, mHeader->NameLength);
+}
+
+std::string_view MeshPak::GetDrawArgName(const DrawArg& drawArg) const
+{
+    return std::string_view(mNames + drawArg.NameOffset, drawArg.NameLength);
+}
+
+const MeshPak::DrawArg* MeshPak::FindDrawArg(std::string_view name) const
+{
+    uint64 hash = HashName(name);
+    uint32 mask = mHeader->HashSlotCount - 1;
+
+    // Bounded by the table size, in case a damaged file has no empty slot.
+    uint32 slot = (uint32)hash & mask;
+    for(uint32 probe = 0; probe <= mask; ++probe)
+    {
+        uint32 index = mHashSlots[slot];
+        if(index == EmptySlot)
+            return nullptr;
+
+        const DrawArg& drawArg = mDrawArgs[index];
+        if(drawArg.NameHash == hash && GetDrawArgName(drawArg) == name)
+            return &drawArg;
+
+        slot = (slot + 1) & mask;
+    }
+
+    return nullptr;
+}
+
+const void* MeshPak::GetVertexData() const
+{
+    return mFile.GetData() + mHeader->VertexOffset;
+}
+
+const void* MeshPak::GetIndexData() const
+{
+    return mFile.GetData() + mHeader->IndexOffset;
+}
+
+const XMFLOAT3* MeshPak::GetPositionData() const
+{
+    if(mHeader->PositionOffset == 0)
+        return nullptr;
+
+    return reinterpret_cast<const XMFLOAT3*>(mFile.GetData() + mHeader->PositionOffset);
+}
+
+#if defined(_WIN32)
+MeshPak::Contents MeshPak::GetContents(const MeshGeometry& geometry)
+{
+    Contents contents;
+    contents.Name = geometry.Name;
+
+    if(geometry.VertexBufferCPU != nullptr && geometry.VertexByteStride > 0)
+    {
+        contents.Vertices = geometry.VertexBufferCPU->GetBufferPointer();
+        contents.VertexByteStride = geometry.VertexByteStride;
+        contents.VertexCount = (uint32)(geometry.VertexBufferCPU->GetBufferSize()/geometry.VertexByteStride);
+    }
+
+    if(geometry.IndexBufferCPU != nullptr)
+    {
+        contents.Indices = geometry.IndexBufferCPU->GetBufferPointer();
+        contents.IndexByteSize = geometry.IndexFormat == DXGI_FORMAT_R16_UINT ? 2 : 4;
+        contents.IndexCount = (uint32)(geometry.IndexBufferCPU->GetBufferSize()/contents.IndexByteSize);
+    }
+
+    if(geometry.PositionBufferCPU != nullptr &&
+       geometry.PositionBufferCPU->GetBufferSize() == (SIZE_T)contents.VertexCount*sizeof(XMFLOAT3))
+    {
+        contents.Positions = static_cast<const XMFLOAT3*>(geometry.PositionBufferCPU->GetBufferPointer());
+    }
+
+    for(const auto& drawArgs : geometry.DrawArgs)
+    {
+        const SubmeshGeometry& source = drawArgs.second;
+
+        Submesh submesh;
+        submesh.Name = drawArgs.first;
+        submesh.IndexCount = source.IndexCount;
+        submesh.StartIndexLocation = source.StartIndexLocation;
+        submesh.BaseVertexLocation = source.BaseVertexLocation;
+        submesh.Bounds.Box = source.Bounds;
+        submesh.Bounds.Sphere = source.SphereBounds;
+        submesh.Bounds.OrientedBox = source.OrientedBounds;
+        submesh.Bounds.Tightest = source.CullVolume;
+        contents.Submeshes.push_back(submesh);
+    }
+
+    return contents;
+}
+
+SubmeshGeometry MeshPak::ToSubmesh(const DrawArg& drawArg)
+{
+    SubmeshGeometry submesh;
+    submesh.IndexCount = drawArg.IndexCount;
+    submesh.StartIndexLocation = drawArg.StartIndexLocation;
+    submesh.BaseVertexLocation = drawArg.BaseVertexLocation;
+    submesh.Bounds = drawArg.Box;
+    submesh.SphereBounds = drawArg.Sphere;
+    submesh.OrientedBounds = drawArg.OrientedBox;
+    submesh.CullVolume = drawArg.CullVolume;
+
+    return submesh;
+}
+
+std::unique_ptr<MeshGeometry> MeshPak::BuildGeometry(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList,
+                                                     bool fillDrawArgs, bool cpuCopies) const
+{
+    const UINT vbByteSize = mHeader->VertexCount*mHeader->VertexByteStride;
+    const UINT ibByteSize = mHeader->IndexCount*mHeader->IndexByteSize;
+    const UINT positionByteSize = mHeader->PositionOffset != 0 ? mHeader->VertexCount*(UINT)sizeof(XMFLOAT3) : 0;
+
+    auto geo = std::make_unique<MeshGeometry>();
+    geo->Name = std::string(GetName());
+
+    if(cpuCopies)
+    {
+        ThrowIfFailed(D3DCreateBlob(vbByteSize, &geo->VertexBufferCPU));
+        CopyMemory(geo->VertexBufferCPU->GetBufferPointer(), GetVertexData(), vbByteSize);
+
+        ThrowIfFailed(D3DCreateBlob(ibByteSize, &geo->IndexBufferCPU));
+        CopyMemory(geo->IndexBufferCPU->GetBufferPointer(), GetIndexData(), ibByteSize);
+
+        if(positionByteSize > 0)
+        {
+            ThrowIfFailed(D3DCreateBlob(positionByteSize, &geo->PositionBufferCPU));
+            CopyMemory(geo->PositionBufferCPU->GetBufferPointer(), GetPositionData(), positionByteSize);
+        }
+    }
+
+    geo->VertexBufferGPU = d3dUtil::CreateDefaultBuffer(device, cmdList, GetVertexData(), vbByteSize, geo->VertexBufferUploader);
+    geo->IndexBufferGPU = d3dUtil::CreateDefaultBuffer(device, cmdList, GetIndexData(), ibByteSize, geo->IndexBufferUploader);
+
+    geo->VertexByteStride = mHeader->VertexByteStride;
+    geo->VertexBufferByteSize = vbByteSize;
+    geo->IndexFormat = mHeader->IndexByteSize == 2 ? DXGI_FORMAT_R16_UINT : DXGI_FORMAT_R32_UINT;
+    geo->IndexBufferByteSize = ibByteSize;
+
+    if(positionByteSize > 0)
+    {
+        geo->PositionBufferGPU = d3dUtil::CreateDefaultBuffer(device, cmdList, GetPositionData(), positionByteSize,
+            geo->PositionBufferUploader);
+        geo->PositionByteStride = sizeof(XMFLOAT3);
+        geo->PositionBufferByteSize = positionByteSize;
+    }
+
+    if(fillDrawArgs)
+    {
+        geo->DrawArgs.reserve(mHeader->DrawArgCount);
+        for(uint32 i = 0; i < mHeader->DrawArgCount; ++i)
+            geo->DrawArgs.emplace(std::string(GetDrawArgName(mDrawArgs[i])), ToSubmesh(mDrawArgs[i]));
+    }
+
+    return geo;
+}
+#endif
@@ -0,0 +1,190 @@
+//***************************************************************************************
+// MeshPak.h
+//
+// .meshpak: a fully baked MeshGeometry that loads with one memory map and one upload
+// per buffer, with nothing to parse.  Layout (native little-endian; every section starts
+// on a SectionAlignment boundary so it can be uploaded, or read unbuffered, in place):
+//
+//   Header
+//   DrawArg  [DrawArgCount]      fixed-size records with bounds
+//   uint32   [HashSlotCount]     open-addressing table of DrawArg indices
+//   char     []                  geometry and DrawArgs names, not terminated
+//   vertex data, index data, optional position-only stream
+//
+// FindDrawArg hashes the name (64-bit FNV-1a), probes the table and compares one
+// record, so a lookup needs no std::string and no map built at load time.
+//
+// Typical use:
+//     MeshGeometryBuilder builder;
+//     builder.AddSubmesh("grid", geoGen.CreateGrid(160.0f, 160.0f, 500, 500));
+//     builder.Finalize();
+//     MeshPak::Write("level.meshpak", MeshPak::GetContents(builder, "levelGeo"));
+//     ...
+//     MeshPak pak;
+//     if(pak.Open("level.meshpak"))
+//         geo = pak.BuildGeometry(device, cmdList);
+//***************************************************************************************
+
+#pragma once
+
+#include "BoundsBuilder.h"
+#include "MappedFile.h"
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#if defined(_WIN32)
+#include <d3d12.h>
+#endif
+
+class MeshGeometryBuilder;
+struct MeshGeometry;
+struct SubmeshGeometry;
+
+class MeshPak
+{
+public:
+
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    static constexpr uint32 Magic = 0x4B41504D;     // "MPAK"
+    static constexpr uint32 Version = 1;
+    static constexpr uint32 SectionAlignment = 4096;
+    static constexpr uint32 EmptySlot = 0xffffffff;
+
+    struct Header
+    {
+        uint32 Magic;
+        uint32 Version;
+
+        uint32 VertexByteStride;
+        uint32 VertexCount;
+        uint32 IndexByteSize;       // 2 or 4
+        uint32 IndexCount;
+
+        uint32 DrawArgCount;
+        uint32 HashSlotCount;       // power of two, at least twice DrawArgCount
+
+        uint32 NameOffset;          // geometry name, in the names section
+        uint32 NameLength;
+
+        uint64 DrawArgsOffset;
+        uint64 HashSlotsOffset;
+        uint64 NamesOffset;
+        uint64 NamesSize;
+        uint64 VertexOffset;
+        uint64 IndexOffset;
+        uint64 PositionOffset;      // 0 when there is no position-only stream
+    };
+
+	///<summary>
+	/// One SubmeshGeometry as stored in the file.
+	///</summary>
+    struct DrawArg
+    {
+        uint64 NameHash;
+        uint32 NameOffset;
+        uint32 NameLength;
+
+        uint32 IndexCount;
+        uint32 StartIndexLocation;
+        std::int32_t BaseVertexLocation;
+        BoundingVolume CullVolume;
+
+        DirectX::BoundingBox Box;
+        DirectX::BoundingSphere Sphere;
+        DirectX::BoundingOrientedBox OrientedBox;
+    };
+
+    struct Submesh
+    {
+        std::string Name;
+        uint32 IndexCount = 0;
+        uint32 StartIndexLocation = 0;
+        std::int32_t BaseVertexLocation = 0;
+        MeshBounds Bounds;
+    };
+
+	///<summary>
+	/// What Write stores.  The pointers are not owned and only read during Write.
+	///</summary>
+    struct Contents
+    {
+        std::string Name;
+
+        const void* Vertices = nullptr;
+        uint32 VertexByteStride = 0;
+        uint32 VertexCount = 0;
+
+        const void* Indices = nullptr;
+        uint32 IndexByteSize = 2;
+        uint32 IndexCount = 0;
+
+        // Optional position-only stream, VertexCount entries.
+        const DirectX::XMFLOAT3* Positions = nullptr;
+
+        std::vector<Submesh> Submeshes;
+    };
+
+    static uint64 HashName(std::string_view name);
+
+	///<summary>
+	/// Writes contents to filename.  Fails on an I/O error or duplicate submesh names.
+	///</summary>
+    static bool Write(const std::filesystem::path& filename, const Contents& contents, std::string* error = nullptr);
+
+	///<summary>
+	/// Contents of a finalized builder, with the DrawArgs names and bounds Build would
+	/// give.  It points into the builder, which must stay alive until Write.
+	///</summary>
+    static Contents GetContents(const MeshGeometryBuilder& builder, const std::string& name);
+
+	///<summary>
+	/// Maps filename and checks that every section and record lies inside the file.
+	///</summary>
+    bool Open(const std::filesystem::path& filename, std::string* error = nullptr);
+
+    const Header& GetHeader() const { return *mHeader; }
+    std::string_view GetName() const;
+
+    uint32 GetDrawArgCount() const { return mHeader->DrawArgCount; }
+    const DrawArg& GetDrawArg(uint32 i) const { return mDrawArgs[i]; }
+    std::string_view GetDrawArgName(const DrawArg& drawArg) const;
+
+	///<summary>
+	/// nullptr if there is no DrawArg with that name.
+	///</summary>
+    const DrawArg* FindDrawArg(std::string_view name) const;
+
+    const void* GetVertexData() const;
+    const void* GetIndexData() const;
+    const DirectX::XMFLOAT3* GetPositionData() const;
+
+#if defined(_WIN32)
+	///<summary>
+	/// Contents of a MeshGeometry with CPU copies (VertexBufferCPU and IndexBufferCPU).
+	///</summary>
+    static Contents GetContents(const MeshGeometry& geometry);
+
+    static SubmeshGeometry ToSubmesh(const DrawArg& drawArg);
+
+	///<summary>
+	/// Uploads the buffers straight from the mapping.  The DrawArgs map is only filled
+	/// when fillDrawArgs is set (FindDrawArg/ToSubmesh work without it), and the CPU
+	/// blobs only when cpuCopies is set.  Upload buffers must outlive the command list,
+	/// as with d3dUtil::CreateDefaultBuffer.
+	///</summary>
+    std::unique_ptr<MeshGeometry> BuildGeometry(ID3D12Device* device, ID3D12GraphicsCommandList* cmdList,
+                                                bool fillDrawArgs = true, bool cpuCopies = false) const;
+#endif
+
+private:
+    MappedFile mFile;
+
+    const Header* mHeader = nullptr;
+    const DrawArg* mDrawArgs = nullptr;
+    const uint32* mHashSlots = nullptr;
+    const char* mNames = nullptr;
+};
@@ -0,0 +1,452 @@
+//***************************************************************************************
+// MeshSimplifier.cpp
+//***************************************************************************************
+
+#include "MeshSimplifier.h"
+#include "MeshOptimizer.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <queue>
+#include <unordered_set>
+
+#if defined(_WIN32)
+#include "d3dUtil.h"
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    using uint32 = std::uint32_t;
+
+    // Symmetric 4x4 matrix sum of w*(n.p + d)^2 terms, plus the total weight.
+    struct Quadric
+    {
+        double A2 = 0, AB = 0, AC = 0, AD = 0;
+        double B2 = 0, BC = 0, BD = 0;
+        double C2 = 0, CD = 0;
+        double D2 = 0;
+        double Weight = 0;
+
+        void AddPlane(double a, double b, double c, double d, double w)
+        {
+            A2 += w*a*a; AB += w*a*b; AC += w*a*c; AD += w*a*d;
+            B2 += w*b*b; BC += w*b*c; BD += w*b*d;
+            C2 += w*c*c; CD += w*c*d;
+            D2 += w*d*d;
+            Weight += w;
+        }
+
+        Quadric& operator+=(const Quadric& q)
+        {
+            A2 += q.A2; AB += q.AB; AC += q.AC; AD += q.AD;
+            B2 += q.B2; BC += q.BC; BD += q.BD;
+            C2 += q.C2; CD += q.CD;
+            D2 += q.D2;
+            Weight += q.Weight;
+            return *this;
+        }
+
+        double Evaluate(const XMFLOAT3& p) const
+        {
+            double x = p.x, y = p.y, z = p.z;
+            double r = A2*x*x + 2*AB*x*y + 2*AC*x*z + 2*AD*x
+                     + B2*y*y + 2*BC*y*z + 2*BD*y
+                     + C2*z*z + 2*CD*z
+                     + D2;
+            return std::max(r, 0.0);
+        }
+    };
+
+    struct Collapse
+    {
+        double Cost;
+        uint32 From;
+        uint32 To;
+        uint32 Version;
+
+        bool operator>(const Collapse& rhs) const { return Cost > rhs.Cost; }
+    };
+
+    XMVECTOR TriangleNormal(const XMFLOAT3& p0, const XMFLOAT3& p1, const XMFLOAT3& p2)
+    {
+        XMVECTOR v0 = XMLoadFloat3(&p0);
+        return XMVector3Cross(XMLoadFloat3(&p1) - v0, XMLoadFloat3(&p2) - v0);
+    }
+
+    class Simplifier
+    {
+    public:
+
+        Simplifier(const XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                   const uint32* indices, uint32 indexCount) :
+            mPositions(vertexCount),
+            mIndices(indices, indices + indexCount - indexCount % 3),
+            mTriangleAlive(indexCount/3, 1),
+            mVertexTriangles(vertexCount),
+            mQuadrics(vertexCount),
+            mLocked(vertexCount, 0),
+            mRemoved(vertexCount, 0),
+            mVersion(vertexCount, 0)
+        {
+            for(uint32 i = 0; i < vertexCount; ++i)
+                mPositions[i] = *reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const std::uint8_t*>(positions) + (size_t)positionStride*i);
+
+            uint32 triangleCount = (uint32)mTriangleAlive.size();
+
+            std::unordered_set<std::uint64_t> directedEdges;
+            directedEdges.reserve(triangleCount*3);
+
+            for(uint32 t = 0; t < triangleCount; ++t)
+            {
+                const uint32* tri = &mIndices[t*3];
+                if(tri[0] == tri[1] || tri[1] == tri[2] || tri[2] == tri[0])
+                {
+                    mTriangleAlive[t] = 0;
+                    continue;
+                }
+
+                mLiveTriangles++;
+
+                for(uint32 k = 0; k < 3; ++k)
+                {
+                    mVertexTriangles[tri[k]].push_back(t);
+                    directedEdges.insert(EdgeKey(tri[k], tri[(k+1)%3]));
+                }
+
+                // Area weighted plane quadric.
+                XMVECTOR n = TriangleNormal(mPositions[tri[0]], mPositions[tri[1]], mPositions[tri[2]]);
+                double length = XMVectorGetX(XMVector3Length(n));
+                if(length <= 0.0)
+                    continue;
+
+                XMFLOAT3 unit;
+                XMStoreFloat3(&unit, n / (float)length);
+                const XMFLOAT3& p0 = mPositions[tri[0]];
+                double d = -(unit.x*(double)p0.x + unit.y*(double)p0.y + unit.z*(double)p0.z);
+
+                for(uint32 k = 0; k < 3; ++k)
+                    mQuadrics[tri[k]].AddPlane(unit.x, unit.y, unit.z, d, 0.5*length);
+            }
+
+            // An edge without its twin is on a boundary, or on a seam where the vertices
+            // were split for their attributes.  Keep both endpoints.
+            for(uint32 t = 0; t < triangleCount; ++t)
+            {
+                if(!mTriangleAlive[t])
+                    continue;
+
+                const uint32* tri = &mIndices[t*3];
+                for(uint32 k = 0; k < 3; ++k)
+                {
+                    uint32 a = tri[k];
+                    uint32 b = tri[(k+1)%3];
+                    if(directedEdges.count(EdgeKey(b, a)) == 0)
+                        mLocked[a] = mLocked[b] = 1;
+                }
+            }
+
+            std::vector<Collapse> heapStorage;
+            heapStorage.reserve(vertexCount*4);
+            mHeap = decltype(mHeap)(std::greater<Collapse>(), std::move(heapStorage));
+
+            for(uint32 v = 0; v < vertexCount; ++v)
+                UpdateCollapse(v);
+        }
+
+        uint32 GetLiveTriangleCount() const { return mLiveTriangles; }
+
+        float GetError() const { return (float)std::sqrt(mMaxError); }
+
+        void Run(uint32 targetTriangleCount)
+        {
+            while(mLiveTriangles > targetTriangleCount && !mHeap.empty())
+            {
+                Collapse c = mHeap.top();
+                mHeap.pop();
+
+                if(mRemoved[c.From] || mRemoved[c.To] || c.Version != mVersion[c.From])
+                    continue;
+
+                Apply(c);
+            }
+        }
+
+        void Emit(std::vector<uint32>& destination) const
+        {
+            for(uint32 t = 0; t < (uint32)mTriangleAlive.size(); ++t)
+            {
+                if(mTriangleAlive[t])
+                    destination.insert(destination.end(), &mIndices[t*3], &mIndices[t*3] + 3);
+            }
+        }
+
+    private:
+
+        static std::uint64_t EdgeKey(uint32 a, uint32 b)
+        {
+            return ((std::uint64_t)a << 32) | b;
+        }
+
+        static bool Contains(const uint32* tri, uint32 v)
+        {
+            return tri[0] == v || tri[1] == v || tri[2] == v;
+        }
+
+        void GatherNeighbors(uint32 v, std::vector<uint32>& neighbors) const
+        {
+            neighbors.clear();
+            for(uint32 t : mVertexTriangles[v])
+            {
+                if(!mTriangleAlive[t])
+                    continue;
+
+                for(uint32 k = 0; k < 3; ++k)
+                {
+                    uint32 w = mIndices[t*3+k];
+                    if(w != v && std::find(neighbors.begin(), neighbors.end(), w) == neighbors.end())
+                        neighbors.push_back(w);
+                }
+            }
+        }
+
+        // fromNeighbors must be GatherNeighbors(from).
+        bool IsValid(uint32 from, uint32 to, const std::vector<uint32>& fromNeighbors)
+        {
+            // Link condition: the only vertices adjacent to both ends may be the apexes of
+            // the triangles on the edge, otherwise the collapse pinches the surface.
+            GatherNeighbors(to, mToNeighbors);
+
+            uint32 common = 0;
+            for(uint32 w : fromNeighbors)
+            {
+                if(std::find(mToNeighbors.begin(), mToNeighbors.end(), w) != mToNeighbors.end())
+                    common++;
+            }
+
+            uint32 shared = 0;
+            for(uint32 t : mVertexTriangles[from])
+            {
+                if(mTriangleAlive[t] && Contains(&mIndices[t*3], to))
+                    shared++;
+            }
+
+            if(common > shared)
+                return false;
+
+            // Reject collapses that flip or nearly flip a surviving triangle.
+            for(uint32 t : mVertexTriangles[from])
+            {
+                const uint32* tri = &mIndices[t*3];
+                if(!mTriangleAlive[t] || Contains(tri, to))
+                    continue;
+
+                XMFLOAT3 p[3] = { mPositions[tri[0]], mPositions[tri[1]], mPositions[tri[2]] };
+                XMVECTOR before = TriangleNormal(p[0], p[1], p[2]);
+
+                for(uint32 k = 0; k < 3; ++k)
+                {
+                    if(tri[k] == from)
+                        p[k] = mPositions[to];
+                }
+
+                XMVECTOR after = TriangleNormal(p[0], p[1], p[2]);
+
+                float d = XMVectorGetX(XMVector3Dot(before, after));
+                float l = XMVectorGetX(XMVector3Length(before)) * XMVectorGetX(XMVector3Length(after));
+                if(d <= 0.25f*l)
+                    return false;
+            }
+
+            return true;
+        }
+
+        void UpdateCollapse(uint32 from)
+        {
+            mVersion[from]++;
+
+            if(mLocked[from] || mRemoved[from])
+                return;
+
+            GatherNeighbors(from, mCandidates);
+
+            mCosts.clear();
+            for(uint32 to : mCandidates)
+            {
+                Quadric q = mQuadrics[from];
+                q += mQuadrics[to];
+                mCosts.push_back({ q.Evaluate(mPositions[to]), from, to, mVersion[from] });
+            }
+
+            // The validity checks cost more than the quadrics, so only run them until the
+            // cheapest valid collapse is found.
+            std::sort(mCosts.begin(), mCosts.end(), [](const Collapse& a, const Collapse& b) { return a.Cost < b.Cost; });
+
+            for(const Collapse& c : mCosts)
+            {
+                if(IsValid(from, c.To, mCandidates))
+                {
+                    mHeap.push(c);
+                    return;
+                }
+            }
+        }
+
+        void Apply(const Collapse& c)
+        {
+            for(uint32 t : mVertexTriangles[c.From])
+            {
+                if(!mTriangleAlive[t])
+                    continue;
+
+                uint32* tri = &mIndices[t*3];
+                if(Contains(tri, c.To))
+                {
+                    mTriangleAlive[t] = 0;
+                    mLiveTriangles--;
+                    continue;
+                }
+
+                for(uint32 k = 0; k < 3; ++k)
+                {
+                    if(tri[k] == c.From)
+                        tri[k] = c.To;
+                }
+
+                mVertexTriangles[c.To].push_back(t);
+            }
+
+            Quadric& q = mQuadrics[c.To];
+            q += mQuadrics[c.From];
+            if(q.Weight > 0.0)
+                mMaxError = std::max(mMaxError, c.Cost / q.Weight);
+
+            mRemoved[c.From] = 1;
+            std::vector<uint32>().swap(mVertexTriangles[c.From]);
+
+            std::vector<uint32>& triangles = mVertexTriangles[c.To];
+            triangles.erase(std::remove_if(triangles.begin(), triangles.end(),
+                [this](uint32 t) { return !mTriangleAlive[t]; }), triangles.end());
+
+            // Every vertex whose neighborhood changed is now a neighbor of c.To.
+            std::vector<uint32> ring;
+            GatherNeighbors(c.To, ring);
+
+            UpdateCollapse(c.To);
+            for(uint32 v : ring)
+                UpdateCollapse(v);
+        }
+
+        std::vector<XMFLOAT3> mPositions;
+        std::vector<uint32> mIndices;
+        std::vector<std::uint8_t> mTriangleAlive;
+        std::vector<std::vector<uint32>> mVertexTriangles;
+        std::vector<Quadric> mQuadrics;
+        std::vector<std::uint8_t> mLocked;
+        std::vector<std::uint8_t> mRemoved;
+        std::vector<uint32> mVersion;
+
+        std::priority_queue<Collapse, std::vector<Collapse>, std::greater<Collapse>> mHeap;
+
+        uint32 mLiveTriangles = 0;
+        double mMaxError = 0.0;
+
+        // Scratch lists reused between calls.
+        std::vector<uint32> mCandidates;
+        std::vector<Collapse> mCosts;
+        std::vector<uint32> mToNeighbors;
+    };
+}
+
+MeshSimplifier::uint32 MeshSimplifier::Simplify(uint32* destination, const uint32* indices, uint32 indexCount,
+                                                const XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                                                uint32 targetIndexCount, float* resultError)
+{
+    Simplifier simplifier(positions, positionStride, vertexCount, indices, indexCount);
+    simplifier.Run(targetIndexCount/3);
+
+    std::vector<uint32> result;
+    result.reserve(simplifier.GetLiveTriangleCount()*3);
+    simplifier.Emit(result);
+
+    std::copy(result.begin(), result.end(), destination);
+
+    if(resultError != nullptr)
+        *resultError = simplifier.GetError();
+
+    return (uint32)result.size();
+}
+
+MeshSimplifier::LodChain MeshSimplifier::BuildLodChain(const XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                                                       const uint32* indices, uint32 indexCount,
+                                                       const std::vector<float>& ratios)
+{
+    auto start = std::chrono::steady_clock::now();
+
+    LodChain chain;
+
+    Simplifier simplifier(positions, positionStride, vertexCount, indices, indexCount);
+    uint32 sourceTriangles = simplifier.GetLiveTriangleCount();
+
+    std::vector<uint32> scratch;
+
+    for(float ratio : ratios)
+    {
+        simplifier.Run((uint32)(std::max(ratio, 0.0f) * sourceTriangles));
+
+        LodLevel level;
+        level.TargetRatio = ratio;
+        level.StartIndex = (uint32)chain.Indices.size();
+        level.Error = simplifier.GetError();
+
+        scratch.clear();
+        simplifier.Emit(scratch);
+        level.IndexCount = (uint32)scratch.size();
+
+        // Dropping triangles leaves holes in the cache order of the source, redo it.
+        chain.Indices.resize(level.StartIndex + level.IndexCount);
+        if(level.IndexCount > 0)
+            MeshOptimizer::OptimizeVertexCache(&chain.Indices[level.StartIndex], scratch.data(), level.IndexCount, vertexCount);
+
+        chain.Levels.push_back(level);
+    }
+
+    chain.Seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    if(chain.Seconds > 0.0)
+        chain.TrianglesPerSecond = sourceTriangles / chain.Seconds;
+
+    return chain;
+}
+
+MeshSimplifier::LodChain MeshSimplifier::BuildLodChain(const GeometryGenerator::MeshData& meshData,
+                                                       const std::vector<float>& ratios)
+{
+    const XMFLOAT3* positions = meshData.Vertices.empty() ? nullptr : &meshData.Vertices[0].Position;
+
+    return BuildLodChain(positions, sizeof(GeometryGenerator::Vertex), (uint32)meshData.Vertices.size(),
+        meshData.Indices32.data(), (uint32)meshData.Indices32.size(), ratios);
+}
+
+#if defined(_WIN32)
+void MeshSimplifier::AddLodSubmeshes(MeshGeometry& geometry, const std::string& name, const LodChain& chain,
+                                     uint32 startIndexLocation, int baseVertexLocation)
+{
+    // LODs cover the same vertices, so they share the bounds of the full mesh if known.
+    SubmeshGeometry bounds;
+    auto it = geometry.DrawArgs.find(name);
+    if(it != geometry.DrawArgs.end())
+        bounds = it->second;
+
+    for(size_t i = 0; i < chain.Levels.size(); ++i)
+    {
+        SubmeshGeometry submesh = bounds;
+        submesh.IndexCount = chain.Levels[i].IndexCount;
+        submesh.StartIndexLocation = startIndexLocation + chain.Levels[i].StartIndex;
+        submesh.BaseVertexLocation = baseVertexLocation;
+
+        geometry.DrawArgs[name + "_lod" + std::to_string(i)] = submesh;
+    }
+}
+#endif
@@ -0,0 +1,85 @@
+//***************************************************************************************
+// MeshSimplifier.h
+//
+// Quadric error metric simplifier (Garland and Heckbert, "Surface Simplification Using
+// Quadric Error Metrics", 1997) that builds LOD chains over a shared vertex buffer.
+//
+// Edges are collapsed onto one of their existing endpoints, so no vertex is ever moved or
+// created and every LOD is just another index range.  Vertices on a boundary or on an
+// attribute seam (texture/normal splits show up as boundaries in the index buffer) are
+// never removed, which keeps the silhouette and the seams intact.
+//
+// Typical use with a MeshGeometry:
+//     auto chain = MeshSimplifier::BuildLodChain(sphere);
+//     // append chain.Indices to the index buffer at sphereIndexOffset, then
+//     MeshSimplifier::AddLodSubmeshes(*geo, "sphere", chain, sphereIndexOffset, sphereVertexOffset);
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include <string>
+
+struct MeshGeometry;
+
+class MeshSimplifier
+{
+public:
+
+    using uint32 = std::uint32_t;
+
+    struct LodLevel
+    {
+        // Requested fraction of the source triangles.
+        float TargetRatio = 1.0f;
+
+        // Range in LodChain::Indices.
+        uint32 StartIndex = 0;
+        uint32 IndexCount = 0;
+
+        // Largest collapse error so far, as an RMS distance to the source surface in the
+        // units of the positions.
+        float Error = 0.0f;
+    };
+
+    struct LodChain
+    {
+        // All levels back to back, level 0 first.
+        std::vector<uint32> Indices;
+        std::vector<LodLevel> Levels;
+
+        double Seconds = 0.0;
+        double TrianglesPerSecond = 0.0;
+    };
+
+	///<summary>
+	/// Simplifies a triangle list until at most targetIndexCount indices are left or no
+	/// more edges can be collapsed.  Writes the result to destination (which may alias
+	/// indices) and returns its index count.  resultError, if given, receives the error
+	/// as in LodLevel::Error.
+	///</summary>
+    static uint32 Simplify(uint32* destination, const uint32* indices, uint32 indexCount,
+                           const DirectX::XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                           uint32 targetIndexCount, float* resultError = nullptr);
+
+	///<summary>
+	/// Simplifies progressively, taking a snapshot at each ratio (in decreasing order, 1.0
+	/// keeps the source indices).  Each level is reordered with
+	/// MeshOptimizer::OptimizeVertexCache.
+	///</summary>
+    static LodChain BuildLodChain(const DirectX::XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                                  const uint32* indices, uint32 indexCount,
+                                  const std::vector<float>& ratios = { 1.0f, 0.5f, 0.25f, 0.125f });
+
+    static LodChain BuildLodChain(const GeometryGenerator::MeshData& meshData,
+                                  const std::vector<float>& ratios = { 1.0f, 0.5f, 0.25f, 0.125f });
+
+#if defined(_WIN32)
+	///<summary>
+	/// Adds DrawArgs entries name_lod0, name_lod1, ... for a chain whose indices were
+	/// copied into the index buffer of geometry at startIndexLocation.
+	///</summary>
+    static void AddLodSubmeshes(MeshGeometry& geometry, const std::string& name, const LodChain& chain,
+                                uint32 startIndexLocation, int baseVertexLocation);
+#endif
+};
@@ -0,0 +1,243 @@
+//***************************************************************************************
+// MeshletBuilder.cpp
+//***************************************************************************************
+
+#include "MeshletBuilder.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+#if defined(_WIN32)
+#include "d3dUtil.h"
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    const XMFLOAT3& PositionAt(const XMFLOAT3* positions, std::uint32_t stride, std::uint32_t index)
+    {
+        return *reinterpret_cast<const XMFLOAT3*>(reinterpret_cast<const std::uint8_t*>(positions) + (size_t)stride*index);
+    }
+
+    void ComputeMeshletBounds(Meshlet& meshlet, const MeshletData& data, const XMFLOAT3* positions, std::uint32_t stride,
+                              std::vector<XMFLOAT3>& scratch)
+    {
+        scratch.resize(meshlet.VertexCount);
+        for(std::uint32_t i = 0; i < meshlet.VertexCount; ++i)
+            scratch[i] = PositionAt(positions, stride, data.VertexIndices[meshlet.VertexOffset + i]);
+
+        meshlet.Bounds = BoundsBuilder::ComputeSphere(scratch.data(), sizeof(XMFLOAT3), (std::uint32_t)scratch.size());
+
+        //
+        // Normal cone: average the unit face normals, then widen the cone until it
+        // contains all of them.
+        //
+
+        const std::uint8_t* primitives = &data.PrimitiveIndices[meshlet.TriangleOffset*3];
+
+        std::vector<XMVECTOR> normals;
+        normals.reserve(meshlet.TriangleCount);
+
+        XMVECTOR axis = XMVectorZero();
+        for(std::uint32_t t = 0; t < meshlet.TriangleCount; ++t)
+        {
+            XMVECTOR p0 = XMLoadFloat3(&scratch[primitives[t*3+0]]);
+            XMVECTOR p1 = XMLoadFloat3(&scratch[primitives[t*3+1]]);
+            XMVECTOR p2 = XMLoadFloat3(&scratch[primitives[t*3+2]]);
+
+            // Triangles are clockwise when seen from the front (left-handed), so this
+            // points out of the front face.
+            XMVECTOR n = XMVector3Cross(p1 - p0, p2 - p0);
+
+            // Skip degenerate triangles, they have no facing.
+            if(XMVectorGetX(XMVector3LengthSq(n)) <= 1e-20f)
+                continue;
+
+            n = XMVector3Normalize(n);
+            normals.push_back(n);
+            axis += n;
+        }
+
+        meshlet.ConeAxis = XMFLOAT3(0.0f, 0.0f, 0.0f);
+        meshlet.ConeCutoff = 1.0f;
+
+        if(normals.empty() || XMVectorGetX(XMVector3LengthSq(axis)) <= 1e-20f)
+            return;
+
+        axis = XMVector3Normalize(axis);
+
+        float minDot = 1.0f;
+        for(const XMVECTOR& n : normals)
+            minDot = std::min(minDot, XMVectorGetX(XMVector3Dot(n, axis)));
+
+        XMStoreFloat3(&meshlet.ConeAxis, axis);
+
+        // A cone of half angle a around the normals is backfacing from every eye inside
+        // the opposite cone of half angle 90-a, whose cutoff is cos(90-a) = sin(a).
+        if(minDot > 0.0f)
+            meshlet.ConeCutoff = std::sqrt(1.0f - minDot*minDot);
+    }
+
+    template<typename IndexType>
+    MeshletData BuildT(const XMFLOAT3* positions, std::uint32_t positionStride, std::uint32_t vertexCount,
+                       const IndexType* indices, std::uint32_t indexCount,
+                       std::uint32_t maxVertices, std::uint32_t maxTriangles)
+    {
+        using uint32 = std::uint32_t;
+
+        assert(maxVertices >= 3 && maxVertices <= MeshletBuilder::MaxMeshletVertices);
+        assert(maxTriangles >= 1 && maxTriangles <= MeshletBuilder::MaxMeshletTriangles);
+
+        MeshletData data;
+
+        uint32 triangleCount = indexCount/3;
+        data.PrimitiveIndices.reserve(triangleCount*3);
+        data.VertexIndices.reserve(vertexCount + vertexCount/4);
+
+        // Local index of each vertex in the meshlet being built, ~0u if not in it.
+        std::vector<uint32> localIndex(vertexCount, ~0u);
+        std::vector<XMFLOAT3> scratch;
+
+        Meshlet current;
+
+        auto flush = [&]()
+        {
+            if(current.TriangleCount == 0)
+                return;
+
+            ComputeMeshletBounds(current, data, positions, positionStride, scratch);
+
+            for(uint32 i = 0; i < current.VertexCount; ++i)
+                localIndex[data.VertexIndices[current.VertexOffset + i]] = ~0u;
+
+            data.Meshlets.push_back(current);
+
+            current = Meshlet();
+            current.VertexOffset = (uint32)data.VertexIndices.size();
+            current.TriangleOffset = (uint32)data.PrimitiveIndices.size()/3;
+        };
+
+        for(uint32 t = 0; t < triangleCount; ++t)
+        {
+            uint32 tri[3] = { indices[t*3+0], indices[t*3+1], indices[t*3+2] };
+
+            uint32 newVertices = 0;
+            for(uint32 k = 0; k < 3; ++k)
+            {
+                if(localIndex[tri[k]] == ~0u)
+                    newVertices++;
+            }
+
+            if(current.VertexCount + newVertices > maxVertices || current.TriangleCount + 1 > maxTriangles)
+                flush();
+
+            for(uint32 k = 0; k < 3; ++k)
+            {
+                uint32 v = tri[k];
+                if(localIndex[v] == ~0u)
+                {
+                    localIndex[v] = current.VertexCount++;
+                    data.VertexIndices.push_back(v);
+                }
+
+                data.PrimitiveIndices.push_back((std::uint8_t)localIndex[v]);
+            }
+
+            current.TriangleCount++;
+        }
+
+        flush();
+
+        return data;
+    }
+}
+
+MeshletData MeshletBuilder::Build(const XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                                  const uint32* indices, uint32 indexCount, uint32 maxVertices, uint32 maxTriangles)
+{
+    return BuildT(positions, positionStride, vertexCount, indices, indexCount, maxVertices, maxTriangles);
+}
+
+MeshletData MeshletBuilder::Build(const XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                                  const uint16* indices, uint32 indexCount, uint32 maxVertices, uint32 maxTriangles)
+{
+    return BuildT(positions, positionStride, vertexCount, indices, indexCount, maxVertices, maxTriangles);
+}
+
+MeshletData MeshletBuilder::Build(const GeometryGenerator::MeshData& meshData, uint32 maxVertices, uint32 maxTriangles)
+{
+    const XMFLOAT3* positions = meshData.Vertices.empty() ? nullptr : &meshData.Vertices[0].Position;
+
+    return BuildT(positions, sizeof(GeometryGenerator::Vertex), (uint32)meshData.Vertices.size(),
+        meshData.Indices32.data(), (uint32)meshData.Indices32.size(), maxVertices, maxTriangles);
+}
+
+#if defined(_WIN32)
+MeshletData MeshletBuilder::Build(const MeshGeometry& geometry, const std::string& submeshName,
+                                  uint32 maxVertices, uint32 maxTriangles)
+{
+    const SubmeshGeometry& submesh = geometry.DrawArgs.at(submeshName);
+
+    // Index values are relative to BaseVertexLocation, so start the position array there.
+    auto vertexBytes = static_cast<const std::uint8_t*>(geometry.VertexBufferCPU->GetBufferPointer());
+    auto positions = reinterpret_cast<const XMFLOAT3*>(vertexBytes + (INT64)submesh.BaseVertexLocation*geometry.VertexByteStride);
+    uint32 vertexCount = geometry.VertexBufferByteSize/geometry.VertexByteStride - submesh.BaseVertexLocation;
+
+    const void* indexBytes = geometry.IndexBufferCPU->GetBufferPointer();
+
+    if(geometry.IndexFormat == DXGI_FORMAT_R16_UINT)
+    {
+        auto indices = static_cast<const uint16*>(indexBytes) + submesh.StartIndexLocation;
+        return BuildT(positions, geometry.VertexByteStride, vertexCount, indices, submesh.IndexCount, maxVertices, maxTriangles);
+    }
+
+    auto indices = static_cast<const uint32*>(indexBytes) + submesh.StartIndexLocation;
+    return BuildT(positions, geometry.VertexByteStride, vertexCount, indices, submesh.IndexCount, maxVertices, maxTriangles);
+}
+#endif
+
+std::vector<std::uint32_t> MeshletBuilder::FlattenIndices(const MeshletData& data)
+{
+    std::vector<uint32> indices(data.PrimitiveIndices.size());
+
+    for(const Meshlet& meshlet : data.Meshlets)
+    {
+        for(uint32 i = 0; i < meshlet.TriangleCount*3; ++i)
+        {
+            uint32 local = data.PrimitiveIndices[meshlet.TriangleOffset*3 + i];
+            indices[meshlet.TriangleOffset*3 + i] = data.VertexIndices[meshlet.VertexOffset + local];
+        }
+    }
+
+    return indices;
+}
+
+bool MeshletBuilder::IsVisible(const Meshlet& meshlet, const BoundingFrustum& frustum, FXMVECTOR eyePos)
+{
+    if(frustum.Contains(meshlet.Bounds) == DISJOINT)
+        return false;
+
+    XMVECTOR center = XMLoadFloat3(&meshlet.Bounds.Center);
+    XMVECTOR axis = XMLoadFloat3(&meshlet.ConeAxis);
+    XMVECTOR toCenter = center - eyePos;
+
+    float d = XMVectorGetX(XMVector3Dot(toCenter, axis));
+    float distance = XMVectorGetX(XMVector3Length(toCenter));
+
+    return d < meshlet.ConeCutoff*distance + meshlet.Bounds.Radius;
+}
+
+std::uint32_t MeshletBuilder::Cull(const MeshletData& data, const BoundingFrustum& frustum, FXMVECTOR eyePos,
+                                   std::vector<uint32>& visible)
+{
+    visible.clear();
+
+    for(uint32 i = 0; i < (uint32)data.Meshlets.size(); ++i)
+    {
+        if(IsVisible(data.Meshlets[i], frustum, eyePos))
+            visible.push_back(i);
+    }
+
+    return (uint32)visible.size();
+}
@@ -0,0 +1,107 @@
+//***************************************************************************************
+// MeshletBuilder.h
+//
+// Splits a triangle list into meshlets (clusters of at most N vertices and M triangles)
+// with a bounding sphere and a normal cone each, so geometry can be culled per cluster
+// instead of per SubmeshGeometry.
+//
+// Culling is done in the space the positions are in.  For a Camera and an object with
+// world matrix W:
+//     BoundingFrustum frustum(camera.GetProj());
+//     frustum.Transform(frustum, XMMatrixInverse(nullptr, W*camera.GetView()));
+// and transform the camera position by the inverse of W.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include <DirectXCollision.h>
+#include <string>
+
+struct MeshGeometry;
+
+struct Meshlet
+{
+    // Range in MeshletData::VertexIndices.
+    std::uint32_t VertexOffset = 0;
+    std::uint32_t VertexCount = 0;
+
+    // Range in MeshletData::PrimitiveIndices, in triangles (3 local indices each).
+    // Also the triangle range of the meshlet in MeshletBuilder::FlattenIndices.
+    std::uint32_t TriangleOffset = 0;
+    std::uint32_t TriangleCount = 0;
+
+    DirectX::BoundingSphere Bounds;
+
+    // Normal cone.  The whole meshlet faces away from a viewer at eye if
+    //   dot(Center - eye, ConeAxis) >= ConeCutoff*length(Center - eye) + Radius.
+    // ConeCutoff is 1 when the normals are too spread out for the test to ever pass.
+    DirectX::XMFLOAT3 ConeAxis = { 0.0f, 0.0f, 0.0f };
+    float ConeCutoff = 1.0f;
+};
+
+struct MeshletData
+{
+    std::vector<Meshlet> Meshlets;
+
+    // Vertex indices (as found in the source index buffer) used by each meshlet.
+    std::vector<std::uint32_t> VertexIndices;
+
+    // Triangles as indices into the meshlet's slice of VertexIndices.
+    std::vector<std::uint8_t> PrimitiveIndices;
+};
+
+class MeshletBuilder
+{
+public:
+
+    using uint16 = std::uint16_t;
+    using uint32 = std::uint32_t;
+
+    static const uint32 MaxMeshletVertices = 256;
+    static const uint32 MaxMeshletTriangles = 512;
+
+	///<summary>
+	/// Builds meshlets by scanning the index buffer in order, so run
+	/// MeshOptimizer::OptimizeVertexCache first for compact clusters.  maxVertices must
+	/// not exceed MaxMeshletVertices and maxTriangles must not exceed MaxMeshletTriangles.
+	/// positionStride is the distance in bytes between two positions.
+	///</summary>
+    static MeshletData Build(const DirectX::XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                             const uint32* indices, uint32 indexCount,
+                             uint32 maxVertices = 64, uint32 maxTriangles = 124);
+    static MeshletData Build(const DirectX::XMFLOAT3* positions, uint32 positionStride, uint32 vertexCount,
+                             const uint16* indices, uint32 indexCount,
+                             uint32 maxVertices = 64, uint32 maxTriangles = 124);
+
+    static MeshletData Build(const GeometryGenerator::MeshData& meshData,
+                             uint32 maxVertices = 64, uint32 maxTriangles = 124);
+
+#if defined(_WIN32)
+	///<summary>
+	/// Builds meshlets for one DrawArgs entry of a MeshGeometry from its CPU copies.
+	/// The vertex format must start with an XMFLOAT3 position.  Vertex indices are
+	/// relative to the submesh's BaseVertexLocation, like the index buffer itself.
+	///</summary>
+    static MeshletData Build(const MeshGeometry& geometry, const std::string& submeshName,
+                             uint32 maxVertices = 64, uint32 maxTriangles = 124);
+#endif
+
+	///<summary>
+	/// Expands the meshlets back into a triangle list where meshlet i covers the indices
+	/// [TriangleOffset*3, (TriangleOffset+TriangleCount)*3), so visible meshlets can be
+	/// drawn with DrawIndexedInstanced without mesh shaders.
+	///</summary>
+    static std::vector<uint32> FlattenIndices(const MeshletData& data);
+
+	///<summary>
+	/// Frustum and normal cone test of one meshlet.
+	///</summary>
+    static bool IsVisible(const Meshlet& meshlet, const DirectX::BoundingFrustum& frustum, DirectX::FXMVECTOR eyePos);
+
+	///<summary>
+	/// Writes the indices of the visible meshlets to visible and returns how many there are.
+	///</summary>
+    static uint32 Cull(const MeshletData& data, const DirectX::BoundingFrustum& frustum, DirectX::FXMVECTOR eyePos,
+                       std::vector<uint32>& visible);
+};
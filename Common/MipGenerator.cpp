@@ -0,0 +1,606 @@
+//***************************************************************************************
+// MipGenerator.cpp
+//
+// Each level is resampled separably: the weights of every output column and row are
+// computed once per level, then bands of output rows filter the source rows they need
+// horizontally and combine those rows vertically.  Each band keeps its own filtered
+// rows, so the few source rows under two bands are filtered twice instead of a whole
+// horizontally filtered level being stored.  Levels below 0 are kept in float as the
+// source of the next one, so quantization does not add up down the chain.
+//***************************************************************************************
+
+#include "MipGenerator.h"
+#include "MappedFile.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define MIP_GENERATOR_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+    using Filter = MipGenerator::Filter;
+
+    // Output rows per ParallelFor task.
+    const uint32 BandHeight = 32;
+
+    // Windowed sinc filters reach this many output texels either side of the center.
+    const float SincRadius = 3.0f;
+    const float KaiserAlpha = 4.0f;
+    const float Pi = 3.14159265358979f;
+
+#if defined(MIP_GENERATOR_SSE2)
+    using Vec4 = __m128;
+
+    inline Vec4 Zero() { return _mm_setzero_ps(); }
+    inline Vec4 Load(const float* p) { return _mm_loadu_ps(p); }
+    inline void Store(float* p, Vec4 v) { _mm_storeu_ps(p, v); }
+    inline Vec4 MulAdd(Vec4 sum, Vec4 v, float weight) { return _mm_add_ps(sum, _mm_mul_ps(v, _mm_set1_ps(weight))); }
+#else
+    struct Vec4
+    {
+        float v[4];
+    };
+
+    inline Vec4 Zero() { return { { 0.0f, 0.0f, 0.0f, 0.0f } }; }
+    inline Vec4 Load(const float* p) { return { { p[0], p[1], p[2], p[3] } }; }
+    inline void Store(float* p, Vec4 v) { std::memcpy(p, v.v, sizeof(v.v)); }
+    inline Vec4 MulAdd(Vec4 sum, Vec4 v, float weight)
+    {
+        for(int i = 0; i < 4; ++i)
+            sum.v[i] += v.v[i]*weight;
+        return sum;
+    }
+#endif
+
+    // How texels are stored; every layout is filtered as four floats per texel.
+    enum class Layout
+    {
+        None,
+        RGBA8,      // also BGRA8: the color channels are filtered alike
+        RGBX8,      // BGRX8; alpha reads as one and is written as 255
+        RG8,
+        R8,
+        A8,
+        RGBA32F,
+        R32F
+    };
+
+    Layout GetLayout(DXGI_FORMAT format)
+    {
+        switch(format)
+        {
+        case DXGI_FORMAT_R8G8B8A8_UNORM:
+        case DXGI_FORMAT_R8G8B8A8_UNORM_SRGB:
+        case DXGI_FORMAT_B8G8R8A8_UNORM:
+        case DXGI_FORMAT_B8G8R8A8_UNORM_SRGB:   return Layout::RGBA8;
+        case DXGI_FORMAT_B8G8R8X8_UNORM:
+        case DXGI_FORMAT_B8G8R8X8_UNORM_SRGB:   return Layout::RGBX8;
+        case DXGI_FORMAT_R8G8_UNORM:            return Layout::RG8;
+        case DXGI_FORMAT_R8_UNORM:              return Layout::R8;
+        case DXGI_FORMAT_A8_UNORM:              return Layout::A8;
+        case DXGI_FORMAT_R32G32B32A32_FLOAT:    return Layout::RGBA32F;
+        case DXGI_FORMAT_R32_FLOAT:             return Layout::R32F;
+        default:                                return Layout::None;
+        }
+    }
+
+    bool IsSRGB(DXGI_FORMAT format)
+    {
+        return format == DXGI_FORMAT_R8G8B8A8_UNORM_SRGB ||
+               format == DXGI_FORMAT_B8G8R8A8_UNORM_SRGB ||
+               format == DXGI_FORMAT_B8G8R8X8_UNORM_SRGB;
+    }
+
+    float SRGBToLinear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : std::pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    // Linear value of every sRGB byte, and the linear value halfway between each pair of
+    // neighbours, so encoding rounds to the nearest byte in sRGB space.  Encoding starts
+    // from the byte for the bottom of the value's 1/4096 step and walks up the
+    // thresholds, which takes at most two steps where the curve is steepest.
+    struct SRGBTables
+    {
+        static const uint32 Steps = 4096;
+
+        float ToLinear[256];
+        float Thresholds[256];
+        uint8 StepStart[Steps];
+
+        SRGBTables()
+        {
+            for(int i = 0; i < 256; ++i)
+                ToLinear[i] = SRGBToLinear(i / 255.0f);
+            for(int i = 0; i < 255; ++i)
+                Thresholds[i] = SRGBToLinear((i + 0.5f) / 255.0f);
+            Thresholds[255] = 2.0f;
+
+            uint32 byte = 0;
+            for(uint32 i = 0; i < Steps; ++i)
+            {
+                while(Thresholds[byte] < (float)i / Steps)
+                    ++byte;
+                StepStart[i] = (uint8)byte;
+            }
+        }
+    };
+
+    const SRGBTables& GetSRGBTables()
+    {
+        static const SRGBTables tables;
+        return tables;
+    }
+
+    uint8 EncodeUnorm(float value)
+    {
+        value = std::min(std::max(value, 0.0f), 1.0f);
+        return (uint8)(value*255.0f + 0.5f);
+    }
+
+    uint8 EncodeSRGB(const SRGBTables& tables, float value)
+    {
+        value = std::min(std::max(value, 0.0f), 1.0f);
+        uint32 byte = tables.StepStart[std::min((uint32)(value*SRGBTables::Steps), SRGBTables::Steps - 1)];
+        while(tables.Thresholds[byte] < value)
+            ++byte;
+        return (uint8)byte;
+    }
+
+    // Reads one row of texels into four floats each, linear for sRGB formats.
+    void DecodeRow(Layout layout, bool srgb, const uint8* in, uint32 width, float* out)
+    {
+        const SRGBTables& tables = GetSRGBTables();
+        const float scale = 1.0f / 255.0f;
+        for(uint32 x = 0; x < width; ++x, out += 4)
+        {
+            switch(layout)
+            {
+            case Layout::RGBA8:
+            case Layout::RGBX8:
+                for(int c = 0; c < 3; ++c)
+                    out[c] = srgb ? tables.ToLinear[in[4*x + c]] : in[4*x + c]*scale;
+                out[3] = layout == Layout::RGBX8 ? 1.0f : in[4*x + 3]*scale;
+                break;
+            case Layout::RG8:
+                out[0] = in[2*x]*scale;
+                out[1] = in[2*x + 1]*scale;
+                out[2] = 0.0f;
+                out[3] = 1.0f;
+                break;
+            case Layout::R8:
+                out[0] = in[x]*scale;
+                out[1] = out[2] = 0.0f;
+                out[3] = 1.0f;
+                break;
+            case Layout::A8:
+                out[0] = out[1] = out[2] = 0.0f;
+                out[3] = in[x]*scale;
+                break;
+            case Layout::RGBA32F:
+                std::memcpy(out, in + 16*x, 16);
+                break;
+            case Layout::R32F:
+                std::memcpy(out, in + 4*x, 4);
+                out[1] = out[2] = 0.0f;
+                out[3] = 1.0f;
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    // Writes one row of filtered texels back in the storage format.  UNORM formats
+    // clamp, which also removes the overshoot of the sinc filters' negative lobes.
+    void EncodeRow(Layout layout, bool srgb, const float* in, uint32 width, uint8* out)
+    {
+        const SRGBTables& tables = GetSRGBTables();
+        for(uint32 x = 0; x < width; ++x, in += 4)
+        {
+            switch(layout)
+            {
+            case Layout::RGBA8:
+            case Layout::RGBX8:
+                for(int c = 0; c < 3; ++c)
+                    out[4*x + c] = srgb ? EncodeSRGB(tables, in[c]) : EncodeUnorm(in[c]);
+                out[4*x + 3] = layout == Layout::RGBX8 ? 255 : EncodeUnorm(in[3]);
+                break;
+            case Layout::RG8:
+                out[2*x] = EncodeUnorm(in[0]);
+                out[2*x + 1] = EncodeUnorm(in[1]);
+                break;
+            case Layout::R8:
+                out[x] = EncodeUnorm(in[0]);
+                break;
+            case Layout::A8:
+                out[x] = EncodeUnorm(in[3]);
+                break;
+            case Layout::RGBA32F:
+                std::memcpy(out + 16*x, in, 16);
+                break;
+            case Layout::R32F:
+                std::memcpy(out + 4*x, in, 4);
+                break;
+            default:
+                break;
+            }
+        }
+    }
+
+    float Sinc(float x)
+    {
+        if(std::fabs(x) < 1e-6f)
+            return 1.0f;
+        return std::sin(Pi*x) / (Pi*x);
+    }
+
+    // Modified Bessel function of the first kind, order 0, by its power series.
+    float BesselI0(float x)
+    {
+        float sum = 1.0f, term = 1.0f;
+        float quarterSquare = 0.25f*x*x;
+        for(int k = 1; k < 32 && term > 1e-8f*sum; ++k)
+        {
+            term *= quarterSquare / (float)(k*k);
+            sum += term;
+        }
+        return sum;
+    }
+
+    // Weight at distance x from the center, in output texels.
+    float EvaluateKernel(Filter filter, float x)
+    {
+        if(std::fabs(x) >= SincRadius)
+            return 0.0f;
+
+        if(filter == Filter::Lanczos)
+            return Sinc(x)*Sinc(x / SincRadius);
+
+        float r = x / SincRadius;
+        return Sinc(x)*BesselI0(KaiserAlpha*std::sqrt(1.0f - r*r)) / BesselI0(KaiserAlpha);
+    }
+
+    // The source texels and weights of every output texel along one axis, Taps per
+    // texel; texels with fewer pad with zero weights.
+    struct Contributions
+    {
+        uint32 Taps = 0;
+        std::vector<uint32> Index;
+        std::vector<float> Weight;
+    };
+
+    void ComputeContributions(Filter filter, uint32 sourceSize, uint32 destSize, Contributions& result)
+    {
+        std::vector<std::pair<uint32, float>> taps;
+        std::vector<std::vector<std::pair<uint32, float>>> all(destSize);
+
+        double scale = (double)sourceSize / (double)destSize;
+        for(uint32 i = 0; i < destSize; ++i)
+        {
+            taps.clear();
+            if(sourceSize == destSize)
+            {
+                taps.push_back({ i, 1.0f });
+            }
+            else if(filter == Filter::Box)
+            {
+                // The overlap of each source texel with the output texel's footprint.
+                double left = i*scale;
+                double right = (i + 1)*scale;
+                for(uint32 j = (uint32)left; j < sourceSize && j < right; ++j)
+                {
+                    double overlap = std::min(right, (double)j + 1.0) - std::max(left, (double)j);
+                    if(overlap > 1e-9)
+                        taps.push_back({ j, (float)overlap });
+                }
+            }
+            else
+            {
+                // The kernel stretched over the footprint, sampled at the source texel
+                // centers; texels past the edges clamp to it.
+                double center = (i + 0.5)*scale;
+                double support = SincRadius*scale;
+                int first = (int)std::floor(center - support);
+                int last = (int)std::ceil(center + support);
+                for(int j = first; j <= last; ++j)
+                {
+                    float weight = EvaluateKernel(filter, (float)((j + 0.5 - center) / scale));
+                    if(weight == 0.0f)
+                        continue;
+
+                    uint32 index = (uint32)std::min(std::max(j, 0), (int)sourceSize - 1);
+                    if(!taps.empty() && taps.back().first == index)
+                        taps.back().second += weight;
+                    else
+                        taps.push_back({ index, weight });
+                }
+            }
+
+            float sum = 0.0f;
+            for(const auto& tap : taps)
+                sum += tap.second;
+            for(auto& tap : taps)
+                tap.second /= sum;
+
+            all[i] = taps;
+        }
+
+        result.Taps = 0;
+        for(const auto& texel : all)
+            result.Taps = std::max(result.Taps, (uint32)texel.size());
+
+        result.Index.assign((size_t)destSize*result.Taps, 0);
+        result.Weight.assign((size_t)destSize*result.Taps, 0.0f);
+        for(uint32 i = 0; i < destSize; ++i)
+        {
+            for(uint32 t = 0; t < result.Taps; ++t)
+            {
+                // Padding repeats the last texel, so band row ranges stay tight.
+                const auto& tap = all[i][std::min(t, (uint32)all[i].size() - 1)];
+                result.Index[(size_t)i*result.Taps + t] = tap.first;
+                result.Weight[(size_t)i*result.Taps + t] = t < all[i].size() ? tap.second : 0.0f;
+            }
+        }
+    }
+
+    // Level 0 is read in its storage format, later levels from the float copy.
+    struct SourceLevel
+    {
+        const uint8* Data = nullptr;
+        size_t RowPitch = 0;
+        const float* Floats = nullptr;
+        uint32 Width = 0;
+        uint32 Height = 0;
+    };
+
+    // Filters source down to destWidth x destHeight.  Writes the result packed in the
+    // storage format to dest (destRowPitch bytes per row) and, when destFloats is not
+    // null, in float to destFloats.
+    void Resample(Layout layout, bool srgb, Filter filter, const SourceLevel& source,
+                  uint32 destWidth, uint32 destHeight, uint8* dest, size_t destRowPitch, float* destFloats)
+    {
+        Contributions columns, rows;
+        ComputeContributions(filter, source.Width, destWidth, columns);
+        ComputeContributions(filter, source.Height, destHeight, rows);
+
+        uint32 bandCount = (destHeight + BandHeight - 1) / BandHeight;
+        ThreadPool::Get().ParallelFor(bandCount, [&](uint32 band)
+        {
+            uint32 firstRow = band*BandHeight;
+            uint32 lastRow = std::min(firstRow + BandHeight, destHeight) - 1;
+
+            uint32 sourceFirst = source.Height, sourceLast = 0;
+            for(size_t i = (size_t)firstRow*rows.Taps; i < (size_t)(lastRow + 1)*rows.Taps; ++i)
+            {
+                sourceFirst = std::min(sourceFirst, rows.Index[i]);
+                sourceLast = std::max(sourceLast, rows.Index[i]);
+            }
+
+            // Horizontal pass over the source rows under the band.
+            size_t filteredPitch = (size_t)destWidth*4;
+            std::vector<float> filtered(filteredPitch*(sourceLast - sourceFirst + 1));
+            std::vector<float> decoded(source.Floats ? 0 : (size_t)source.Width*4);
+            for(uint32 y = sourceFirst; y <= sourceLast; ++y)
+            {
+                const float* in;
+                if(source.Floats)
+                {
+                    in = source.Floats + (size_t)y*source.Width*4;
+                }
+                else
+                {
+                    DecodeRow(layout, srgb, source.Data + y*source.RowPitch, source.Width, decoded.data());
+                    in = decoded.data();
+                }
+
+                float* out = filtered.data() + (y - sourceFirst)*filteredPitch;
+                const uint32* index = columns.Index.data();
+                const float* weight = columns.Weight.data();
+                for(uint32 x = 0; x < destWidth; ++x)
+                {
+                    Vec4 sum = Zero();
+                    for(uint32 t = 0; t < columns.Taps; ++t, ++index, ++weight)
+                        sum = MulAdd(sum, Load(in + (size_t)*index*4), *weight);
+                    Store(out + (size_t)x*4, sum);
+                }
+            }
+
+            // Vertical pass.
+            std::vector<float> row(filteredPitch);
+            for(uint32 y = firstRow; y <= lastRow; ++y)
+            {
+                const uint32* index = rows.Index.data() + (size_t)y*rows.Taps;
+                const float* weight = rows.Weight.data() + (size_t)y*rows.Taps;
+                float* out = destFloats ? destFloats + (size_t)y*filteredPitch : row.data();
+                for(uint32 x = 0; x < destWidth; ++x)
+                {
+                    Vec4 sum = Zero();
+                    for(uint32 t = 0; t < rows.Taps; ++t)
+                        sum = MulAdd(sum, Load(filtered.data() + (index[t] - sourceFirst)*filteredPitch + (size_t)x*4), weight[t]);
+                    Store(out + (size_t)x*4, sum);
+                }
+
+                EncodeRow(layout, srgb, out, destWidth, dest + y*destRowPitch);
+            }
+        });
+    }
+
+    bool Fail(std::string* error, const std::string& message)
+    {
+        if(error)
+            *error = message;
+        return false;
+    }
+}
+
+bool MipGenerator::IsSupported(DXGI_FORMAT format)
+{
+    return GetLayout(format) != Layout::None;
+}
+
+MipGenerator::uint32 MipGenerator::GetFullMipCount(uint32 width, uint32 height)
+{
+    uint32 size = std::max(width, height);
+    uint32 count = 1;
+    while(size > 1)
+    {
+        size >>= 1;
+        ++count;
+    }
+    return count;
+}
+
+MipGenerator::uint64 MipGenerator::GetChainSize(DXGI_FORMAT format, uint32 width, uint32 height, uint32 mipCount)
+{
+    uint64 size = 0;
+    for(uint32 mip = 0; mip < mipCount; ++mip)
+    {
+        size_t numBytes = 0;
+        DDSParser::GetSurfaceInfo(std::max(width >> mip, 1u), std::max(height >> mip, 1u), format, &numBytes, nullptr, nullptr);
+        size += numBytes;
+    }
+    return size;
+}
+
+bool MipGenerator::GenerateChain(DXGI_FORMAT format, const std::uint8_t* source, size_t sourceRowPitch,
+                                 uint32 width, uint32 height, uint32 mipCount, Filter filter, std::uint8_t* dest)
+{
+    Layout layout = GetLayout(format);
+    if(layout == Layout::None || width == 0 || height == 0 || mipCount == 0 || mipCount > GetFullMipCount(width, height))
+        return false;
+
+    bool srgb = IsSRGB(format);
+
+    size_t numBytes = 0, rowBytes = 0;
+    DDSParser::GetSurfaceInfo(width, height, format, &numBytes, &rowBytes, nullptr);
+    for(uint32 y = 0; y < height; ++y)
+        std::memcpy(dest + y*rowBytes, source + y*sourceRowPitch, rowBytes);
+
+    SourceLevel level;
+    level.Data = source;
+    level.RowPitch = sourceRowPitch;
+    level.Width = width;
+    level.Height = height;
+
+    std::vector<float> floats[2];
+    dest += numBytes;
+    for(uint32 mip = 1; mip < mipCount; ++mip)
+    {
+        uint32 mipWidth = std::max(width >> mip, 1u);
+        uint32 mipHeight = std::max(height >> mip, 1u);
+        DDSParser::GetSurfaceInfo(mipWidth, mipHeight, format, &numBytes, &rowBytes, nullptr);
+
+        std::vector<float>& mipFloats = floats[mip & 1];
+        bool last = mip + 1 == mipCount;
+        if(!last)
+            mipFloats.resize((size_t)mipWidth*mipHeight*4);
+
+        Resample(layout, srgb, filter, level, mipWidth, mipHeight, dest, rowBytes, last ? nullptr : mipFloats.data());
+
+        level.Data = nullptr;
+        level.Floats = mipFloats.data();
+        level.Width = mipWidth;
+        level.Height = mipHeight;
+        dest += numBytes;
+    }
+
+    return true;
+}
+
+bool MipGenerator::GenerateMips(DXGI_FORMAT format, uint32 width, uint32 height, uint32 arraySize,
+                                const std::uint8_t* bitData, size_t bitSize, Filter filter,
+                                std::vector<std::uint8_t>& chain, uint32* mipCount)
+{
+    if(!IsSupported(format) || width == 0 || height == 0 || arraySize == 0)
+        return false;
+
+    size_t numBytes = 0, rowBytes = 0;
+    DDSParser::GetSurfaceInfo(width, height, format, &numBytes, &rowBytes, nullptr);
+    if(bitSize < (uint64)numBytes*arraySize)
+        return false;
+
+    uint32 count = GetFullMipCount(width, height);
+    uint64 chainSize = GetChainSize(format, width, height, count);
+    chain.resize((size_t)(chainSize*arraySize));
+
+    for(uint32 slice = 0; slice < arraySize; ++slice)
+    {
+        if(!GenerateChain(format, bitData + (size_t)slice*numBytes, rowBytes, width, height, count, filter,
+                          chain.data() + (size_t)(slice*chainSize)))
+            return false;
+    }
+
+    if(mipCount)
+        *mipCount = count;
+    return true;
+}
+
+bool MipGenerator::GenerateDDS(const std::uint8_t* fileData, uint64 fileSize, Filter filter,
+                               std::vector<std::uint8_t>& output, std::string* error)
+{
+    output.clear();
+
+    DDSParser::Layout layout;
+    if(DDSParser::Parse(fileData, fileSize, layout) != DDSParser::Result::Ok)
+        return Fail(error, "not a valid DDS file");
+
+    const DDSParser::TextureDesc& desc = layout.Desc;
+    if(!IsSupported(desc.Format))
+        return Fail(error, "unsupported format");
+    if(desc.Dimension == DDSParser::TextureDimension::Texture3D)
+        return Fail(error, "volume textures are not supported");
+
+    DDSParser::TextureDesc outputDesc = desc;
+    outputDesc.MipCount = GetFullMipCount(desc.Width, desc.Height);
+    uint64 chainSize = GetChainSize(desc.Format, desc.Width, desc.Height, outputDesc.MipCount);
+
+    output.resize((size_t)(DDSParser::DX10HeaderSize + chainSize*desc.ArraySize));
+    DDSParser::WriteHeader(outputDesc, output.data());
+
+    for(uint32 slice = 0; slice < desc.ArraySize; ++slice)
+    {
+        const DDSParser::Subresource& top = layout.Subresources[(size_t)slice*desc.MipCount];
+        uint8* dest = output.data() + DDSParser::DX10HeaderSize + slice*chainSize;
+        if(!GenerateChain(desc.Format, fileData + top.Offset, (size_t)top.RowPitch, desc.Width, desc.Height,
+                          outputDesc.MipCount, filter, dest))
+        {
+            output.clear();
+            return Fail(error, "mip generation failed");
+        }
+    }
+
+    return true;
+}
+
+bool MipGenerator::GenerateFile(const std::filesystem::path& source, const std::filesystem::path& dest, Filter filter,
+                                std::string* error)
+{
+    std::vector<uint8> output;
+    {
+        MappedFile file;
+        if(!file.Open(source))
+            return Fail(error, "cannot open " + source.string());
+        if(!GenerateDDS(file.GetData(), file.GetSize(), filter, output, error))
+            return false;
+    }
+
+    std::ofstream out(dest, std::ios::binary | std::ios::trunc);
+    if(!out)
+        return Fail(error, "cannot create " + dest.string());
+
+    out.write(reinterpret_cast<const char*>(output.data()), (std::streamsize)output.size());
+    if(!out.flush())
+        return Fail(error, "write failed for " + dest.string());
+
+    return true;
+}
@@ -0,0 +1,84 @@
+//***************************************************************************************
+// MipGenerator.h
+//
+// CPU mip chains for uncompressed textures that come without them.  Each level is
+// filtered from the one above it in linear float, four channels per SSE register, in
+// bands of rows on the ThreadPool.  Formats with _SRGB are filtered gamma-correctly
+// (decoded to linear light first, encoded again on output); alpha is always linear.
+// Texels outside the surface clamp to the edge.
+//
+// Filters:
+//   Box       average of the texels under each output texel (2x2 for even sizes, with
+//             fractional weights for odd ones); cheap enough for load time
+//   Kaiser    Kaiser-windowed sinc, radius 3, alpha 4: sharper, for bake time
+//   Lanczos   Lanczos-3 windowed sinc, slightly sharper than Kaiser with more ringing
+//
+// Given DDS_LOADER_MIP_AUTOGEN, CreateDDSTextureFromFile12 and
+// CreateDDSTextureFromMemory12 call GenerateMips with Box for 2D textures that have a
+// single mip in a supported format.  At bake time,
+//     MipGenerator::GenerateFile("Textures/decal.dds", "Textures/decal_mips.dds", MipGenerator::Filter::Kaiser);
+// writes the full chain to disk instead.
+//***************************************************************************************
+
+#pragma once
+
+#include "DDSParser.h"
+#include <string>
+
+class MipGenerator
+{
+public:
+
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    enum class Filter
+    {
+        Box,
+        Kaiser,
+        Lanczos
+    };
+
+	///<summary>
+	/// R8G8B8A8, B8G8R8A8 and B8G8R8X8 (UNORM or _SRGB), R8G8, R8, A8,
+	/// R32G32B32A32_FLOAT and R32_FLOAT.
+	///</summary>
+    static bool IsSupported(DXGI_FORMAT format);
+
+	///<summary>
+	/// Levels down to 1x1: 1 + floor(log2(max(width, height))).
+	///</summary>
+    static uint32 GetFullMipCount(uint32 width, uint32 height);
+
+	///<summary>
+	/// Bytes of mipCount levels of one surface, packed as in a DDS file.
+	///</summary>
+    static uint64 GetChainSize(DXGI_FORMAT format, uint32 width, uint32 height, uint32 mipCount);
+
+	///<summary>
+	/// Writes mipCount levels of a width x height surface to dest, packed as in a DDS
+	/// file (GetSurfaceInfo row pitches): level 0 is copied from source, the others are
+	/// filtered.  dest must hold GetChainSize bytes.
+	///</summary>
+    static bool GenerateChain(DXGI_FORMAT format, const std::uint8_t* source, size_t sourceRowPitch,
+                              uint32 width, uint32 height, uint32 mipCount, Filter filter, std::uint8_t* dest);
+
+	///<summary>
+	/// Full chains for arraySize packed single-mip surfaces (cube faces count as
+	/// slices), in the order FillInitData12 reads them: every level of slice 0, then
+	/// every level of slice 1, and so on.
+	///</summary>
+    static bool GenerateMips(DXGI_FORMAT format, uint32 width, uint32 height, uint32 arraySize,
+                             const std::uint8_t* bitData, size_t bitSize, Filter filter,
+                             std::vector<std::uint8_t>& chain, uint32* mipCount);
+
+	///<summary>
+	/// Rebuilds every mip below level 0 of a 2D DDS file in memory (array and cube
+	/// textures included) and writes a DDS file with a DX10 header and the full chain
+	/// to output.
+	///</summary>
+    static bool GenerateDDS(const std::uint8_t* fileData, uint64 fileSize, Filter filter,
+                            std::vector<std::uint8_t>& output, std::string* error = nullptr);
+    static bool GenerateFile(const std::filesystem::path& source, const std::filesystem::path& dest, Filter filter,
+                             std::string* error = nullptr);
+};
@@ -0,0 +1,591 @@
+//***************************************************************************************
+// ObjLoader.cpp
+//***************************************************************************************
+
+#include "ObjLoader.h"
+#include "MappedFile.h"
+#include "TangentGenerator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <charconv>
+#include <cstring>
+#include <unordered_map>
+
+#if defined(_WIN32)
+#include "d3dUtil.h"
+#endif
+
+using namespace DirectX;
+
+namespace
+{
+    using uint32 = std::uint32_t;
+
+    // Chunks are at least this large, so small files are not split needlessly.
+    const size_t MinChunkSize = 1 << 20;
+
+    // Positions handed to one ParallelFor task while building vertices.
+    const uint32 PositionBlockSize = 16384;
+
+    const uint32 NoIndex = 0xffffffff;
+
+    struct Corner
+    {
+        uint32 Position = NoIndex;
+        uint32 TexC = NoIndex;
+        uint32 Normal = NoIndex;
+    };
+
+    struct MaterialChange
+    {
+        // Chunk-local index of the first triangle using Name.
+        uint32 Triangle = 0;
+        std::string Name;
+    };
+
+    struct Chunk
+    {
+        const char* Begin = nullptr;
+        const char* End = nullptr;
+
+        // Attribute lines in the chunk, and where they start in the shared arrays.
+        uint32 PositionCount = 0;
+        uint32 TexCCount = 0;
+        uint32 NormalCount = 0;
+        uint32 PositionBase = 0;
+        uint32 TexCBase = 0;
+        uint32 NormalBase = 0;
+
+        // Lines in the chunk, and the 1-based number of its first line in the file.
+        uint32 LineCount = 0;
+        uint32 FirstLine = 1;
+
+        std::vector<Corner> Corners;
+        std::vector<MaterialChange> MaterialChanges;
+        std::vector<std::string> Libraries;
+        std::string Error;
+    };
+
+    struct Attributes
+    {
+        std::vector<XMFLOAT3> Positions;
+        std::vector<XMFLOAT2> TexCs;
+        std::vector<XMFLOAT3> Normals;
+    };
+
+    inline const char* SkipSpaces(const char* p, const char* end)
+    {
+        while(p < end && (*p == ' ' || *p == '\t'))
+            ++p;
+        return p;
+    }
+
+    inline const char* FindLineEnd(const char* p, const char* end)
+    {
+        const void* newline = std::memchr(p, '\n', end - p);
+        return newline != nullptr ? static_cast<const char*>(newline) : end;
+    }
+
+    // The rest of the line without surrounding blanks (handles \r\n files).
+    inline std::string RestOfLine(const char* p, const char* end)
+    {
+        p = SkipSpaces(p, end);
+        while(end > p && (end[-1] == ' ' || end[-1] == '\t' || end[-1] == '\r'))
+            --end;
+        return std::string(p, end);
+    }
+
+    inline bool ParseFloat(const char*& p, const char* end, float& value)
+    {
+        p = SkipSpaces(p, end);
+        if(p < end && *p == '+')
+            ++p;
+
+        auto result = std::from_chars(p, end, value);
+        if(result.ec != std::errc())
+            return false;
+
+        p = result.ptr;
+        return true;
+    }
+
+    // Parses one 1-based (or negative, relative) OBJ index and makes it 0-based.
+    inline bool ParseIndex(const char*& p, const char* end, uint32 countSoFar, uint32 total, uint32& index)
+    {
+        long long value = 0;
+        auto result = std::from_chars(p, end, value);
+        if(result.ec != std::errc() || value == 0)
+            return false;
+
+        p = result.ptr;
+
+        long long resolved = value > 0 ? value - 1 : (long long)countSoFar + value;
+        if(resolved < 0 || resolved >= (long long)total)
+            return false;
+
+        index = (uint32)resolved;
+        return true;
+    }
+
+    // Attribute line kinds: 1 = v, 2 = vt, 3 = vn, 0 = anything else.
+    inline int AttributeKind(const char* p, const char* end)
+    {
+        if(end - p < 2 || p[0] != 'v')
+            return 0;
+        if(p[1] == ' ' || p[1] == '\t')
+            return 1;
+        if(end - p < 3 || (p[2] != ' ' && p[2] != '\t'))
+            return 0;
+        return p[1] == 't' ? 2 : (p[1] == 'n' ? 3 : 0);
+    }
+
+    void CountAttributes(Chunk& chunk)
+    {
+        for(const char* line = chunk.Begin; line < chunk.End; )
+        {
+            const char* lineEnd = FindLineEnd(line, chunk.End);
+            switch(AttributeKind(SkipSpaces(line, lineEnd), lineEnd))
+            {
+            case 1: chunk.PositionCount++; break;
+            case 2: chunk.TexCCount++; break;
+            case 3: chunk.NormalCount++; break;
+            }
+            chunk.LineCount++;
+            line = lineEnd + 1;
+        }
+    }
+
+    void ParseChunk(Chunk& chunk, Attributes& attributes)
+    {
+        uint32 positions = 0, texCs = 0, normals = 0;
+        uint32 totalPositions = (uint32)attributes.Positions.size();
+        uint32 totalTexCs = (uint32)attributes.TexCs.size();
+        uint32 totalNormals = (uint32)attributes.Normals.size();
+
+        std::vector<Corner> polygon;
+        uint32 lineNumber = chunk.FirstLine - 1;
+
+        for(const char* line = chunk.Begin; line < chunk.End; )
+        {
+            const char* lineEnd = FindLineEnd(line, chunk.End);
+            const char* p = SkipSpaces(line, lineEnd);
+            lineNumber++;
+
+            bool ok = true;
+            switch(AttributeKind(p, lineEnd))
+            {
+            case 1:
+            {
+                XMFLOAT3& v = attributes.Positions[chunk.PositionBase + positions++];
+                p += 1;
+                ok = ParseFloat(p, lineEnd, v.x) && ParseFloat(p, lineEnd, v.y) && ParseFloat(p, lineEnd, v.z);
+                break;
+            }
+            case 2:
+            {
+                XMFLOAT2& t = attributes.TexCs[chunk.TexCBase + texCs++];
+                p += 2;
+                ok = ParseFloat(p, lineEnd, t.x);
+                t.y = 0.0f;
+                const char* q = p;
+                if(ok && ParseFloat(q, lineEnd, t.y))
+                    p = q;
+                t.y = 1.0f - t.y;
+                break;
+            }
+            case 3:
+            {
+                XMFLOAT3& n = attributes.Normals[chunk.NormalBase + normals++];
+                p += 2;
+                ok = ParseFloat(p, lineEnd, n.x) && ParseFloat(p, lineEnd, n.y) && ParseFloat(p, lineEnd, n.z);
+                break;
+            }
+            default:
+                if(lineEnd - p >= 2 && p[0] == 'f' && (p[1] == ' ' || p[1] == '\t'))
+                {
+                    polygon.clear();
+                    p += 1;
+
+                    for(;;)
+                    {
+                        p = SkipSpaces(p, lineEnd);
+                        if(p == lineEnd || *p == '\r' || *p == '#')
+                            break;
+
+                        Corner corner;
+                        ok = ParseIndex(p, lineEnd, chunk.PositionBase + positions, totalPositions, corner.Position);
+                        if(ok && p < lineEnd && *p == '/')
+                        {
+                            ++p;
+                            if(p < lineEnd && *p != '/')
+                                ok = ParseIndex(p, lineEnd, chunk.TexCBase + texCs, totalTexCs, corner.TexC);
+                            if(ok && p < lineEnd && *p == '/')
+                            {
+                                ++p;
+                                ok = ParseIndex(p, lineEnd, chunk.NormalBase + normals, totalNormals, corner.Normal);
+                            }
+                        }
+                        if(!ok)
+                            break;
+
+                        polygon.push_back(corner);
+                    }
+
+                    // Fan triangulation; convex polygons are the norm in OBJ files.  The
+                    // corners are reversed (see ObjLoader.h).
+                    for(size_t i = 1; ok && i + 1 < polygon.size(); ++i)
+                    {
+                        chunk.Corners.push_back(polygon[0]);
+                        chunk.Corners.push_back(polygon[i+1]);
+                        chunk.Corners.push_back(polygon[i]);
+                    }
+                }
+                else if(lineEnd - p > 7 && std::strncmp(p, "usemtl", 6) == 0 && (p[6] == ' ' || p[6] == '\t'))
+                {
+                    MaterialChange change;
+                    change.Triangle = (uint32)(chunk.Corners.size()/3);
+                    change.Name = RestOfLine(p + 6, lineEnd);
+                    chunk.MaterialChanges.push_back(std::move(change));
+                }
+                else if(lineEnd - p > 7 && std::strncmp(p, "mtllib", 6) == 0 && (p[6] == ' ' || p[6] == '\t'))
+                {
+                    chunk.Libraries.push_back(RestOfLine(p + 6, lineEnd));
+                }
+                break;
+            }
+
+            if(!ok)
+            {
+                chunk.Error = "line " + std::to_string(lineNumber) + ": malformed: " + RestOfLine(line, lineEnd);
+                return;
+            }
+
+            line = lineEnd + 1;
+        }
+    }
+}
+
+bool ObjLoader::Load(const std::filesystem::path& filename, ObjModel& model, std::string* error)
+{
+    MappedFile file;
+    if(!file.Open(filename))
+    {
+        if(error != nullptr)
+            *error = "cannot open " + filename.string();
+        return false;
+    }
+
+    file.Prefetch(0, file.GetSize());
+
+    return Parse(reinterpret_cast<const char*>(file.GetData()), (size_t)file.GetSize(), model, error);
+}
+
+bool ObjLoader::Parse(const char* text, size_t size, ObjModel& model, std::string* error)
+{
+    model = ObjModel();
+    ThreadPool& pool = ThreadPool::Get();
+
+    //
+    // Split into line-aligned chunks.
+    //
+
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(size / MinChunkSize, pool.GetThreadCount()*8));
+    std::vector<Chunk> chunks(chunkCount);
+
+    const char* end = text + size;
+    const char* begin = text;
+    for(size_t i = 0; i < chunkCount; ++i)
+    {
+        const char* chunkEnd = i + 1 == chunkCount ? end : text + size*(i+1)/chunkCount;
+        if(chunkEnd < begin)
+            chunkEnd = begin;
+        if(chunkEnd < end)
+            chunkEnd = std::min(end, FindLineEnd(chunkEnd, end) + 1);
+
+        chunks[i].Begin = begin;
+        chunks[i].End = chunkEnd;
+        begin = chunkEnd;
+    }
+
+    //
+    // Pass 1: count attributes so every chunk knows its bases.
+    //
+
+    pool.ParallelFor((uint32)chunkCount, [&](uint32 i) { CountAttributes(chunks[i]); });
+
+    uint32 positionCount = 0, texCCount = 0, normalCount = 0, lineCount = 0;
+    for(Chunk& chunk : chunks)
+    {
+        chunk.PositionBase = positionCount;
+        chunk.TexCBase = texCCount;
+        chunk.NormalBase = normalCount;
+        chunk.FirstLine = lineCount + 1;
+        positionCount += chunk.PositionCount;
+        texCCount += chunk.TexCCount;
+        normalCount += chunk.NormalCount;
+        lineCount += chunk.LineCount;
+    }
+
+    //
+    // Pass 2: parse attributes in place and faces into chunk-local corners.
+    //
+
+    Attributes attributes;
+    attributes.Positions.resize(positionCount);
+    attributes.TexCs.resize(texCCount);
+    attributes.Normals.resize(normalCount);
+
+    pool.ParallelFor((uint32)chunkCount, [&](uint32 i) { ParseChunk(chunks[i], attributes); });
+
+    for(const Chunk& chunk : chunks)
+    {
+        if(!chunk.Error.empty())
+        {
+            if(error != nullptr)
+                *error = chunk.Error;
+            return false;
+        }
+    }
+
+    //
+    // Gather the triangles with their material ids.  Material 0 is the unnamed one
+    // used before the first usemtl.
+    //
+
+    std::vector<std::string> materialNames(1);
+    std::unordered_map<std::string, uint32> materialIds;
+    materialIds[""] = 0;
+
+    std::vector<uint32> chunkTriangleBase(chunkCount + 1, 0);
+    for(size_t i = 0; i < chunkCount; ++i)
+        chunkTriangleBase[i+1] = chunkTriangleBase[i] + (uint32)(chunks[i].Corners.size()/3);
+    uint32 triangleCount = chunkTriangleBase[chunkCount];
+
+    std::vector<Corner> corners((size_t)triangleCount*3);
+    std::vector<uint32> triangleMaterials(triangleCount);
+
+    uint32 material = 0;
+    for(size_t i = 0; i < chunkCount; ++i)
+    {
+        const Chunk& chunk = chunks[i];
+        uint32 base = chunkTriangleBase[i];
+        uint32 chunkTriangles = chunkTriangleBase[i+1] - base;
+
+        std::copy(chunk.Corners.begin(), chunk.Corners.end(), corners.begin() + (size_t)base*3);
+
+        uint32 t = 0;
+        for(const MaterialChange& change : chunk.MaterialChanges)
+        {
+            std::fill(triangleMaterials.begin() + base + t, triangleMaterials.begin() + base + change.Triangle, material);
+            t = change.Triangle;
+
+            auto it = materialIds.find(change.Name);
+            if(it == materialIds.end())
+            {
+                it = materialIds.emplace(change.Name, (uint32)materialNames.size()).first;
+                materialNames.push_back(change.Name);
+            }
+            material = it->second;
+        }
+        std::fill(triangleMaterials.begin() + base + t, triangleMaterials.begin() + base + chunkTriangles, material);
+
+        model.MaterialLibraries.insert(model.MaterialLibraries.end(), chunk.Libraries.begin(), chunk.Libraries.end());
+    }
+    chunks.clear();
+
+    //
+    // Deduplicate (position, uv, normal) tuples.  Corners are bucketed by position
+    // index (counting sort); each bucket then only holds the few tuples sharing that
+    // position, found by a short linear search.
+    //
+
+    uint32 cornerCount = triangleCount*3;
+
+    std::vector<uint32> bucketOffsets(positionCount + 1, 0);
+    for(const Corner& corner : corners)
+        bucketOffsets[corner.Position + 1]++;
+    for(uint32 p = 0; p < positionCount; ++p)
+        bucketOffsets[p+1] += bucketOffsets[p];
+
+    std::vector<uint32> bucketCorners(cornerCount);
+    {
+        std::vector<uint32> fill(bucketOffsets.begin(), bucketOffsets.end() - 1);
+        for(uint32 c = 0; c < cornerCount; ++c)
+            bucketCorners[fill[corners[c].Position]++] = c;
+    }
+
+    // Per bucket: the first corner of every distinct tuple (stored in the bucket's own
+    // slice) and how many there are.
+    std::vector<uint32> uniqueCorners(cornerCount);
+    std::vector<uint32> uniqueCounts(positionCount + 1, 0);
+    std::vector<uint32> cornerVertices(cornerCount);
+
+    uint32 positionBlocks = (positionCount + PositionBlockSize - 1)/PositionBlockSize;
+    pool.ParallelFor(positionBlocks, [&](uint32 block)
+    {
+        uint32 first = block*PositionBlockSize;
+        uint32 last = std::min(positionCount, first + PositionBlockSize);
+
+        for(uint32 p = first; p < last; ++p)
+        {
+            uint32 begin = bucketOffsets[p];
+            uint32 unique = 0;
+
+            for(uint32 i = begin; i < bucketOffsets[p+1]; ++i)
+            {
+                const Corner& corner = corners[bucketCorners[i]];
+
+                uint32 k = 0;
+                while(k < unique)
+                {
+                    const Corner& other = corners[uniqueCorners[begin + k]];
+                    if(other.TexC == corner.TexC && other.Normal == corner.Normal)
+                        break;
+                    ++k;
+                }
+
+                if(k == unique)
+                    uniqueCorners[begin + unique++] = bucketCorners[i];
+
+                // Local id for now, made global once the bucket bases are known.
+                cornerVertices[bucketCorners[i]] = k;
+            }
+
+            uniqueCounts[p+1] = unique;
+        }
+    });
+
+    // uniqueCounts becomes the first vertex of every bucket.
+    for(uint32 p = 0; p < positionCount; ++p)
+        uniqueCounts[p+1] += uniqueCounts[p];
+    uint32 vertexCount = uniqueCounts[positionCount];
+
+    GeometryGenerator::MeshData& mesh = model.Mesh;
+    mesh.Vertices.resize(vertexCount);
+
+    std::atomic<bool> missingNormals(false);
+    pool.ParallelFor(positionBlocks, [&](uint32 block)
+    {
+        uint32 first = block*PositionBlockSize;
+        uint32 last = std::min(positionCount, first + PositionBlockSize);
+
+        for(uint32 p = first; p < last; ++p)
+        {
+            uint32 vertexBase = uniqueCounts[p];
+            for(uint32 k = 0; k < uniqueCounts[p+1] - vertexBase; ++k)
+            {
+                const Corner& corner = corners[uniqueCorners[bucketOffsets[p] + k]];
+
+                GeometryGenerator::Vertex& v = mesh.Vertices[vertexBase + k];
+                v.Position = attributes.Positions[p];
+                v.TexC = corner.TexC != NoIndex ? attributes.TexCs[corner.TexC] : XMFLOAT2(0.0f, 0.0f);
+                v.TangentU = XMFLOAT3(0.0f, 0.0f, 0.0f);
+                if(corner.Normal != NoIndex)
+                    v.Normal = attributes.Normals[corner.Normal];
+                else
+                {
+                    v.Normal = XMFLOAT3(0.0f, 0.0f, 0.0f);
+                    missingNormals.store(true, std::memory_order_relaxed);
+                }
+            }
+
+            for(uint32 i = bucketOffsets[p]; i < bucketOffsets[p+1]; ++i)
+                cornerVertices[bucketCorners[i]] += vertexBase;
+        }
+    });
+
+    //
+    // Index buffer with the triangles grouped by material (stable counting sort).
+    //
+
+    std::vector<uint32> materialOffsets(materialNames.size() + 1, 0);
+    for(uint32 m : triangleMaterials)
+        materialOffsets[m + 1]++;
+    for(size_t m = 0; m + 1 < materialOffsets.size(); ++m)
+    {
+        if(materialOffsets[m+1] > 0)
+        {
+            Submesh submesh;
+            submesh.Material = materialNames[m];
+            submesh.StartIndexLocation = materialOffsets[m]*3;
+            submesh.IndexCount = materialOffsets[m+1]*3;
+            model.Submeshes.push_back(submesh);
+        }
+        materialOffsets[m+1] += materialOffsets[m];
+    }
+
+    mesh.Indices32.resize(cornerCount);
+    for(uint32 t = 0; t < triangleCount; ++t)
+    {
+        uint32 destination = materialOffsets[triangleMaterials[t]]++;
+        for(uint32 k = 0; k < 3; ++k)
+            mesh.Indices32[destination*3 + k] = cornerVertices[t*3 + k];
+    }
+
+    //
+    // Derived attributes.
+    //
+
+    if(missingNormals)
+    {
+        // Area-weighted face normals summed per position, so uv seams stay smooth.  The
+        // corners run clockwise in the file's right-handed space.
+        std::vector<XMFLOAT3> positionNormals(positionCount, XMFLOAT3(0.0f, 0.0f, 0.0f));
+        for(uint32 t = 0; t < triangleCount; ++t)
+        {
+            const Corner* tri = &corners[t*3];
+            XMVECTOR p0 = XMLoadFloat3(&attributes.Positions[tri[0].Position]);
+            XMVECTOR p1 = XMLoadFloat3(&attributes.Positions[tri[1].Position]);
+            XMVECTOR p2 = XMLoadFloat3(&attributes.Positions[tri[2].Position]);
+            XMVECTOR faceNormal = XMVector3Cross(p2 - p0, p1 - p0);
+
+            for(uint32 k = 0; k < 3; ++k)
+            {
+                XMFLOAT3& n = positionNormals[tri[k].Position];
+                XMStoreFloat3(&n, XMLoadFloat3(&n) + faceNormal);
+            }
+        }
+
+        for(uint32 p = 0; p < positionCount; ++p)
+        {
+            XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&positionNormals[p]));
+            for(uint32 v = uniqueCounts[p]; v < uniqueCounts[p+1]; ++v)
+            {
+                const Corner& corner = corners[uniqueCorners[bucketOffsets[p] + v - uniqueCounts[p]]];
+                if(corner.Normal == NoIndex)
+                    XMStoreFloat3(&mesh.Vertices[v].Normal, n);
+            }
+        }
+    }
+
+    if(texCCount > 0)
+        TangentGenerator::Generate(mesh);
+
+    GeometryGenerator::ComputeBounds(mesh);
+
+    return true;
+}
+
+#if defined(_WIN32)
+void ObjLoader::AddSubmeshes(MeshGeometry& geometry, const std::string& name, const ObjModel& model,
+                             uint32 startIndexLocation, std::int32_t baseVertexLocation)
+{
+    const GeometryGenerator::MeshData& mesh = model.Mesh;
+    const XMFLOAT3* positions = mesh.Vertices.empty() ? nullptr : &mesh.Vertices[0].Position;
+
+    for(const Submesh& objSubmesh : model.Submeshes)
+    {
+        SubmeshGeometry submesh;
+        submesh.IndexCount = objSubmesh.IndexCount;
+        submesh.StartIndexLocation = startIndexLocation + objSubmesh.StartIndexLocation;
+        submesh.BaseVertexLocation = baseVertexLocation;
+
+        BoundsBuilder::Apply(BoundsBuilder::Compute(positions, sizeof(GeometryGenerator::Vertex), (uint32)mesh.Vertices.size(),
+            mesh.Indices32.data() + objSubmesh.StartIndexLocation, objSubmesh.IndexCount), submesh);
+
+        std::string material = objSubmesh.Material.empty() ? "default" : objSubmesh.Material;
+        geometry.DrawArgs[model.Submeshes.size() == 1 ? name : name + "_" + material] = submesh;
+    }
+}
+#endif
@@ -0,0 +1,79 @@
+//***************************************************************************************
+// ObjLoader.h
+//
+// Wavefront OBJ importer.  The file is memory-mapped and cut into line-aligned chunks
+// that are parsed in parallel on ThreadPool::Get() with std::from_chars:
+//   1. every chunk counts its v/vt/vn lines, so each knows where its attributes start
+//      in the shared arrays and negative (relative) indices resolve in the same pass;
+//   2. every chunk parses its attributes straight into place and triangulates its
+//      faces (as fans) into a chunk-local list;
+//   3. position/uv/normal tuples are deduplicated into vertices.  Tuples are bucketed
+//      by position index, and each bucket is searched on its own, in parallel, so the
+//      vertex order follows the position order and does not depend on thread timing;
+//   4. triangles are grouped by material into one submesh per usemtl name.
+//
+// The output uses the same convention as GltfLoader.  Positions and normals stay in the
+// file's right-handed space and texture coordinates are flipped to the Direct3D origin
+// (v = 1 - v).  The triangles are reversed, so they are clockwise once
+// GltfLoader::GetToLeftHanded() mirrors z in the world matrix, as the PSOs expect.
+// Without that mirror the model draws mirrored.
+//
+// Meshes without normals get area-weighted smooth normals, and tangents are generated
+// with TangentGenerator when the mesh has uvs.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include <filesystem>
+#include <string>
+
+struct MeshGeometry;
+
+class ObjLoader
+{
+public:
+
+    using uint32 = std::uint32_t;
+
+	///<summary>
+	/// Triangles of one material, a range of ObjModel::Mesh.Indices32.
+	///</summary>
+    struct Submesh
+    {
+        std::string Material;
+        uint32 StartIndexLocation = 0;
+        uint32 IndexCount = 0;
+    };
+
+    struct ObjModel
+    {
+        GeometryGenerator::MeshData Mesh;
+        std::vector<Submesh> Submeshes;
+
+        // mtllib file names as written in the file, relative to the .obj.
+        std::vector<std::string> MaterialLibraries;
+    };
+
+	///<summary>
+	/// Loads filename into model.  Returns false if the file cannot be mapped or has a
+	/// malformed line, such as a face that references a missing attribute; error then
+	/// gives the line number and the line.
+	///</summary>
+    static bool Load(const std::filesystem::path& filename, ObjModel& model, std::string* error = nullptr);
+
+	///<summary>
+	/// Same, parsing text already in memory.
+	///</summary>
+    static bool Parse(const char* text, size_t size, ObjModel& model, std::string* error = nullptr);
+
+#if defined(_WIN32)
+	///<summary>
+	/// Adds a DrawArgs entry name_material (or name when there is one material) per
+	/// submesh, with bounds, for a model copied into geometry at startIndexLocation and
+	/// baseVertexLocation.
+	///</summary>
+    static void AddSubmeshes(MeshGeometry& geometry, const std::string& name, const ObjModel& model,
+                             uint32 startIndexLocation, std::int32_t baseVertexLocation);
+#endif
+};
@@ -0,0 +1,22 @@
+//***************************************************************************************
+// PrimitiveTables.cpp
+//
+// Compile-time checks of the tables in PrimitiveTables.h.  They live here rather than in
+// the header so the compiler evaluates them once, not in every file that includes it.
+//***************************************************************************************
+
+#include "PrimitiveTables.h"
+
+namespace PrimitiveTables
+{
+    static_assert(GeosphereVertexCount(0) == 12 && GeosphereIndexCount(0) == 60, "icosahedron counts");
+    static_assert(GeosphereVertexCount(1) == 42 && GeosphereIndexCount(1) == 240, "geosphere level 1 counts");
+    static_assert(CylinderVertexCount(4, 1) == 10 + 12 && CylinderIndexCount(4, 1) == 48, "cylinder counts");
+
+    static_assert(FacesOutward(CubeCorners, CubeIndices), "cube winding");
+    static_assert(FacesAlongNormals(MakeBox(1.0f, 2.0f, 3.0f)), "box winding");
+    static_assert(FacesAlongNormals(MakeQuad(0.0f, 0.0f, 1.0f, 1.0f, 0.0f)), "quad winding");
+    static_assert(FacesAlongNormals(MakeGeosphere<0>(1.0f)), "icosahedron winding");
+    static_assert(FacesAlongNormals(MakeGeosphere<1>(1.0f)), "geosphere winding");
+    static_assert(FacesAlongNormals(MakeCylinder<8, 2>(1.0f, 0.5f, 2.0f)), "cylinder winding");
+}
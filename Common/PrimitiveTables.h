@@ -0,0 +1,528 @@
+//***************************************************************************************
+// PrimitiveTables.h
+//
+// Compile-time versions of the fixed GeometryGenerator primitives.  Every Make*
+// function is constexpr, so
+//     static constexpr auto box = PrimitiveTables::MakeBox(1.0f, 1.0f, 1.0f);
+// is built by the compiler, lives in read-only data and can be handed to
+// d3dUtil::CreateDefaultBuffer as is.  Called with runtime arguments they are ordinary
+// functions, which is how CreateBox and CreateQuad use them.
+//
+// Indices are 16-bit since every table is far below 65536 vertices.  Vertex order and
+// winding match the GeometryGenerator functions of the same name; the static_asserts in
+// PrimitiveTables.cpp check counts, index ranges and that every triangle faces outward.
+//
+// Needs C++17 (constexpr std::array access and lambdas).
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include <array>
+#include <cstddef>
+#include <utility>
+
+namespace PrimitiveTables
+{
+    using uint16 = std::uint16_t;
+    using uint32 = std::uint32_t;
+    using Vertex = GeometryGenerator::Vertex;
+
+    template<std::size_t VertexCount, std::size_t IndexCount>
+    struct StaticMesh
+    {
+        std::array<Vertex, VertexCount> Vertices;
+        std::array<uint16, IndexCount> Indices;
+    };
+
+    constexpr std::size_t GeosphereVertexCount(uint32 level) { return (std::size_t(10) << (2*level)) + 2; }
+    constexpr std::size_t GeosphereIndexCount(uint32 level) { return std::size_t(60) << (2*level); }
+
+    constexpr std::size_t CylinderVertexCount(uint32 slices, uint32 stacks) { return (stacks+1)*(slices+1) + 2*(slices+2); }
+    constexpr std::size_t CylinderIndexCount(uint32 slices, uint32 stacks) { return 6*slices*stacks + 6*slices; }
+
+    namespace Detail
+    {
+        // <cmath> is not constexpr, so these are evaluated in double with series that
+        // converge well below float precision.
+
+        constexpr double Pi = 3.14159265358979323846;
+
+        constexpr double Sqrt(double x)
+        {
+            if(x <= 0.0)
+                return 0.0;
+
+            // Newton's method from above converges monotonically.
+            double r = x > 1.0 ? x : 1.0;
+            for(int i = 0; i < 128; ++i)
+            {
+                double next = 0.5*(r + x/r);
+                if(next >= r)
+                    break;
+                r = next;
+            }
+            return r;
+        }
+
+        constexpr double Sin(double x)
+        {
+            // Reduce to [-pi, pi].
+            double turns = x / (2.0*Pi);
+            long long k = (long long)(turns + (turns >= 0.0 ? 0.5 : -0.5));
+            x -= k*2.0*Pi;
+
+            double term = x;
+            double sum = x;
+            for(int n = 1; n < 16; ++n)
+            {
+                term *= -x*x / ((2*n)*(2*n+1));
+                sum += term;
+            }
+            return sum;
+        }
+
+        constexpr double Cos(double x)
+        {
+            return Sin(x + 0.5*Pi);
+        }
+
+        constexpr double Atan(double x)
+        {
+            if(x < 0.0)
+                return -Atan(-x);
+            if(x > 1.0)
+                return 0.5*Pi - Atan(1.0/x);
+
+            // atan(x) = 2*atan(x / (1 + sqrt(1 + x^2))), twice, leaves |x| < 0.2.
+            x = x / (1.0 + Sqrt(1.0 + x*x));
+            x = x / (1.0 + Sqrt(1.0 + x*x));
+
+            double term = x;
+            double sum = x;
+            for(int n = 1; n < 24; ++n)
+            {
+                term *= -x*x;
+                sum += term / (2*n+1);
+            }
+            return 4.0*sum;
+        }
+
+        constexpr double Atan2(double y, double x)
+        {
+            if(x > 0.0)
+                return Atan(y/x);
+            if(x < 0.0)
+                return y >= 0.0 ? Atan(y/x) + Pi : Atan(y/x) - Pi;
+            if(y > 0.0)
+                return 0.5*Pi;
+            if(y < 0.0)
+                return -0.5*Pi;
+            return 0.0;
+        }
+
+        constexpr double Acos(double x)
+        {
+            x = x < -1.0 ? -1.0 : (x > 1.0 ? 1.0 : x);
+            return Atan2(Sqrt(1.0 - x*x), x);
+        }
+
+        template<std::size_t N, typename F, std::size_t... I>
+        constexpr std::array<Vertex, N> GenerateVertices(F f, std::index_sequence<I...>)
+        {
+            return {{ f(I)... }};
+        }
+
+        // Vertex has no constexpr default constructor, so vertex tables are built in
+        // one go from a function of the vertex index.
+        template<std::size_t N, typename F>
+        constexpr std::array<Vertex, N> GenerateVertices(F f)
+        {
+            return GenerateVertices<N>(f, std::make_index_sequence<N>());
+        }
+
+        constexpr DirectX::XMFLOAT3 Cross(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+        {
+            return DirectX::XMFLOAT3(a.y*b.z - a.z*b.y, a.z*b.x - a.x*b.z, a.x*b.y - a.y*b.x);
+        }
+
+        constexpr DirectX::XMFLOAT3 Sub(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+        {
+            return DirectX::XMFLOAT3(a.x - b.x, a.y - b.y, a.z - b.z);
+        }
+
+        constexpr float Dot(const DirectX::XMFLOAT3& a, const DirectX::XMFLOAT3& b)
+        {
+            return a.x*b.x + a.y*b.y + a.z*b.z;
+        }
+
+        constexpr DirectX::XMFLOAT3 FaceNormal(const DirectX::XMFLOAT3& p0, const DirectX::XMFLOAT3& p1, const DirectX::XMFLOAT3& p2)
+        {
+            // Clockwise triangles are front facing, so this points out of the front face.
+            return Cross(Sub(p1, p0), Sub(p2, p0));
+        }
+    }
+
+	///<summary>
+	/// Same as GeometryGenerator::CreateBox with no subdivisions.
+	///</summary>
+    constexpr StaticMesh<24, 36> MakeBox(float width, float height, float depth)
+    {
+        float w2 = 0.5f*width;
+        float h2 = 0.5f*height;
+        float d2 = 0.5f*depth;
+
+        return
+        {
+            {{
+                // Front face.
+                Vertex(-w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+                Vertex(-w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+                Vertex(+w2, +h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+                Vertex(+w2, -h2, -d2, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+
+                // Back face.
+                Vertex(-w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+                Vertex(+w2, -h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+                Vertex(+w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+                Vertex(-w2, +h2, +d2, 0.0f, 0.0f, 1.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+
+                // Top face.
+                Vertex(-w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+                Vertex(-w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+                Vertex(+w2, +h2, +d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+                Vertex(+w2, +h2, -d2, 0.0f, 1.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+
+                // Bottom face.
+                Vertex(-w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 1.0f),
+                Vertex(+w2, -h2, -d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+                Vertex(+w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+                Vertex(-w2, -h2, +d2, 0.0f, -1.0f, 0.0f, -1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+
+                // Left face.
+                Vertex(-w2, -h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 1.0f),
+                Vertex(-w2, +h2, +d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f),
+                Vertex(-w2, +h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f),
+                Vertex(-w2, -h2, -d2, -1.0f, 0.0f, 0.0f, 0.0f, 0.0f, -1.0f, 1.0f, 1.0f),
+
+                // Right face.
+                Vertex(+w2, -h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 1.0f),
+                Vertex(+w2, +h2, -d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f),
+                Vertex(+w2, +h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.0f),
+                Vertex(+w2, -h2, +d2, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 1.0f)
+            }},
+            {{
+                0, 1, 2,    0, 2, 3,    // front
+                4, 5, 6,    4, 6, 7,    // back
+                8, 9, 10,   8, 10, 11,  // top
+                12, 13, 14, 12, 14, 15, // bottom
+                16, 17, 18, 16, 18, 19, // left
+                20, 21, 22, 20, 22, 23  // right
+            }}
+        };
+    }
+
+	///<summary>
+	/// Same as GeometryGenerator::CreateQuad.
+	///</summary>
+    constexpr StaticMesh<4, 6> MakeQuad(float x, float y, float w, float h, float depth)
+    {
+        return
+        {
+            {{
+                // Position coordinates specified in NDC space.
+                Vertex(x, y - h, depth, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 1.0f),
+                Vertex(x, y, depth, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 0.0f, 0.0f),
+                Vertex(x + w, y, depth, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f),
+                Vertex(x + w, y - h, depth, 0.0f, 0.0f, -1.0f, 1.0f, 0.0f, 0.0f, 1.0f, 1.0f)
+            }},
+            {{ 0, 1, 2, 0, 2, 3 }}
+        };
+    }
+
+	///<summary>
+	/// Same as GeometryGenerator::CreateGeosphere, for low levels (the table grows 4x
+	/// per level and compilers limit constexpr evaluation steps).
+	///</summary>
+    template<uint32 Level>
+    constexpr StaticMesh<GeosphereVertexCount(Level), GeosphereIndexCount(Level)> MakeGeosphere(float radius)
+    {
+        static_assert(Level <= 2, "MakeGeosphere is meant for low levels; use GeometryGenerator::GetUnitGeosphere");
+
+        constexpr std::size_t VertexCount = GeosphereVertexCount(Level);
+        constexpr std::size_t IndexCount = GeosphereIndexCount(Level);
+
+        const float X = 0.525731f;
+        const float Z = 0.850651f;
+
+        std::array<DirectX::XMFLOAT3, VertexCount> positions{};
+        positions[0] = DirectX::XMFLOAT3(-X, 0.0f, Z);  positions[1] = DirectX::XMFLOAT3(X, 0.0f, Z);
+        positions[2] = DirectX::XMFLOAT3(-X, 0.0f, -Z); positions[3] = DirectX::XMFLOAT3(X, 0.0f, -Z);
+        positions[4] = DirectX::XMFLOAT3(0.0f, Z, X);   positions[5] = DirectX::XMFLOAT3(0.0f, Z, -X);
+        positions[6] = DirectX::XMFLOAT3(0.0f, -Z, X);  positions[7] = DirectX::XMFLOAT3(0.0f, -Z, -X);
+        positions[8] = DirectX::XMFLOAT3(Z, X, 0.0f);   positions[9] = DirectX::XMFLOAT3(-Z, X, 0.0f);
+        positions[10] = DirectX::XMFLOAT3(Z, -X, 0.0f); positions[11] = DirectX::XMFLOAT3(-Z, -X, 0.0f);
+
+        const uint16 icosahedron[60] =
+        {
+            1,4,0,  4,9,0,  4,5,9,  8,5,4,  1,8,4,
+            1,10,8, 10,3,8, 8,3,5,  3,2,5,  3,7,2,
+            3,10,7, 10,6,7, 6,11,7, 6,0,11, 6,1,0,
+            10,1,6, 11,0,9, 2,11,9, 5,2,9,  11,2,7
+        };
+
+        std::array<uint16, IndexCount> indices{};
+        for(std::size_t i = 0; i < 60; ++i)
+            indices[i] = icosahedron[i];
+
+        // Subdivide like GeometryGenerator::Subdivide: midpoints are shared between the
+        // two triangles of an edge and appended in first-use order.
+        std::size_t vertexCount = 12;
+        std::size_t indexCount = 60;
+        for(uint32 level = 0; level < Level; ++level)
+        {
+            std::array<uint16, IndexCount> source = indices;
+            std::array<uint32, IndexCount> edgeKeys{};
+            std::array<uint16, IndexCount> edgeMidpoints{};
+            std::size_t edgeCount = 0;
+
+            auto midpoint = [&](uint16 a, uint16 b)
+            {
+                uint32 key = a < b ? (uint32(a) << 16) | b : (uint32(b) << 16) | a;
+                for(std::size_t e = 0; e < edgeCount; ++e)
+                {
+                    if(edgeKeys[e] == key)
+                        return edgeMidpoints[e];
+                }
+
+                const DirectX::XMFLOAT3& p0 = positions[a];
+                const DirectX::XMFLOAT3& p1 = positions[b];
+                positions[vertexCount] = DirectX::XMFLOAT3(0.5f*(p0.x + p1.x), 0.5f*(p0.y + p1.y), 0.5f*(p0.z + p1.z));
+
+                edgeKeys[edgeCount] = key;
+                edgeMidpoints[edgeCount] = (uint16)vertexCount;
+                edgeCount++;
+
+                return (uint16)vertexCount++;
+            };
+
+            std::size_t k = 0;
+            for(std::size_t t = 0; t < indexCount; t += 3)
+            {
+                uint16 v0 = source[t], v1 = source[t+1], v2 = source[t+2];
+                uint16 m0 = midpoint(v0, v1);
+                uint16 m1 = midpoint(v1, v2);
+                uint16 m2 = midpoint(v0, v2);
+
+                const uint16 triangles[12] = { v0, m0, m2,  m0, m1, m2,  m2, m1, v2,  m0, v1, m1 };
+                for(uint16 index : triangles)
+                    indices[k++] = index;
+            }
+
+            indexCount = k;
+        }
+
+        auto vertex = [&](std::size_t i)
+        {
+            // Project onto the sphere and derive the rest from spherical coordinates.
+            const DirectX::XMFLOAT3& p = positions[i];
+            double length = Detail::Sqrt((double)p.x*p.x + (double)p.y*p.y + (double)p.z*p.z);
+            double nx = p.x/length, ny = p.y/length, nz = p.z/length;
+
+            double theta = Detail::Atan2(nz, nx);
+            if(theta < 0.0)
+                theta += 2.0*Detail::Pi;
+            double phi = Detail::Acos(ny);
+
+            // Partial derivative of P with respect to theta, normalized.  Zero at the poles.
+            double sinPhi = Detail::Sin(phi);
+            double tx = sinPhi > 0.0 ? -Detail::Sin(theta) : 0.0;
+            double tz = sinPhi > 0.0 ? Detail::Cos(theta) : 0.0;
+
+            return Vertex(
+                (float)(radius*nx), (float)(radius*ny), (float)(radius*nz),
+                (float)nx, (float)ny, (float)nz,
+                (float)tx, 0.0f, (float)tz,
+                (float)(theta/(2.0*Detail::Pi)), (float)(phi/Detail::Pi));
+        };
+
+        return { Detail::GenerateVertices<VertexCount>(vertex), indices };
+    }
+
+	///<summary>
+	/// Same as GeometryGenerator::CreateCylinder with Slices and Stacks fixed.
+	///</summary>
+    template<uint32 Slices, uint32 Stacks>
+    constexpr StaticMesh<CylinderVertexCount(Slices, Stacks), CylinderIndexCount(Slices, Stacks)>
+        MakeCylinder(float bottomRadius, float topRadius, float height)
+    {
+        static_assert(Slices >= 3 && Stacks >= 1, "a cylinder needs at least 3 slices and 1 stack");
+        static_assert(CylinderVertexCount(Slices, Stacks) <= 65536, "too many vertices for 16-bit indices");
+
+        constexpr std::size_t VertexCount = CylinderVertexCount(Slices, Stacks);
+        constexpr std::size_t IndexCount = CylinderIndexCount(Slices, Stacks);
+        constexpr uint32 RingVertexCount = Slices + 1;
+        constexpr uint32 SideVertexCount = (Stacks + 1)*RingVertexCount;
+        constexpr uint32 CapVertexCount = Slices + 2;
+
+        // The side normal only depends on the slice, see GeometryGenerator::CreateCylinder.
+        double dr = (double)bottomRadius - topRadius;
+        double invLength = 1.0 / Detail::Sqrt((double)height*height + dr*dr);
+
+        auto vertex = [&](std::size_t i)
+        {
+            if(i < SideVertexCount)
+            {
+                uint32 ring = (uint32)i / RingVertexCount;
+                uint32 slice = (uint32)i % RingVertexCount;
+
+                double angle = slice*2.0*Detail::Pi/Slices;
+                double c = Detail::Cos(angle);
+                double s = Detail::Sin(angle);
+
+                double y = -0.5*height + ring*((double)height/Stacks);
+                double r = bottomRadius + ring*(((double)topRadius - bottomRadius)/Stacks);
+
+                return Vertex(
+                    (float)(r*c), (float)y, (float)(r*s),
+                    (float)(height*invLength*c), (float)(dr*invLength), (float)(height*invLength*s),
+                    (float)-s, 0.0f, (float)c,
+                    (float)slice/Slices, 1.0f - (float)ring/Stacks);
+            }
+
+            // Top cap, then bottom cap: a ring followed by the center vertex.
+            bool top = i < SideVertexCount + CapVertexCount;
+            uint32 capIndex = (uint32)(i - SideVertexCount) % CapVertexCount;
+            float y = top ? 0.5f*height : -0.5f*height;
+            float ny = top ? 1.0f : -1.0f;
+
+            if(capIndex == Slices + 1)
+                return Vertex(0.0f, y, 0.0f, 0.0f, ny, 0.0f, 1.0f, 0.0f, 0.0f, 0.5f, 0.5f);
+
+            double angle = capIndex*2.0*Detail::Pi/Slices;
+            float radius = top ? topRadius : bottomRadius;
+            float x = (float)(radius*Detail::Cos(angle));
+            float z = (float)(radius*Detail::Sin(angle));
+
+            // Scale down by the height to try and make top cap texture coord area
+            // proportional to base.
+            return Vertex(x, y, z, 0.0f, ny, 0.0f, 1.0f, 0.0f, 0.0f, x/height + 0.5f, z/height + 0.5f);
+        };
+
+        std::array<uint16, IndexCount> indices{};
+        std::size_t k = 0;
+
+        for(uint32 i = 0; i < Stacks; ++i)
+        {
+            for(uint32 j = 0; j < Slices; ++j)
+            {
+                indices[k++] = (uint16)(i*RingVertexCount + j);
+                indices[k++] = (uint16)((i+1)*RingVertexCount + j);
+                indices[k++] = (uint16)((i+1)*RingVertexCount + j+1);
+
+                indices[k++] = (uint16)(i*RingVertexCount + j);
+                indices[k++] = (uint16)((i+1)*RingVertexCount + j+1);
+                indices[k++] = (uint16)(i*RingVertexCount + j+1);
+            }
+        }
+
+        uint32 topBase = SideVertexCount;
+        for(uint32 i = 0; i < Slices; ++i)
+        {
+            indices[k++] = (uint16)(topBase + Slices+1);
+            indices[k++] = (uint16)(topBase + i+1);
+            indices[k++] = (uint16)(topBase + i);
+        }
+
+        uint32 bottomBase = SideVertexCount + CapVertexCount;
+        for(uint32 i = 0; i < Slices; ++i)
+        {
+            indices[k++] = (uint16)(bottomBase + Slices+1);
+            indices[k++] = (uint16)(bottomBase + i);
+            indices[k++] = (uint16)(bottomBase + i+1);
+        }
+
+        return { Detail::GenerateVertices<VertexCount>(vertex), indices };
+    }
+
+    // Corners and indices of the 8-vertex cube of MainApp::BuildBoxGeometry.
+    constexpr std::array<DirectX::XMFLOAT3, 8> CubeCorners =
+    {{
+        DirectX::XMFLOAT3(-1.0f, -1.0f, -1.0f),
+        DirectX::XMFLOAT3(-1.0f, +1.0f, -1.0f),
+        DirectX::XMFLOAT3(+1.0f, +1.0f, -1.0f),
+        DirectX::XMFLOAT3(+1.0f, -1.0f, -1.0f),
+        DirectX::XMFLOAT3(-1.0f, -1.0f, +1.0f),
+        DirectX::XMFLOAT3(-1.0f, +1.0f, +1.0f),
+        DirectX::XMFLOAT3(+1.0f, +1.0f, +1.0f),
+        DirectX::XMFLOAT3(+1.0f, -1.0f, +1.0f)
+    }};
+
+    constexpr std::array<uint16, 36> CubeIndices =
+    {{
+        0, 1, 2,  0, 2, 3,  // front face
+        4, 6, 5,  4, 7, 6,  // back face
+        4, 5, 1,  4, 1, 0,  // left face
+        3, 2, 6,  3, 6, 7,  // right face
+        1, 5, 6,  1, 6, 2,  // top face
+        4, 0, 3,  4, 3, 7   // bottom face
+    }};
+
+    //
+    // Compile-time checks.
+    //
+
+    template<std::size_t VertexCount, std::size_t IndexCount>
+    constexpr bool IndicesInRange(const std::array<uint16, IndexCount>& indices)
+    {
+        for(uint16 index : indices)
+        {
+            if(index >= VertexCount)
+                return false;
+        }
+        return true;
+    }
+
+	///<summary>
+	/// True if every triangle is non-degenerate and its front face points along the
+	/// normals of its vertices.
+	///</summary>
+    template<std::size_t VertexCount, std::size_t IndexCount>
+    constexpr bool FacesAlongNormals(const StaticMesh<VertexCount, IndexCount>& mesh)
+    {
+        if(IndexCount % 3 != 0 || !IndicesInRange<VertexCount>(mesh.Indices))
+            return false;
+
+        for(std::size_t t = 0; t < IndexCount; t += 3)
+        {
+            const Vertex& v0 = mesh.Vertices[mesh.Indices[t]];
+            const Vertex& v1 = mesh.Vertices[mesh.Indices[t+1]];
+            const Vertex& v2 = mesh.Vertices[mesh.Indices[t+2]];
+
+            DirectX::XMFLOAT3 n = Detail::FaceNormal(v0.Position, v1.Position, v2.Position);
+            if(Detail::Dot(n, v0.Normal) <= 0.0f || Detail::Dot(n, v1.Normal) <= 0.0f || Detail::Dot(n, v2.Normal) <= 0.0f)
+                return false;
+        }
+        return true;
+    }
+
+	///<summary>
+	/// True if every triangle of a convex shape around the origin faces away from it.
+	///</summary>
+    template<std::size_t VertexCount, std::size_t IndexCount>
+    constexpr bool FacesOutward(const std::array<DirectX::XMFLOAT3, VertexCount>& positions,
+                                const std::array<uint16, IndexCount>& indices)
+    {
+        if(IndexCount % 3 != 0 || !IndicesInRange<VertexCount>(indices))
+            return false;
+
+        for(std::size_t t = 0; t < IndexCount; t += 3)
+        {
+            const DirectX::XMFLOAT3& p0 = positions[indices[t]];
+            DirectX::XMFLOAT3 n = Detail::FaceNormal(p0, positions[indices[t+1]], positions[indices[t+2]]);
+            if(Detail::Dot(n, p0) <= 0.0f)
+                return false;
+        }
+        return true;
+    }
+}
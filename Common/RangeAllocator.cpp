@@ -0,0 +1,294 @@
+//***************************************************************************************
+// RangeAllocator.cpp
+//***************************************************************************************
+
+#include "RangeAllocator.h"
+#include <cassert>
+
+#if defined(_MSC_VER)
+#include <intrin.h>
+#endif
+
+namespace
+{
+    // Index of the lowest set bit; mask must not be 0.
+    inline std::uint32_t LowestBit(std::uint32_t mask)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanForward(&index, mask);
+        return (std::uint32_t)index;
+#else
+        return (std::uint32_t)__builtin_ctz(mask);
+#endif
+    }
+
+    // Index of the highest set bit; value must not be 0.
+    inline std::uint32_t HighestBit(std::uint32_t value)
+    {
+#if defined(_MSC_VER)
+        unsigned long index;
+        _BitScanReverse(&index, value);
+        return (std::uint32_t)index;
+#else
+        return 31u - (std::uint32_t)__builtin_clz(value);
+#endif
+    }
+}
+
+RangeAllocator::RangeAllocator(uint32 size) :
+    mSize(size)
+{
+    Reset();
+}
+
+void RangeAllocator::Reset()
+{
+    mNodes.clear();
+    mUnusedNodes.clear();
+    mFreeSize = 0;
+    mAllocationCount = 0;
+
+    mFirstLevelMask = 0;
+    for(uint32 i = 0; i < FirstLevelCount; ++i)
+        mSecondLevelMasks[i] = 0;
+    for(uint32 i = 0; i < BinCount; ++i)
+        mBinHeads[i] = InvalidOffset;
+
+    if(mSize > 0)
+    {
+        uint32 node = NewNode();
+        mNodes[node].Offset = 0;
+        mNodes[node].Size = mSize;
+        InsertFree(node);
+    }
+}
+
+RangeAllocator::uint32 RangeAllocator::BinRoundDown(uint32 size)
+{
+    if(size < SecondLevelCount)
+        return size;
+
+    // Floating point style: the exponent picks the first level and the next
+    // SecondLevelBits bits below the leading one pick the bin in it.
+    uint32 firstLevel = HighestBit(size);
+    uint32 shift = firstLevel - SecondLevelBits;
+    uint32 secondLevel = (size >> shift) & (SecondLevelCount - 1);
+
+    return (firstLevel - SecondLevelBits + 1)*SecondLevelCount + secondLevel;
+}
+
+RangeAllocator::uint32 RangeAllocator::BinRoundUp(uint32 size)
+{
+    uint32 bin = BinRoundDown(size);
+    if(size < SecondLevelCount)
+        return bin;
+
+    // Sizes between two bin starts go to the next bin, whose ranges all fit.
+    uint32 shift = HighestBit(size) - SecondLevelBits;
+    if((size & ((1u << shift) - 1)) != 0)
+        bin++;
+
+    return bin;
+}
+
+RangeAllocator::uint32 RangeAllocator::FindFreeBin(uint32 firstBin) const
+{
+    if(firstBin >= BinCount)
+        return InvalidOffset;
+
+    uint32 firstLevel = firstBin / SecondLevelCount;
+    uint32 secondLevel = firstBin % SecondLevelCount;
+
+    uint32 secondMask = mSecondLevelMasks[firstLevel] & (0xffu << secondLevel);
+    if(secondMask != 0)
+        return firstLevel*SecondLevelCount + LowestBit(secondMask);
+
+    if(firstLevel + 1 >= FirstLevelCount)
+        return InvalidOffset;
+
+    uint32 firstMask = mFirstLevelMask & (~0u << (firstLevel + 1));
+    if(firstMask == 0)
+        return InvalidOffset;
+
+    firstLevel = LowestBit(firstMask);
+    return firstLevel*SecondLevelCount + LowestBit(mSecondLevelMasks[firstLevel]);
+}
+
+RangeAllocator::uint32 RangeAllocator::NewNode()
+{
+    if(!mUnusedNodes.empty())
+    {
+        uint32 node = mUnusedNodes.back();
+        mUnusedNodes.pop_back();
+        mNodes[node] = Node();
+        return node;
+    }
+
+    mNodes.emplace_back();
+    return (uint32)mNodes.size() - 1;
+}
+
+void RangeAllocator::InsertFree(uint32 node)
+{
+    Node& n = mNodes[node];
+    uint32 bin = BinRoundDown(n.Size);
+
+    n.Used = false;
+    n.PrevFree = InvalidOffset;
+    n.NextFree = mBinHeads[bin];
+    if(n.NextFree != InvalidOffset)
+        mNodes[n.NextFree].PrevFree = node;
+    mBinHeads[bin] = node;
+
+    mSecondLevelMasks[bin / SecondLevelCount] |= (std::uint8_t)(1u << (bin % SecondLevelCount));
+    mFirstLevelMask |= 1u << (bin / SecondLevelCount);
+
+    mFreeSize += n.Size;
+}
+
+void RangeAllocator::RemoveFree(uint32 node)
+{
+    Node& n = mNodes[node];
+    uint32 bin = BinRoundDown(n.Size);
+
+    if(n.PrevFree != InvalidOffset)
+        mNodes[n.PrevFree].NextFree = n.NextFree;
+    else
+        mBinHeads[bin] = n.NextFree;
+
+    if(n.NextFree != InvalidOffset)
+        mNodes[n.NextFree].PrevFree = n.PrevFree;
+
+    if(mBinHeads[bin] == InvalidOffset)
+    {
+        uint32 firstLevel = bin / SecondLevelCount;
+        mSecondLevelMasks[firstLevel] &= (std::uint8_t)~(1u << (bin % SecondLevelCount));
+        if(mSecondLevelMasks[firstLevel] == 0)
+            mFirstLevelMask &= ~(1u << firstLevel);
+    }
+
+    n.PrevFree = InvalidOffset;
+    n.NextFree = InvalidOffset;
+
+    mFreeSize -= n.Size;
+}
+
+RangeAllocator::Allocation RangeAllocator::Allocate(uint32 size)
+{
+    Allocation allocation;
+    if(size == 0 || size > mFreeSize)
+        return allocation;
+
+    uint32 node = InvalidOffset;
+    uint32 bin = FindFreeBin(BinRoundUp(size));
+    if(bin != InvalidOffset)
+    {
+        node = mBinHeads[bin];
+    }
+    else
+    {
+        // Only the bin of size itself is left, which can hold ranges on either side of
+        // size.  Search it, so that e.g. an exact fit is still found when nearly full.
+        for(uint32 n = mBinHeads[BinRoundDown(size)]; n != InvalidOffset; n = mNodes[n].NextFree)
+        {
+            if(mNodes[n].Size >= size)
+            {
+                node = n;
+                break;
+            }
+        }
+        if(node == InvalidOffset)
+            return allocation;
+    }
+
+    RemoveFree(node);
+
+    // Give the tail back as a new free range.
+    if(mNodes[node].Size > size)
+    {
+        uint32 rest = NewNode();
+
+        // NewNode may have reallocated mNodes, so index again.
+        Node& n = mNodes[node];
+        Node& r = mNodes[rest];
+        r.Offset = n.Offset + size;
+        r.Size = n.Size - size;
+        r.PrevPhysical = node;
+        r.NextPhysical = n.NextPhysical;
+        if(n.NextPhysical != InvalidOffset)
+            mNodes[n.NextPhysical].PrevPhysical = rest;
+        n.NextPhysical = rest;
+        n.Size = size;
+
+        InsertFree(rest);
+    }
+
+    mNodes[node].Used = true;
+    mAllocationCount++;
+
+    allocation.Offset = mNodes[node].Offset;
+    allocation.Size = size;
+    allocation.Node = node;
+    return allocation;
+}
+
+void RangeAllocator::Free(const Allocation& allocation)
+{
+    if(!allocation.IsValid())
+        return;
+
+    uint32 node = allocation.Node;
+    assert(node < mNodes.size() && mNodes[node].Used && mNodes[node].Offset == allocation.Offset);
+
+    mNodes[node].Used = false;
+    mAllocationCount--;
+
+    // Merge with a free range before.
+    uint32 prev = mNodes[node].PrevPhysical;
+    if(prev != InvalidOffset && !mNodes[prev].Used)
+    {
+        RemoveFree(prev);
+
+        Node& p = mNodes[prev];
+        p.Size += mNodes[node].Size;
+        p.NextPhysical = mNodes[node].NextPhysical;
+        if(p.NextPhysical != InvalidOffset)
+            mNodes[p.NextPhysical].PrevPhysical = prev;
+
+        mUnusedNodes.push_back(node);
+        node = prev;
+    }
+
+    // Merge with a free range after.
+    uint32 next = mNodes[node].NextPhysical;
+    if(next != InvalidOffset && !mNodes[next].Used)
+    {
+        RemoveFree(next);
+
+        Node& n = mNodes[node];
+        n.Size += mNodes[next].Size;
+        n.NextPhysical = mNodes[next].NextPhysical;
+        if(n.NextPhysical != InvalidOffset)
+            mNodes[n.NextPhysical].PrevPhysical = node;
+
+        mUnusedNodes.push_back(next);
+    }
+
+    InsertFree(node);
+}
+
+RangeAllocator::uint32 RangeAllocator::GetLargestFreeRange() const
+{
+    if(mFirstLevelMask == 0)
+        return 0;
+
+    uint32 firstLevel = HighestBit(mFirstLevelMask);
+    uint32 bin = firstLevel*SecondLevelCount + HighestBit(mSecondLevelMasks[firstLevel]);
+
+    uint32 largest = 0;
+    for(uint32 node = mBinHeads[bin]; node != InvalidOffset; node = mNodes[node].NextFree)
+        largest = largest > mNodes[node].Size ? largest : mNodes[node].Size;
+
+    return largest;
+}
@@ -0,0 +1,106 @@
+//***************************************************************************************
+// RangeAllocator.h
+//
+// Suballocates ranges of a fixed-size space (elements of a vertex or index buffer,
+// bytes of a heap) without touching the memory itself.  Free ranges are kept in
+// two-level segregated lists (TLSF): each power of two is split into 8 bins, and a
+// bitmask per level finds a large enough free range with two bit scans, so Allocate
+// and Free are O(1).  Freed ranges merge with free neighbors right away.
+//
+// Requests are rounded up to the next bin boundary only while searching, never in the
+// returned size, so any range in the first non-empty bin fits.  The request's own bin
+// is searched linearly only when no larger bin has a range.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+class RangeAllocator
+{
+public:
+
+    using uint32 = std::uint32_t;
+
+    static const uint32 InvalidOffset = 0xffffffff;
+
+	///<summary>
+	/// Result of Allocate.  Offset is InvalidOffset when the allocation failed; Node is
+	/// internal and has to be passed back to Free unchanged.
+	///</summary>
+    struct Allocation
+    {
+        uint32 Offset = InvalidOffset;
+        uint32 Size = 0;
+        uint32 Node = InvalidOffset;
+
+        bool IsValid() const { return Offset != InvalidOffset; }
+    };
+
+    explicit RangeAllocator(uint32 size);
+
+	///<summary>
+	/// Returns an invalid Allocation if size is 0 or no free range is large enough.
+	///</summary>
+    Allocation Allocate(uint32 size);
+    void Free(const Allocation& allocation);
+
+	///<summary>
+	/// Frees everything.
+	///</summary>
+    void Reset();
+
+    uint32 GetSize() const { return mSize; }
+    uint32 GetFreeSize() const { return mFreeSize; }
+    uint32 GetAllocationCount() const { return mAllocationCount; }
+
+	///<summary>
+	/// Largest size Allocate can currently succeed with.  Linear in the size of the top
+	/// non-empty bin, meant for statistics.
+	///</summary>
+    uint32 GetLargestFreeRange() const;
+
+private:
+    static const uint32 SecondLevelBits = 3;
+    static const uint32 SecondLevelCount = 1 << SecondLevelBits;
+    static const uint32 FirstLevelCount = 32 - SecondLevelBits + 1;
+    static const uint32 BinCount = FirstLevelCount*SecondLevelCount;
+
+    struct Node
+    {
+        uint32 Offset = 0;
+        uint32 Size = 0;
+
+        // Neighbors in address order.
+        uint32 PrevPhysical = InvalidOffset;
+        uint32 NextPhysical = InvalidOffset;
+
+        // Neighbors in the bin's free list.
+        uint32 PrevFree = InvalidOffset;
+        uint32 NextFree = InvalidOffset;
+
+        bool Used = false;
+    };
+
+    // Bin whose ranges are all >= size (rounding up) or that size belongs to (rounding down).
+    static uint32 BinRoundUp(uint32 size);
+    static uint32 BinRoundDown(uint32 size);
+
+    uint32 FindFreeBin(uint32 firstBin) const;
+
+    uint32 NewNode();
+    void InsertFree(uint32 node);
+    void RemoveFree(uint32 node);
+
+    uint32 mSize = 0;
+    uint32 mFreeSize = 0;
+    uint32 mAllocationCount = 0;
+
+    std::vector<Node> mNodes;
+    std::vector<uint32> mUnusedNodes;
+
+    uint32 mFirstLevelMask = 0;
+    std::uint8_t mSecondLevelMasks[FirstLevelCount] = {};
+    uint32 mBinHeads[BinCount];
+};
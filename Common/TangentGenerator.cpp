@@ -0,0 +1,220 @@
+//***************************************************************************************
+// TangentGenerator.cpp
+//***************************************************************************************
+
+#include "TangentGenerator.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    // Triangles or vertices handed to one ParallelFor task.
+    const std::uint32_t TriangleBlockSize = 4096;
+    const std::uint32_t VertexBlockSize = 4096;
+
+    template<typename T>
+    inline const T& StreamAt(const T* stream, std::uint32_t stride, std::uint32_t i)
+    {
+        return *reinterpret_cast<const T*>(reinterpret_cast<const std::uint8_t*>(stream) + (size_t)i*stride);
+    }
+
+    // Removes the component of v along the unit vector n.
+    inline XMVECTOR ProjectOnPlane(FXMVECTOR v, FXMVECTOR n)
+    {
+        return XMVectorNegativeMultiplySubtract(n, XMVector3Dot(n, v), v);
+    }
+
+    // Any unit vector orthogonal to n.
+    XMVECTOR AnyPerpendicular(FXMVECTOR n)
+    {
+        XMFLOAT3 a;
+        XMStoreFloat3(&a, XMVectorAbs(n));
+        XMVECTOR axis = (a.x <= a.y && a.x <= a.z) ? XMVectorSet(1.0f, 0.0f, 0.0f, 0.0f) :
+                        (a.y <= a.z)               ? XMVectorSet(0.0f, 1.0f, 0.0f, 0.0f) :
+                                                     XMVectorSet(0.0f, 0.0f, 1.0f, 0.0f);
+        return XMVector3Normalize(ProjectOnPlane(axis, n));
+    }
+}
+
+void TangentGenerator::Generate(const XMFLOAT3* positions, uint32 positionStride,
+                                const XMFLOAT3* normals, uint32 normalStride,
+                                const XMFLOAT2* texCs, uint32 texCStride,
+                                uint32 vertexCount, const uint32* indices, uint32 indexCount,
+                                XMFLOAT4* tangents)
+{
+    uint32 triangleCount = indexCount/3;
+    uint32 cornerCount = triangleCount*3;
+
+    //
+    // Pass 1, parallel over triangles: the tangent of every corner, projected onto the
+    // corner's vertex normal and weighted by the corner angle.  w holds the angle with
+    // the handedness of the corner, for the vote.
+    //
+
+    std::vector<XMFLOAT4> cornerTangents(cornerCount);
+
+    uint32 triangleBlocks = (triangleCount + TriangleBlockSize - 1)/TriangleBlockSize;
+    ThreadPool::Get().ParallelFor(triangleBlocks, [&](uint32 block)
+    {
+        uint32 first = block*TriangleBlockSize;
+        uint32 last = std::min(triangleCount, first + TriangleBlockSize);
+
+        for(uint32 t = first; t < last; ++t)
+        {
+            const uint32* tri = &indices[t*3];
+            if(tri[0] >= vertexCount || tri[1] >= vertexCount || tri[2] >= vertexCount)
+            {
+                for(uint32 k = 0; k < 3; ++k)
+                    cornerTangents[t*3+k] = XMFLOAT4(0.0f, 0.0f, 0.0f, 0.0f);
+                continue;
+            }
+
+            XMVECTOR p[3], uv[3];
+            for(uint32 k = 0; k < 3; ++k)
+            {
+                p[k] = XMLoadFloat3(&StreamAt(positions, positionStride, tri[k]));
+                uv[k] = XMLoadFloat2(&StreamAt(texCs, texCStride, tri[k]));
+            }
+
+            // Solve [e1; e2] = [duv1; duv2] * [T; B] for the uv gradient T.  Only its
+            // direction is used, so the division by the signed uv area becomes a sign.
+            XMVECTOR e1 = p[1] - p[0];
+            XMVECTOR e2 = p[2] - p[0];
+            XMFLOAT2 duv1, duv2;
+            XMStoreFloat2(&duv1, uv[1] - uv[0]);
+            XMStoreFloat2(&duv2, uv[2] - uv[0]);
+
+            float signedArea = duv1.x*duv2.y - duv1.y*duv2.x;
+            float sign = signedArea > 0.0f ? 1.0f : -1.0f;
+            XMVECTOR faceTangent = sign*(duv2.y*e1 - duv1.y*e2);
+
+            if(signedArea == 0.0f)
+                faceTangent = XMVectorZero();
+
+            // The uv gradients satisfy T x B = (e1 x e2)/signedArea, so the bitangent is
+            // +cross(n, T) when the uv winding and the winding around the normal agree.
+            // A normal that opposes the triangle's winding flips the handedness.
+            XMVECTOR faceNormal = XMVector3Cross(e1, e2);
+
+            for(uint32 k = 0; k < 3; ++k)
+            {
+                XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&StreamAt(normals, normalStride, tri[k])));
+
+                // Corner angle measured in the tangent plane of the vertex, as MikkTSpace does.
+                XMVECTOR toNext = XMVector3Normalize(ProjectOnPlane(p[(k+1)%3] - p[k], n));
+                XMVECTOR toPrev = XMVector3Normalize(ProjectOnPlane(p[(k+2)%3] - p[k], n));
+                float cosAngle = std::min(1.0f, std::max(-1.0f, XMVectorGetX(XMVector3Dot(toNext, toPrev))));
+                float angle = std::acos(cosAngle);
+
+                XMVECTOR tangent = XMVector3Normalize(ProjectOnPlane(faceTangent, n));
+                if(XMVector3Equal(tangent, XMVectorZero()))
+                    angle = 0.0f;
+
+                float facing = XMVectorGetX(XMVector3Dot(n, faceNormal)) < 0.0f ? -1.0f : 1.0f;
+
+                XMStoreFloat4(&cornerTangents[t*3+k], XMVectorSetW(tangent*angle, sign*facing*angle));
+            }
+        }
+    });
+
+    //
+    // Pass 2: vertex -> corner table (counting sort, corners in index order).
+    //
+
+    std::vector<uint32> cornerOffsets(vertexCount + 1, 0);
+    for(uint32 c = 0; c < cornerCount; ++c)
+    {
+        if(indices[c] < vertexCount)
+            cornerOffsets[indices[c] + 1]++;
+    }
+    for(uint32 v = 0; v < vertexCount; ++v)
+        cornerOffsets[v+1] += cornerOffsets[v];
+
+    std::vector<uint32> corners(cornerOffsets[vertexCount]);
+    std::vector<uint32> fill(cornerOffsets.begin(), cornerOffsets.end() - 1);
+    for(uint32 c = 0; c < cornerCount; ++c)
+    {
+        if(indices[c] < vertexCount)
+            corners[fill[indices[c]]++] = c;
+    }
+
+    //
+    // Pass 3, parallel over vertices: sum the corners in a fixed order, then
+    // Gram-Schmidt against the normal.
+    //
+
+    uint32 vertexBlocks = (vertexCount + VertexBlockSize - 1)/VertexBlockSize;
+    ThreadPool::Get().ParallelFor(vertexBlocks, [&](uint32 block)
+    {
+        uint32 first = block*VertexBlockSize;
+        uint32 last = std::min(vertexCount, first + VertexBlockSize);
+
+        for(uint32 v = first; v < last; ++v)
+        {
+            XMVECTOR sum = XMVectorZero();
+            for(uint32 i = cornerOffsets[v]; i < cornerOffsets[v+1]; ++i)
+                sum += XMLoadFloat4(&cornerTangents[corners[i]]);
+
+            XMVECTOR n = XMVector3Normalize(XMLoadFloat3(&StreamAt(normals, normalStride, v)));
+            XMVECTOR tangent = ProjectOnPlane(XMVectorSetW(sum, 0.0f), n);
+
+            if(XMVectorGetX(XMVector3LengthSq(tangent)) > 1e-20f)
+                tangent = XMVector3Normalize(tangent);
+            else
+                tangent = AnyPerpendicular(n);
+
+            float handedness = XMVectorGetW(sum) < 0.0f ? -1.0f : 1.0f;
+            XMStoreFloat4(&tangents[v], XMVectorSetW(tangent, handedness));
+        }
+    });
+}
+
+void TangentGenerator::Generate(GeometryGenerator::MeshData& meshData, std::vector<float>* handedness)
+{
+    uint32 vertexCount = (uint32)meshData.Vertices.size();
+    if(vertexCount == 0)
+        return;
+
+    const GeometryGenerator::Vertex& v0 = meshData.Vertices[0];
+    const uint32 stride = sizeof(GeometryGenerator::Vertex);
+
+    std::vector<XMFLOAT4> tangents(vertexCount);
+    Generate(&v0.Position, stride, &v0.Normal, stride, &v0.TexC, stride,
+        vertexCount, meshData.Indices32.data(), (uint32)meshData.Indices32.size(), tangents.data());
+
+    for(uint32 i = 0; i < vertexCount; ++i)
+        meshData.Vertices[i].TangentU = XMFLOAT3(tangents[i].x, tangents[i].y, tangents[i].z);
+
+    if(handedness != nullptr)
+    {
+        handedness->resize(vertexCount);
+        for(uint32 i = 0; i < vertexCount; ++i)
+            (*handedness)[i] = tangents[i].w;
+    }
+}
+
+void TangentGenerator::Generate(GeometryGenerator::MeshDataSoA& meshData, std::vector<float>* handedness)
+{
+    uint32 vertexCount = (uint32)meshData.Positions.size();
+    if(vertexCount == 0)
+        return;
+
+    std::vector<XMFLOAT4> tangents(vertexCount);
+    Generate(meshData.Positions.data(), sizeof(XMFLOAT3), meshData.Normals.data(), sizeof(XMFLOAT3),
+        meshData.TexCs.data(), sizeof(XMFLOAT2),
+        vertexCount, meshData.Indices32.data(), (uint32)meshData.Indices32.size(), tangents.data());
+
+    meshData.TangentUs.resize(vertexCount);
+    for(uint32 i = 0; i < vertexCount; ++i)
+        meshData.TangentUs[i] = XMFLOAT3(tangents[i].x, tangents[i].y, tangents[i].z);
+
+    if(handedness != nullptr)
+    {
+        handedness->resize(vertexCount);
+        for(uint32 i = 0; i < vertexCount; ++i)
+            (*handedness)[i] = tangents[i].w;
+    }
+}
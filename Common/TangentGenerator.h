@@ -0,0 +1,49 @@
+//***************************************************************************************
+// TangentGenerator.h
+//
+// Per-vertex tangent frames for any indexed triangle mesh with positions, normals and
+// texture coordinates, following the MikkTSpace rules: per-corner tangents are
+// projected onto the vertex normal, weighted by the corner angle and averaged, and
+// the handedness comes from the winding of the triangle in uv space, compared with its
+// winding around the vertex normal.  Reversing the winding of a mesh without touching
+// its normals therefore leaves its frames unchanged.
+//
+// Triangles are processed in parallel into per-corner contributions, then every vertex
+// gathers its corners through a vertex->corner table, so the result does not depend
+// on the thread count.
+//
+// MikkTSpace splits a vertex whose corners disagree on handedness (a mirrored uv seam
+// that shares vertices).  The vertex buffer is not changed here, so such a vertex
+// keeps the handedness carrying the larger angle.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+
+class TangentGenerator
+{
+public:
+
+    using uint32 = std::uint32_t;
+
+	///<summary>
+	/// Writes one tangent per vertex: xyz is the unit tangent (orthogonal to the normal)
+	/// and w is the handedness, so bitangent = w*cross(normal, tangent).  Each stream
+	/// has its own stride in bytes, so interleaved and separate layouts both work.
+	/// Vertices not referenced by any triangle, or whose triangles have no uv area, get
+	/// an arbitrary tangent orthogonal to the normal and w = 1.
+	///</summary>
+    static void Generate(const DirectX::XMFLOAT3* positions, uint32 positionStride,
+                         const DirectX::XMFLOAT3* normals, uint32 normalStride,
+                         const DirectX::XMFLOAT2* texCs, uint32 texCStride,
+                         uint32 vertexCount, const uint32* indices, uint32 indexCount,
+                         DirectX::XMFLOAT4* tangents);
+
+	///<summary>
+	/// Fills TangentU (Vertex has no room for the sign).  Pass handedness to also get
+	/// the w of every vertex.
+	///</summary>
+    static void Generate(GeometryGenerator::MeshData& meshData, std::vector<float>* handedness = nullptr);
+    static void Generate(GeometryGenerator::MeshDataSoA& meshData, std::vector<float>* handedness = nullptr);
+};
@@ -0,0 +1,137 @@
+//***************************************************************************************
+// ThreadPool.cpp
+//***************************************************************************************
+
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace
+{
+    // Set while a thread is running tasks of some pool.
+    thread_local bool tInsideTask = false;
+}
+
+ThreadPool::ThreadPool(uint32 threadCount)
+{
+    if(threadCount == 0)
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+
+    for(uint32 i = 1; i < threadCount; ++i)
+        mWorkers.emplace_back(&ThreadPool::WorkerMain, this);
+}
+
+ThreadPool::~ThreadPool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mQuit = true;
+    }
+    mWorkReady.notify_all();
+
+    for(std::thread& worker : mWorkers)
+        worker.join();
+}
+
+ThreadPool& ThreadPool::Get()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+void ThreadPool::ParallelFor(uint32 count, const std::function<void(uint32)>& task)
+{
+    if(count == 0)
+        return;
+
+    if(mWorkers.empty() || count == 1 || tInsideTask)
+    {
+        for(uint32 i = 0; i < count; ++i)
+            task(i);
+        return;
+    }
+
+    std::lock_guard<std::mutex> submitLock(mSubmitMutex);
+
+    {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mTask = &task;
+        mTaskCount = count;
+        mNextTask = 0;
+        mBusyWorkers = (uint32)mWorkers.size();
+        mGeneration++;
+    }
+    mWorkReady.notify_all();
+
+    RunTasks();
+
+    // task lives on the caller's stack, so wait until no worker can still touch it,
+    // even when a task threw.
+    std::exception_ptr exception;
+    {
+        std::unique_lock<std::mutex> lock(mMutex);
+        mWorkDone.wait(lock, [this]() { return mBusyWorkers == 0; });
+        mTask = nullptr;
+        std::swap(exception, mException);
+    }
+
+    if(exception)
+        std::rethrow_exception(exception);
+}
+
+void ThreadPool::WorkerMain()
+{
+    std::uint64_t seenGeneration = 0;
+
+    for(;;)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mMutex);
+            mWorkReady.wait(lock, [&]() { return mQuit || mGeneration != seenGeneration; });
+
+            if(mQuit)
+                return;
+
+            seenGeneration = mGeneration;
+        }
+
+        RunTasks();
+
+        bool last;
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            last = --mBusyWorkers == 0;
+        }
+        if(last)
+            mWorkDone.notify_one();
+    }
+}
+
+void ThreadPool::RunTasks()
+{
+    bool wasInside = tInsideTask;
+    tInsideTask = true;
+
+    for(;;)
+    {
+        uint32 i = mNextTask.fetch_add(1);
+        if(i >= mTaskCount)
+            break;
+
+        // An exception must not leave a worker thread (std::terminate) or unwind the
+        // caller while workers still run the task.  Keep the first one for
+        // ParallelFor to rethrow and skip the tasks nobody has started yet.
+        try
+        {
+            (*mTask)(i);
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> lock(mMutex);
+            if(!mException)
+                mException = std::current_exception();
+            mNextTask = mTaskCount;
+        }
+    }
+
+    tInsideTask = wasInside;
+}
@@ -0,0 +1,75 @@
+//***************************************************************************************
+// ThreadPool.h
+//
+// Fixed set of worker threads for data-parallel CPU work (geometry generation, mesh
+// processing, texture decoding).  The calling thread takes part in every ParallelFor,
+// and a ParallelFor issued from inside a task runs serially, so nesting cannot deadlock.
+//***************************************************************************************
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+class ThreadPool
+{
+public:
+
+    using uint32 = std::uint32_t;
+
+	///<summary>
+	/// threadCount is the total number of threads that run tasks, including the caller.
+	/// 0 uses std::thread::hardware_concurrency().
+	///</summary>
+    explicit ThreadPool(uint32 threadCount = 0);
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool& rhs) = delete;
+    ThreadPool& operator=(const ThreadPool& rhs) = delete;
+
+	///<summary>
+	/// Process-wide pool sized to the hardware, created on first use.
+	///</summary>
+    static ThreadPool& Get();
+
+    uint32 GetThreadCount() const { return (uint32)mWorkers.size() + 1; }
+
+	///<summary>
+	/// Calls task(i) for every i in [0, count) and returns when all calls are done.
+	/// Indices are handed out one at a time, so make each task a reasonable chunk of work
+	/// (a tile, a row of blocks, a range of vertices).  If a task throws, tasks not
+	/// started yet are skipped and the first exception is rethrown on the caller once
+	/// every thread has finished.
+	///</summary>
+    void ParallelFor(uint32 count, const std::function<void(uint32)>& task);
+
+private:
+
+    void WorkerMain();
+    void RunTasks();
+
+    std::vector<std::thread> mWorkers;
+
+    std::mutex mMutex;
+    std::condition_variable mWorkReady;
+    std::condition_variable mWorkDone;
+
+    // Only one ParallelFor runs at a time.
+    std::mutex mSubmitMutex;
+
+    const std::function<void(uint32)>* mTask = nullptr;
+    uint32 mTaskCount = 0;
+    std::atomic<uint32> mNextTask{ 0 };
+    uint32 mBusyWorkers = 0;
+    std::uint64_t mGeneration = 0;
+    bool mQuit = false;
+
+    // First exception thrown by a task of the current ParallelFor.
+    std::exception_ptr mException;
+};
@@ -0,0 +1,117 @@
+//***************************************************************************************
+// VertexPacking.cpp
+//***************************************************************************************
+
+#include "VertexPacking.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+using namespace DirectX::PackedVector;
+
+PackedVertexBounds VertexPacking::ComputeBounds(const GeometryGenerator::Vertex* vertices, uint32 vertexCount)
+{
+    PackedVertexBounds bounds;
+    if(vertexCount == 0)
+        return bounds;
+
+    XMVECTOR vMin = XMVectorReplicate(+FLT_MAX);
+    XMVECTOR vMax = XMVectorReplicate(-FLT_MAX);
+
+    for(uint32 i = 0; i < vertexCount; ++i)
+    {
+        XMVECTOR p = XMLoadFloat3(&vertices[i].Position);
+        vMin = XMVectorMin(vMin, p);
+        vMax = XMVectorMax(vMax, p);
+    }
+
+    XMStoreFloat3(&bounds.Center, 0.5f*(vMin + vMax));
+    XMStoreFloat3(&bounds.Extents, 0.5f*(vMax - vMin));
+
+    return bounds;
+}
+
+void VertexPacking::Pack(PackedVertex* destination, const GeometryGenerator::Vertex* vertices, uint32 vertexCount,
+                         const PackedVertexBounds& bounds)
+{
+    // Flat submeshes (a grid) have a zero extent on one axis; any value decodes
+    // to the center there, so just avoid the divide by zero.
+    XMVECTOR center = XMLoadFloat3(&bounds.Center);
+    XMVECTOR extents = XMVectorMax(XMLoadFloat3(&bounds.Extents), XMVectorReplicate(FLT_MIN));
+    XMVECTOR invSize = XMVectorReciprocal(2.0f*extents);
+    XMVECTOR boxMin = center - extents;
+
+    for(uint32 i = 0; i < vertexCount; ++i)
+    {
+        const GeometryGenerator::Vertex& v = vertices[i];
+        PackedVertex& packed = destination[i];
+
+        XMVECTOR p = (XMLoadFloat3(&v.Position) - boxMin) * invSize;
+        XMStoreUShortN4(&packed.Position, XMVectorSetW(XMVectorSaturate(p), 0.0f));
+
+        XMFLOAT2 n = EncodeOctahedral(v.Normal);
+        XMFLOAT2 t = EncodeOctahedral(v.TangentU);
+        XMStoreByteN4(&packed.NormalTangent, XMVectorSet(n.x, n.y, t.x, t.y));
+
+        XMStoreHalf2(&packed.TexC, XMLoadFloat2(&v.TexC));
+    }
+}
+
+void VertexPacking::Unpack(GeometryGenerator::Vertex* destination, const PackedVertex* vertices, uint32 vertexCount,
+                           const PackedVertexBounds& bounds)
+{
+    XMVECTOR center = XMLoadFloat3(&bounds.Center);
+    XMVECTOR extents = XMLoadFloat3(&bounds.Extents);
+
+    for(uint32 i = 0; i < vertexCount; ++i)
+    {
+        const PackedVertex& packed = vertices[i];
+        GeometryGenerator::Vertex& v = destination[i];
+
+        XMVECTOR p = XMLoadUShortN4(&packed.Position);
+        XMStoreFloat3(&v.Position, XMVectorMultiplyAdd(2.0f*p - XMVectorSplatOne(), extents, center));
+
+        XMFLOAT4 nt;
+        XMStoreFloat4(&nt, XMLoadByteN4(&packed.NormalTangent));
+        v.Normal = DecodeOctahedral(XMFLOAT2(nt.x, nt.y));
+        v.TangentU = DecodeOctahedral(XMFLOAT2(nt.z, nt.w));
+
+        XMStoreFloat2(&v.TexC, XMLoadHalf2(&packed.TexC));
+    }
+}
+
+XMFLOAT2 VertexPacking::EncodeOctahedral(const XMFLOAT3& n)
+{
+    // Project onto the octahedron |x|+|y|+|z| = 1, then fold the lower hemisphere
+    // over the diagonals so the whole sphere maps to the unit square.
+    float l1 = std::fabs(n.x) + std::fabs(n.y) + std::fabs(n.z);
+    if(l1 == 0.0f)
+        return XMFLOAT2(0.0f, 0.0f);
+
+    float x = n.x / l1;
+    float y = n.y / l1;
+
+    if(n.z < 0.0f)
+    {
+        float fx = (1.0f - std::fabs(y)) * (x >= 0.0f ? 1.0f : -1.0f);
+        float fy = (1.0f - std::fabs(x)) * (y >= 0.0f ? 1.0f : -1.0f);
+        x = fx;
+        y = fy;
+    }
+
+    return XMFLOAT2(x, y);
+}
+
+XMFLOAT3 VertexPacking::DecodeOctahedral(const XMFLOAT2& e)
+{
+    XMFLOAT3 n(e.x, e.y, 1.0f - std::fabs(e.x) - std::fabs(e.y));
+
+    float t = std::max(-n.z, 0.0f);
+    n.x += n.x >= 0.0f ? -t : t;
+    n.y += n.y >= 0.0f ? -t : t;
+
+    XMFLOAT3 result;
+    XMStoreFloat3(&result, XMVector3Normalize(XMLoadFloat3(&n)));
+    return result;
+}
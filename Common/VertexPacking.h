@@ -0,0 +1,83 @@
+//***************************************************************************************
+// VertexPacking.h
+//
+// Packs GeometryGenerator::Vertex (44 bytes, all float) into a 16-byte vertex:
+//   Position  R16G16B16A16_UNORM  xyz normalized against the submesh bounds (8 bytes)
+//   Normal    R8G8B8A8_SNORM      octahedral normal in xy, octahedral tangent in zw (4 bytes)
+//   TexC      R16G16_FLOAT        half-precision uv (4 bytes)
+//
+// The shader-side decode lives in Shaders/PackedVertex.hlsl; Unpack below is the
+// CPU reference it has to match.
+//***************************************************************************************
+
+#pragma once
+
+#include "GeometryGenerator.h"
+#include <DirectXPackedVector.h>
+#include <array>
+
+#if defined(_WIN32)
+#include <d3d12.h>
+#endif
+
+struct PackedVertex
+{
+    DirectX::PackedVector::XMUSHORTN4 Position;
+    DirectX::PackedVector::XMBYTEN4 NormalTangent;
+    DirectX::PackedVector::XMHALF2 TexC;
+};
+
+static_assert(sizeof(PackedVertex) == 16, "PackedVertex must stay 16 bytes");
+
+// Quantization range of the positions, an axis-aligned box like BoundingBox.
+// Shaders decode with Center + (2*p - 1)*Extents, so upload both as constants.
+struct PackedVertexBounds
+{
+    DirectX::XMFLOAT3 Center = { 0.0f, 0.0f, 0.0f };
+    DirectX::XMFLOAT3 Extents = { 0.0f, 0.0f, 0.0f };
+};
+
+class VertexPacking
+{
+public:
+
+    using uint32 = std::uint32_t;
+
+	///<summary>
+	/// Computes the quantization box of a vertex range (one submesh).
+	///</summary>
+    static PackedVertexBounds ComputeBounds(const GeometryGenerator::Vertex* vertices, uint32 vertexCount);
+
+	///<summary>
+	/// Encodes vertexCount vertices.  Positions outside bounds are clamped.
+	///</summary>
+    static void Pack(PackedVertex* destination, const GeometryGenerator::Vertex* vertices, uint32 vertexCount,
+                     const PackedVertexBounds& bounds);
+
+	///<summary>
+	/// Reference decode.  Normals and tangents come back unit length.
+	///</summary>
+    static void Unpack(GeometryGenerator::Vertex* destination, const PackedVertex* vertices, uint32 vertexCount,
+                       const PackedVertexBounds& bounds);
+
+	///<summary>
+	/// Octahedral mapping of a unit vector to [-1,1]^2 and back.
+	///</summary>
+    static DirectX::XMFLOAT2 EncodeOctahedral(const DirectX::XMFLOAT3& n);
+    static DirectX::XMFLOAT3 DecodeOctahedral(const DirectX::XMFLOAT2& e);
+
+#if defined(_WIN32)
+	///<summary>
+	/// Input layout of PackedVertex in slot 0.
+	///</summary>
+    static std::array<D3D12_INPUT_ELEMENT_DESC, 3> GetInputLayout()
+    {
+        return
+        {{
+            { "POSITION", 0, DXGI_FORMAT_R16G16B16A16_UNORM, 0, 0, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "NORMAL", 0, DXGI_FORMAT_R8G8B8A8_SNORM, 0, 8, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 },
+            { "TEXCOORD", 0, DXGI_FORMAT_R16G16_FLOAT, 0, 12, D3D12_INPUT_CLASSIFICATION_PER_VERTEX_DATA, 0 }
+        }};
+    }
+#endif
+};
@@ -7,6 +7,7 @@
 #pragma once
 
 #include "EnginePch.h"
+#include "BoundsBuilder.h"
 
 extern const int gNumFrameResources;
 
@@ -91,6 +92,15 @@ public:
         return (byteSize + 255) & ~255;
     }
 
+    // Strip cut (primitive restart) value matching an index buffer format, for
+    // D3D12_GRAPHICS_PIPELINE_STATE_DESC::IBStripCutValue.  Strip topologies only
+    // restart on all-ones indices when the PSO uses the cut value of the bound format.
+    static D3D12_INDEX_BUFFER_STRIP_CUT_VALUE GetStripCutValue(DXGI_FORMAT indexFormat)
+    {
+        return indexFormat == DXGI_FORMAT_R32_UINT ? D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFFFFFF
+                                                   : D3D12_INDEX_BUFFER_STRIP_CUT_VALUE_0xFFFF;
+    }
+
     static ComPtr<ID3DBlob> LoadBinary(const wstring& filename);
 
     static ComPtr<ID3D12Resource> CreateDefaultBuffer(
@@ -134,6 +144,16 @@ struct SubmeshGeometry
     // Bounding box of the geometry defined by this submesh. 
     // This is used in later chapters of the book.
 	BoundingBox Bounds;
+
+	// Tighter volumes filled by BoundsBuilder next to Bounds.  CullVolume names the
+	// smallest of the three; BoundsBuilder::IsVisible tests with that one.
+	BoundingSphere SphereBounds = BoundingSphere(XMFLOAT3(0.0f, 0.0f, 0.0f), 0.0f);
+	BoundingOrientedBox OrientedBounds;
+	BoundingVolume CullVolume = BoundingVolume::Box;
+
+	// Material of an imported submesh, an index into the importer's material list
+	// (GltfLoader::GetMaterials and BuildMaterials); -1 when it has none.
+	int MaterialIndex = -1;
 };
 
 struct MeshGeometry
@@ -158,6 +178,15 @@ struct MeshGeometry
 	DXGI_FORMAT IndexFormat = DXGI_FORMAT_R16_UINT;
 	UINT IndexBufferByteSize = 0;
 
+	// Optional position-only stream (one XMFLOAT3 per vertex, same vertex order as
+	// the main vertex buffer).  Depth-only, shadow and culling passes bind this
+	// instead of the full interleaved vertex buffer.
+	ComPtr<ID3DBlob> PositionBufferCPU = nullptr;
+	ComPtr<ID3D12Resource> PositionBufferGPU = nullptr;
+	ComPtr<ID3D12Resource> PositionBufferUploader = nullptr;
+	UINT PositionByteStride = 0;
+	UINT PositionBufferByteSize = 0;
+
 	// A MeshGeometry may store multiple geometries in one vertex/index buffer.
 	// Use this container to define the Submesh geometries so we can draw
 	// the Submeshes individually.
@@ -173,6 +202,16 @@ struct MeshGeometry
 		return vbv;
 	}
 
+	D3D12_VERTEX_BUFFER_VIEW PositionBufferView()const
+	{
+		D3D12_VERTEX_BUFFER_VIEW vbv;
+		vbv.BufferLocation = PositionBufferGPU->GetGPUVirtualAddress();
+		vbv.StrideInBytes = PositionByteStride;
+		vbv.SizeInBytes = PositionBufferByteSize;
+
+		return vbv;
+	}
+
 	D3D12_INDEX_BUFFER_VIEW IndexBufferView()const
 	{
 		D3D12_INDEX_BUFFER_VIEW ibv;
@@ -188,6 +227,7 @@ struct MeshGeometry
 	{
 		VertexBufferUploader = nullptr;
 		IndexBufferUploader = nullptr;
+		PositionBufferUploader = nullptr;
 	}
 };
 
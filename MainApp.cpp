@@ -10,6 +10,7 @@
 #include "Common/d3dApp.h"
 #include "Common/MathHelper.h"
 #include "Common/UploadBuffer.h"
+#include "Common/PrimitiveTables.h"
 
 struct Vertex
 {
@@ -333,44 +334,20 @@ void MainApp::BuildShadersAndInputLayout()
 */
 void MainApp::BuildBoxGeometry()
 {
-	array<Vertex, 8> vertices =
-	{
-		Vertex({ XMFLOAT3(-1.0f, -1.0f, -1.0f), XMFLOAT4(Colors::White) }),
-		Vertex({ XMFLOAT3(-1.0f, +1.0f, -1.0f), XMFLOAT4(Colors::Black) }),
-		Vertex({ XMFLOAT3(+1.0f, +1.0f, -1.0f), XMFLOAT4(Colors::Red) }),
-		Vertex({ XMFLOAT3(+1.0f, -1.0f, -1.0f), XMFLOAT4(Colors::Green) }),
-		Vertex({ XMFLOAT3(-1.0f, -1.0f, +1.0f), XMFLOAT4(Colors::Blue) }),
-		Vertex({ XMFLOAT3(-1.0f, +1.0f, +1.0f), XMFLOAT4(Colors::Yellow) }),
-		Vertex({ XMFLOAT3(+1.0f, +1.0f, +1.0f), XMFLOAT4(Colors::Cyan) }),
-		Vertex({ XMFLOAT3(+1.0f, -1.0f, +1.0f), XMFLOAT4(Colors::Magenta) })
-	};
-
-	array<uint16_t, 36> indices =
-	{
-		// front face
-		0, 1, 2,
-		0, 2, 3,
-
-		// back face
-		4, 6, 5,
-		4, 7, 6,
-
-		// left face
-		4, 5, 1,
-		4, 1, 0,
-
-		// right face
-		3, 2, 6,
-		3, 6, 7,
-
-		// top face
-		1, 5, 6,
-		1, 6, 2,
-
-		// bottom face
-		4, 0, 3,
-		4, 3, 7
-	};
+	// Built at compile time; both tables live in read-only data.
+	static constexpr array<Vertex, 8> vertices =
+	{{
+		{ PrimitiveTables::CubeCorners[0], XMFLOAT4(1.0f, 1.0f, 1.0f, 1.0f) },		// Colors::White
+		{ PrimitiveTables::CubeCorners[1], XMFLOAT4(0.0f, 0.0f, 0.0f, 1.0f) },		// Colors::Black
+		{ PrimitiveTables::CubeCorners[2], XMFLOAT4(1.0f, 0.0f, 0.0f, 1.0f) },		// Colors::Red
+		{ PrimitiveTables::CubeCorners[3], XMFLOAT4(0.0f, 0.501960814f, 0.0f, 1.0f) },	// Colors::Green
+		{ PrimitiveTables::CubeCorners[4], XMFLOAT4(0.0f, 0.0f, 1.0f, 1.0f) },		// Colors::Blue
+		{ PrimitiveTables::CubeCorners[5], XMFLOAT4(1.0f, 1.0f, 0.0f, 1.0f) },		// Colors::Yellow
+		{ PrimitiveTables::CubeCorners[6], XMFLOAT4(0.0f, 1.0f, 1.0f, 1.0f) },		// Colors::Cyan
+		{ PrimitiveTables::CubeCorners[7], XMFLOAT4(1.0f, 0.0f, 1.0f, 1.0f) }		// Colors::Magenta
+	}};
+
+	static constexpr const array<uint16_t, 36>& indices = PrimitiveTables::CubeIndices;
 
 	const UINT vbByteSize = (UINT)vertices.size() * sizeof(Vertex);
 	const UINT ibByteSize = (UINT)indices.size() * sizeof(std::uint16_t);
@@ -401,6 +378,8 @@ void MainApp::BuildBoxGeometry()
 	submesh.BaseVertexLocation = 0;
 
     _boxGeo->DrawArgs["box"] = submesh;
+
+	BoundsBuilder::ComputeSubmeshBounds(*_boxGeo);
 }
 
 /* Pipeline State Object 
@@ -0,0 +1,27 @@
+//***************************************************************************************
+// PackedVertex.hlsl
+//
+// Decodes the 16-byte vertex written by VertexPacking::Pack.  Include it from a shader
+// and bind VertexPacking::GetInputLayout().  Must match VertexPacking::Unpack.
+//***************************************************************************************
+
+struct PackedVertexIn
+{
+	float4 PosQ          : POSITION;  // R16G16B16A16_UNORM, xyz in [0,1] over the submesh bounds
+	float4 NormalTangent : NORMAL;    // R8G8B8A8_SNORM, octahedral normal (xy) and tangent (zw)
+	float2 TexC          : TEXCOORD;  // R16G16_FLOAT
+};
+
+float3 DecodeOctahedral(float2 e)
+{
+	float3 n = float3(e.xy, 1.0f - abs(e.x) - abs(e.y));
+	float t = saturate(-n.z);
+	n.xy += n.xy >= 0.0f ? -t : t;
+	return normalize(n);
+}
+
+// boundsCenter/boundsExtents are PackedVertexBounds of the submesh being drawn.
+float3 DecodePosition(float4 posQ, float3 boundsCenter, float3 boundsExtents)
+{
+	return boundsCenter + (2.0f*posQ.xyz - 1.0f)*boundsExtents;
+}
@@ -0,0 +1,97 @@
+//***************************************************************************************
+// BCDecoderTests.cpp
+//***************************************************************************************
+
+#include "BCDecoder.h"
+#include "TestCheck.h"
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+
+    // A 4-color BC1 block from pure red to pure blue whose pixel i uses palette entry
+    // i % 4, so every palette entry lands in every row.
+    void TestBC1()
+    {
+        const uint8 block[8] = { 0x00, 0xf8, 0x1f, 0x00, 0xe4, 0xe4, 0xe4, 0xe4 };
+        const uint8 palette[4][4] =
+        {
+            { 255, 0,   0, 255 },
+            {   0, 0, 255, 255 },
+            { 170, 0,  85, 255 },
+            {  85, 0, 170, 255 }
+        };
+
+        uint8 pixels[4][16];
+        BCDecoder::DecodeBlock(DXGI_FORMAT_BC1_UNORM, block, pixels, sizeof(pixels[0]));
+
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            for(uint32 c = 0; c < 4; ++c)
+                CHECK(pixels[i/4][(i%4)*4 + c] == palette[i%4][c]);
+        }
+    }
+
+    // An 8-value BC4 block whose pixel i uses palette entry i % 8, decoded to R000 with
+    // alpha one.
+    void TestBC4()
+    {
+        uint8 block[8] = { 255, 0 };
+        unsigned long long indices = 0;
+        for(uint32 i = 0; i < 16; ++i)
+            indices |= (unsigned long long)(i % 8) << (3*i);
+        for(uint32 i = 0; i < 6; ++i)
+            block[2 + i] = (uint8)(indices >> (8*i));
+
+        uint8 pixels[4][16];
+        BCDecoder::DecodeBlock(DXGI_FORMAT_BC4_UNORM, block, pixels, sizeof(pixels[0]));
+
+        for(uint32 i = 0; i < 16; ++i)
+        {
+            uint32 entry = i % 8;
+            uint32 expected = entry == 0 ? 255 : entry == 1 ? 0 : ((8 - entry)*255 + 3) / 7;
+
+            const uint8* pixel = &pixels[i/4][(i%4)*4];
+            CHECK(pixel[0] == expected);
+            CHECK(pixel[1] == 0 && pixel[2] == 0 && pixel[3] == 255);
+        }
+    }
+
+    // Decode clips the edge blocks and leaves the bytes past the surface alone.
+    void TestClipping()
+    {
+        const uint8 block[8] = { 0x00, 0xf8, 0x00, 0xf8, 0x00, 0x00, 0x00, 0x00 };
+        uint8 source[16];
+        for(uint32 i = 0; i < 16; ++i)
+            source[i] = block[i % 8];
+
+        const uint32 width = 5, height = 3;
+        const size_t rowPitch = 6*4;
+        uint8 dest[4*rowPitch];
+        for(uint8& byte : dest)
+            byte = 0xcd;
+
+        CHECK(BCDecoder::Decode(DXGI_FORMAT_BC1_UNORM, source, 16, width, height, dest, rowPitch));
+
+        for(uint32 y = 0; y < 4; ++y)
+        {
+            for(uint32 x = 0; x < 6; ++x)
+            {
+                const uint8* pixel = &dest[y*rowPitch + x*4];
+                bool inside = x < width && y < height;
+                CHECK(inside ? pixel[0] == 255 && pixel[1] == 0 && pixel[2] == 0 && pixel[3] == 255
+                             : pixel[0] == 0xcd && pixel[3] == 0xcd);
+            }
+        }
+    }
+}
+
+int main()
+{
+    TestBC1();
+    TestBC4();
+    TestClipping();
+
+    return TestCheck::Result("BCDecoderTests");
+}
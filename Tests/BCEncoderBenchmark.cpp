@@ -0,0 +1,102 @@
+//***************************************************************************************
+// BCEncoderBenchmark.cpp
+//
+// Encodes a synthetic image (gradients, edges, noise and an alpha ramp) with
+// BCEncoder::Encode for every format and quality and prints the throughput in source
+// MB/s and the PSNR.  BC7 runs twice, with the alpha ramp and fully opaque, since the
+// two search different modes.
+//     BCEncoderBenchmark [width height]
+//***************************************************************************************
+
+#include "BCEncoder.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    struct Format
+    {
+        DXGI_FORMAT Value;
+        const char* Name;
+        uint32 BlockSize;
+        bool Opaque;
+    };
+
+    const Format Formats[] =
+    {
+        { DXGI_FORMAT_BC1_UNORM, "BC1", 8, false },
+        { DXGI_FORMAT_BC3_UNORM, "BC3", 16, false },
+        { DXGI_FORMAT_BC5_UNORM, "BC5", 16, false },
+        { DXGI_FORMAT_BC7_UNORM, "BC7", 16, false },
+        { DXGI_FORMAT_BC7_UNORM, "BC7 opaque", 16, true }
+    };
+
+    const char* QualityNames[] = { "Fast", "Normal", "High" };
+
+    // Smooth gradients, hard-edged checkers, a little noise and an alpha ramp, so every
+    // format has both easy and hard blocks.
+    std::vector<uint8> MakeImage(uint32 width, uint32 height, bool opaque)
+    {
+        std::vector<uint8> image((size_t)width*height*4);
+        uint64 state = 0x9E3779B97F4A7C15ull;
+        for(uint32 y = 0; y < height; ++y)
+        {
+            for(uint32 x = 0; x < width; ++x)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                int noise = (int)(state >> 61) - 4;
+
+                bool checker = ((x / 37) ^ (y / 29)) & 1;
+                uint8* pixel = &image[((size_t)y*width + x)*4];
+                pixel[0] = (uint8)std::clamp((int)(x*255 / width) + noise, 0, 255);
+                pixel[1] = (uint8)std::clamp((int)(y*255 / height) + (checker ? 40 : -40) + noise, 0, 255);
+                pixel[2] = (uint8)std::clamp((int)(127.5f + 127.5f*std::sin(x*0.05f + y*0.03f)), 0, 255);
+                pixel[3] = opaque ? 255 : (uint8)((x + y)*255 / (width + height));
+            }
+        }
+        return image;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32 width = 1024, height = 1024;
+    if(argc == 3)
+    {
+        width = (uint32)std::strtoul(argv[1], nullptr, 10);
+        height = (uint32)std::strtoul(argv[2], nullptr, 10);
+    }
+
+    std::printf("%ux%u\n", width, height);
+    for(const Format& format : Formats)
+    {
+        std::vector<uint8> source = MakeImage(width, height, format.Opaque);
+        size_t sourceRowPitch = (size_t)width*4;
+        size_t destRowPitch = (size_t)((width + 3) / 4)*format.BlockSize;
+        std::vector<uint8> dest(destRowPitch*((height + 3) / 4));
+
+        for(uint32 q = 0; q < 3; ++q)
+        {
+            auto start = std::chrono::steady_clock::now();
+            BCEncoder::Encode(format.Value, (BCEncoder::Quality)q, source.data(), sourceRowPitch,
+                              width, height, dest.data(), destRowPitch);
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            double psnr = BCEncoder::ComputePSNR(format.Value, source.data(), sourceRowPitch, width, height,
+                                                 dest.data(), destRowPitch);
+            std::printf("  %-10s %-6s %8.2f MB/s %7.2f dB\n", format.Name, QualityNames[q],
+                        seconds > 0.0 ? source.size() / seconds * 1e-6 : 0.0, psnr);
+        }
+    }
+
+    return 0;
+}
@@ -0,0 +1,92 @@
+//***************************************************************************************
+// BCEncoderTests.cpp
+//***************************************************************************************
+
+#include "BCDecoder.h"
+#include "BCEncoder.h"
+#include "TestCheck.h"
+#include <cmath>
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+
+    const DXGI_FORMAT Formats[] =
+    {
+        DXGI_FORMAT_BC1_UNORM,
+        DXGI_FORMAT_BC3_UNORM,
+        DXGI_FORMAT_BC5_UNORM,
+        DXGI_FORMAT_BC7_UNORM
+    };
+
+    const BCEncoder::Quality Qualities[] =
+    {
+        BCEncoder::Quality::Fast,
+        BCEncoder::Quality::Normal,
+        BCEncoder::Quality::High
+    };
+
+    uint32 GetBlockSize(DXGI_FORMAT format)
+    {
+        return format == DXGI_FORMAT_BC1_UNORM ? 8 : 16;
+    }
+
+    // Opaque gradients with hard edges, the kind of block the partitioned BC7 modes are for.
+    std::vector<uint8> MakeImage(uint32 width, uint32 height)
+    {
+        std::vector<uint8> image((size_t)width*height*4);
+        for(uint32 y = 0; y < height; ++y)
+        {
+            for(uint32 x = 0; x < width; ++x)
+            {
+                bool checker = ((x / 5) ^ (y / 3)) & 1;
+                uint8* pixel = &image[((size_t)y*width + x)*4];
+                pixel[0] = (uint8)(x*255 / width);
+                pixel[1] = (uint8)(checker ? 200 - y : 40 + y);
+                pixel[2] = (uint8)(127.5f + 127.5f*std::sin(x*0.3f + y*0.2f));
+                pixel[3] = 255;
+            }
+        }
+        return image;
+    }
+
+    // Every level is at least as good as the one below it, and opaque BC7 stays opaque.
+    void TestQualityOrder()
+    {
+        const uint32 width = 64, height = 64;
+        std::vector<uint8> source = MakeImage(width, height);
+
+        for(DXGI_FORMAT format : Formats)
+        {
+            size_t rowPitch = (size_t)(width / 4)*GetBlockSize(format);
+            std::vector<uint8> encoded(rowPitch*(height / 4));
+
+            double previous = 0.0;
+            for(BCEncoder::Quality quality : Qualities)
+            {
+                CHECK(BCEncoder::Encode(format, quality, source.data(), width*4, width, height, encoded.data(), rowPitch));
+                double psnr = BCEncoder::ComputePSNR(format, source.data(), width*4, width, height, encoded.data(), rowPitch);
+                CHECK(psnr >= previous);
+                previous = psnr;
+
+                if(format == DXGI_FORMAT_BC7_UNORM)
+                {
+                    std::vector<uint8> decoded((size_t)width*height*4);
+                    CHECK(BCDecoder::Decode(format, encoded.data(), rowPitch, width, height, decoded.data(), width*4));
+                    bool opaque = true;
+                    for(size_t i = 3; i < decoded.size(); i += 4)
+                        opaque = opaque && decoded[i] == 255;
+                    CHECK(opaque);
+                }
+            }
+        }
+    }
+}
+
+int main()
+{
+    TestQualityOrder();
+
+    return TestCheck::Result("BCEncoderTests");
+}
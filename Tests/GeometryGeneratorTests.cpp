@@ -0,0 +1,61 @@
+//***************************************************************************************
+// GeometryGeneratorTests.cpp
+//***************************************************************************************
+
+#include "GeometryGenerator.h"
+#include "MeshOptimizer.h"
+#include "TestCheck.h"
+#include <algorithm>
+
+namespace
+{
+    using uint32 = std::uint32_t;
+
+    bool SameIndices(const std::vector<std::uint16_t>& indices16, const std::vector<uint32>& indices32)
+    {
+        return std::equal(indices16.begin(), indices16.end(), indices32.begin(), indices32.end());
+    }
+
+    // GetIndices16 converts once and hands back the cached copy until the index count
+    // changes or InvalidateIndices16 is called.
+    void TestIndices16()
+    {
+        GeometryGenerator geoGen;
+        GeometryGenerator::MeshData mesh = geoGen.CreateSphere(1.0f, 12, 12);
+
+        std::vector<std::uint16_t>& indices16 = mesh.GetIndices16();
+        const std::uint16_t* cached = indices16.data();
+        CHECK(SameIndices(indices16, mesh.Indices32));
+        CHECK(mesh.GetIndices16().data() == cached);
+
+        // The optimizer rewrites Indices32 in place and invalidates the copy itself.
+        MeshOptimizer::OptimizeVertexCache(mesh);
+        CHECK(SameIndices(mesh.GetIndices16(), mesh.Indices32));
+
+        mesh.Indices32.resize(mesh.Indices32.size() - 3);
+        CHECK(SameIndices(mesh.GetIndices16(), mesh.Indices32));
+
+        std::swap(mesh.Indices32[0], mesh.Indices32[1]);
+        mesh.InvalidateIndices16();
+        CHECK(SameIndices(mesh.GetIndices16(), mesh.Indices32));
+
+        mesh.Indices32.push_back(0x10000);
+        bool threw = false;
+        try
+        {
+            mesh.GetIndices16();
+        }
+        catch(const std::out_of_range&)
+        {
+            threw = true;
+        }
+        CHECK(threw);
+    }
+}
+
+int main()
+{
+    TestIndices16();
+
+    return TestCheck::Result("GeometryGeneratorTests");
+}
@@ -0,0 +1,209 @@
+//***************************************************************************************
+// MeshOptimizerTests.cpp
+//***************************************************************************************
+
+#include "MeshOptimizer.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <array>
+
+namespace
+{
+    using uint32 = std::uint32_t;
+
+    // Triangles as (a, b, c) rotated to start at their smallest index, so equal
+    // triangles with the same winding compare equal.
+    std::vector<std::array<uint32, 3>> SortedTriangles(const uint32* indices, uint32 triangleCount)
+    {
+        std::vector<std::array<uint32, 3>> triangles(triangleCount);
+        for(uint32 t = 0; t < triangleCount; ++t)
+        {
+            const uint32* tri = &indices[t*3];
+            uint32 r = (tri[1] < tri[0] && tri[1] <= tri[2]) ? 1 : (tri[2] < tri[0] && tri[2] < tri[1]) ? 2 : 0;
+            triangles[t] = { tri[r], tri[(r+1)%3], tri[(r+2)%3] };
+        }
+        std::sort(triangles.begin(), triangles.end());
+        return triangles;
+    }
+
+    // Every triangle comes out once with its winding, also with one or two trailing
+    // indices, which are copied through; an empty list is accepted.
+    void TestVertexCache()
+    {
+        GeometryGenerator geoGen;
+        GeometryGenerator::MeshData sphere = geoGen.CreateGeosphere(1.0f, 3);
+        uint32 vertexCount = (uint32)sphere.Vertices.size();
+
+        for(uint32 extra = 0; extra < 3; ++extra)
+        {
+            std::vector<uint32> indices = sphere.Indices32;
+            for(uint32 i = 0; i < extra; ++i)
+                indices.push_back(i);
+
+            uint32 indexCount = (uint32)indices.size();
+            uint32 triangleCount = indexCount/3;
+            std::vector<uint32> optimized(indexCount, ~0u);
+            MeshOptimizer::OptimizeVertexCache(optimized.data(), indices.data(), indexCount, vertexCount);
+
+            CHECK(SortedTriangles(optimized.data(), triangleCount) == SortedTriangles(indices.data(), triangleCount));
+            CHECK(std::equal(indices.begin() + triangleCount*3, indices.end(), optimized.begin() + triangleCount*3));
+        }
+
+        MeshOptimizer::OptimizeVertexCache(nullptr, nullptr, 0, 0);
+
+        GeometryGenerator::MeshData grid = geoGen.CreateGrid(10.0f, 10.0f, 64, 64);
+        MeshOptimizer::VertexCacheResult result = MeshOptimizer::OptimizeVertexCache(grid);
+        CHECK(result.After.TriangleCount == result.Before.TriangleCount);
+        CHECK(result.After.ACMR < result.Before.ACMR);
+    }
+
+    // Remapping keeps every triangle (by position), drops the vertices nothing uses,
+    // numbers the rest by first use and shrinks the bounds to what is left.
+    void TestVertexFetch()
+    {
+        GeometryGenerator geoGen;
+        GeometryGenerator::MeshData mesh = geoGen.CreateSphere(1.0f, 16, 16);
+        MeshOptimizer::OptimizeVertexCache(mesh);
+
+        // A far away vertex no triangle references.
+        GeometryGenerator::Vertex stray = mesh.Vertices[0];
+        stray.Position = DirectX::XMFLOAT3(100.0f, 0.0f, 0.0f);
+        mesh.Vertices.insert(mesh.Vertices.begin() + 5, stray);
+        for(uint32& index : mesh.Indices32)
+        {
+            if(index >= 5)
+                ++index;
+        }
+        GeometryGenerator::ComputeBounds(mesh);
+
+        auto positions = [](const GeometryGenerator::MeshData& meshData)
+        {
+            std::vector<std::array<float, 9>> triangles;
+            for(size_t i = 0; i + 2 < meshData.Indices32.size(); i += 3)
+            {
+                std::array<float, 9> triangle;
+                for(int k = 0; k < 3; ++k)
+                {
+                    const DirectX::XMFLOAT3& p = meshData.Vertices[meshData.Indices32[i+k]].Position;
+                    triangle[k*3+0] = p.x;
+                    triangle[k*3+1] = p.y;
+                    triangle[k*3+2] = p.z;
+                }
+                triangles.push_back(triangle);
+            }
+            return triangles;
+        };
+
+        auto before = positions(mesh);
+        uint32 vertexCount = (uint32)mesh.Vertices.size();
+        MeshOptimizer::VertexFetchResult result = MeshOptimizer::OptimizeVertexFetch(mesh);
+
+        CHECK(result.VertexCount == vertexCount - 1);
+        CHECK(mesh.Vertices.size() == result.VertexCount);
+        CHECK(positions(mesh) == before);
+        CHECK(result.After.CacheLineFetches <= result.Before.CacheLineFetches);
+
+        // First use order: each index is at most one past the largest seen so far.
+        uint32 next = 0;
+        bool firstUseOrder = true;
+        for(uint32 index : mesh.Indices32)
+        {
+            firstUseOrder = firstUseOrder && index <= next;
+            next = std::max(next, index + 1);
+        }
+        CHECK(firstUseOrder);
+
+        CHECK(mesh.Bounds.Box.Extents.x < 1.01f);
+    }
+
+    // Expands strips with restart indices back into a triangle list, dropping
+    // degenerate triangles.  destination needs (stripIndexCount-2)*3 entries.
+    template<typename IndexType>
+    uint32 Unstripify(IndexType* destination, const IndexType* strip, uint32 stripIndexCount)
+    {
+        const IndexType restart = (IndexType)~IndexType(0);
+
+        uint32 count = 0;
+        uint32 start = 0;
+        for(uint32 i = 0; i < stripIndexCount; ++i)
+        {
+            if(strip[i] == restart)
+            {
+                start = i + 1;
+                continue;
+            }
+
+            uint32 n = i - start;
+            if(n < 2)
+                continue;
+
+            IndexType a = strip[i-2], b = strip[i-1], c = strip[i];
+            if(a == b || b == c || c == a)
+                continue;
+
+            // Odd triangles are flipped back to the original winding.
+            if((n - 2) & 1)
+                std::swap(a, b);
+
+            destination[count++] = a;
+            destination[count++] = b;
+            destination[count++] = c;
+        }
+
+        return count;
+    }
+
+    // Strips expand back to the same triangles with the same winding, for 32-bit and
+    // 16-bit indices, and fit in GetStripifyBound.
+    void TestStripify()
+    {
+        GeometryGenerator geoGen;
+        GeometryGenerator::MeshData meshes[] =
+        {
+            geoGen.CreateBox(1.0f, 2.0f, 3.0f, 3),
+            geoGen.CreateGrid(10.0f, 10.0f, 40, 30),
+            geoGen.CreateCylinder(1.0f, 0.5f, 2.0f, 20, 20),
+            geoGen.CreateSphere(1.0f, 20, 20),
+            geoGen.CreateGeosphere(1.0f, 3),
+            geoGen.CreateQuad(0.0f, 0.0f, 1.0f, 1.0f, 0.0f)
+        };
+
+        for(GeometryGenerator::MeshData& mesh : meshes)
+        {
+            uint32 indexCount = (uint32)mesh.Indices32.size();
+            uint32 triangleCount = indexCount/3;
+            auto expected = SortedTriangles(mesh.Indices32.data(), triangleCount);
+
+            std::vector<uint32> strip;
+            MeshOptimizer::StripStats stats = MeshOptimizer::Stripify(mesh, strip);
+            CHECK(stats.StripIndexCount <= MeshOptimizer::GetStripifyBound(indexCount));
+            CHECK(stats.StripIndexCount < indexCount);
+            CHECK(stats.StripCount == 1 + (uint32)std::count(strip.begin(), strip.end(), ~0u));
+
+            std::vector<uint32> list(strip.size()*3);
+            uint32 listCount = Unstripify(list.data(), strip.data(), (uint32)strip.size());
+            CHECK(listCount == indexCount);
+            CHECK(SortedTriangles(list.data(), listCount/3) == expected);
+
+            const std::vector<std::uint16_t>& indices16 = mesh.GetIndices16();
+            std::vector<std::uint16_t> strip16(MeshOptimizer::GetStripifyBound(indexCount));
+            uint32 strip16Count = MeshOptimizer::Stripify(strip16.data(), indices16.data(), indexCount,
+                (uint32)mesh.Vertices.size());
+
+            std::vector<std::uint16_t> list16(strip16Count*3);
+            uint32 list16Count = Unstripify(list16.data(), strip16.data(), strip16Count);
+            std::vector<uint32> list32(list16.begin(), list16.begin() + list16Count);
+            CHECK(list16Count == indexCount);
+            CHECK(SortedTriangles(list32.data(), list16Count/3) == expected);
+        }
+    }
+}
+
+int main()
+{
+    TestVertexCache();
+    TestVertexFetch();
+    TestStripify();
+
+    return TestCheck::Result("MeshOptimizerTests");
+}
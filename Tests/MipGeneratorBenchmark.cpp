@@ -0,0 +1,95 @@
+//***************************************************************************************
+// MipGeneratorBenchmark.cpp
+//
+// Generates the full chain of a synthetic surface with MipGenerator::GenerateChain for
+// R8G8B8A8_UNORM, R8G8B8A8_UNORM_SRGB and R32G32B32A32_FLOAT with every filter and
+// prints the throughput in source megapixels per second.
+//     MipGeneratorBenchmark [width height]
+//***************************************************************************************
+
+#include "MipGenerator.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+    using uint64 = std::uint64_t;
+
+    struct Format
+    {
+        DXGI_FORMAT Value;
+        const char* Name;
+    };
+
+    const Format Formats[] =
+    {
+        { DXGI_FORMAT_R8G8B8A8_UNORM, "R8G8B8A8_UNORM" },
+        { DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, "R8G8B8A8_UNORM_SRGB" },
+        { DXGI_FORMAT_R32G32B32A32_FLOAT, "R32G32B32A32_FLOAT" }
+    };
+
+    const char* FilterNames[] = { "Box", "Kaiser", "Lanczos" };
+
+    // Megapixels of level 0 per second.
+    double Benchmark(DXGI_FORMAT format, MipGenerator::Filter filter, uint32 width, uint32 height)
+    {
+        size_t numBytes = 0, rowBytes = 0;
+        DDSParser::GetSurfaceInfo(width, height, format, &numBytes, &rowBytes, nullptr);
+
+        // Pseudo-random bytes; for the float format that is a mix of ordinary values,
+        // denormals and the odd NaN, so it gets a smooth pattern instead.
+        std::vector<uint8> source(numBytes);
+        if(format == DXGI_FORMAT_R32G32B32A32_FLOAT)
+        {
+            float* values = reinterpret_cast<float*>(source.data());
+            for(size_t i = 0; i < numBytes / sizeof(float); ++i)
+                values[i] = 0.5f + 0.5f*std::sin((float)i*0.01f);
+        }
+        else
+        {
+            uint64 state = 0x9E3779B97F4A7C15ull;
+            for(uint8& byte : source)
+            {
+                state ^= state << 13;
+                state ^= state >> 7;
+                state ^= state << 17;
+                byte = (uint8)(state >> 56);
+            }
+        }
+
+        uint32 mipCount = MipGenerator::GetFullMipCount(width, height);
+        std::vector<uint8> chain((size_t)MipGenerator::GetChainSize(format, width, height, mipCount));
+
+        auto start = std::chrono::steady_clock::now();
+        MipGenerator::GenerateChain(format, source.data(), rowBytes, width, height, mipCount, filter, chain.data());
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        return seconds > 0.0 ? (double)width*height / seconds * 1e-6 : 0.0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    uint32 width = 2048, height = 2048;
+    if(argc == 3)
+    {
+        width = (uint32)std::strtoul(argv[1], nullptr, 10);
+        height = (uint32)std::strtoul(argv[2], nullptr, 10);
+    }
+
+    std::printf("%ux%u\n", width, height);
+    for(const Format& format : Formats)
+    {
+        for(uint32 f = 0; f < 3; ++f)
+        {
+            std::printf("  %-20s %-8s %8.1f MPixels/s\n", format.Name, FilterNames[f],
+                        Benchmark(format.Value, (MipGenerator::Filter)f, width, height));
+        }
+    }
+
+    return 0;
+}
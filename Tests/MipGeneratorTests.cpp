@@ -0,0 +1,80 @@
+//***************************************************************************************
+// MipGeneratorTests.cpp
+//***************************************************************************************
+
+#include "MipGenerator.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cstdlib>
+
+namespace
+{
+    using uint8 = std::uint8_t;
+    using uint32 = std::uint32_t;
+
+    const MipGenerator::Filter Filters[] =
+    {
+        MipGenerator::Filter::Box,
+        MipGenerator::Filter::Kaiser,
+        MipGenerator::Filter::Lanczos
+    };
+
+    // Every filter keeps a constant surface constant, odd sizes included, and level 0
+    // is the source.
+    void TestConstant()
+    {
+        const uint32 width = 13, height = 6;
+        const uint8 color[4] = { 200, 100, 50, 128 };
+
+        std::vector<uint8> source((size_t)width*height*4);
+        for(size_t i = 0; i < source.size(); ++i)
+            source[i] = color[i % 4];
+
+        uint32 mipCount = MipGenerator::GetFullMipCount(width, height);
+        CHECK(mipCount == 4);
+
+        for(DXGI_FORMAT format : { DXGI_FORMAT_R8G8B8A8_UNORM, DXGI_FORMAT_R8G8B8A8_UNORM_SRGB })
+        {
+            for(MipGenerator::Filter filter : Filters)
+            {
+                std::vector<uint8> chain((size_t)MipGenerator::GetChainSize(format, width, height, mipCount));
+                CHECK(chain.size() == (13*6 + 6*3 + 3*1 + 1*1)*4);
+                CHECK(MipGenerator::GenerateChain(format, source.data(), width*4, width, height, mipCount, filter, chain.data()));
+
+                bool same = std::equal(source.begin(), source.end(), chain.begin());
+                for(size_t i = source.size(); i < chain.size(); ++i)
+                    same = same && std::abs(chain[i] - color[i % 4]) <= 1;
+                CHECK(same);
+            }
+        }
+    }
+
+    // A 2x2 box average is taken in linear light for _SRGB: black and white average to
+    // sRGB 188, not 128.  Alpha stays linear.
+    void TestSRGB()
+    {
+        const uint8 source[16] =
+        {
+            0, 0, 0, 0,         255, 255, 255, 255,
+            255, 255, 255, 255, 0, 0, 0, 0
+        };
+
+        uint8 chain[20];
+        CHECK(MipGenerator::GenerateChain(DXGI_FORMAT_R8G8B8A8_UNORM_SRGB, source, 8, 2, 2, 2,
+                                          MipGenerator::Filter::Box, chain));
+        CHECK(std::abs(chain[16] - 188) <= 1 && chain[16] == chain[17] && chain[17] == chain[18]);
+        CHECK(std::abs(chain[19] - 128) <= 1);
+
+        CHECK(MipGenerator::GenerateChain(DXGI_FORMAT_R8G8B8A8_UNORM, source, 8, 2, 2, 2,
+                                          MipGenerator::Filter::Box, chain));
+        CHECK(std::abs(chain[16] - 128) <= 1);
+    }
+}
+
+int main()
+{
+    TestConstant();
+    TestSRGB();
+
+    return TestCheck::Result("MipGeneratorTests");
+}
@@ -0,0 +1,104 @@
+//***************************************************************************************
+// ObjLoaderTests.cpp
+//***************************************************************************************
+
+#include "ObjLoader.h"
+#include "TestCheck.h"
+#include <cstring>
+#include <string>
+
+using namespace DirectX;
+
+namespace
+{
+    using uint32 = std::uint32_t;
+
+    // A counter-clockwise quad in the xy plane facing +z, the OBJ (right-handed) front.
+    const char* Quad =
+        "mtllib quad.mtl\n"
+        "v 0 0 0\n"
+        "v 1 0 0\n"
+        "v 1 1 0\n"
+        "v 0 1 0\n"
+        "vt 0 0\n"
+        "vt 1 0\n"
+        "vt 1 1\n"
+        "vt 0 1\n"
+        "vn 0 0 1\n"
+        "usemtl red\n"
+        "f 1/1/1 2/2/1 3/3/1 4/4/1\n";
+
+    float WindingAboutNormal(const ObjLoader::ObjModel& model, uint32 triangle)
+    {
+        const GeometryGenerator::MeshData& mesh = model.Mesh;
+        XMVECTOR p0 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[triangle*3 + 0]].Position);
+        XMVECTOR p1 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[triangle*3 + 1]].Position);
+        XMVECTOR p2 = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[triangle*3 + 2]].Position);
+        XMVECTOR n = XMLoadFloat3(&mesh.Vertices[mesh.Indices32[triangle*3]].Normal);
+        return XMVectorGetX(XMVector3Dot(XMVector3Cross(p1 - p0, p2 - p0), n));
+    }
+
+    // Positions stay as written, v is flipped and the triangles are reversed, so they
+    // are clockwise about their normals (see ObjLoader.h).
+    void TestConvention()
+    {
+        ObjLoader::ObjModel model;
+        std::string error;
+        CHECK(ObjLoader::Parse(Quad, std::strlen(Quad), model, &error));
+        CHECK(error.empty());
+
+        CHECK(model.Mesh.Vertices.size() == 4);
+        CHECK(model.Mesh.Indices32.size() == 6);
+        CHECK(model.Submeshes.size() == 1 && model.Submeshes[0].Material == "red");
+        CHECK(model.MaterialLibraries.size() == 1 && model.MaterialLibraries[0] == "quad.mtl");
+
+        for(const GeometryGenerator::Vertex& v : model.Mesh.Vertices)
+        {
+            CHECK(v.TexC.x == v.Position.x);
+            CHECK(v.TexC.y == 1.0f - v.Position.y);
+            CHECK(v.Position.z == 0.0f);
+        }
+
+        for(uint32 t = 0; t < 2; ++t)
+            CHECK(WindingAboutNormal(model, t) < 0.0f);
+
+        // Generated normals follow the file's winding, not the reversed one.
+        const char* noNormals = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+        CHECK(ObjLoader::Parse(noNormals, std::strlen(noNormals), model));
+        CHECK(model.Mesh.Vertices.size() == 3);
+        for(const GeometryGenerator::Vertex& v : model.Mesh.Vertices)
+            CHECK(v.Normal.z > 0.99f);
+        CHECK(WindingAboutNormal(model, 0) < 0.0f);
+    }
+
+    // Errors name the line, also when it lies in a later chunk of a large file.
+    void TestErrorLine()
+    {
+        ObjLoader::ObjModel model;
+        std::string error;
+        const char* bad = "v 0 0 0\nv 1 0 0\n\nf 1 2 3\n";
+        CHECK(!ObjLoader::Parse(bad, std::strlen(bad), model, &error));
+        CHECK(error.compare(0, 8, "line 4: ") == 0);
+
+        std::string large;
+        uint32 lineCount = 0;
+        while(large.size() < (4u << 20))
+        {
+            large += "v 0.125 0.25 0.5\n";
+            ++lineCount;
+        }
+        large += "f 1 2 x\n";
+
+        CHECK(!ObjLoader::Parse(large.data(), large.size(), model, &error));
+        std::string expected = "line " + std::to_string(lineCount + 1) + ": ";
+        CHECK(error.compare(0, expected.size(), expected) == 0);
+    }
+}
+
+int main()
+{
+    TestConvention();
+    TestErrorLine();
+
+    return TestCheck::Result("ObjLoaderTests");
+}
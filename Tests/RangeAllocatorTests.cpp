@@ -0,0 +1,198 @@
+//***************************************************************************************
+// RangeAllocatorTests.cpp
+//***************************************************************************************
+
+#include "RangeAllocator.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <map>
+#include <random>
+
+namespace
+{
+    using uint32 = std::uint32_t;
+    using Allocation = RangeAllocator::Allocation;
+
+    // Fills a fresh allocator front to back, runs out, and takes size 0 as a failure.
+    void TestAllocate()
+    {
+        RangeAllocator allocator(100);
+        CHECK(allocator.GetFreeSize() == 100);
+        CHECK(allocator.GetLargestFreeRange() == 100);
+        CHECK(!allocator.Allocate(0).IsValid());
+
+        Allocation a = allocator.Allocate(10);
+        Allocation b = allocator.Allocate(30);
+        Allocation c = allocator.Allocate(60);
+        CHECK(a.IsValid() && a.Offset == 0 && a.Size == 10);
+        CHECK(b.IsValid() && b.Offset == 10 && b.Size == 30);
+        CHECK(c.IsValid() && c.Offset == 40 && c.Size == 60);
+        CHECK(allocator.GetFreeSize() == 0);
+        CHECK(allocator.GetAllocationCount() == 3);
+        CHECK(allocator.GetLargestFreeRange() == 0);
+        CHECK(!allocator.Allocate(1).IsValid());
+
+        allocator.Free(b);
+        CHECK(allocator.GetFreeSize() == 30);
+        CHECK(!allocator.Allocate(31).IsValid());
+        Allocation d = allocator.Allocate(30);
+        CHECK(d.IsValid() && d.Offset == 10);
+
+        // Freeing an invalid allocation does nothing.
+        allocator.Free(Allocation());
+        CHECK(allocator.GetAllocationCount() == 3);
+
+        allocator.Reset();
+        CHECK(allocator.GetFreeSize() == 100 && allocator.GetAllocationCount() == 0);
+        CHECK(allocator.Allocate(100).Offset == 0);
+
+        RangeAllocator empty(0);
+        CHECK(!empty.Allocate(1).IsValid());
+        CHECK(empty.GetLargestFreeRange() == 0);
+    }
+
+    // Freed ranges merge with free neighbors on either side, in any order.
+    void TestCoalescing()
+    {
+        const uint32 orders[][3] = { { 0, 1, 2 }, { 2, 1, 0 }, { 0, 2, 1 }, { 1, 0, 2 }, { 1, 2, 0 }, { 2, 0, 1 } };
+        for(const auto& order : orders)
+        {
+            RangeAllocator allocator(300);
+            Allocation ranges[3] = { allocator.Allocate(100), allocator.Allocate(100), allocator.Allocate(100) };
+
+            for(uint32 i : order)
+                allocator.Free(ranges[i]);
+
+            CHECK(allocator.GetFreeSize() == 300);
+            CHECK(allocator.GetLargestFreeRange() == 300);
+            Allocation all = allocator.Allocate(300);
+            CHECK(all.IsValid() && all.Offset == 0);
+        }
+
+        // A hole between two used ranges stays a hole of exactly its size.
+        RangeAllocator allocator(300);
+        Allocation a = allocator.Allocate(100);
+        Allocation b = allocator.Allocate(100);
+        allocator.Allocate(100);
+        allocator.Free(b);
+        CHECK(allocator.GetLargestFreeRange() == 100);
+        allocator.Free(a);
+        CHECK(allocator.GetLargestFreeRange() == 200);
+    }
+
+    // Sizes at and next to the bin boundaries: the first bins hold one size each, then
+    // every power of two is split into 8 bins.  A free range of exactly the requested
+    // size has to be found even when it sits in the request's own bin, and a range one
+    // smaller must not be handed out.
+    void TestBinBoundaries()
+    {
+        std::vector<uint32> sizes;
+        for(uint32 size = 1; size <= 40; ++size)
+            sizes.push_back(size);
+        for(uint32 shift = 6; shift < 31; ++shift)
+        {
+            uint32 power = 1u << shift;
+            uint32 step = power >> 3;
+            for(uint32 start : { power, power + step, power + 7*step })
+            {
+                sizes.push_back(start - 1);
+                sizes.push_back(start);
+                sizes.push_back(start + 1);
+            }
+        }
+        sizes.push_back(0xffffffffu);
+
+        for(uint32 size : sizes)
+        {
+            // The whole space fits exactly.
+            RangeAllocator whole(size);
+            Allocation exact = whole.Allocate(size);
+            CHECK(exact.IsValid() && exact.Offset == 0 && exact.Size == size);
+
+            if(size < 3 || size > 0x7fffffff)
+                continue;
+
+            // A free range of size at the front, then a used range that blocks the rest,
+            // then a free range of size-1 at the back.
+            RangeAllocator allocator(2*size);
+            Allocation front = allocator.Allocate(size);
+            Allocation fence = allocator.Allocate(1);
+            CHECK(front.IsValid() && fence.IsValid());
+            allocator.Free(front);
+
+            Allocation again = allocator.Allocate(size);
+            CHECK(again.IsValid() && again.Offset == 0);
+            CHECK(!allocator.Allocate(size).IsValid());
+
+            Allocation tail = allocator.Allocate(size - 1);
+            CHECK(tail.IsValid() && tail.Offset == size + 1);
+        }
+    }
+
+    // Random allocations and frees against a map of the live ranges: no two overlap,
+    // everything stays inside the space, and the free size always adds up.
+    void TestRandom()
+    {
+        const uint32 size = 1 << 20;
+        RangeAllocator allocator(size);
+        std::map<uint32, Allocation> live;
+        uint32 used = 0;
+
+        std::mt19937 random(12345);
+        for(uint32 step = 0; step < 200000; ++step)
+        {
+            if(live.empty() || random() % 100 < 55)
+            {
+                // Mostly small requests with an occasional large one.
+                uint32 request = random() % 16 == 0 ? 1 + random() % (size/8) : 1 + random() % 2000;
+                Allocation a = allocator.Allocate(request);
+                if(!a.IsValid())
+                {
+                    CHECK(allocator.GetLargestFreeRange() < request);
+                    continue;
+                }
+
+                CHECK(a.Size == request && (std::uint64_t)a.Offset + a.Size <= size);
+
+                auto next = live.lower_bound(a.Offset);
+                if(next != live.end())
+                    CHECK(a.Offset + a.Size <= next->first);
+                if(next != live.begin())
+                {
+                    auto prev = std::prev(next);
+                    CHECK(prev->first + prev->second.Size <= a.Offset);
+                }
+
+                live[a.Offset] = a;
+                used += a.Size;
+            }
+            else
+            {
+                auto it = live.begin();
+                std::advance(it, random() % live.size());
+                used -= it->second.Size;
+                allocator.Free(it->second);
+                live.erase(it);
+            }
+
+            CHECK(allocator.GetFreeSize() == size - used);
+            CHECK(allocator.GetAllocationCount() == live.size());
+        }
+
+        for(const auto& entry : live)
+            allocator.Free(entry.second);
+
+        CHECK(allocator.GetFreeSize() == size);
+        CHECK(allocator.GetLargestFreeRange() == size);
+    }
+}
+
+int main()
+{
+    TestAllocate();
+    TestCoalescing();
+    TestBinBoundaries();
+    TestRandom();
+
+    return TestCheck::Result("RangeAllocatorTests");
+}
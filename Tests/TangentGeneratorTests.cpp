@@ -0,0 +1,87 @@
+//***************************************************************************************
+// TangentGeneratorTests.cpp
+//***************************************************************************************
+
+#include "TangentGenerator.h"
+#include "TestCheck.h"
+#include <algorithm>
+
+using namespace DirectX;
+
+namespace
+{
+    using uint32 = std::uint32_t;
+
+    // Fraction of triangle corners where w*cross(n, t) points along the triangle's uv
+    // bitangent dP/dv, (duv1.x*e2 - duv2.x*e1)/signedArea.
+    float BitangentAgreement(const GeometryGenerator::MeshData& mesh, const std::vector<float>& handedness)
+    {
+        uint32 agree = 0;
+        uint32 total = 0;
+        for(size_t i = 0; i + 2 < mesh.Indices32.size(); i += 3)
+        {
+            const uint32* tri = &mesh.Indices32[i];
+            const GeometryGenerator::Vertex& v0 = mesh.Vertices[tri[0]];
+            const GeometryGenerator::Vertex& v1 = mesh.Vertices[tri[1]];
+            const GeometryGenerator::Vertex& v2 = mesh.Vertices[tri[2]];
+
+            XMVECTOR e1 = XMLoadFloat3(&v1.Position) - XMLoadFloat3(&v0.Position);
+            XMVECTOR e2 = XMLoadFloat3(&v2.Position) - XMLoadFloat3(&v0.Position);
+            float du1 = v1.TexC.x - v0.TexC.x, dv1 = v1.TexC.y - v0.TexC.y;
+            float du2 = v2.TexC.x - v0.TexC.x, dv2 = v2.TexC.y - v0.TexC.y;
+            float signedArea = du1*dv2 - dv1*du2;
+            if(signedArea == 0.0f)
+                continue;
+
+            XMVECTOR bitangent = (du1*e2 - du2*e1)/signedArea;
+            for(uint32 k = 0; k < 3; ++k)
+            {
+                const GeometryGenerator::Vertex& v = mesh.Vertices[tri[k]];
+                XMVECTOR frame = handedness[tri[k]]*XMVector3Cross(XMLoadFloat3(&v.Normal), XMLoadFloat3(&v.TangentU));
+                agree += XMVectorGetX(XMVector3Dot(frame, bitangent)) > 0.0f ? 1 : 0;
+                ++total;
+            }
+        }
+        return total > 0 ? (float)agree/total : 0.0f;
+    }
+
+    void TestHandedness()
+    {
+        GeometryGenerator geoGen;
+        GeometryGenerator::MeshData sphere = geoGen.CreateSphere(1.0f, 24, 24);
+
+        std::vector<float> handedness;
+        GeometryGenerator::MeshData generated = sphere;
+        TangentGenerator::Generate(generated, &handedness);
+        CHECK(std::all_of(handedness.begin(), handedness.end(), [](float w) { return w == 1.0f; }));
+        CHECK(BitangentAgreement(generated, handedness) > 0.95f);
+
+        // The same surface wound the other way, with its normals left as they are,
+        // must keep its frames.
+        GeometryGenerator::MeshData reversed = sphere;
+        for(size_t i = 0; i + 2 < reversed.Indices32.size(); i += 3)
+            std::swap(reversed.Indices32[i+1], reversed.Indices32[i+2]);
+
+        std::vector<float> reversedHandedness;
+        TangentGenerator::Generate(reversed, &reversedHandedness);
+        CHECK(reversedHandedness == handedness);
+        CHECK(BitangentAgreement(reversed, reversedHandedness) > 0.95f);
+
+        // Mirrored uvs flip the handedness.
+        GeometryGenerator::MeshData mirrored = sphere;
+        for(GeometryGenerator::Vertex& v : mirrored.Vertices)
+            v.TexC.x = 1.0f - v.TexC.x;
+
+        std::vector<float> mirroredHandedness;
+        TangentGenerator::Generate(mirrored, &mirroredHandedness);
+        CHECK(std::all_of(mirroredHandedness.begin(), mirroredHandedness.end(), [](float w) { return w == -1.0f; }));
+        CHECK(BitangentAgreement(mirrored, mirroredHandedness) > 0.95f);
+    }
+}
+
+int main()
+{
+    TestHandedness();
+
+    return TestCheck::Result("TangentGeneratorTests");
+}
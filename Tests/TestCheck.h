@@ -0,0 +1,44 @@
+//***************************************************************************************
+// TestCheck.h
+//
+// Checks for the test executables.  A failed CHECK prints the expression and where it
+// is and the test carries on; main returns TestCheck::Result, which is nonzero after
+// any failure so ctest reports the test as failed.
+//***************************************************************************************
+
+#pragma once
+
+#include <cstdio>
+
+namespace TestCheck
+{
+    inline int& FailureCount()
+    {
+        static int count = 0;
+        return count;
+    }
+
+    inline bool Report(bool passed, const char* expression, const char* file, int line)
+    {
+        if(!passed)
+        {
+            std::fprintf(stderr, "%s(%d): CHECK failed: %s\n", file, line, expression);
+            ++FailureCount();
+        }
+        return passed;
+    }
+
+    inline int Result(const char* testName)
+    {
+        if(FailureCount() == 0)
+        {
+            std::printf("%s: passed\n", testName);
+            return 0;
+        }
+
+        std::printf("%s: %d check(s) failed\n", testName, FailureCount());
+        return 1;
+    }
+}
+
+#define CHECK(expression) TestCheck::Report(!!(expression), #expression, __FILE__, __LINE__)
@@ -0,0 +1,141 @@
+//***************************************************************************************
+// VertexPackingTests.cpp
+//
+// Pack/Unpack round trips must stay within what the format allows: half a 16-bit step
+// per axis for positions, half-precision rounding for uv, and 1 degree for normals and
+// tangents (the octahedral 8-bit worst case is about 0.95).
+//***************************************************************************************
+
+#include "VertexPacking.h"
+#include "TestCheck.h"
+#include <algorithm>
+#include <cfloat>
+#include <cmath>
+
+using namespace DirectX;
+
+namespace
+{
+    using uint32 = std::uint32_t;
+
+    // Largest errors of a round trip.  Angles are in degrees.
+    struct RoundTripError
+    {
+        float MaxPositionError = 0.0f;
+        float MaxTexCError = 0.0f;
+        float MaxNormalAngle = 0.0f;
+        float MaxTangentAngle = 0.0f;
+        bool WithinBounds = true;
+    };
+
+    // Degrees between a vector and its unit-length decode; -1 for zero-length input,
+    // which has no direction to keep.
+    float Angle(const XMFLOAT3& original, const XMFLOAT3& decoded)
+    {
+        XMVECTOR a = XMLoadFloat3(&original);
+        if(XMVectorGetX(XMVector3LengthSq(a)) < 1e-12f)
+            return -1.0f;
+
+        float cosine = XMVectorGetX(XMVector3Dot(XMVector3Normalize(a), XMLoadFloat3(&decoded)));
+        return XMConvertToDegrees(std::acos(std::min(std::max(cosine, -1.0f), 1.0f)));
+    }
+
+    // Packs and unpacks vertices against their own bounds and measures the error.
+    RoundTripError MeasureRoundTrip(const std::vector<GeometryGenerator::Vertex>& vertices)
+    {
+        RoundTripError error;
+        uint32 vertexCount = (uint32)vertices.size();
+
+        PackedVertexBounds bounds = VertexPacking::ComputeBounds(vertices.data(), vertexCount);
+        std::vector<PackedVertex> packed(vertexCount);
+        std::vector<GeometryGenerator::Vertex> unpacked(vertexCount);
+        VertexPacking::Pack(packed.data(), vertices.data(), vertexCount, bounds);
+        VertexPacking::Unpack(unpacked.data(), packed.data(), vertexCount, bounds);
+
+        // Half a quantization step on every axis, plus float rounding in the decode.
+        XMVECTOR extents = XMLoadFloat3(&bounds.Extents);
+        float positionBound = XMVectorGetX(XMVector3Length(extents)) / 65535.0f * 1.05f +
+            4.0f*FLT_EPSILON*XMVectorGetX(XMVector3Length(XMVectorAbs(XMLoadFloat3(&bounds.Center)) + extents));
+        const float angleBound = 1.0f;
+
+        for(uint32 i = 0; i < vertexCount; ++i)
+        {
+            const GeometryGenerator::Vertex& a = vertices[i];
+            const GeometryGenerator::Vertex& b = unpacked[i];
+
+            float position = XMVectorGetX(XMVector3Length(XMLoadFloat3(&a.Position) - XMLoadFloat3(&b.Position)));
+            error.MaxPositionError = std::max(error.MaxPositionError, position);
+            error.WithinBounds = error.WithinBounds && position <= positionBound;
+
+            // Round to nearest half: at most half an ulp, 2^-11 relative, or 2^-25 once denormal.
+            const float texC[2][2] = { { a.TexC.x, b.TexC.x }, { a.TexC.y, b.TexC.y } };
+            for(const auto& c : texC)
+            {
+                float difference = std::fabs(c[0] - c[1]);
+                error.MaxTexCError = std::max(error.MaxTexCError, difference);
+                error.WithinBounds = error.WithinBounds && difference <= std::max(std::fabs(c[0])*(1.0f/2048.0f), 1.0f/33554432.0f);
+            }
+
+            float normal = Angle(a.Normal, b.Normal);
+            float tangent = Angle(a.TangentU, b.TangentU);
+            error.MaxNormalAngle = std::max(error.MaxNormalAngle, normal);
+            error.MaxTangentAngle = std::max(error.MaxTangentAngle, tangent);
+            error.WithinBounds = error.WithinBounds && normal <= angleBound && tangent <= angleBound;
+        }
+
+        return error;
+    }
+
+    void Print(const char* name, const RoundTripError& error)
+    {
+        std::printf("%-10s position %.2e  uv %.2e  normal %.2f deg  tangent %.2f deg\n", name,
+            error.MaxPositionError, error.MaxTexCError, error.MaxNormalAngle, error.MaxTangentAngle);
+    }
+
+    // A radius-3 geosphere and a cylinder, generated meshes as they are drawn.
+    void TestGeneratedMeshes()
+    {
+        GeometryGenerator geoGen;
+        GeometryGenerator::MeshData mesh = geoGen.CreateGeosphere(3.0f, 4);
+        GeometryGenerator::MeshData cylinder = geoGen.CreateCylinder(1.0f, 0.5f, 3.0f, 32, 8);
+        mesh.Vertices.insert(mesh.Vertices.end(), cylinder.Vertices.begin(), cylinder.Vertices.end());
+
+        RoundTripError error = MeasureRoundTrip(mesh.Vertices);
+        Print("meshes", error);
+        CHECK(error.WithinBounds);
+    }
+
+    // Directions spread densely over the sphere, so the octahedral worst case is hit,
+    // with positions far from the origin and a zero-length tangent.
+    void TestDirections()
+    {
+        std::vector<GeometryGenerator::Vertex> vertices;
+        const uint32 steps = 128;
+        for(uint32 i = 0; i <= steps; ++i)
+        {
+            for(uint32 j = 0; j < 2*steps; ++j)
+            {
+                float phi = XM_PI*i/steps;
+                float theta = XM_PI*j/steps;
+                XMFLOAT3 n(std::sin(phi)*std::cos(theta), std::cos(phi), std::sin(phi)*std::sin(theta));
+                XMFLOAT3 t(-std::sin(theta), 0.0f, std::cos(theta));
+                vertices.emplace_back(1000.0f + n.x, -50.0f + n.y, n.z, n.x, n.y, n.z, t.x, t.y, t.z,
+                    (float)j/(2*steps - 1), (float)i/steps);
+            }
+        }
+        vertices[0].TangentU = XMFLOAT3(0.0f, 0.0f, 0.0f);
+
+        RoundTripError error = MeasureRoundTrip(vertices);
+        Print("directions", error);
+        CHECK(error.WithinBounds);
+        CHECK(error.MaxNormalAngle > 0.5f);
+    }
+}
+
+int main()
+{
+    TestGeneratedMeshes();
+    TestDirections();
+
+    return TestCheck::Result("VertexPackingTests");
+}